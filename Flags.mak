@@ -32,8 +32,10 @@ endif
 
 ifeq ($(POSIX),yes)
   STD = -std=c99 -DPOSIX
+  POSIXLIB = -lpthread
 else
   STD = -std=c99
+  POSIXLIB =
 endif
 
 ifneq ($(HDF5),yes)
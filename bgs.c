@@ -36,6 +36,11 @@
 #include "lis.h"
 #endif
 
+#if OMP
+#include <omp.h>
+#include "ompu.h"
+#endif
+
 /* timers */
 #if TIMERS
 #define S(LABEL) SOLFEC_Timer_Start (ldy->dom->solfec, LABEL)
@@ -177,15 +182,13 @@ static void receive_middle_reactions (DOM *dom, COMDATA *recv, int nrecv, MEM *s
   }
 }
 
-/* a single row Gauss-Seidel step */
-static int gauss_seidel (GAUSS_SEIDEL *gs, short dynamic, double step, DIAB *dia, double *errup, double *errlo)
+/* compute local velocity from the current reactions */
+static void local_velocity (DIAB *dia, double *B)
 {
-  double R0 [3], B [3], *R, *W;
-  int diagiters;
+  double *R, *W;
   OFFB *blk;
   CON *con;
 
-  /* compute local velocity */
   COPY (dia->B, B);
   for (blk = dia->adj; blk; blk = blk->n)
   {
@@ -200,14 +203,14 @@ static int gauss_seidel (GAUSS_SEIDEL *gs, short dynamic, double step, DIAB *dia
     R = con->R;
     NVADDMUL (B, W, R, B);
   }
- 
-  R = dia->R; 
-  COPY (R, R0); /* previous reaction */
+}
 
-  /* solve local diagonal block problem */
-  con = dia->con;
-  diagiters = DIAGONAL_BLOCK_Solver (gs->diagsolver, gs->diagepsilon, gs->diagmaxiter, dynamic,
-                    step, con->kind, &con->mat, con->gap, con->area, con->Z, con->base, dia, B);
+/* retry a failed diagonal block solution and accumulate relative error components */
+static int diagonal_outcome (GAUSS_SEIDEL *gs, short dynamic, double step, DIAB *dia,
+  double *B, double *R0, int diagiters, double *errup, double *errlo)
+{
+  double *R = dia->R;
+  CON *con = dia->con;
 
   if (diagiters >= gs->diagmaxiter || diagiters < 0) /* failed */
   {
@@ -244,6 +247,25 @@ static int gauss_seidel (GAUSS_SEIDEL *gs, short dynamic, double step, DIAB *dia
   return diagiters;
 }
 
+/* a single row Gauss-Seidel step */
+static int gauss_seidel (GAUSS_SEIDEL *gs, short dynamic, double step, DIAB *dia, double *errup, double *errlo)
+{
+  double R0 [3], B [3];
+  int diagiters;
+  CON *con;
+
+  local_velocity (dia, B);
+
+  COPY (dia->R, R0); /* previous reaction */
+
+  /* solve local diagonal block problem */
+  con = dia->con;
+  diagiters = DIAGONAL_BLOCK_Solver (gs->diagsolver, gs->diagepsilon, gs->diagmaxiter, dynamic,
+                    step, con->kind, &con->mat, con->gap, con->area, con->Z, con->base, dia, B);
+
+  return diagonal_outcome (gs, dynamic, step, dia, B, R0, diagiters, errup, errlo);
+}
+
 /* a Guss-Seidel sweep over a set of blocks */
 static int gauss_seidel_sweep (SET *set, int reverse, GAUSS_SEIDEL *gs, short dynamic, double step, int loops, double *errup, double *errlo)
 {
@@ -275,6 +297,148 @@ static int gauss_seidel_sweep (SET *set, int reverse, GAUSS_SEIDEL *gs, short dy
   return dimax;
 }
 
+typedef struct colors COLORS;
+
+#if OMP
+/* a set of blocks split into colors of mutually non-adjacent blocks; blocks of one color can
+ * be relaxed concurrently since external reactions do not change during a sweep; MPI is not
+ * called during such sweeps, so that the MPI_THREAD_FUNNELED support level is sufficient */
+struct colors
+{
+  DIAB **dia; /* blocks ordered by colors */
+
+  int *first; /* blocks of color i are dia [first [i]], ..., dia [first [i+1]-1] */
+
+  int colors; /* number of colors */
+
+  double *errup, *errlo; /* per-block error components */
+};
+
+/* color a set of blocks */
+static COLORS* colors_create (LOCDYN *ldy, SET *set)
+{
+  int i, n, m, *pos;
+  COLORS *cs;
+  DIAB *dia;
+  OFFB *blk;
+  SET *item;
+
+  n = SET_Size (set);
+  if (n == 0) return NULL;
+
+  for (dia = ldy->dia; dia; dia = dia->n) dia->calm = -1; /* 'calm' is used by the serial solver only; here it holds colors */
+  for (item = SET_First (set); item; item = SET_Next (item)) ((DIAB*)item->data)->calm = 0; /* set members are uncolored */
+
+  for (m = 0, item = SET_First (set); item; item = SET_Next (item)) /* simple greedy coloring */
+  {
+    dia = item->data;
+
+    do
+    {
+      dia->calm ++; /* start from first color */
+
+      for (blk = dia->adj; blk; blk = blk->n) /* for each adjacent block */
+      {
+	if (blk->dia->calm == dia->calm) break; /* see whether the trial color exists in the adjacency */
+      }
+    }
+    while (blk); /* if so try next color */
+
+    m = MAX (m, dia->calm);
+  }
+
+  ERRMEM (cs = malloc (sizeof (COLORS)));
+  ERRMEM (cs->dia = malloc (sizeof (DIAB* [n])));
+  ERRMEM (cs->first = MEM_CALLOC (sizeof (int [m+1])));
+  ERRMEM (pos = malloc (sizeof (int [m])));
+  ERRMEM (cs->errup = malloc (sizeof (double [2*n])));
+  cs->errlo = cs->errup + n;
+  cs->colors = m;
+
+  for (item = SET_First (set); item; item = SET_Next (item)) cs->first [((DIAB*)item->data)->calm] ++; /* colors are 1, 2, ..., m */
+  for (i = 0; i < m; i ++) cs->first [i+1] += cs->first [i], pos [i] = cs->first [i]; /* number of blocks with smaller colors */
+  for (item = SET_First (set); item; item = SET_Next (item)) /* the set order is preserved within colors */
+  {
+    dia = item->data;
+    cs->dia [pos [dia->calm-1] ++] = dia;
+  }
+
+  free (pos);
+
+  return cs;
+}
+
+/* release colors */
+static void colors_destroy (COLORS *cs)
+{
+  if (cs)
+  {
+    free (cs->dia);
+    free (cs->first);
+    free (cs->errup);
+    free (cs);
+  }
+}
+
+/* a multi-threaded Gauss-Seidel sweep over a colored set of blocks */
+static int colored_sweep (COLORS *cs, int reverse, GAUSS_SEIDEL *gs, short dynamic, double step, int loops, double *errup, double *errlo)
+{
+  int i, dimax = 0;
+
+  #pragma omp parallel
+  {
+    for (int n = 0; n < loops; n ++)
+    {
+      for (int c = 0; c < cs->colors; c ++)
+      {
+	int k = reverse ? cs->colors - 1 - c : c;
+
+	#pragma omp for reduction (max:dimax)
+	for (int j = cs->first [k]; j < cs->first [k+1]; j += DBS_LANES) /* blocks of a color are solved in batches */
+	{
+	  int m = MIN (DBS_LANES, cs->first [k+1] - j), iters [DBS_LANES];
+	  double B [3*DBS_LANES], R0 [DBS_LANES][3];
+
+	  for (int l = 0; l < m; l ++)
+	  {
+	    local_velocity (cs->dia [j+l], &B[3*l]);
+	    COPY (cs->dia [j+l]->R, R0 [l]); /* previous reaction */
+	  }
+
+	  DIAGONAL_BLOCK_Solver_Batch (gs->diagsolver, gs->diagepsilon, gs->diagmaxiter, dynamic, step, m, &cs->dia [j], B, iters);
+
+	  for (int l = 0; l < m; l ++)
+	  {
+	    double up = 0.0, lo = 0.0;
+	    int di = diagonal_outcome (gs, dynamic, step, cs->dia [j+l], &B[3*l], R0 [l], iters [l], &up, &lo);
+	    if (n == 0) cs->errup [j+l] = up, cs->errlo [j+l] = lo; /* first loop contributes to the outputed error components */
+	    dimax = MAX (dimax, di);
+	  }
+	}
+      }
+    }
+  }
+
+  for (i = 0; i < cs->first [cs->colors]; i ++) /* summed in the block order so that the error does not depend on timing */
+  {
+    *errup += cs->errup [i];
+    *errlo += cs->errlo [i];
+  }
+
+  return dimax;
+}
+#endif
+
+/* a Gauss-Seidel sweep over a set of blocks; colored sets are relaxed by all threads */
+static int sweep (SET *set, COLORS *cs, int reverse, GAUSS_SEIDEL *gs, short dynamic, double step, int loops, double *errup, double *errlo)
+{
+#if OMP
+  if (cs) return colored_sweep (cs, reverse, gs, dynamic, step, loops, errup, errlo);
+#endif
+
+  return gauss_seidel_sweep (set, reverse, gs, dynamic, step, loops, errup, errlo);
+}
+
 /* middle node list needs score-based sorting */
 typedef struct middle_list MIDDLE_NODE;
 
@@ -464,6 +628,11 @@ GAUSS_SEIDEL* GAUSS_SEIDEL_Create (double epsilon, int maxiter, double meritval,
   gs->innerloops = 1;
   gs->verbose = 1;
   gs->nomerit = 0;
+  gs->meritmode = GS_MERIT_EXACT;
+  gs->schedule = GS_SCHEDULE_FULL;
+  gs->parksweeps = 3;
+  gs->relaxed = 0;
+  gs->skipped = 0;
   gs->itershist = NULL;
   gs->itershistcount = -1;
   gs->itershistsize = 0;
@@ -517,6 +686,13 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
 
   int nsend, nrecv, size;
 
+  COLORS *bottom_colors = NULL, /* colored sets relaxed by threads */
+         *top_colors    = NULL,
+	 *middle_colors = NULL,
+	 *int1_colors   = NULL,
+	 *int2_colors   = NULL,
+	 *all_colors    = NULL;
+
   S("GSINIT");
 
   dom = ldy->dom;
@@ -735,6 +911,18 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
     }
   }
 
+#if OMP
+  if (ompu_threads () > 1) /* hybrid mode: sets swept without communication are relaxed by colors */
+  {
+    bottom_colors = colors_create (ldy, bottom);
+    top_colors = colors_create (ldy, top);
+    int1_colors = colors_create (ldy, int1);
+    int2_colors = colors_create (ldy, int2);
+    if (gs->variant == GS_MIDDLE_JACOBI) middle_colors = colors_create (ldy, middle);
+    all_colors = colors_create (ldy, all);
+  }
+#endif
+
   dynamic = dom->dynamic;
   step = dom->step;
   gs->error = GS_OK;
@@ -756,9 +944,9 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
     {
       if (gs->variant != GS_BOUNDARY_JACOBI)
       {
-	S("GSRUN"); di = gauss_seidel_sweep (bottom, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	S("GSRUN"); di = sweep (bottom, bottom_colors, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
 	S("GSCOM"); COM_Send (bot_pattern); E("GSCOM");
-	S("GSRUN"); di = gauss_seidel_sweep (int1, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	S("GSRUN"); di = sweep (int1, int1_colors, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
 	S("GSCOM"); COM_Recv (bot_pattern); receive_reactions (dom, recv_bot, nrecv_bot); E("GSCOM");
 
 	if (gs->variant == GS_FULL)
@@ -767,27 +955,27 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
 	}
 	else /* GS_MIDDLE_JACOBI */
 	{
-	  S("GSRUN"); di = gauss_seidel_sweep (middle, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	  S("GSRUN"); di = sweep (middle, middle_colors, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
 	  S("GSCOM"); COM_Repeat (mid_pattern); receive_reactions (dom, recv_mid, nrecv_mid); E("GSCOM");
 	}
 
-	S("GSRUN"); di = gauss_seidel_sweep (top, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	S("GSRUN"); di = sweep (top, top_colors, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
 	S("GSCOM"); COM_Send (top_pattern); E("GSCOM");
-	S("GSRUN"); di = gauss_seidel_sweep (int2, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	S("GSRUN"); di = sweep (int2, int2_colors, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
 	S("GSCOM"); COM_Recv (top_pattern); receive_reactions (dom, recv_top, nrecv_top); E("GSCOM");
       }
       else
       {
-	S("GSRUN"); di = gauss_seidel_sweep (all, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	S("GSRUN"); di = sweep (all, all_colors, 1, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
       }
     }
     else
     {
       if (gs->variant != GS_BOUNDARY_JACOBI)
       {
-	S("GSRUN"); di = gauss_seidel_sweep (top, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	S("GSRUN"); di = sweep (top, top_colors, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
 	S("GSCOM"); COM_Send (top_pattern); E("GSCOM");
-	S("GSRUN"); di = gauss_seidel_sweep (int2, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN"); /* large |top| => large |int2| */
+	S("GSRUN"); di = sweep (int2, int2_colors, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN"); /* large |top| => large |int2| */
 	S("GSCOM"); COM_Recv (top_pattern); receive_reactions (dom, recv_top, nrecv_top); E("GSCOM");
 
 	if (gs->variant == GS_FULL)
@@ -796,18 +984,18 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
 	}
 	else /* GS_MIDDLE_JACOBI */
 	{
-	  S("GSRUN"); di = gauss_seidel_sweep (middle, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	  S("GSRUN"); di = sweep (middle, middle_colors, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
 	  S("GSCOM"); COM_Repeat (mid_pattern); receive_reactions (dom, recv_mid, nrecv_mid); E("GSCOM");
 	}
 
-	S("GSRUN"); di = gauss_seidel_sweep (bottom, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	S("GSRUN"); di = sweep (bottom, bottom_colors, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
 	S("GSCOM"); COM_Send (bot_pattern); E("GSCOM");
-	S("GSRUN"); di = gauss_seidel_sweep (int1, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	S("GSRUN"); di = sweep (int1, int1_colors, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
 	S("GSCOM"); COM_Recv (bot_pattern); receive_reactions (dom, recv_bot, nrecv_bot); E("GSCOM");
       }
       else
       {
-	S("GSRUN"); di = gauss_seidel_sweep (all, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
+	S("GSRUN"); di = sweep (all, all_colors, 0, gs, dynamic, step, gs->innerloops, &errup, &errlo); dimax = MAX (dimax, di); E("GSRUN");
       }
     }
 
@@ -870,6 +1058,15 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
       free (recv_mid);
     }
   }
+#if OMP
+  colors_destroy (bottom_colors);
+  colors_destroy (top_colors);
+  colors_destroy (middle_colors);
+  colors_destroy (int1_colors);
+  colors_destroy (int2_colors);
+  colors_destroy (all_colors);
+#endif
+
   MEM_Release (&setmem);
 
   /* get maximal iterations count of a diagonal block solver (this has been
@@ -912,9 +1109,9 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
 /* run serial solver */
 void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
 {
-  double error, *merit, step;
-  int verbose, diagiters;
-  short dynamic, nomerit;
+  short dynamic, nomerit, incmerit, exact, active, converged;
+  double error, *merit, step, eps2;
+  int verbose, diagiters, parked;
   char fmt [512];
   int div = 10;
   DIAB *end;
@@ -928,6 +1125,14 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
 
   if (nomerit) *merit = 0.0;
 
+  incmerit = !nomerit && gs->meritmode == GS_MERIT_INCREMENTAL;
+
+  exact = 1;
+
+  active = gs->schedule == GS_SCHEDULE_ACTIVE;
+
+  eps2 = gs->epsilon * gs->epsilon;
+
   if (verbose) sprintf (fmt, "GAUSS_SEIDEL: iteration: %%%dd  error:  %%.2e  merit:  %%.2e\n", (int)log10 (gs->maxiter) + 1);
 
   gs->rerhist = realloc (gs->rerhist, gs->maxiter * sizeof (double));
@@ -936,6 +1141,11 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
   if (gs->reverse && ldy->dia) for (end = ldy->dia; end->n; end = end->n); /* find last block for the backward run */
   else end = NULL;
 
+  if (active)
+  {
+    for (DIAB *dia = ldy->dia; dia; dia = dia->n) dia->calm = 0; /* all blocks are active initially */
+  }
+
   dynamic = ldy->dom->dynamic;
   step = ldy->dom->step;
   gs->error = GS_OK;
@@ -943,9 +1153,12 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
   do
   {
     double errup = 0.0,
-	   errlo = 0.0;
+	   errlo = 0.0,
+	   meritup = 0.0;
     OFFB *blk;
     DIAB *dia;
+
+    parked = 0;
    
     for (dia = end && gs->iters % 2 ? end : ldy->dia; dia; dia = end && gs->iters % 2 ? dia->p : dia->n) /* run forward and backward alternately */
     {
@@ -953,6 +1166,16 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
 	     B [3],
 	     *R = dia->R;
 
+      if (active && dia->calm >= gs->parksweeps) /* skip a parked block */
+      {
+	errlo += DOT (R, R);
+	parked ++;
+	gs->skipped ++;
+	continue;
+      }
+
+      gs->relaxed ++;
+
       /* compute local free velocity */
       COPY (dia->B, B);
       for (blk = dia->adj; blk; blk = blk->n)
@@ -964,6 +1187,10 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
       
       COPY (R, R0); /* previous reaction */
 
+      /* current local velocity: diagonal solvers start from it, hence
+       * iterates do not depend on whether the merit is exact or estimated */
+      NVADDMUL (B, dia->W, R, dia->U);
+
       /* solve local diagonal block problem */
       CON *con = dia->con;
       diagiters = DIAGONAL_BLOCK_Solver (gs->diagsolver, gs->diagepsilon, gs->diagmaxiter, dynamic,
@@ -1011,29 +1238,76 @@ void GAUSS_SEIDEL_Solve (GAUSS_SEIDEL *gs, LOCDYN *ldy)
 	}
       }
 
+      /* accumulate merit function
+       * from the local velocity */
+      if (incmerit)
+      {
+	double U [3]; /* dia->U holds the diagonal solver output */
+
+	NVADDMUL (B, dia->W, R, U);
+	meritup += MERIT_Block (ldy, dia, U);
+      }
+
       /* accumulate relative
        * error components */
       SUB (R, R0, R0);
-      errup += DOT (R0, R0);
-      errlo += DOT (R, R);
+      double up = DOT (R0, R0),
+	     lo = DOT (R, R);
+      errup += up;
+      errlo += lo;
+
+      if (active)
+      {
+	if (up <= eps2 * lo) dia->calm ++; /* calm sweep */
+	else
+	{
+	  dia->calm = 0; /* significant change => reactivate neighbours */
+	  for (blk = dia->adj; blk; blk = blk->n) blk->dia->calm = 0;
+	}
+      }
     }
 
+    /* calculate relative error */
+    error = sqrt (errup) / sqrt (errlo == 0.0 ? 1.0 : errlo);
+
     /* merit function value */
     if (!nomerit)
     {
-      *merit = MERIT_Function (ldy, 1);
+      /* while error > epsilon the merit value does
+       * not affect termination: use the estimate */
+      if (incmerit && error > gs->epsilon)
+      {
+	*merit = MERIT_Estimate (ldy, meritup);
+	exact = 0;
+      }
+      else
+      {
+	*merit = MERIT_Function (ldy, 1);
+	exact = 1;
+      }
     }
 
-    /* calculate relative error */
-    error = sqrt (errup) / sqrt (errlo == 0.0 ? 1.0 : errlo);
-
     /* record values */
     gs->rerhist [gs->iters] = error;
     gs->merhist [gs->iters] = *merit;
 
     if (gs->iters % div == 0 && verbose) printf (fmt, gs->iters, error, *merit), div *= 2;
+
+    converged = error <= gs->epsilon && *merit <= gs->meritval;
+
+    if (converged && parked) /* confirm convergence with a sweep over all blocks */
+    {
+      for (dia = ldy->dia; dia; dia = dia->n) dia->calm = 0;
+      converged = 0;
+    }
+  }
+  while (++ gs->iters < gs->maxiter && !converged);
+
+  if (!exact) /* make the final merit value and U exact */
+  {
+    *merit = MERIT_Function (ldy, 1);
+    gs->merhist [gs->iters-1] = *merit;
   }
-  while (++ gs->iters < gs->maxiter && (error > gs->epsilon || *merit > gs->meritval));
 
   if (gs->itershistcount >= 0)
   {
@@ -1135,6 +1409,30 @@ char* GAUSS_SEIDEL_Variant (GAUSS_SEIDEL *gs)
   return NULL;
 }
 
+/* return merit mode string */
+char* GAUSS_SEIDEL_Meritmode (GAUSS_SEIDEL *gs)
+{
+  switch (gs->meritmode)
+  {
+  case GS_MERIT_EXACT: return "EXACT";
+  case GS_MERIT_INCREMENTAL: return "INCREMENTAL";
+  }
+
+  return NULL;
+}
+
+/* return schedule string */
+char* GAUSS_SEIDEL_Schedule (GAUSS_SEIDEL *gs)
+{
+  switch (gs->schedule)
+  {
+  case GS_SCHEDULE_FULL: return "FULL";
+  case GS_SCHEDULE_ACTIVE: return "ACTIVE";
+  }
+
+  return NULL;
+}
+
 /* write labeled satate values */
 void GAUSS_SEIDEL_Write_State (GAUSS_SEIDEL *gs, PBF *bf)
 {
@@ -56,10 +56,24 @@ enum gsvariant
   GS_BOUNDARY_JACOBI
 };
 
+enum gsmerit
+{
+  GS_MERIT_EXACT,
+  GS_MERIT_INCREMENTAL
+};
+
+enum gsschedule
+{
+  GS_SCHEDULE_FULL,
+  GS_SCHEDULE_ACTIVE
+};
+
 typedef enum gserror GSERROR;
 typedef enum gsfail GSFAIL;
 typedef enum gsonoff GSONOFF;
 typedef enum gsvariant GSVARIANT;
+typedef enum gsmerit GSMERIT;
+typedef enum gsschedule GSSCHEDULE;
 
 struct gs
 {
@@ -108,6 +122,16 @@ struct gs
   short verbose; /* local verbosity flag */
 
   short nomerit; /* merit function evaluation flag */
+
+  GSMERIT meritmode; /* exact merit after every sweep or its incremental estimate while error > epsilon (serial mode) */
+
+  GSSCHEDULE schedule; /* sweep over all blocks or skip the converged ones (serial mode) */
+
+  int parksweeps; /* number of calm sweeps after which a block is skipped in the GS_SCHEDULE_ACTIVE mode */
+
+  long relaxed; /* total number of diagonal block updates (serial mode) */
+
+  long skipped; /* total number of diagonal block updates skipped in the GS_SCHEDULE_ACTIVE mode (serial mode) */
 };
 
 /* create solver */
@@ -133,6 +157,12 @@ char* GAUSS_SEIDEL_Reverse (GAUSS_SEIDEL *gs);
 /* return variant string */
 char* GAUSS_SEIDEL_Variant (GAUSS_SEIDEL *gs);
 
+/* return merit mode string */
+char* GAUSS_SEIDEL_Meritmode (GAUSS_SEIDEL *gs);
+
+/* return schedule string */
+char* GAUSS_SEIDEL_Schedule (GAUSS_SEIDEL *gs);
+
 /* write labeled satate values */
 void GAUSS_SEIDEL_Write_State (GAUSS_SEIDEL *gs, PBF *bf);
 
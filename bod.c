@@ -818,7 +818,6 @@ static char* copylabel (char *label)
   return out;
 }
 
-#if MPI
 static int conf_pack_size (BODY *bod)
 {
   switch (bod->kind)
@@ -844,7 +843,6 @@ static int velo_pack_size (BODY *bod)
 
   return 0;
 }
-#endif
 
 /* compute work of contact constraints */
 static void compute_contacts_work (BODY *bod, double step)
@@ -1010,6 +1008,9 @@ BODY* BODY_Create (short kind, SHAPE *shp, BULK_MATERIAL *mat, char *label, BODY
   /* initial damping */
   bod->damping = 0.0;
 
+  /* default refactorization */
+  bod->refactor = REF_FULL;
+
 #if MPI
   bod->children = bod->prevchildren = NULL;
 
@@ -2043,6 +2044,7 @@ void BODY_Split (BODY *bod, double *point, double *normal, short topoadj, int su
       COPY6 (bod->extents, out[i]->extents);
       out [i]->scheme = bod->scheme;
       out [i]->damping = bod->damping;
+      out [i]->refactor = bod->refactor;
     }
   }
 
@@ -2083,6 +2085,7 @@ int BODY_Split_Mesh (BODY *bod, int *surf, int sid1, int sid2, char *label1, cha
                 bod->flags & BODY_PERMANENT_FLAGS, bod->form, NULL, NULL, NULL, NULL);
     (*bod1)->scheme = bod->scheme;
     (*bod1)->damping = bod->damping;
+    (*bod1)->refactor = bod->refactor;
     (*lst1) = lst[0];
     (*nlst1) = nlst[0];
     free (out);
@@ -2100,8 +2103,10 @@ int BODY_Split_Mesh (BODY *bod, int *surf, int sid1, int sid2, char *label1, cha
                 bod->flags & BODY_PERMANENT_FLAGS, bod->form, NULL, NULL, NULL, NULL);
     (*bod1)->scheme = bod->scheme;
     (*bod1)->damping = bod->damping;
+    (*bod1)->refactor = bod->refactor;
     (*bod2)->scheme = bod->scheme;
     (*bod2)->damping = bod->damping;
+    (*bod2)->refactor = bod->refactor;
     (*lst1) = lst[0];
     (*nlst1) = nlst[0];
     (*lst2) = lst[1];
@@ -2182,6 +2187,7 @@ BODY** BODY_Separate (BODY *bod, int *m)
     COPY6 (bod->extents, out[i]->extents);
     out [i]->scheme = bod->scheme;
     out [i]->damping = bod->damping;
+    out [i]->refactor = bod->refactor;
 
     vtot += out [i]->ref_volume;
   }
@@ -2199,6 +2205,26 @@ BODY** BODY_Separate (BODY *bod, int *m)
   return out;
 }
 
+/* update body after its state has been red */
+static void post_read (BODY *bod)
+{
+  /* post-process red data if needed */
+  if (bod->kind == FEM) FEM_Post_Read (bod);
+
+  /* update shape */
+  SHAPE_Update (bod->shape, bod, (MOTION)BODY_Cur_Point); 
+  if (bod->msh) FEM_Update_Rough_Mesh (bod);
+
+#if !MPI
+  /* update display points */
+  for (SET *item = SET_First (bod->displaypoints); item; item = SET_Next (item))
+  {
+    DISPLAY_POINT *point = item->data;
+    BODY_Cur_Point (bod, point->sgp, point->X, point->x);
+  }
+#endif
+}
+
 void BODY_Write_State (BODY *bod, PBF *bf)
 {
 #if IOVER >= 3
@@ -2256,21 +2282,16 @@ void BODY_Read_State (BODY *bod, PBF *bf, int iover)
     }
   }
 
-  /* post-process red data if needed */
-  if (bod->kind == FEM) FEM_Post_Read (bod);
+  post_read (bod);
+}
 
-  /* update shape */
-  SHAPE_Update (bod->shape, bod, (MOTION)BODY_Cur_Point); 
-  if (bod->msh) FEM_Update_Rough_Mesh (bod);
+void BODY_Set_State (BODY *bod, double *conf, double *velo, double *energy)
+{
+  blas_dcopy (BODY_Conf_Size (bod), conf, 1, bod->conf, 1);
+  blas_dcopy (bod->dofs, velo, 1, bod->velo, 1);
+  blas_dcopy (BODY_ENERGY_SIZE(bod->kind), energy, 1, bod->energy, 1);
 
-#if !MPI
-  /* update display points */
-  for (SET *item = SET_First (bod->displaypoints); item; item = SET_Next (item))
-  {
-    DISPLAY_POINT *point = item->data;
-    BODY_Cur_Point (bod, point->sgp, point->X, point->x);
-  }
-#endif
+  post_read (bod);
 }
 
 void BODY_Destroy (BODY *bod)
@@ -2300,6 +2321,8 @@ void BODY_Destroy (BODY *bod)
 
   if (bod->K) MX_Destroy (bod->K);
 
+  if (bod->tangent) MX_Destroy (bod->tangent);
+
   if (bod->kind == FEM) FEM_Destroy (bod);
 
   if (bod->msh) MESH_Destroy (bod->msh);
@@ -2444,6 +2467,9 @@ void BODY_Pack (BODY *bod, int *dsize, double **d, int *doubles, int *isize, int
   /* damping */
   pack_double (dsize, d, doubles, bod->damping);
 
+  /* refactorization policy */
+  pack_int (isize, i, ints, bod->refactor);
+
   /* pack cracks */
   CRACKS_Pack (bod->cra, dsize, d, doubles, isize, i, ints); 
 }
@@ -2511,12 +2537,79 @@ BODY* BODY_Unpack (SOLFEC *sol, int *dpos, double *d, int doubles, int *ipos, in
   /* damping */
   bod->damping = unpack_double (dpos, d, doubles);
 
+  /* refactorization policy */
+  bod->refactor = unpack_int (ipos, i, ints);
+
   /* unpack cracks */
   bod->cra = CRACKS_Unpack (dpos, d, doubles, ipos, i, ints);
 
   return bod;
 }
 
+/* pack body state for a restart checkpoint */
+void BODY_Checkpoint_Pack (BODY *bod, int *dsize, double **d, int *doubles, int *isize, int **i, int *ints)
+{
+  /* kind and sizes for consistency checks */
+  pack_int (isize, i, ints, bod->kind);
+  pack_int (isize, i, ints, conf_pack_size (bod));
+  pack_int (isize, i, ints, velo_pack_size (bod));
+
+  /* configuration and velocity (with time step data of FEM bodies) */
+  pack_doubles (dsize, d, doubles, bod->conf, conf_pack_size (bod));
+  pack_doubles (dsize, d, doubles, bod->velo, velo_pack_size (bod));
+
+  /* permanent flags */
+  pack_int (isize, i, ints, bod->flags & BODY_PERMANENT_FLAGS);
+
+  /* pack parmec forces if present */
+  if (bod->parmec)
+  {
+    pack_int (isize, i, ints, 1);
+    pack_doubles (dsize, d, doubles, bod->parmec->force, 3);
+    pack_doubles (dsize, d, doubles, bod->parmec->torque, 3);
+  }
+  else pack_int (isize, i, ints, 0);
+
+  /* energy */
+  pack_doubles (dsize, d, doubles, bod->energy, BODY_ENERGY_SIZE(bod->kind));
+}
+
+/* unpack body state of a restart checkpoint */
+void BODY_Checkpoint_Unpack (BODY *bod, int *dpos, double *d, int doubles, int *ipos, int *i, int ints)
+{
+  int kind = unpack_int (ipos, i, ints),
+      conf = unpack_int (ipos, i, ints),
+      velo = unpack_int (ipos, i, ints);
+
+  ASSERT_TEXT (((bod->kind == RIG || bod->kind == OBS) &&
+    (kind == RIG || kind == OBS)) || bod->kind == (unsigned)kind, "Body kind mismatch when reading a checkpoint");
+  ASSERT_TEXT (conf_pack_size (bod) == conf && velo_pack_size (bod) == velo, "Body size mismatch when reading a checkpoint");
+
+  /* configuration and velocity */
+  unpack_doubles (dpos, d, doubles, bod->conf, conf);
+  unpack_doubles (dpos, d, doubles, bod->velo, velo);
+
+  /* permanent flags */
+  bod->flags = (bod->flags & ~BODY_PERMANENT_FLAGS) | unpack_int (ipos, i, ints);
+
+  /* unpack parmec forces if present */
+  if (unpack_int (ipos, i, ints))
+  {
+    if (!bod->parmec) ERRMEM (bod->parmec = MEM_CALLOC (sizeof(PARMEC_FORCE)));
+    unpack_doubles (dpos, d, doubles, bod->parmec->force, 3);
+    unpack_doubles (dpos, d, doubles, bod->parmec->torque, 3);
+  }
+
+  /* init inverse */
+  if (bod->dom->dynamic) BODY_Dynamic_Init (bod);
+  else BODY_Static_Init (bod);
+
+  /* energy (after the initialisation which resets the kinetic energy) */
+  unpack_doubles (dpos, d, doubles, bod->energy, BODY_ENERGY_SIZE(bod->kind));
+
+  post_read (bod);
+}
+
 #if MPI
 /* pack parent body */
 void BODY_Parent_Pack (BODY *bod, int *dsize, double **d, int *doubles, int *isize, int **i, int *ints)
@@ -2537,6 +2630,9 @@ void BODY_Parent_Pack (BODY *bod, int *dsize, double **d, int *doubles, int *isi
   /* damping */
   pack_double (dsize, d, doubles, bod->damping);
 
+  /* refactorization policy */
+  pack_int (isize, i, ints, bod->refactor);
+
   /* pack energy */
   pack_doubles (dsize, d, doubles, bod->energy, BODY_ENERGY_SIZE(bod->kind));
 
@@ -2573,6 +2669,9 @@ void BODY_Parent_Unpack (BODY *bod, int *dpos, double *d, int doubles, int *ipos
   /* damping */
   bod->damping = unpack_double (dpos, d, doubles);
 
+  /* refactorization policy */
+  bod->refactor = unpack_int (ipos, i, ints);
+
   /* unpack energy */
   unpack_doubles (dpos, d, doubles, bod->energy, BODY_ENERGY_SIZE(bod->kind));
 
@@ -2608,6 +2707,8 @@ void BODY_Child_Pack (BODY *bod, int *dsize, double **d, int *doubles, int *isiz
   pack_int (isize, i, ints, bod->scheme); /* pack integration scheme */
   
   pack_double (dsize, d, doubles, bod->damping); /* damping */
+
+  pack_int (isize, i, ints, bod->refactor); /* refactorization policy */
 }
 
 /* unpack child body */
@@ -2633,6 +2734,8 @@ void BODY_Child_Unpack (BODY *bod, int *dpos, double *d, int doubles, int *ipos,
 
   bod->damping = unpack_double (dpos, d, doubles); /* damping */
 
+  bod->refactor = unpack_int (ipos, i, ints); /* refactorization policy */
+
   /* init inverse */
   if (dynamic) BODY_Dynamic_Init (bod);
   else BODY_Static_Init (bod);
@@ -91,6 +91,15 @@ typedef enum
                  /* reference: M. Zhang, R.D. Skeel. Cheap implicit symplectic integrators. Applied Numerical Mathematics, 6:297-302, 1997 */
 } SCHEME;
 
+/* sparse inverse refactorization policies */
+typedef enum
+{
+  REF_FULL,      /* analyse and factorize anew at every update (DEFAULT) */
+  REF_NUMERIC,   /* factorize numerically, reusing the symbolic analysis */
+  REF_KRYLOV     /* precondition a few conjugate gradient iterations with a lagged factorization,
+                    refactorize numerically once these iterations stop converging quickly */
+} REFACTOR;
+
 struct general_force
 {
   enum {SPATIAL   = 0x01,
@@ -200,10 +209,24 @@ struct general_body
 
   double damping;   /* stiffness proportional damping */
 
+  REFACTOR refactor; /* sparse inverse refactorization policy */
+
+  MX *tangent;      /* current tangent operator, when the factorized 'inverse' lags behind it */
+
+  int refiters;     /* maximal number of Krylov iterations since the last refactorization */
+
   double *eval;     /* eigenvalues */
 
   MX *evec;         /* eigenvectors */
 
+  double *etab;     /* rows of 'evec' at surface mesh nodes, in 3 x modes blocks */
+
+  int *emap;        /* mesh node to 'etab' block map (-1 for nodes without a block); allocated with 'etab' */
+
+  double *threadbuf; /* per-thread FEM force accumulation buffers, kept zero between calls (OMP) */
+
+  int threadbufsize; /* allocated length of 'threadbuf' */
+
   char *elabel; /* registered FE base label */
 
   DOM *dom;        /* domain storing the body */
@@ -223,6 +246,12 @@ struct general_body
 
   double cristep0; /* critical time step at time 0 used by FE bodies */
 
+  int subcycles; /* number of explicit substeps per domain time step (> 1 when subcycled) */
+
+  double substep; /* critical time step of a subcycled body */
+
+  double subenergy; /* energy balance at the start of a subcycled time step */
+
   unsigned char fracture; /* fracture flag */
 
   int rank; /* parent => new/current rank; child => parent's rank */
@@ -343,6 +372,9 @@ void BODY_Write_State (BODY *bod, PBF *bf);
 /* read body state */
 void BODY_Read_State (BODY *bod, PBF *bf, int iover);
 
+/* set body state from configuration, velocity and energy vectors */
+void BODY_Set_State (BODY *bod, double *conf, double *velo, double *energy);
+
 /* release body memory */
 void BODY_Destroy (BODY *bod);
 
@@ -354,6 +386,10 @@ void BODY_Pack (BODY *bod, int *dsize, double **d, int *doubles, int *isize, int
  * d and i and no more than a specific number of doubles and ints can be red) */
 BODY* BODY_Unpack (SOLFEC *sol, int *dpos, double *d, int doubles, int *ipos, int *i, int ints);
 
+/* pack and unpack body state of a restart checkpoint; unpacking initialises the inverse and updates the shape */
+void BODY_Checkpoint_Pack (BODY *bod, int *dsize, double **d, int *doubles, int *isize, int **i, int *ints);
+void BODY_Checkpoint_Unpack (BODY *bod, int *dpos, double *d, int doubles, int *ipos, int *i, int ints);
+
 #if MPI
 /* parent bodies store all body data and serve for time stepping */
 void BODY_Parent_Pack (BODY *bod, int *dsize, double **d, int *doubles, int *isize, int **i, int *ints);
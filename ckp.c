@@ -0,0 +1,223 @@
+/*
+ * ckp.c
+ * Copyright (C) 2006, Tomasz Koziara (t.koziara AT gmail.com)
+ * --------------------------------------------------------------
+ * restart checkpoints
+ */
+
+/* This file is part of Solfec.
+ * Solfec is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Solfec is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
+
+#if POSIX
+#define _XOPEN_SOURCE 500 /* fileno, fsync */
+#include <unistd.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ckp.h"
+#include "pck.h"
+#include "err.h"
+
+/* checkpoint file layout (native binary, written by and for the same build):
+ *
+ *   char [8] magic, int version, int doubles, int ints,
+ *   double [doubles], int [ints], char [8] magic
+ *
+ * the doubles and ints are the packed output and callback times followed by
+ * the packed domain state (DOM_Checkpoint_Pack); the file is written next to
+ * its final path and renamed when complete, so that an interrupted write
+ * leaves the previous checkpoint intact */
+
+#define MAGIC "SOLFECKP"
+#define VERSION 1
+
+/* write packed buffers into 'path'; return zero or an error code */
+static int write_file (const char *path, double *d, int doubles, int *i, int ints)
+{
+  int version = VERSION, error = 0;
+  char *tmp;
+  FILE *f;
+
+  ERRMEM (tmp = malloc (strlen (path) + 8));
+  sprintf (tmp, "%s.tmp", path);
+
+  if (!(f = fopen (tmp, "wb")))
+  {
+    free (tmp);
+    return ERR_FILE_OPEN;
+  }
+
+  if (fwrite (MAGIC, 1, 8, f) != 8 ||
+      fwrite (&version, sizeof (int), 1, f) != 1 ||
+      fwrite (&doubles, sizeof (int), 1, f) != 1 ||
+      fwrite (&ints, sizeof (int), 1, f) != 1 ||
+      fwrite (d, sizeof (double), doubles, f) != (size_t) doubles ||
+      fwrite (i, sizeof (int), ints, f) != (size_t) ints ||
+      fwrite (MAGIC, 1, 8, f) != 8 ||
+      fflush (f) != 0) error = ERR_FILE_WRITE;
+
+#if POSIX
+  if (!error && fsync (fileno (f)) != 0) error = ERR_FILE_WRITE; /* survive a crash after renaming */
+#endif
+
+  if (fclose (f) != 0 && !error) error = ERR_FILE_CLOSE;
+
+  if (!error && rename (tmp, path) != 0) error = ERR_FILE_WRITE;
+
+  if (error) remove (tmp);
+
+  free (tmp);
+
+  return error;
+}
+
+#if POSIX
+/* background writer */
+static void* write_thread (void *data)
+{
+  CKP *ckp = data;
+  int error = write_file (ckp->path, ckp->d, ckp->doubles, ckp->i, ckp->ints);
+
+  if (error && !ckp->error) ckp->error = error; /* read only after joining */
+
+  return NULL;
+}
+#endif
+
+/* create checkpoint writer at 'path' with a wall-clock 'interval' in seconds */
+CKP* CKP_Create (const char *path, double interval)
+{
+  CKP *ckp;
+
+  ERRMEM (ckp = MEM_CALLOC (sizeof (CKP)));
+  ERRMEM (ckp->path = malloc (strlen (path) + 1));
+  strcpy (ckp->path, path);
+  ckp->interval = interval;
+  timerstart (&ckp->timing);
+
+  return ckp;
+}
+
+/* test whether the wall-clock interval has elapsed */
+int CKP_Due (CKP *ckp)
+{
+  return timerend (&ckp->timing) >= ckp->interval;
+}
+
+/* pack current state and write it in the background */
+void CKP_Write (CKP *ckp, SOLFEC *sol)
+{
+  CKP_Flush (ckp); /* buffers are reused */
+
+  ckp->doubles = ckp->ints = 0;
+
+  pack_double (&ckp->dsize, &ckp->d, &ckp->doubles, sol->output_time);
+  pack_double (&ckp->dsize, &ckp->d, &ckp->doubles, sol->callback_time);
+
+  DOM_Checkpoint_Pack (sol->dom, &ckp->dsize, &ckp->d, &ckp->doubles, &ckp->isize, &ckp->i, &ckp->ints);
+
+#if POSIX
+  if (pthread_create (&ckp->thread, NULL, write_thread, ckp) == 0) ckp->busy = 1;
+  else /* fall back to synchronous output */
+#endif
+  {
+    int error = write_file (ckp->path, ckp->d, ckp->doubles, ckp->i, ckp->ints);
+
+    if (error && !ckp->error) ckp->error = error;
+  }
+
+  timerstart (&ckp->timing);
+}
+
+/* wait for a pending write; return zero or the first write error code */
+int CKP_Flush (CKP *ckp)
+{
+#if POSIX
+  if (ckp->busy)
+  {
+    pthread_join (ckp->thread, NULL);
+    ckp->busy = 0;
+  }
+#endif
+
+  WARNING (!ckp->error, "Writing of the checkpoint %s has failed: %s", ckp->path, errstring (ckp->error));
+
+  int error = ckp->error;
+
+  ckp->error = 0; /* warn once */
+
+  return error;
+}
+
+/* restore state from a checkpoint file; return 1 on success, 0 if the file is missing or incomplete */
+int CKP_Read (const char *path, SOLFEC *sol)
+{
+  int version, doubles, ints, dpos, ipos, *i;
+  char magic [2][8];
+  double *d;
+  FILE *f;
+
+  if (!(f = fopen (path, "rb"))) return 0;
+
+  d = NULL;
+  i = NULL;
+
+  if (fread (magic [0], 1, 8, f) != 8 ||
+      fread (&version, sizeof (int), 1, f) != 1 ||
+      fread (&doubles, sizeof (int), 1, f) != 1 ||
+      fread (&ints, sizeof (int), 1, f) != 1 ||
+      memcmp (magic [0], MAGIC, 8) != 0 || version != VERSION || doubles < 2 || ints < 0) goto failure;
+
+  ERRMEM (d = malloc (sizeof (double [doubles])));
+  ERRMEM (i = malloc (sizeof (int [ints + 1])));
+
+  if (fread (d, sizeof (double), doubles, f) != (size_t) doubles ||
+      fread (i, sizeof (int), ints, f) != (size_t) ints ||
+      fread (magic [1], 1, 8, f) != 8 ||
+      memcmp (magic [1], MAGIC, 8) != 0) goto failure;
+
+  fclose (f);
+
+  dpos = ipos = 0;
+
+  sol->output_time = unpack_double (&dpos, d, doubles);
+  sol->callback_time = unpack_double (&dpos, d, doubles);
+
+  DOM_Checkpoint_Unpack (sol->dom, &dpos, d, doubles, &ipos, i, ints);
+
+  free (d);
+  free (i);
+
+  return 1;
+
+failure:
+  fclose (f);
+  free (d);
+  free (i);
+
+  return 0;
+}
+
+/* flush and release writer */
+void CKP_Destroy (CKP *ckp)
+{
+  CKP_Flush (ckp);
+
+  free (ckp->path);
+  free (ckp->d);
+  free (ckp->i);
+  free (ckp);
+}
@@ -0,0 +1,77 @@
+/*
+ * ckp.h
+ * Copyright (C) 2006, Tomasz Koziara (t.koziara AT gmail.com)
+ * --------------------------------------------------------------
+ * restart checkpoints
+ */
+
+/* This file is part of Solfec.
+ * Solfec is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Solfec is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
+
+#if POSIX
+#include <pthread.h>
+#endif
+
+#include "sol.h"
+#include "tmr.h"
+
+#ifndef __ckp__
+#define __ckp__
+
+typedef struct ckp CKP;
+
+/* checkpoint writer */
+struct ckp
+{
+  char *path; /* checkpoint file path */
+
+  double interval; /* wall-clock interval between checkpoints [s] */
+
+  TIMING timing; /* wall-clock time since the last checkpoint */
+
+  double *d; /* packed doubles */
+
+  int *i; /* packed ints */
+
+  int dsize, doubles, /* doubles buffer size and number of packed doubles */
+      isize, ints; /* ints buffer size and number of packed ints */
+
+  int error; /* first write error code */
+
+#if POSIX
+  pthread_t thread; /* background writer */
+
+  int busy; /* background write is pending */
+#endif
+};
+
+/* create checkpoint writer at 'path' with a wall-clock 'interval' in seconds */
+CKP* CKP_Create (const char *path, double interval);
+
+/* test whether the wall-clock interval has elapsed */
+int CKP_Due (CKP *ckp);
+
+/* pack current state and write it in the background */
+void CKP_Write (CKP *ckp, SOLFEC *sol);
+
+/* wait for a pending write; return zero or the first write error code */
+int CKP_Flush (CKP *ckp);
+
+/* restore state from a checkpoint file; return 1 on success, 0 if the file is missing or incomplete */
+int CKP_Read (const char *path, SOLFEC *sol);
+
+/* flush and release writer */
+void CKP_Destroy (CKP *ckp);
+
+#endif
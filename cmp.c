@@ -23,6 +23,7 @@
 #include <string.h>
 
 #include "ext/fastlz.h"
+#include "ext/zstd/zstd.h"
 #include "cmp.h"
 #include "alg.h"
 #include "err.h"
@@ -107,3 +108,103 @@ void decompress (int *input, int size, double **d, int *doubles, int **i, int *i
 
   if (output != (char*) input) free (output);
 }
+
+/* shuffle bytes of 'size / elsize' elements, so that k-th bytes of all elements are stored contiguously */
+static void shuffle (char *input, int size, int elsize, char *output)
+{
+  int n = size / elsize, i, k;
+
+  for (k = 0; k < elsize; k ++)
+  {
+    for (i = 0; i < n; i ++) output [k*n + i] = input [i*elsize + k];
+  }
+
+  memcpy (output + n*elsize, input + n*elsize, size - n*elsize); /* trailing bytes */
+}
+
+/* reverse byte shuffling */
+static void unshuffle (char *input, int size, int elsize, char *output)
+{
+  int n = size / elsize, i, k;
+
+  for (k = 0; k < elsize; k ++)
+  {
+    for (i = 0; i < n; i ++) output [i*elsize + k] = input [k*n + i];
+  }
+
+  memcpy (output + n*elsize, input + n*elsize, size - n*elsize);
+}
+
+/* size of output buffer sufficient for encoding 'size' bytes */
+int CMP_Bound (int size)
+{
+  int zbound = (int) ZSTD_compressBound (size);
+
+  return MAX (size + size / 16 + 66, zbound); /* see ext/fastlz.h */
+}
+
+/* encode 'size' bytes of 'input' into 'output' of 'outsize' bytes; return the
+ * encoded size or 0 if encoding failed or would not reduce the size of data */
+int CMP_Encode (CMP_CODEC *codec, char *input, int size, char *output, int outsize)
+{
+  char *buf = NULL;
+  int num;
+
+  if (size < 16 || outsize < CMP_Bound (size)) return 0; /* see ext/fastlz.h */
+
+  if (codec->shuffle > 1) /* no ERRMEM: may run on the output thread */
+  {
+    if (!(buf = malloc (size))) return 0;
+    shuffle (input, size, codec->shuffle, buf);
+    input = buf;
+  }
+
+  switch (codec->alg)
+  {
+  case CMP_FASTLZ: num = fastlz_compress_level (codec->level == 2 ? 2 : 1, input, size, output); break;
+  case CMP_ZSTD:
+  {
+    size_t ret = ZSTD_compress (output, outsize, input, size, codec->level);
+    num = ZSTD_isError (ret) ? 0 : (int) ret;
+  }
+  break;
+  default: num = 0; break;
+  }
+
+  free (buf);
+
+  return num < size ? num : 0;
+}
+
+/* decode 'size' bytes of 'input' into 'output' of 'outsize' bytes; return the decoded size or 0 on failure */
+int CMP_Decode (CMP_ALG alg, int shuffle, char *input, int size, char *output, int outsize)
+{
+  char *buf = NULL, *out = output;
+  int num;
+
+  if (shuffle > 1)
+  {
+    ERRMEM (buf = malloc (outsize));
+    out = buf;
+  }
+
+  switch (alg)
+  {
+  case CMP_FASTLZ: num = fastlz_decompress (input, size, out, outsize); break;
+  case CMP_ZSTD:
+  {
+    size_t ret = ZSTD_decompress (out, outsize, input, size);
+    num = ZSTD_isError (ret) ? 0 : (int) ret;
+  }
+  break;
+  default: num = 0; break;
+  }
+
+  if (buf)
+  {
+    if (num > 0) unshuffle (buf, num, shuffle, output);
+    free (buf);
+  }
+
+  return num;
+}
@@ -25,9 +25,36 @@
 typedef enum
 {
   CMP_OFF,
-  CMP_FASTLZ
+  CMP_FASTLZ,
+  CMP_ZSTD
 } CMP_ALG;
 
+#define CMP_SHUFFLE 8 /* byte shuffling element size (size of a double) */
+
+#define CMP_ZSTD_MAXLEVEL 22 /* maximal ZSTD compression level */
+
+typedef struct cmp_codec CMP_CODEC;
+
+/* codec settings */
+struct cmp_codec
+{
+  CMP_ALG alg; /* compression algorithm */
+
+  int level; /* compression level (FASTLZ: 1 or 2, ZSTD: 1 to CMP_ZSTD_MAXLEVEL) */
+
+  int shuffle; /* element size of byte shuffling before compression (0 or 1: no shuffling) */
+};
+
+/* size of output buffer sufficient for encoding 'size' bytes */
+int CMP_Bound (int size);
+
+/* encode 'size' bytes of 'input' into 'output' of 'outsize' bytes; return the
+ * encoded size or 0 if encoding failed or would not reduce the size of data */
+int CMP_Encode (CMP_CODEC *codec, char *input, int size, char *output, int outsize);
+
+/* decode 'size' bytes of 'input' into 'output' of 'outsize' bytes; return the decoded size or 0 on failure */
+int CMP_Decode (CMP_ALG alg, int shuffle, char *input, int size, char *output, int outsize);
+
 /* compress doubles and integers into an array of integers */
 int* compress (CMP_ALG alg, double *d, int doubles, int *i, int ints, int *size);
 
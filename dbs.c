@@ -22,6 +22,7 @@
 #include <Python.h>
 #include <structmember.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdio.h>
 #include "lng.h"
 #include "alg.h"
@@ -548,3 +549,362 @@ int DIAGONAL_BLOCK_Solver (DIAS diagsolver, double diagepsilon, int diagmaxiter,
 
   return 0;
 }
+
+/* structure-of-arrays storage of DBS_LANES contact blocks */
+typedef struct lanes LANES;
+
+struct lanes
+{
+  double W [9][DBS_LANES],
+         B [3][DBS_LANES],
+         V [3][DBS_LANES],
+         U [3][DBS_LANES],
+         R [3][DBS_LANES],
+	 rho [DBS_LANES],
+	 friction [DBS_LANES],
+	 restitution [DBS_LANES],
+	 cohesion [DBS_LANES],
+	 gap [DBS_LANES];
+
+  int active [DBS_LANES], /* convergence mask: 1 => iterate, 0 => converged or idle */
+      iters [DBS_LANES]; /* iterations count; < 0 => failure */
+};
+
+/* projected gradient over all lanes */
+static void projected_gradient_lanes (LANES *x, short dynamic, double epsilon, int maxiter, double step)
+{
+  int l, iter, any;
+
+  for (iter = 0, any = 1; iter < maxiter && any; iter ++)
+  {
+    for (l = 0, any = 0; l < DBS_LANES; l ++)
+    {
+      double U0, U1, U2, UN, R0, R1, R2, S, error;
+
+      U0 = x->B[0][l] + x->W[0][l]*x->R[0][l] + x->W[3][l]*x->R[1][l] + x->W[6][l]*x->R[2][l];
+      U1 = x->B[1][l] + x->W[1][l]*x->R[0][l] + x->W[4][l]*x->R[1][l] + x->W[7][l]*x->R[2][l];
+      U2 = x->B[2][l] + x->W[2][l]*x->R[0][l] + x->W[5][l]*x->R[1][l] + x->W[8][l]*x->R[2][l];
+
+      UN = dynamic ? U2 + x->restitution[l] * MIN (x->V[2][l], 0) : MAX (x->gap[l], 0)/step + U2;
+
+      R0 = x->R[0][l] - x->rho[l] * U0;
+      R1 = x->R[1][l] - x->rho[l] * U1;
+      R2 = MAX (0, x->R[2][l] - x->rho[l] * UN + x->cohesion[l]);
+
+      S = sqrt (R0*R0 + R1*R1);
+      S = S >= x->friction[l] * R2 && S > 0.0 ? x->friction[l] * R2 / S : 1.0;
+      R0 *= S;
+      R1 *= S;
+      R2 -= x->cohesion[l];
+
+      S = R0*R0 + R1*R1 + R2*R2;
+      error = sqrt (((R0-x->R[0][l])*(R0-x->R[0][l]) + (R1-x->R[1][l])*(R1-x->R[1][l]) + (R2-x->R[2][l])*(R2-x->R[2][l]))/MAX (S, 1.0));
+
+      if (x->active [l]) /* masked update */
+      {
+	x->U[0][l] = U0; x->U[1][l] = U1; x->U[2][l] = U2;
+	x->R[0][l] = R0; x->R[1][l] = R1; x->R[2][l] = R2;
+	x->iters [l] ++;
+	x->active [l] = error > epsilon;
+	any += x->active [l];
+      }
+    }
+  }
+}
+
+/* De Saxce-Feng over all lanes */
+static void de_saxce_feng_lanes (LANES *x, short dynamic, double epsilon, int maxiter, double step)
+{
+  int l, iter, any;
+
+  for (iter = 0, any = 1; iter < maxiter && any; iter ++)
+  {
+    for (l = 0, any = 0; l < DBS_LANES; l ++)
+    {
+      double U0, U1, U2, UN, S0, S1, S2, R0, R1, R2, fri, fri2, slen, l1, l2, g1, g2, u0, u1, S, error;
+
+      U0 = x->B[0][l] + x->W[0][l]*x->R[0][l] + x->W[3][l]*x->R[1][l] + x->W[6][l]*x->R[2][l];
+      U1 = x->B[1][l] + x->W[1][l]*x->R[0][l] + x->W[4][l]*x->R[1][l] + x->W[7][l]*x->R[2][l];
+      U2 = x->B[2][l] + x->W[2][l]*x->R[0][l] + x->W[5][l]*x->R[1][l] + x->W[8][l]*x->R[2][l];
+
+      UN = dynamic ? U2 + x->restitution[l] * MIN (x->V[2][l], 0) : MAX (x->gap[l], 0)/step + U2;
+
+      fri = x->friction[l];
+      S0 = x->R[0][l] - x->rho[l] * U0;
+      S1 = x->R[1][l] - x->rho[l] * U1;
+      S2 = x->R[2][l] - x->rho[l] * (UN + fri * sqrt (U0*U0 + U1*U1)) + x->cohesion[l];
+
+      /* projection onto the friction cone (cf. SCF_Project) */
+      fri2 = fri*fri;
+      slen = sqrt (S0*S0 + S1*S1);
+      l1 = -(S2 + fri*slen) / (1.0 + fri2);
+      l2 =  (slen - fri*S2) / (1.0 + fri2);
+      u0 = slen != 0.0 ? S0/slen : 1.0;
+      u1 = slen != 0.0 ? S1/slen : 0.0;
+      g1 = MAX (l1, 0.0);
+      g2 = MAX (l2, 0.0);
+      R0 = S0 - (g2 - g1*fri)*u0;
+      R1 = S1 - (g2 - g1*fri)*u1;
+      R2 = S2 - (-g1 - g2*fri) - x->cohesion[l];
+
+      S = R0*R0 + R1*R1 + R2*R2;
+      error = sqrt (((R0-x->R[0][l])*(R0-x->R[0][l]) + (R1-x->R[1][l])*(R1-x->R[1][l]) + (R2-x->R[2][l])*(R2-x->R[2][l]))/MAX (S, 1.0));
+
+      if (x->active [l]) /* masked update */
+      {
+	x->U[0][l] = U0; x->U[1][l] = U1; x->U[2][l] = U2;
+	x->R[0][l] = R0; x->R[1][l] = R1; x->R[2][l] = R2;
+	x->iters [l] ++;
+	x->active [l] = error > epsilon;
+	any += x->active [l];
+      }
+    }
+  }
+}
+
+/* semismooth Newton over all lanes; the 3x3 linear systems are solved by Cramer's rule */
+static void semismooth_newton_lanes (LANES *x, short dynamic, double epsilon, int maxiter, double step)
+{
+  int l, iter, any, divi;
+
+  divi = MAX (1, maxiter / 10);
+
+  for (iter = 0, any = 1; iter < maxiter && any; iter ++)
+  {
+    for (l = 0, any = 0; l < DBS_LANES; l ++)
+    {
+      double *W [9], R [3], U [3], RES [3], a [9], b [3], c [3], d [3],
+	     UN, norm, lim, rho, fri, coh, det, error;
+      int k;
+
+      if (!x->active [l]) continue;
+
+      for (k = 0; k < 9; k ++) W [k] = &x->W[k][l];
+      for (k = 0; k < 3; k ++) R [k] = x->R[k][l], U [k] = x->U[k][l];
+      rho = x->rho[l];
+      fri = x->friction[l];
+      coh = x->cohesion[l];
+
+      UN = dynamic ? U[2] + x->restitution[l] * MIN (x->V[2][l], 0) : MAX (x->gap[l], 0)/step + U[2];
+
+      d [0] = R[0] - rho * U[0];
+      d [1] = R[1] - rho * U[1];
+      d [2] = (R[2]+coh) - rho * UN;
+
+      for (k = 0; k < 3; k ++) RES [k] = x->B[k][l] + *W[k]*R[0] + *W[k+3]*R[1] + *W[k+6]*R[2] - U[k];
+
+      norm = sqrt (d[0]*d[0]+d[1]*d[1]);
+      lim = fri * MAX (0, d[2]);
+
+      if (d [2] >= 0 && norm >= lim && lim > 0.0) /* frictional slipping */
+      {
+	double F [4], M [4], H [4], len, den, e, alfa, delta, beta;
+
+	len = sqrt (R[0]*R[0]+R[1]*R[1]);
+	den = MAX (lim, len) * norm;
+	e = lim / norm;
+	if (len == 0.0) beta = 1.0;
+	else
+	{
+	  alfa = (R[0]*d[0]+R[1]*d[1]) / (len*norm);
+	  delta = MIN (len/lim, 1.0);
+	  beta = (alfa < 0.0 ? 1.0 / (1.0 - alfa*delta) : 1.0);
+	}
+
+	F [0] = (R[0]*d[0])/den;
+	F [1] = (R[1]*d[0])/den;
+	F [2] = (R[0]*d[1])/den;
+	F [3] = (R[1]*d[1])/den;
+
+	M [0] = e * (1.0 - F[0]);
+	M [1] = - e * F[1];
+	M [2] = - e * F[2];
+	M [3] = e * (1.0 - F[3]);
+
+	H [0] = 1.0 - beta * M[0];
+	H [1] = - beta * M[1];
+	H [2] = - beta * M[2];
+	H [3] = 1.0 - beta * M[3];
+
+	a [0] = H[0] + rho*(M[0]**W[0] + M[2]**W[1]);
+	a [1] = H[1] + rho*(M[1]**W[0] + M[3]**W[1]);
+	a [2] = *W[2];
+	a [3] = H[2] + rho*(M[0]**W[3] + M[2]**W[4]);
+	a [4] = H[3] + rho*(M[1]**W[3] + M[3]**W[4]);
+	a [5] = *W[5];
+	a [6] = rho*(M[0]**W[6] + M[2]**W[7]) - fri*(d[0]/norm);
+	a [7] = rho*(M[1]**W[6] + M[3]**W[7]) - fri*(d[1]/norm);
+	a [8] = *W[8];
+
+	b [0] = fri*(d[0]/norm)*(R[2]+coh) - R[0] - rho*(M[0]*RES[0] + M[2]*RES[1]);
+	b [1] = fri*(d[1]/norm)*(R[2]+coh) - R[1] - rho*(M[1]*RES[0] + M[3]*RES[1]);
+	b [2] = -UN - RES[2];
+      }
+      else if (d [2] >= 0 && norm >= lim) /* degenerate slipping */
+      {
+	a [0] = 1.0; a [1] = 0.0; a [2] = *W[2];
+	a [3] = 0.0; a [4] = 1.0; a [5] = *W[5];
+	a [6] = 0.0; a [7] = 0.0; a [8] = *W[8];
+
+	b [0] = -R[0] - RES[0];
+	b [1] = -R[1] - RES[1];
+	b [2] = -UN - RES[2];
+      }
+      else if (d [2] >= 0) /* frictional sticking */
+      {
+	for (k = 0; k < 9; k ++) a [k] = *W[k];
+	a [6] += U[0]/d[2];
+	a [7] += U[1]/d[2];
+
+	b [0] = -(1.0 + rho*U[2]/d[2])*U[0] - RES[0];
+	b [1] = -(1.0 + rho*U[2]/d[2])*U[1] - RES[1];
+	b [2] = -UN - RES[2];
+      }
+      else /* separation */
+      {
+	a [0] = 1.0; a [1] = 0.0; a [2] = 0.0;
+	a [3] = 0.0; a [4] = 1.0; a [5] = 0.0;
+	a [6] = 0.0; a [7] = 0.0; a [8] = 1.0;
+
+	b [0] = -R[0];
+	b [1] = -R[1];
+	b [2] = -R[2];
+      }
+
+      det = a[0]*(a[4]*a[8]-a[7]*a[5]) - a[3]*(a[1]*a[8]-a[7]*a[2]) + a[6]*(a[1]*a[5]-a[4]*a[2]);
+
+      c [0] = (b[0]*(a[4]*a[8]-a[7]*a[5]) - a[3]*(b[1]*a[8]-a[7]*b[2]) + a[6]*(b[1]*a[5]-a[4]*b[2])) / det;
+      c [1] = (a[0]*(b[1]*a[8]-a[7]*b[2]) - b[0]*(a[1]*a[8]-a[7]*a[2]) + a[6]*(a[1]*b[2]-b[1]*a[2])) / det;
+      c [2] = (a[0]*(a[4]*b[2]-b[1]*a[5]) - a[3]*(a[1]*b[2]-b[1]*a[2]) + b[0]*(a[1]*a[5]-a[4]*a[2])) / det;
+
+      if (!isfinite (c[0]+c[1]+c[2])) /* failed lane */
+      {
+	x->active [l] = 0;
+	x->iters [l] = -1;
+	continue;
+      }
+
+      for (k = 0; k < 3; k ++)
+      {
+	x->U[k][l] = U[k] + RES[k] + *W[k]*c[0] + *W[k+3]*c[1] + *W[k+6]*c[2];
+	x->R[k][l] = R[k] + c[k];
+      }
+
+      error = x->R[0][l]*x->R[0][l] + x->R[1][l]*x->R[1][l] + x->R[2][l]*x->R[2][l];
+      error = sqrt ((c[0]*c[0] + c[1]*c[1] + c[2]*c[2]) / MAX (error, 1.0));
+
+      x->iters [l] ++;
+
+      if ((x->iters [l] % divi) == 0)
+      {
+	x->rho [l] *= 10.0; /* penalty scaling */
+	if (isinf (x->rho [l])) { x->active [l] = 0; x->iters [l] = -1; continue; }
+      }
+
+      x->active [l] = error > epsilon;
+      any += x->active [l];
+    }
+  }
+}
+
+/* can the block be solved in a lane? */
+static int lane_block (DIAS diagsolver, DIAB *dia)
+{
+  CON *con = dia->con;
+
+  return con->kind == CONTACT && con->mat.base->model == SIGNORINI_COULOMB && diagsolver != DS_PROJECTED_NEWTON;
+}
+
+/* batched diagonal block solver */
+void DIAGONAL_BLOCK_Solver_Batch (DIAS diagsolver, double diagepsilon, int diagmaxiter,
+  short dynamic, double step, int n, DIAB **dia, double *B, int *iters)
+{
+  int i, j, k, l, m, lane [DBS_LANES];
+  double R0 [DBS_LANES][3];
+  LANES x;
+  DIAB *d;
+  CON *con;
+
+  for (i = 0; i < n;)
+  {
+    memset (&x, 0, sizeof (LANES));
+
+    /* gather lanes */
+    for (m = 0; i < n && m < DBS_LANES; i ++)
+    {
+      d = dia [i];
+      con = d->con;
+
+      if (!lane_block (diagsolver, d)) /* other kinds and models => scalar solver */
+      {
+	iters [i] = DIAGONAL_BLOCK_Solver (diagsolver, diagepsilon, diagmaxiter, dynamic, step,
+	  con->kind, &con->mat, con->gap, con->area, con->Z, con->base, d, &B[3*i]);
+	continue;
+      }
+
+      SURFACE_MATERIAL *bas = con->mat.base;
+
+      for (k = 0; k < 9; k ++) x.W[k][m] = d->W[k];
+      for (k = 0; k < 3; k ++)
+      {
+	x.B[k][m] = B[3*i+k];
+	x.V[k][m] = d->V[k];
+	x.U[k][m] = d->U[k];
+	x.R[k][m] = d->R[k];
+      }
+      x.rho [m] = d->rho;
+      x.friction [m] = bas->friction;
+      x.restitution [m] = bas->restitution;
+      x.cohesion [m] = SURFACE_MATERIAL_Cohesion_Get (&con->mat) * con->area;
+      x.gap [m] = con->gap;
+      COPY (d->R, R0[m]);
+
+      if (dynamic && con->gap > 0) /* open contact */
+      {
+	for (k = 0; k < 3; k ++) x.R[k][m] = 0.0, x.U[k][m] = x.B[k][m];
+      }
+      else x.active [m] = 1;
+
+      lane [m ++] = i;
+    }
+
+    if (m == 0) continue;
+
+    for (l = m; l < DBS_LANES; l ++) /* idle lanes */
+    {
+      x.W[0][l] = x.W[4][l] = x.W[8][l] = 1.0;
+    }
+
+    switch (diagsolver)
+    {
+    case DS_PROJECTED_GRADIENT: projected_gradient_lanes (&x, dynamic, diagepsilon, diagmaxiter, step); break;
+    case DS_DE_SAXCE_FENG: de_saxce_feng_lanes (&x, dynamic, diagepsilon, diagmaxiter, step); break;
+    case DS_SEMISMOOTH_NEWTON: semismooth_newton_lanes (&x, dynamic, diagepsilon, diagmaxiter, step); break;
+    case DS_PROJECTED_NEWTON: break;
+    }
+
+    /* scatter lanes */
+    for (l = 0; l < m; l ++)
+    {
+      j = lane [l];
+      d = dia [j];
+
+      if (x.active [l] || x.iters [l] < 0) /* failed lane => scalar solver from the initial reaction */
+      {
+	con = d->con;
+	COPY (R0[l], d->R);
+	iters [j] = DIAGONAL_BLOCK_Solver (diagsolver, diagepsilon, diagmaxiter, dynamic, step,
+	  con->kind, &con->mat, con->gap, con->area, con->Z, con->base, d, &B[3*j]);
+      }
+      else
+      {
+	for (k = 0; k < 3; k ++)
+	{
+	  d->R[k] = x.R[k][l];
+	  d->U[k] = x.U[k][l];
+	}
+	iters [j] = x.iters [l];
+      }
+    }
+  }
+}
@@ -34,6 +34,8 @@ enum dias
 
 typedef enum dias DIAS;
 
+#define DBS_LANES 4 /* number of blocks solved together by DIAGONAL_BLOCK_Solver_Batch */
+
 /* diagsolver: diagonal solver kind
  * diagepsilon: relative accuracy on termination
  * diagmaxiter: maximal iterations count
@@ -52,4 +54,13 @@ int DIAGONAL_BLOCK_Solver (DIAS diagsolver, double diagepsilon, int diagmaxiter,
   short dynamic, double step, short kind, SURFACE_MATERIAL_STATE *mat, double gap,
   double area, double *Z, double *base, DIAB *dia, double *B);
 
+/* batched diagonal block solver: mutually independent blocks dia [0..n-1] with local free
+ * velocities B [3*i..3*i+2] are solved DBS_LANES at a time in a structure-of-arrays form;
+ * this applies to SIGNORINI_COULOMB contacts and the DS_PROJECTED_GRADIENT, DS_DE_SAXCE_FENG,
+ * DS_SEMISMOOTH_NEWTON solvers, while other blocks and lanes that fail or do not converge
+ * are solved by DIAGONAL_BLOCK_Solver; iters [i] receives the result of the solution of dia [i],
+ * interpreted as the DIAGONAL_BLOCK_Solver return value */
+void DIAGONAL_BLOCK_Solver_Batch (DIAS diagsolver, double diagepsilon, int diagmaxiter,
+  short dynamic, double step, int n, DIAB **dia, double *B, int *iters);
+
 #endif
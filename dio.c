@@ -9,7 +9,9 @@
 #include <sys/stat.h>
 #include <regex.h>
 #endif
+#include <stdint.h>
 #include <string.h>
+#include <math.h>
 #include "sol.h"
 #include "dio.h"
 #include "pck.h"
@@ -149,7 +151,13 @@ static void dom_attach_constraints (DOM *dom)
 /* write new bodies data */
 static void write_new_bodies (DOM *dom)
 {
+#if PBF_COLLECTIVE
+  int any = dom->newb != NULL, all;
+  MPI_Allreduce (&any, &all, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD); /* the group is created collectively */
+  if (all == 0) return;
+#else
   if (dom->newb == NULL) return; /* nothing to write */
+#endif
 
 #if HDF5
   PBF *bf = dom->solfec->bf;
@@ -375,6 +383,455 @@ static void read_new_bodies (DOM *dom, PBF *bf)
 #endif
 }
 
+/* body records of delta coded frames */
+#define FULL_RECORD  0 /* complete state, as written by BODY_Write_State */
+#define SAME_RECORD  1 /* unchanged configuration and velocity; energy follows */
+#define DELTA_RECORD 2 /* XOR coded and quantized increments of configuration and velocity; energy follows */
+
+#define DIO_MAXINC 1073741824.0 /* bound on quantized increments */
+
+#if HDF5
+#define FRAME(bf) ((bf)->frame)
+#else
+#define FRAME(bf) ((bf)->cur)
+#define BODY_TABLE 1 /* per frame tables of body record positions */
+#endif
+
+typedef struct dio_ref DIO_REF;
+
+/* reference state of a body */
+struct dio_ref
+{
+  int kind, /* body kind */
+      nconf, /* configuration size */
+      ndofs, /* velocity size */
+      nener, /* energy size */
+      rank, /* output rank */
+      stamp; /* frame of the most recent record */
+
+  double val []; /* configuration, velocity, energy */
+};
+
+/* delta coding references of a single output file */
+struct dio_delta
+{
+  MEM mapmem; /* map items pool */
+
+  MAP *refs; /* body identifiers mapped to reference states */
+
+  unsigned int *words; /* XOR words buffer */
+
+  int *incs, /* quantized increments buffer */
+      size; /* buffers size */
+
+  int frame, /* number of written frames (WRITE) or last decoded frame (READ) */
+      lag; /* frames since the most recent keyframe (WRITE) */
+
+  DIO_DELTA *next; /* next file in case of parallel input */
+};
+
+/* create delta coding references */
+static DIO_DELTA* delta_create (void)
+{
+  DIO_DELTA *dlt;
+
+  ERRMEM (dlt = MEM_CALLOC (sizeof (DIO_DELTA)));
+  MEM_Init (&dlt->mapmem, sizeof (MAP), 128);
+  dlt->frame = dlt->lag = -1;
+
+  return dlt;
+}
+
+/* make sure there is one list item per input file */
+static DIO_DELTA* delta_list (DIO_DELTA **head, PBF *bf)
+{
+  DIO_DELTA **tail;
+
+  for (tail = head; bf; bf = bf->next, tail = &(*tail)->next)
+  {
+    if (*tail == NULL) *tail = delta_create ();
+  }
+
+  return *head;
+}
+
+/* is i-th value of a body state quantized */
+inline static int quantized (DIO_REF *ref, int i, double tol)
+{
+  if (tol <= 0.0) return 0;
+  else if (i >= ref->nconf) return 1; /* velocity */
+  else return ref->kind == FEM && ref->nconf == ref->ndofs; /* finite element displacements */
+}
+
+/* grow buffers to n values */
+static void delta_buffers (DIO_DELTA *dlt, int n)
+{
+  if (n > dlt->size)
+  {
+    dlt->size = 2 * n;
+    ERRMEM (dlt->words = realloc (dlt->words, sizeof (unsigned int [2 * dlt->size])));
+    ERRMEM (dlt->incs = realloc (dlt->incs, sizeof (int [dlt->size])));
+  }
+}
+
+/* find or create a reference state of given sizes */
+static DIO_REF* delta_ref (DIO_DELTA *dlt, unsigned int id, int kind, int nconf, int ndofs)
+{
+  int nener = BODY_ENERGY_SIZE (kind);
+  DIO_REF *ref;
+  MAP *node;
+
+  if ((node = MAP_Find_Node (dlt->refs, (void*) (long) id, NULL)))
+  {
+    ref = node->data;
+
+    if (ref->nconf != nconf || ref->ndofs != ndofs || ref->nener != nener)
+    {
+      free (ref);
+      ERRMEM (ref = malloc (sizeof (DIO_REF) + sizeof (double [nconf + ndofs + nener])));
+      node->data = ref;
+    }
+  }
+  else
+  {
+    ERRMEM (ref = malloc (sizeof (DIO_REF) + sizeof (double [nconf + ndofs + nener])));
+    MAP_Insert (&dlt->mapmem, &dlt->refs, (void*) (long) id, ref, NULL);
+  }
+
+  ref->kind = kind;
+  ref->nconf = nconf;
+  ref->ndofs = ndofs;
+  ref->nener = nener;
+  ref->rank = 0;
+
+  return ref;
+}
+
+/* remove references of bodies absent from the frame 'stamp' */
+static void delta_prune (DIO_DELTA *dlt, int stamp)
+{
+  MAP *item;
+
+  for (item = MAP_First (dlt->refs); item; )
+  {
+    DIO_REF *ref = item->data;
+
+    if (ref->stamp != stamp)
+    {
+      free (ref);
+      item = MAP_Delete_Node (&dlt->mapmem, &dlt->refs, item);
+    }
+    else item = MAP_Next (item);
+  }
+}
+
+/* write body record of a delta coded frame */
+static void delta_write_body (DIO_DELTA *dlt, BODY *bod, PBF *bf, int key, double tol)
+{
+  int nconf = BODY_Conf_Size (bod),
+      ndofs = bod->dofs,
+      mode, nw, ni, i;
+  DIO_REF *ref;
+  double *x, q;
+
+  ref = MAP_Find (dlt->refs, (void*) (long) bod->id, NULL);
+
+  if (key || !ref || ref->kind != (int) bod->kind || ref->nconf != nconf || ref->ndofs != ndofs) mode = FULL_RECORD;
+  else
+  {
+    delta_buffers (dlt, nconf + ndofs);
+
+    for (mode = SAME_RECORD, nw = ni = i = 0; i < nconf + ndofs; i ++)
+    {
+      x = i < nconf ? &bod->conf [i] : &bod->velo [i - nconf];
+
+      if (quantized (ref, i, tol))
+      {
+	q = round ((*x - ref->val [i]) / tol);
+	if (!(fabs (q) < DIO_MAXINC)) { mode = FULL_RECORD; break; } /* also when NaN */
+	if (q != 0.0) mode = DELTA_RECORD;
+	dlt->incs [ni ++] = (int) q;
+      }
+      else
+      {
+	uint64_t a, b;
+
+	memcpy (&a, x, sizeof (double));
+	memcpy (&b, &ref->val [i], sizeof (double));
+	a ^= b;
+	if (a) mode = DELTA_RECORD;
+	dlt->words [nw ++] = (unsigned int) (a >> 32);
+	dlt->words [nw ++] = (unsigned int) a;
+      }
+    }
+  }
+
+  PBF_Int (bf, &mode, 1);
+
+  if (mode == FULL_RECORD)
+  {
+    BODY_Write_State (bod, bf);
+
+    ref = delta_ref (dlt, bod->id, bod->kind, nconf, ndofs);
+    memcpy (ref->val, bod->conf, sizeof (double [nconf]));
+    memcpy (ref->val + nconf, bod->velo, sizeof (double [ndofs]));
+  }
+  else
+  {
+    if (mode == DELTA_RECORD)
+    {
+      if (nw) PBF_Uint (bf, dlt->words, nw);
+      if (ni) PBF_Int (bf, dlt->incs, ni);
+
+      for (ni = i = 0; i < nconf + ndofs; i ++)
+      {
+	if (quantized (ref, i, tol)) ref->val [i] += (double) dlt->incs [ni ++] * tol;
+	else ref->val [i] = i < nconf ? bod->conf [i] : bod->velo [i - nconf];
+      }
+    }
+
+    PBF_Double (bf, bod->energy, ref->nener);
+#if MPI
+    PBF_Int (bf, &bod->dom->rank, 1);
+#endif
+  }
+
+  ref->stamp = dlt->frame;
+}
+
+/* read body record of a delta coded frame into its reference state */
+static DIO_REF* delta_read_body (DIO_DELTA *dlt, unsigned int id, PBF *bf, double tol)
+{
+  int mode, n, nw, ni, i;
+  DIO_REF *ref;
+
+  PBF_Int (bf, &mode, 1);
+
+  if (mode == FULL_RECORD)
+  {
+    int kind, nconf, ndofs;
+
+    PBF_Int (bf, &kind, 1);
+    PBF_Int (bf, &nconf, 1);
+    PBF_Int (bf, &ndofs, 1);
+
+    ref = delta_ref (dlt, id, kind, nconf, ndofs);
+    PBF_Double (bf, ref->val, nconf + ndofs + ref->nener);
+  }
+  else
+  {
+    ASSERT (mode == SAME_RECORD || mode == DELTA_RECORD, ERR_FILE_FORMAT);
+    ASSERT (ref = MAP_Find (dlt->refs, (void*) (long) id, NULL), ERR_FILE_FORMAT); /* decoding has not started from a keyframe */
+
+    n = ref->nconf + ref->ndofs;
+
+    if (mode == DELTA_RECORD)
+    {
+      delta_buffers (dlt, n);
+
+      for (nw = ni = i = 0; i < n; i ++)
+      {
+	if (quantized (ref, i, tol)) ni ++;
+	else nw += 2;
+      }
+
+      if (nw) PBF_Uint (bf, dlt->words, nw);
+      if (ni) PBF_Int (bf, dlt->incs, ni);
+
+      for (nw = ni = i = 0; i < n; i ++)
+      {
+	if (quantized (ref, i, tol)) ref->val [i] += (double) dlt->incs [ni ++] * tol;
+	else
+	{
+	  uint64_t a, b;
+
+	  a = ((uint64_t) dlt->words [nw] << 32) | (uint64_t) dlt->words [nw + 1];
+	  memcpy (&b, &ref->val [i], sizeof (double));
+	  a ^= b;
+	  memcpy (&ref->val [i], &a, sizeof (double));
+	  nw += 2;
+	}
+      }
+    }
+
+    PBF_Double (bf, ref->val + n, ref->nener);
+  }
+
+  if (bf->parallel == PBF_ON) PBF_Int (bf, &ref->rank, 1);
+
+  ref->stamp = FRAME (bf);
+
+  return ref;
+}
+
+/* decode body records of the current frame into references; return 0 if the frame is not delta coded */
+static int delta_read_frame (DIO_DELTA *dlt, PBF *bf)
+{
+  unsigned int id;
+  int lag, nbod;
+  double tol;
+
+  if (!PBF_Label (bf, "DELTA"))
+  {
+    delta_prune (dlt, -1);
+    return 0;
+  }
+
+  PBF_Int (bf, &lag, 1);
+  PBF_Double (bf, &tol, 1);
+
+  ASSERT (PBF_Label (bf, "BODS"), ERR_FILE_FORMAT);
+
+  PBF_Int (bf, &nbod, 1);
+
+  for (int n = 0; n < nbod; n ++)
+  {
+    PBF_Uint (bf, &id, 1);
+    delta_read_body (dlt, id, bf, tol);
+  }
+
+  delta_prune (dlt, FRAME (bf));
+
+  return 1;
+}
+
+/* decode frames from the most recent keyframe, or from the last decoded frame, up to the current one;
+ * the body records of the current frame itself are left for decoding by the caller */
+static void delta_seek (DIO_DELTA **head, PBF *bf, int lag)
+{
+  DIO_DELTA *dlt, *d;
+  int target, start;
+  PBF *b;
+
+  dlt = delta_list (head, bf);
+  target = FRAME (bf);
+  start = dlt->frame >= target - lag && dlt->frame < target ? dlt->frame + 1 : target - lag;
+
+  if (start < target)
+  {
+    PBF_Backward (bf, target - start);
+
+    for (; start < target; start ++)
+    {
+      for (b = bf, d = dlt; b; b = b->next, d = d->next) delta_read_frame (d, b);
+
+      PBF_Forward (bf, 1);
+    }
+  }
+}
+
+/* update body state from its reference */
+static void delta_set_body (BODY *bod, DIO_REF *ref)
+{
+  ASSERT_TEXT (((bod->kind == RIG || bod->kind == OBS) &&
+    (ref->kind == RIG || ref->kind == OBS)) || (int) bod->kind == ref->kind, "Body kind mismatch when reading state");
+  ASSERT_TEXT (BODY_Conf_Size (bod) == ref->nconf, "Body configuration size mismatch when reading state");
+  ASSERT_TEXT (bod->dofs == ref->ndofs, "Body dofs size mismatch when reading state");
+
+  BODY_Set_State (bod, ref->val, ref->val + ref->nconf, ref->val + ref->nconf + ref->ndofs);
+}
+
+/* free delta coding references */
+void dom_delta_destroy (DIO_DELTA *dlt)
+{
+  DIO_DELTA *next;
+
+  for (; dlt; dlt = next)
+  {
+    next = dlt->next;
+
+    for (MAP *item = MAP_First (dlt->refs); item; item = MAP_Next (item)) free (item->data);
+
+    MEM_Release (&dlt->mapmem);
+    free (dlt->words);
+    free (dlt->incs);
+    free (dlt);
+  }
+}
+
+#if BODY_TABLE
+/* compare body table records by body id */
+static int body_table_compare (const void *a, const void *b)
+{
+  const unsigned int *x = a, *y = b;
+
+  if (x[0] < y[0]) return -1;
+  else if (x[0] > y[0]) return 1;
+  else return 0;
+}
+
+/* write (body id, record position) table sorted by body id */
+static void write_body_table (PBF *bf, unsigned int *tab, int n)
+{
+  qsort (tab, n, sizeof (unsigned int [2]), body_table_compare);
+
+  PBF_Label (bf, "BTAB");
+
+  PBF_Int (bf, &n, 1);
+
+  PBF_Uint (bf, tab, 2*n);
+}
+
+/* find body record position by binary search of the current frame body table;
+ * return 1 if found, 0 if not found and -1 if the frame has no body table */
+static int find_body (PBF *bf, unsigned int id, unsigned int *pos)
+{
+  unsigned int base, rec [2];
+  int n, l, h, m;
+
+  if (!PBF_Label (bf, "BTAB")) return -1;
+
+  PBF_Int (bf, &n, 1);
+
+  base = PBF_Tell (bf);
+
+  for (l = 0, h = n - 1; l <= h; )
+  {
+    m = l + (h - l) / 2;
+
+    PBF_Goto (bf, base + m * 2 * BYTES_PER_XDR_UNIT); /* records are pairs of XDR words */
+
+    PBF_Uint (bf, rec, 2);
+
+    if (id == rec [0])
+    {
+      *pos = rec [1];
+      return 1;
+    }
+    else if (id < rec [0]) h = m - 1;
+    else l = m + 1;
+  }
+
+  return 0;
+}
+
+/* test whether the current frame body tables hold exactly the bodies of the domain */
+static int body_table_matches (DOM *dom, PBF *bf)
+{
+  int n, j, size = 0, ret = 1;
+  unsigned int *tab;
+
+  for (; bf && ret; bf = bf->next)
+  {
+    if (!PBF_Label (bf, "BTAB")) return 0;
+
+    PBF_Int (bf, &n, 1);
+
+    ERRMEM (tab = malloc (sizeof (unsigned int [2]) * (n + 1)));
+
+    PBF_Uint (bf, tab, 2*n);
+
+    for (j = 0; j < n && ret; j ++) ret = MAP_Find (dom->idb, (void*) (long) tab [2*j], NULL) != NULL;
+
+    free (tab);
+
+    size += n;
+  }
+
+  return ret && size == dom->nbod;
+}
+#endif
+
 /* write domain state */
 void dom_write_state (DOM *dom, PBF *bf, SET *subset)
 {
@@ -410,17 +867,40 @@ void dom_write_state (DOM *dom, PBF *bf, SET *subset)
 
   SET_Free (&dom->setmem, &dom->newb);
 
-  /* write regular bodies (this also includes states of newly created ones) */
+  /* delta coding of body states: full states at keyframes and increments in between */
 
-  PBF_Label (bf, "BODS");
+  DIO_DELTA *dlt = NULL;
+  double tol = 0.0;
 
-  if (subset)
+  if (subset == NULL && dom->solfec->keyframes > 0)
   {
-    int nbod = SET_Size (subset);
+    dlt = delta_list (&dom->delta, bf);
+    dlt->lag = dlt->lag < 0 || dlt->lag + 1 >= dom->solfec->keyframes ? 0 : dlt->lag + 1;
+    dlt->frame ++;
+    tol = dom->solfec->tolerance;
 
-    PBF_Int (bf, &nbod, 1);
+    PBF_Label (bf, "DELTA");
+
+    PBF_Int (bf, &dlt->lag, 1);
+
+    PBF_Double (bf, &tol, 1);
   }
-  else PBF_Int (bf, &dom->nbod, 1);
+  else if (subset == NULL && dom->delta) dom->delta->lag = -1; /* start with a keyframe if resumed */
+
+  /* write regular bodies (this also includes states of newly created ones) */
+
+  PBF_Label (bf, "BODS");
+
+  int nbod = subset ? SET_Size (subset) : dom->nbod;
+
+  PBF_Int (bf, &nbod, 1);
+
+#if BODY_TABLE
+  unsigned int *tab = NULL;
+  int ntab = 0;
+
+  if (!dlt) ERRMEM (tab = malloc (sizeof (unsigned int [2]) * (nbod + 1)));
+#endif
 
   for (BODY *bod = dom->bod; bod; bod = bod->next)
   {
@@ -430,9 +910,29 @@ void dom_write_state (DOM *dom, PBF *bf, SET *subset)
 
     if (bod->label) PBF_Label (bf, bod->label); /* label body record for fast access */
 
-    BODY_Write_State (bod, bf);
+    if (dlt) delta_write_body (dlt, bod, bf, dlt->lag == 0, tol);
+    else
+    {
+#if BODY_TABLE
+      tab [2*ntab] = bod->id;
+      tab [2*ntab+1] = PBF_Tell (bf);
+      ntab ++;
+#endif
+
+      BODY_Write_State (bod, bf);
+    }
   }
 
+  if (dlt) delta_prune (dlt, dlt->frame);
+#if BODY_TABLE
+  else /* body records of delta coded frames are decoded as a whole */
+  {
+    write_body_table (bf, tab, ntab);
+
+    free (tab);
+  }
+#endif
+
   /* write constraints */
 
   PBF_Label (bf, "CONS");
@@ -483,12 +983,28 @@ void dom_read_state (DOM *dom, PBF *bf)
   /* read all bodies if needed */
   if (!dom->allbodiesread) read_new_bodies (dom, bf);
 
+  /* decode delta coded frames from the nearest keyframe */
+  DIO_DELTA *dlt = NULL;
+  int frame = FRAME (bf);
+
+  if (PBF_Label (bf, "DELTA"))
+  {
+    int lag;
+
+    PBF_Int (bf, &lag, 1);
+
+    delta_seek (&dom->delta, bf, lag);
+
+    dlt = dom->delta;
+  }
+  else if (dom->delta) dom->delta->frame = -1;
+
   /* mark all bodies as absent */
   for (bod = dom->bod; bod; bod = bod->next) bod->flags |= BODY_ABSENT;
 
   SET *usedlabel = NULL;
 
-  for (; bf; bf = bf->next)
+  for (DIO_DELTA *d = dlt; bf; bf = bf->next, d = d ? d->next : NULL)
   {
     if (PBF_Label (bf, "DOM"))
     {
@@ -513,6 +1029,17 @@ void dom_read_state (DOM *dom, PBF *bf)
 
       PBF_Double (bf, &dom->merit, 1);
 
+      /* read delta coding parameters */
+
+      int lag, delta = d && PBF_Label (bf, "DELTA");
+      double tol = 0.0;
+
+      if (delta)
+      {
+	PBF_Int (bf, &lag, 1);
+	PBF_Double (bf, &tol, 1);
+      }
+
       /* read body states */
 
       ASSERT (PBF_Label (bf, "BODS"), ERR_FILE_FORMAT);
@@ -550,10 +1077,18 @@ void dom_read_state (DOM *dom, PBF *bf)
 	  dom->nbod ++;
 	}
 
-	BODY_Read_State (bod, bf, iover);
+	if (delta)
+	{
+	  DIO_REF *ref = delta_read_body (d, id, bf, tol);
+	  delta_set_body (bod, ref);
+	  if (bf->parallel == PBF_ON && dom->solfec->mode == SOLFEC_READ) bod->rank = ref->rank;
+	}
+	else BODY_Read_State (bod, bf, iover);
 	bod->flags &= ~BODY_ABSENT;
       }
 
+      if (d) delta_prune (d, delta ? FRAME (bf) : -1);
+
       /* read constraints */
 
       ASSERT (PBF_Label (bf, "CONS"), ERR_FILE_FORMAT);
@@ -594,6 +1129,8 @@ void dom_read_state (DOM *dom, PBF *bf)
 
   SET_Free (NULL, &usedlabel);
 
+  if (dlt) dlt->frame = frame; /* references hold the states of this frame */
+
   /* attach constraints to bodies */
   dom_attach_constraints (dom);
 }
@@ -601,6 +1138,15 @@ void dom_read_state (DOM *dom, PBF *bf)
 /* read state of an individual body */
 int dom_read_body (DOM *dom, PBF *bf, BODY *bod)
 {
+  /* delta coded frames are decoded as a whole */
+
+  if (PBF_Label (bf, "DELTA"))
+  {
+    dom_read_state (dom, bf);
+
+    return MAP_Find (dom->idb, (void*) (long) bod->id, NULL) == bod;
+  }
+
   /* read iover */
 
   int iover = 2;
@@ -623,6 +1169,22 @@ int dom_read_body (DOM *dom, PBF *bf, BODY *bod)
   }
   else
   {
+#if BODY_TABLE
+    unsigned int pos;
+    int found = -1;
+
+    for (PBF *f = bf; f && found <= 0; f = f->next)
+    {
+      if ((found = find_body (f, bod->id, &pos)) > 0)
+      {
+	PBF_Goto (f, pos);
+	BODY_Read_State (bod, f, iover);
+      }
+    }
+
+    if (found >= 0) return found; /* older outputs have no body tables */
+#endif
+
     for (; bf; bf = bf->next)
     {
       if (PBF_Label (bf, "BODS"))
@@ -664,6 +1226,39 @@ int dom_read_body (DOM *dom, PBF *bf, BODY *bod)
   return 0;
 }
 
+/* read states of a set of bodies; return the number of bodies read */
+int dom_read_bodies (DOM *dom, PBF *bf, SET *bodies)
+{
+  int n = 0;
+
+#if BODY_TABLE
+  /* body tables are used only when the frame stores the same bodies as the domain
+   * and all requested bodies are found; otherwise bodies were inserted or deleted */
+  if (!PBF_Label (bf, "DELTA") && body_table_matches (dom, bf))
+  {
+    for (SET *item = SET_First (bodies); item; item = SET_Next (item))
+    {
+      n += dom_read_body (dom, bf, item->data);
+    }
+
+    if (n == SET_Size (bodies)) return n;
+  }
+#endif
+
+  dom_read_state (dom, bf); /* read the whole frame */
+
+  n = 0;
+
+  for (SET *item = SET_First (bodies); item; item = SET_Next (item))
+  {
+    BODY *bod = item->data;
+
+    if (MAP_Find (dom->idb, (void*) (long) bod->id, NULL) == bod) n ++;
+  }
+
+  return n;
+}
+
 /* read state of an individual constraint */
 int dom_read_constraint (DOM *dom, PBF *bf, CON *con)
 {
@@ -715,9 +1310,103 @@ static char *get_regerror (int errcode, regex_t *compiled)
 }
 #endif
 
+/* decode the current delta coded frame of input files into new references; NULL if the frame is not delta coded */
+static DIO_DELTA* delta_decode (PBF *bf)
+{
+  DIO_DELTA *dlt = NULL, *d;
+  int lag;
+  PBF *b;
+
+  if (!PBF_Label (bf, "DELTA")) return NULL;
+
+  PBF_Int (bf, &lag, 1);
+
+  delta_seek (&dlt, bf, lag);
+
+  for (b = bf, d = dlt; b; b = b->next, d = d->next) delta_read_frame (d, b);
+
+  return dlt;
+}
+
+/* initialize states of (regular expression 'subset' matching labeled) bodies from decoded references */
+static int delta_init_state (DOM *dom, DIO_DELTA *dlt, SET *subset, int rigid_to_fem)
+{
+#if POSIX
+  regex_t *xp = NULL;
+  int n = 0, k;
+
+  if (subset)
+  {
+    ERRMEM (xp = malloc (sizeof (regex_t [SET_Size (subset)])));
+
+    for (SET *item = SET_First (subset); item; item = SET_Next (item), n ++)
+    {
+      int error = regcomp (&xp[n], item->data, 0);
+
+      if (error != 0)
+      {
+	char *message = get_regerror (error, &xp[n]);
+	fprintf (stderr, "-->\n");
+	fprintf (stderr, "Regular expression ERROR --> %s\n", message);
+	fprintf (stderr, "<--\n");
+	for (k = 0; k <= n; k ++) regfree (&xp[k]);
+	dom_delta_destroy (dlt);
+	free (message);
+	free (xp);
+	return 0;
+      }
+    }
+  }
+#else
+  if (subset)
+  {
+    ASSERT_TEXT (0, "Regular expressions require POSIX support --> recompile Solfec with POSIX=yes");
+    dom_delta_destroy (dlt);
+    return 0;
+  }
+#endif
+
+  for (BODY *bod = dom->bod; bod; bod = bod->next)
+  {
+    DIO_REF *ref = NULL;
+
+#if POSIX
+    if (subset)
+    {
+      if (!bod->label) continue;
+      for (k = 0; k < n; k ++) if (regexec (&xp[k], bod->label, 0, NULL, 0) == 0) break;
+      if (k == n) continue;
+    }
+#endif
+
+    for (DIO_DELTA *d = dlt; d && !ref; d = d->next) ref = MAP_Find (d->refs, (void*) (long) bod->id, NULL);
+
+    if (ref == NULL) continue;
+
+    if (rigid_to_fem && bod->kind == FEM && ref->kind == RIG)
+    {
+      BODY_From_Rigid (bod, ref->val, ref->val+9, ref->val+12, ref->val+15);
+    }
+    else delta_set_body (bod, ref);
+  }
+
+#if POSIX
+  for (k = 0; k < n; k ++) regfree (&xp[k]);
+  free (xp);
+#endif
+
+  dom_delta_destroy (dlt);
+
+  return 1;
+}
+
 /* initialize domain state */
 int dom_init_state (DOM *dom, PBF *bf, SET *subset)
 {
+  DIO_DELTA *dlt = delta_decode (bf);
+
+  if (dlt) return delta_init_state (dom, dlt, subset, 0);
+
   for (; bf; bf = bf->next)
   {
     if (PBF_Label (bf, "DOM"))
@@ -773,6 +1462,21 @@ int dom_init_state (DOM *dom, PBF *bf, SET *subset)
 	return 0;
 #endif
       }
+#if BODY_TABLE
+      else if (PBF_Label (bf, "BTAB")) /* update states of existing bodies only */
+      {
+	for (BODY *bod = dom->bod; bod; bod = bod->next)
+	{
+	  unsigned int pos;
+
+	  if (find_body (bf, bod->id, &pos) > 0)
+	  {
+	    PBF_Goto (bf, pos);
+	    BODY_Read_State (bod, bf, iover);
+	  }
+	}
+      }
+#endif
       else
       {
 	ASSERT (PBF_Label (bf, "BODS"), ERR_FILE_FORMAT);
@@ -833,6 +1537,10 @@ int dom_init_state (DOM *dom, PBF *bf, SET *subset)
 /* map rigid onto FEM state */
 int dom_rigid_to_fem (DOM *dom, PBF *bf, SET *subset)
 {
+  DIO_DELTA *dlt = delta_decode (bf);
+
+  if (dlt) return delta_init_state (dom, dlt, subset, 1);
+
   for (; bf; bf = bf->next)
   {
     if (PBF_Label (bf, "DOM"))
@@ -11,6 +11,8 @@
 #ifndef __dio__
 #define __dio__
 
+typedef struct dio_delta DIO_DELTA;
+
 /* write domain state */
 void dom_write_state (DOM *dom, PBF *bf, SET *subset);
 
@@ -20,6 +22,9 @@ void dom_read_state (DOM *dom, PBF *bf);
 /* read state of an individual body */
 int dom_read_body (DOM *dom, PBF *bf, BODY *bod);
 
+/* read states of a set of bodies */
+int dom_read_bodies (DOM *dom, PBF *bf, SET *bodies);
+
 /* read state of an individual constraint */
 int dom_read_constraint (DOM *dom, PBF *bf, CON *con);
 
@@ -29,4 +34,7 @@ int dom_init_state (DOM *dom, PBF *bf, SET *subset);
 /* map rigid onto FEM state */
 int dom_rigid_to_fem (DOM *dom, PBF *bf, SET *subset);
 
+/* free delta coding references */
+void dom_delta_destroy (DIO_DELTA *dlt);
+
 #endif
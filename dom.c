@@ -51,6 +51,8 @@
 #define CONBLK 128 /* constraints memory block size */
 #define MAPBLK 128 /* map items memory block size */
 #define SETBLK 128 /* set items memory block size */
+#define SUBLEV 24 /* number of subcycling levels */
+#define SUBTOL 0.01 /* subcycling energy balance tolerance */
 
 /* excluded surface pairs comparison */
 static int pair_compare (int *a, int *b)
@@ -426,8 +428,9 @@ static void ext_to_remove (DOM *dom, CON *con)
 }
 #endif
 
-/* update contact data */
-static void update_contact (DOM *dom, CON *con)
+/* update contact data; return 0 if the contact was lost; the domain
+ * is not modified and different contacts can be updated concurrently */
+static int update_contact_data (DOM *dom, CON *con)
 {
   double mpnt [3], spnt [3], normal [3];
   void *mgobj = mgobj(con),
@@ -458,7 +461,13 @@ static void update_contact (DOM *dom, CON *con)
     }
     else
     {
-      if (con->gap <= dom->depth) dom->flags |= DOM_DEPTH_VIOLATED;
+      if (con->gap <= dom->depth)
+      {
+#if OMP
+	#pragma omp atomic
+#endif
+	dom->flags |= DOM_DEPTH_VIOLATED;
+      }
 
       COPY (mpnt, con->point);
       BODY_Ref_Point (con->master, con->msgp, mpnt, con->mpnt);
@@ -471,16 +480,28 @@ static void update_contact (DOM *dom, CON *con)
       }
     }
   }
-  else
-  {
+
+  if (tri) free (tri);
+
+  return state || (con->state & CON_COHESIVE);
+}
+
+/* remove a lost contact */
+static void remove_contact (DOM *dom, CON *con)
+{
 #if MPI
-    ext_to_remove (dom, con); /* schedule remote deletion of external constraints */
+  ext_to_remove (dom, con); /* schedule remote deletion of external constraints */
 #endif
-    DOM_Remove_Constraint (dom, con); /* remove from the domain */
-  }
+  DOM_Remove_Constraint (dom, con); /* remove from the domain */
+}
 
-  if (tri) free (tri);
+#if !OMP
+/* update contact data */
+static void update_contact (DOM *dom, CON *con)
+{
+  if (!update_contact_data (dom, con)) remove_contact (dom, con);
 }
+#endif
 
 /* update fixed point data */
 static void update_fixpnt (DOM *dom, CON *con)
@@ -621,7 +642,6 @@ static int gobj_adjacent (short paircode, void *aobj, void *bobj)
   return 0;
 }
 
-#if MPI
 /* return an SGP index:
  * semi-positive index indicates regular surface SGP */
 static int SGP_index (BODY *bod, SGP *sgp)
@@ -645,6 +665,7 @@ static SGP* SGP_from_index (DOM *dom, BODY *bod, int n)
   return sgp;
 }
 
+#if MPI
 /* constraint weight */
 static int constraint_weight (CON *con)
 {
@@ -3053,6 +3074,73 @@ static void sparsify_contacts (DOM *dom)
   MEM_Release (&mem);
 }
 
+/* test whether a body is integrated with explicit subcycling */
+static int subcycled (DOM *dom, BODY *bod)
+{
+  return dom->subcycling && bod->kind == FEM && bod->scheme == SCH_DEF_EXP &&
+        (bod->form == TOTAL_LAGRANGIAN || bod->form == BODY_COROTATIONAL);
+}
+
+/* group subcycled bodies by the power of two substep counts resolving
+ * their critical steps within the coarse step and report the groups */
+static void subcycling_groups (DOM *dom, double step)
+{
+  int count [SUBLEV], level;
+  BODY *bod;
+
+  for (level = 0; level < SUBLEV; level ++) count [level] = 0;
+
+  for (bod = dom->bod; bod; bod = bod->next)
+  {
+    if (subcycled (dom, bod))
+    {
+      for (level = 0; level < SUBLEV-1 && step > (double) (1 << level) * bod->substep; level ++);
+      bod->subcycles = 1 << level;
+      bod->subenergy = bod->energy [KINETIC] + bod->energy [INTERNAL] - bod->energy [EXTERNAL]; /* balance at time t */
+      count [level] ++;
+    }
+    else bod->subcycles = 1;
+  }
+
+  if (dom->subcycling && dom->verbose)
+  {
+#if MPI
+    for (level = 1; level < SUBLEV; level ++) count [level] = PUT_int_sum (count [level]);
+
+    if (dom->rank == 0)
+#endif
+    {
+      for (level = 1; level < SUBLEV; level ++)
+	if (count [level]) printf (" (SUBSTEP: %.3g x %d, BODIES: %d) ", step / (double) (1 << level), 1 << level, count [level]);
+      fflush (stdout);
+    }
+  }
+}
+
+/* check energy balance of subcycled bodies over the completed step */
+static void subcycling_balance (DOM *dom)
+{
+  double *energy, emax, etot;
+  BODY *bod;
+
+  for (bod = dom->bod; bod; bod = bod->next)
+  {
+    if (bod->subcycles > 1 && bod->damping == 0.0) /* damping dissipates energy */
+    {
+      energy = bod->energy;
+      etot = energy [KINETIC] + energy [INTERNAL] - energy [EXTERNAL];
+      emax = MAX (fabs (energy [KINETIC]), fabs (energy [INTERNAL]));
+      emax = MAX (emax, fabs (energy [EXTERNAL]));
+
+      if (emax > DBL_EPSILON && fabs (etot - bod->subenergy) > SUBTOL * emax && dom->verbose)
+      {
+	fprintf (stderr, "WARNING: energy balance of subcycled body %d changed by %g over %d substeps\n",
+	         bod->id, etot - bod->subenergy, bod->subcycles);
+      }
+    }
+  }
+}
+
 /* constraint kind string */
 char* CON_Kind (CON *con)
 {
@@ -3081,6 +3169,7 @@ DOM* DOM_Create (AABB *aabb, SPSET *sps, short dynamic, double step)
   dom->sps = sps;
   dom->dynamic = (dynamic == 1 ? 1 : 0);
   dom->step = step;
+  dom->subcycling = 0;
   dom->time = 0.0;
 
   MEM_Init (&dom->conmem, sizeof (CON), CONBLK);
@@ -3096,6 +3185,7 @@ DOM* DOM_Create (AABB *aabb, SPSET *sps, short dynamic, double step)
   dom->newb = NULL;
   dom->allbodies = NULL;
   dom->allbodiesread = 0;
+  dom->delta = NULL;
   dom->sparecid = NULL;
   dom->excluded = NULL;
   dom->cid = 1;
@@ -3670,7 +3760,8 @@ LOCDYN* DOM_Update_Begin (DOM *dom)
 
       double h = BODY_Dynamic_Critical_Step (bod);
 
-      if (h < step) step = h;
+      if (subcycled (dom, bod)) bod->substep = h;
+      else if (h < step) step = h;
     }
   }
 
@@ -3683,6 +3774,8 @@ LOCDYN* DOM_Update_Begin (DOM *dom)
 #endif
   if (dom->verbose) printf (" (STEP: %.3g) ", step), fflush (stdout);
 
+  if (dom->dynamic) subcycling_groups (dom, step);
+
   /* begin time integration */
   if (dom->dynamic)
   {
@@ -3715,13 +3808,33 @@ LOCDYN* DOM_Update_Begin (DOM *dom)
 
   /* update old constraints */
   CON *next;
+#if OMP
+  int j, n, *kept;
+  CON **pcon = ompu_constraints (dom, &n);
+  ERRMEM (kept = malloc (sizeof (int [n+1])));
+  #pragma omp parallel for shared (pcon, kept)
+  for (j = 0; j < n; j ++)
+  {
+    kept [j] = pcon[j]->kind == CONTACT ? update_contact_data (dom, pcon[j]) : 1; /* contact geometry is updated concurrently */
+  }
+  for (j = 0; j < n; j ++)
+  {
+    if (!kept [j]) remove_contact (dom, pcon[j]); /* while lost contacts are removed in the list order */
+  }
+  free (kept);
+  free (pcon);
+#endif
   for (con = dom->con; con; con = next)
   {
     next = con->next; /* contact update can delete the current iterate */
 
     switch (con->kind)
     {
+#if OMP
+      case CONTACT: break;
+#else
       case CONTACT: update_contact (dom, con); break;
+#endif
       case FIXPNT:  update_fixpnt  (dom, con); break;
       case FIXDIR:  update_fixdir  (dom, con); break;
       case VELODIR: update_velodir (dom, con); break;
@@ -3839,8 +3952,26 @@ void DOM_Update_End (DOM *dom)
 
   /* end time integration */
   if (dom->dynamic)
+  {
+#if OMP
+    int j, n;
+    BODY **pbod = ompu_rigid_bodies (dom, &n);
+    #pragma omp parallel for shared (pbod)
+    for (j = 0; j < n; j ++)
+    {
+      BODY_Dynamic_Step_End (pbod[j], time, step); /* each body gathers its own constraint reactions */
+    }
+    free (pbod);
+
+    for (bod = dom->bod; bod; bod = bod->next)
+      if (!(bod->kind == OBS || bod->kind == RIG)) BODY_Dynamic_Step_End (bod, time, step);
+#else
     for (bod = dom->bod; bod; bod = bod->next)
       BODY_Dynamic_Step_End (bod, time, step);
+#endif
+
+    if (dom->subcycling) subcycling_balance (dom);
+  }
   else
     for (bod = dom->bod; bod; bod = bod->next)
       BODY_Static_Step_End (bod, time, step);
@@ -4043,6 +4174,150 @@ void DOM_Pending_Body_Remove (DOM *dom, BODY *bod)
 }
 #endif
 
+/* pack domain state for a restart checkpoint */
+void DOM_Checkpoint_Pack (DOM *dom, int *dsize, double **d, int *doubles, int *isize, int **i, int *ints)
+{
+  CON *con, *last;
+  BODY *bod;
+  SET *item;
+
+  pack_double (dsize, d, doubles, dom->time);
+  pack_double (dsize, d, doubles, dom->step);
+
+  /* constraint identifiers */
+  pack_int (isize, i, ints, dom->cid);
+  pack_int (isize, i, ints, SET_Size (dom->sparecid));
+  for (item = SET_First (dom->sparecid); item; item = SET_Next (item))
+    pack_int (isize, i, ints, (int) (long) item->data);
+
+  /* bodies */
+  pack_int (isize, i, ints, dom->nbod);
+  for (bod = dom->bod; bod; bod = bod->next)
+  {
+    pack_int (isize, i, ints, bod->id);
+    BODY_Checkpoint_Pack (bod, dsize, d, doubles, isize, i, ints);
+  }
+
+  /* constraints from the oldest to the newest, so that unpacking restores the list order */
+  for (last = dom->con; last && last->next; last = last->next);
+  pack_int (isize, i, ints, dom->ncon);
+  for (con = last; con; con = con->prev)
+  {
+    pack_int (isize, i, ints, con->id);
+    pack_int (isize, i, ints, con->kind);
+
+    if (con->kind == CONTACT)
+    {
+      pack_int (isize, i, ints, con->master->id);
+      pack_int (isize, i, ints, con->slave->id);
+      pack_int (isize, i, ints, SGP_index (con->master, con->msgp));
+      pack_int (isize, i, ints, SGP_index (con->slave, con->ssgp));
+      pack_int (isize, i, ints, con->state);
+      pack_int (isize, i, ints, con->paircode);
+      pack_ints (isize, i, ints, con->spair, 2);
+      pack_doubles (dsize, d, doubles, con->mpnt, 3);
+      pack_doubles (dsize, d, doubles, con->spnt, 3);
+      SURFACE_MATERIAL_Pack_State (&con->mat, dsize, d, doubles, isize, i, ints);
+    }
+
+    /* warm start data */
+    pack_doubles (dsize, d, doubles, con->R, 3);
+    pack_doubles (dsize, d, doubles, con->U, 3);
+    pack_doubles (dsize, d, doubles, con->V, 3);
+    pack_doubles (dsize, d, doubles, con->point, 3);
+    pack_doubles (dsize, d, doubles, con->base, 9);
+    pack_double (dsize, d, doubles, con->area);
+    pack_double (dsize, d, doubles, con->gap);
+    pack_double (dsize, d, doubles, con->merit);
+    pack_doubles (dsize, d, doubles, con->Z, DOM_Z_SIZE);
+  }
+}
+
+/* unpack domain state of a restart checkpoint; the bodies and the constraints other
+ * than contacts must have been created by the same input before; contacts are recreated */
+void DOM_Checkpoint_Unpack (DOM *dom, int *dpos, double *d, int doubles, int *ipos, int *i, int ints)
+{
+  int j, n, id, kind, mid, sid, msgp, ssgp;
+  SET *sparecid;
+  unsigned int cid;
+  CON *con, *next;
+  BODY *bod;
+
+  dom->time = unpack_double (dpos, d, doubles);
+  dom->step = unpack_double (dpos, d, doubles);
+
+  /* constraint identifiers */
+  cid = unpack_int (ipos, i, ints);
+  n = unpack_int (ipos, i, ints);
+  for (sparecid = NULL, j = 0; j < n; j ++)
+    SET_Insert (&dom->setmem, &sparecid, (void*) (long) unpack_int (ipos, i, ints), NULL);
+
+  /* bodies */
+  n = unpack_int (ipos, i, ints);
+  ASSERT_TEXT (n == dom->nbod, "The checkpoint stores %d bodies while %d bodies were defined", n, dom->nbod);
+  for (j = 0; j < n; j ++)
+  {
+    id = unpack_int (ipos, i, ints);
+    ASSERT_TEXT (bod = MAP_Find (dom->idb, (void*) (long) id, NULL), "Body %d of the checkpoint has not been defined", id);
+    BODY_Checkpoint_Unpack (bod, dpos, d, doubles, ipos, i, ints);
+  }
+
+  /* current contacts are replaced by the stored ones */
+  for (con = dom->con; con; con = next)
+  {
+    next = con->next;
+    if (con->kind == CONTACT) DOM_Remove_Constraint (dom, con);
+  }
+  SET_Free (&dom->setmem, &dom->sparecid); /* stored contact ids are assigned below */
+
+  /* constraints */
+  n = unpack_int (ipos, i, ints);
+  for (j = 0; j < n; j ++)
+  {
+    id = unpack_int (ipos, i, ints);
+    kind = unpack_int (ipos, i, ints);
+
+    if (kind == CONTACT)
+    {
+      mid = unpack_int (ipos, i, ints);
+      sid = unpack_int (ipos, i, ints);
+      msgp = unpack_int (ipos, i, ints);
+      ssgp = unpack_int (ipos, i, ints);
+      BODY *master = MAP_Find (dom->idb, (void*) (long) mid, NULL),
+	   *slave = MAP_Find (dom->idb, (void*) (long) sid, NULL);
+      ASSERT_TEXT (master && slave && msgp < master->nsgp && ssgp < slave->nsgp, "Invalid contact %d in the checkpoint", id);
+
+      dom->cid = id; /* use the stored id */
+      con = insert (dom, master, slave, SGP_from_index (dom, master, msgp), SGP_from_index (dom, slave, ssgp), CONTACT);
+      con->state = unpack_int (ipos, i, ints) & ~CON_NEW;
+      con->paircode = unpack_int (ipos, i, ints);
+      unpack_ints (ipos, i, ints, con->spair, 2);
+      unpack_doubles (dpos, d, doubles, con->mpnt, 3);
+      unpack_doubles (dpos, d, doubles, con->spnt, 3);
+      con->state |= SURFACE_MATERIAL_Unpack_State (dom->sps, &con->mat, dpos, d, doubles, ipos, i, ints);
+      con->dia = LOCDYN_Insert (dom->ldy, con, master, slave);
+    }
+    else
+    {
+      con = MAP_Find (dom->idc, (void*) (long) id, NULL);
+      ASSERT_TEXT (con && (int) con->kind == kind, "Constraint %d of the checkpoint has not been defined", id);
+    }
+
+    unpack_doubles (dpos, d, doubles, con->R, 3);
+    unpack_doubles (dpos, d, doubles, con->U, 3);
+    unpack_doubles (dpos, d, doubles, con->V, 3);
+    unpack_doubles (dpos, d, doubles, con->point, 3);
+    unpack_doubles (dpos, d, doubles, con->base, 9);
+    con->area = unpack_double (dpos, d, doubles);
+    con->gap = unpack_double (dpos, d, doubles);
+    con->merit = unpack_double (dpos, d, doubles);
+    unpack_doubles (dpos, d, doubles, con->Z, DOM_Z_SIZE);
+  }
+
+  dom->cid = cid;
+  dom->sparecid = sparecid;
+}
+
 /* write domain state */
 void DOM_Write_State (DOM *dom, PBF *bf)
 {
@@ -4061,6 +4336,12 @@ int DOM_Read_Body (DOM *dom, PBF *bf, BODY *bod)
   return dom_read_body (dom, bf, bod);
 }
 
+/* read states of a set of bodies */
+int DOM_Read_Bodies (DOM *dom, PBF *bf, SET *bodies)
+{
+  return dom_read_bodies (dom, bf, bodies);
+}
+
 /* read state of an individual constraint */
 int DOM_Read_Constraint (DOM *dom, PBF *bf, CON *con)
 {
@@ -4119,6 +4400,8 @@ void DOM_Destroy (DOM *dom)
 
   LOCDYN_Destroy (dom->ldy);
 
+  dom_delta_destroy (dom->delta);
+
   MEM_Release (&dom->conmem);
   MEM_Release (&dom->setmem);
   MEM_Release (&dom->mapmem);
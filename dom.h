@@ -230,6 +230,7 @@ struct domain
 
   short dynamic; /* 1 for dynamics, 0 for quas-statics */
   double step; /* time step size */
+  short subcycling; /* 1 if explicit finite element bodies are subcycled, 0 otherwise */
   double time; /* current time */
 
   unsigned int bid; /* last free body identifier */
@@ -240,6 +241,7 @@ struct domain
   SET *newb; /* set of newly created bodies for time > 0 and before state write */
   MAP *allbodies; /* all created bodies mapped by ids */
   short allbodiesread; /* read flag related to setting up the allbodies set */
+  struct dio_delta *delta; /* delta coding references of output body states (dio.c) */
 
   int nobs, /* obstacles */
       nrig, /* rigid */
@@ -394,6 +396,11 @@ void DOM_Pending_Body_Insert (DOM *dom, BODY *bod);
 void DOM_Pending_Body_Remove (DOM *dom, BODY *bod);
 #endif
 
+/* pack and unpack domain state of a restart checkpoint; unpacking requires
+ * the same bodies and non-contact constraints and recreates the contacts */
+void DOM_Checkpoint_Pack (DOM *dom, int *dsize, double **d, int *doubles, int *isize, int **i, int *ints);
+void DOM_Checkpoint_Unpack (DOM *dom, int *dpos, double *d, int doubles, int *ipos, int *i, int ints);
+
 /* write domain state */
 void DOM_Write_State (DOM *dom, PBF *bf);
 
@@ -403,6 +410,9 @@ void DOM_Read_State (DOM *dom, PBF *bf);
 /* read state of an individual body */
 int  DOM_Read_Body (DOM *dom, PBF *bf, BODY *bod);
 
+/* read states of a set of bodies */
+int  DOM_Read_Bodies (DOM *dom, PBF *bf, SET *bodies);
+
 /* read state of an individual constraint */
 int  DOM_Read_Constraint (DOM *dom, PBF *bf, CON *con);
 
@@ -44,6 +44,9 @@ typedef double (*node_t) [3]; /* mesh node */
 #define IMP_EPS 1E-9
 #define MAX_ITERS 64
 #define MAX_NODES 20
+#define IPBATCH 8 /* integration points batch size */
+#define REF_TOL 1E-10 /* relative residual of the lagged factorization Krylov solves */
+#define REF_MAXITER 10 /* maximal number of Krylov iterations before numeric refactorization */
 #define DOM_TOL 0.1
 #define CUT_TOL 0.001
 #define MESH_DOFS(msh) ((msh)->nodes_count * 3)
@@ -56,6 +59,8 @@ typedef double (*node_t) [3]; /* mesh node */
 #define FEM_FINT(bod) ((bod)->velo + (bod)->dofs * 3) /* internal force */
 #define FEM_FBOD(bod) ((bod)->form < BODY_COROTATIONAL_MODAL ? (bod)->velo + (bod)->dofs * 4 : FEM_MESH_VEL0(bod) + MESH_DOFS(FEM_MESH(bod))) /* unit body force */
 #define FEM_ROT(bod) ((bod)->conf + (bod)->dofs) /* rotation */
+#define SUBSTEP(bod, step) ((bod)->subcycles > 1 ? (step) / (double) (bod)->subcycles : (step)) /* subcycled explicit substep */
+#define FEM_THREADED_REACTIONS 64 /* constraint reactions are accumulated by threads when count x this > mesh dofs */
 
 /* ==================== INTEGRATION ======================= */
 
@@ -863,7 +868,7 @@ inline static double element_det (int type, node_t nodes, double *point, double
   return DET (F);
 }
 
-/* element deformation determinant at local point */
+/* element deformation gradient at local point */
 inline static void element_gradient (int type, node_t q, double *point, double *F0, double *derivs, double *F)
 {
   double local_derivs [3*MAX_NODES], IF0 [9], det, *l, *d;
@@ -882,10 +887,22 @@ inline static void element_gradient (int type, node_t q, double *point, double *
       for (k = 0; k < n; k ++) F [3*j+i] += q[k][i] * derivs [3*k+j];
 }
 
+/* element deformation gradient from referential shape derivatives */
+inline static void element_cached_gradient (int n, node_t q, double *derivs, double *F)
+{
+  int i, j, k;
+
+  IDENTITY (F);
+
+  for (i = 0; i < 3; i ++)
+    for (j = 0; j < 3; j ++)
+      for (k = 0; k < n; k ++) F [3*j+i] += q[k][i] * derivs [3*k+j];
+}
+
 /* compute element shape functions at a local point and return global matrix */
 static MX* element_shapes_matrix (BODY *bod, MESH *msh, ELEMENT *ele, double *point)
 {
-  static int *p, *i, *q, *u, k, n, m, o;
+  int *p, *i, *q, *u, k, n, m, o;
   double shapes [MAX_NODES], *x, *y;
   int dofs = MESH_DOFS (msh);
   MX *N;
@@ -932,6 +949,46 @@ static int number_of_integration_points (ELEMENT *ele)
   return i;
 }
 
+/* create element integration data in one mesh block, following the element traversal order;
+ * ELEMENT->idata = {J0*wgt0, derivs0, J1*wgt1, derivs1, ...}, where derivs are referential shape derivatives */
+#define ELEMENT_IDATA_SIZE(ele) (3*(ele)->type+1)
+static void create_element_integration_data (MESH *msh)
+{
+  double nodes [MAX_NODES][3], F0 [9], F [9], J, *x;
+  ELEMENT *ele;
+  int bulk, n;
+
+  for (ele = msh->surfeles, bulk = 0, n = 0; ele; )
+  {
+    n += number_of_integration_points (ele) * ELEMENT_IDATA_SIZE (ele);
+
+    if (bulk) ele = ele->next;
+    else if (ele->next) ele = ele->next;
+    else ele = msh->bulkeles, bulk = 1;
+  }
+
+  ERRMEM (msh->idata = malloc (sizeof (double [n])));
+
+  for (ele = msh->surfeles, bulk = 0, x = msh->idata; ele; )
+  {
+    element_nodes (msh->ref_nodes, ele->type, ele->nodes, nodes);
+
+    ele->idata = x;
+
+    INTEGRATE3D (ele->type, INTF, ele->dom, ele->domnum,
+
+      J = element_det (ele->type, nodes, point, F0);
+      element_gradient (ele->type, nodes, point, F0, x + 1, F); /* only derivatives are used */
+      x [0] = J * weight;
+      x += ELEMENT_IDATA_SIZE (ele);
+    )
+
+    if (bulk) ele = ele->next;
+    else if (ele->next) ele = ele->next;
+    else ele = msh->bulkeles, bulk = 1;
+  }
+}
+
 /* allocate bulk material states at integration points */
 static void allocate_element_states (MESH *msh, BULK_MATERIAL *mat)
 {
@@ -1045,20 +1102,38 @@ static void element_body_force (BODY *bod, MESH *msh, ELEMENT *ele, double *f, d
   )
 }
 
+/* compute internal force contributions of a batch of integration points */
+static void element_batch_force (BULK_MATERIAL *mat, double *state, double (*field) [MAX_NFIELD],
+  int nb, double *F, double *a, double **B, int n, double *g)
+{
+  double P [9*IPBATCH], Q [9], *b, *p;
+  int i, j;
+
+  BULK_MATERIAL_ROUTINE_BATCH (mat, nb, IPBATCH, state, field [0], F, a, P);
+
+  for (j = 0; j < nb; j ++)
+  {
+    for (i = 0; i < 9; i ++) Q [i] = P [i*IPBATCH+j];
+
+    for (i = 0, b = B [j], p = g; i < n; i ++, b += 3, p += 3) { NVADDMUL (p, Q, b, p); }
+  }
+}
+
 /* copute element internal force or force derivative contribution */
 static void element_internal_force (int derivative, BODY *bod, MESH *msh, ELEMENT *ele, double *g)
 {
-  double nodes [MAX_NODES][3], q [MAX_NODES][3], derivs [3*MAX_NODES], field [MAX_NFIELD],
-	 shapes [MAX_NODES], F0 [9], F [9], P [9], K [81], KB [9], J, integral, *B, *p;
+  double nodes [MAX_NODES][3], q [MAX_NODES][3], ders [3*MAX_NODES], field [MAX_NFIELD],
+	 shapes [MAX_NODES], F0 [9], F [9], K [81], KB [9], J, integral, *derivs, *B, *p;
+  double Fb [9*IPBATCH], ab [IPBATCH], fb [IPBATCH][MAX_NFIELD], db [IPBATCH][3*MAX_NODES], *Bb [IPBATCH];
   BULK_MATERIAL *mat = FEM_MATERIAL (bod, ele);
-  double *bfld = bod->field, *conf = FEM_MESH_CONF (bod);
-  int i, j, n, m, ip = 0,
+  double *bfld = bod->field, *conf = FEM_MESH_CONF (bod), *idata = ele->idata;
+  int i, j, n, m, ip = 0, nb = 0,
       nbfld = mat->nfield,
       *nod = ele->nodes;
 
   ASSERT_TEXT (mat->nfield < MAX_NFIELD, "The maximum of %d field variables has been exceeded.\n", MAX_NFIELD);
 
-  n = element_nodes (msh->ref_nodes, ele->type, ele->nodes, nodes);
+  n = idata ? ele->type : element_nodes (msh->ref_nodes, ele->type, ele->nodes, nodes);
 
   m = 3 * n;
 
@@ -1083,9 +1158,20 @@ static void element_internal_force (int derivative, BODY *bod, MESH *msh, ELEMEN
 
   INTEGRATE3D (ele->type, INTF, ele->dom, ele->domnum,
 
-    J = element_det (ele->type, nodes, point, F0);
-    element_gradient (ele->type, q, point, F0, derivs, F);
-    integral = J * weight;
+    if (idata) /* cached referential geometry */
+    {
+      integral = idata [0];
+      derivs = idata + 1;
+      element_cached_gradient (n, q, derivs, F);
+      idata += m + 1;
+    }
+    else
+    {
+      J = element_det (ele->type, nodes, point, F0);
+      derivs = ders;
+      element_gradient (ele->type, q, point, F0, derivs, F);
+      integral = J * weight;
+    }
 
     if (bfld)
     {
@@ -1117,26 +1203,42 @@ static void element_internal_force (int derivative, BODY *bod, MESH *msh, ELEMEN
 	for (j = 0, B = derivs, p = &g[m*i]; j < n; j ++, B += 3, p += 3) { NVADDMUL (p, KB, B, p); }
       }
     }
-    else
+    else /* gather the integration point into a batch */
     {
-      BULK_MATERIAL_ROUTINE (mat, ele->state + ip * mat->nstate, field, F, integral, P, NULL);
+      for (i = 0; i < 9; i ++) Fb [i*IPBATCH+nb] = F [i];
+      for (i = 0; i < nbfld; i ++) fb [nb][i] = field [i];
+      ab [nb] = integral;
+
+      if (derivs == ders)
+      {
+	for (i = 0; i < m; i ++) db [nb][i] = ders [i];
+	Bb [nb] = db [nb];
+      }
+      else Bb [nb] = derivs;
 
-      for (i = 0, B = derivs, p = g; i < n; i ++, B += 3, p += 3) { NVADDMUL (p, P, B, p); }
+      if (++ nb == IPBATCH)
+      {
+        element_batch_force (mat, ele->state + (ip+1-nb) * mat->nstate, fb, nb, Fb, ab, Bb, n, g);
+	nb = 0;
+      }
     }
 
     ip ++;
   )
+
+  if (nb) element_batch_force (mat, ele->state + (ip-nb) * mat->nstate, fb, nb, Fb, ab, Bb, n, g);
 }
 
 /* compute elastic energy of individual element (and its volume if pvol != NULL) */
 double FEM_Element_Internal_Energy (BODY *bod, MESH *msh, ELEMENT *ele, double *pvol)
 {
   double nodes [MAX_NODES][3], q [MAX_NODES][3], derivs [3*MAX_NODES], F0 [9], F [9], J, integral;
+  double Fb [9*IPBATCH], ab [IPBATCH];
   BULK_MATERIAL *mat = FEM_MATERIAL (bod, ele);
-  double *conf = FEM_MESH_CONF (bod), *p;
-  int i, n, *nod = ele->nodes;
+  double *conf = FEM_MESH_CONF (bod), *idata = ele->idata, *p;
+  int i, n, ip = 0, nb = 0, *nod = ele->nodes;
 
-  n = element_nodes (msh->ref_nodes, ele->type, ele->nodes, nodes);
+  n = idata ? ele->type : element_nodes (msh->ref_nodes, ele->type, ele->nodes, nodes);
 
   for (i = 0; i < n; i ++)
   {
@@ -1150,14 +1252,33 @@ double FEM_Element_Internal_Energy (BODY *bod, MESH *msh, ELEMENT *ele, double *
 
   INTEGRATE3D (ele->type, INTF, ele->dom, ele->domnum,
 
-    J = element_det (ele->type, nodes, point, F0);
-    element_gradient (ele->type, q, point, F0, derivs, F);
-    integral += J * weight * SVK_Energy_C (lambda (mat->young, mat->poisson), mi (mat->young, mat->poisson), 1.0, F);
+    if (idata) /* cached referential geometry */
+    {
+      J = idata [0];
+      element_cached_gradient (n, q, idata + 1, F);
+      idata += 3*n + 1;
+    }
+    else
+    {
+      J = element_det (ele->type, nodes, point, F0) * weight;
+      element_gradient (ele->type, q, point, F0, derivs, F);
+    }
+
+    for (i = 0; i < 9; i ++) Fb [i*IPBATCH+nb] = F [i];
+    ab [nb] = J;
 
-    if (pvol) *pvol += J * weight;
+    if (++ nb == IPBATCH)
+    {
+      integral += BULK_MATERIAL_ROUTINE_BATCH (mat, nb, IPBATCH, ele->state + (ip+1-nb) * mat->nstate, NULL, Fb, ab, NULL);
+      nb = 0;
+    }
+
+    if (pvol) *pvol += J;
+
+    ip ++;
   )
 
-  /* XXX/TODO => SVK material fixed above */
+  if (nb) integral += BULK_MATERIAL_ROUTINE_BATCH (mat, nb, IPBATCH, ele->state + (ip-nb) * mat->nstate, NULL, Fb, ab, NULL);
 
   return integral;
 }
@@ -1339,7 +1460,9 @@ static void fem_constraints_force (BODY *bod, double *r)
   ELEMENT *ele;
   CONVEX *cvx;
   MESH *msh;
+#if !OMP
   SET *node;
+#endif
   int i, dofs;
 
   msh = FEM_MESH (bod);
@@ -1353,9 +1476,23 @@ static void fem_constraints_force (BODY *bod, double *r)
 
   for (i = 0; i < dofs; i ++) rmsh [i] = 0.0;
 
+#if OMP
+  int j, m, threads = ompu_threads ();
+  CON **pcon = ompu_body_constraints (bod, &m);
+  /* few constraints touching a large mesh: accumulate serially rather than
+   * reduce threads x dofs buffers for the work of a handful of elements */
+  double *buf = m * FEM_THREADED_REACTIONS > dofs ? ompu_kept_buffers (&bod->threadbuf, &bod->threadbufsize, threads, dofs) : NULL;
+  #pragma omp parallel for schedule (static) shared (pcon, buf) private (ele, cvx) if (buf)
+  for (j = 0; j < m; j ++)
+  {
+    CON *con = pcon[j];
+    double *force = buf ? &buf [omp_get_thread_num () * dofs] : rmsh;
+#else
   for (node = SET_First (bod->con); node; node = SET_Next (node))
   {
     CON *con = node->data;
+    double *force = rmsh;
+#endif
     short isma = (bod == con->master);
     double *X = (isma ? con->mpnt : con->spnt);
 
@@ -1366,7 +1503,7 @@ static void fem_constraints_force (BODY *bod, double *r)
     }
     else ele = (isma ? con->msgp->gobj : con->ssgp->gobj);
 
-    accumulate_reac (bod, msh, ele, X, con->base, con->R, isma, rmsh);
+    accumulate_reac (bod, msh, ele, X, con->base, con->R, isma, force);
 
     if (isma && bod == con->slave) /* self-contact */
     {
@@ -1379,21 +1516,25 @@ static void fem_constraints_force (BODY *bod, double *r)
       }
       else ele = con->ssgp->gobj;
 
-      accumulate_reac (bod, msh, ele, X, con->base, con->R, 0, rmsh);
+      accumulate_reac (bod, msh, ele, X, con->base, con->R, 0, force);
     }
   }
+#if OMP
+  if (buf) ompu_kept_buffers_reduce (buf, threads, dofs, rmsh);
+  free (pcon);
+#endif
 
   if (bod->form >= BODY_COROTATIONAL_MODAL) /* H' = bod->evec' * R' * N' * E */
   {
-    double *R = FEM_ROT (bod),
-	   *x = rmsh,
-	   *y = x + dofs,
-	    z [3];
+    double *R = FEM_ROT (bod), z [3];
 
-    for (;x < y; x += 3)
+#if OMP
+    #pragma omp parallel for private (z)
+#endif
+    for (i = 0; i < dofs; i += 3)
     {
-      COPY (x, z);
-      TVMUL (R, z, x);
+      COPY (&rmsh[i], z);
+      TVMUL (R, z, &rmsh[i]);
     }
 
     MX_Matvec (1.0, MX_Tran (bod->evec), rmsh, 0.0, r); /* r = bod->evec' * R' * SUM { N' * E * R } */
@@ -1413,24 +1554,23 @@ static void internal_force (BODY *bod, double *fint)
   for (i = 0; i < dofs; i ++) fint [i] = 0.0;
 
 #if OMP
-  int j, n;
+  int j, n, threads = ompu_threads ();
   ELEMENT **pele = ompu_elements (msh, &n);
-  omp_lock_t *locks = ompu_locks (msh->nodes_count);
-  #pragma omp parallel for shared (pele, fint, locks) private (g, i, v, w)
+  double *buf = ompu_kept_buffers (&bod->threadbuf, &bod->threadbufsize, threads, dofs);
+  #pragma omp parallel for schedule (static) shared (pele, buf) private (g, i, v, w)
   for (j = 0; j < n; j ++)
   {
+    double *f = &buf [omp_get_thread_num () * dofs];
+
     element_internal_force (0, bod, msh, pele[j], g);
 
     for (i = 0, v = g; i < pele[j]->type; i ++, v += 3)
     {
-      int k = pele[j]->nodes[i];
-      w = &fint [k * 3];
-      omp_set_lock(&locks[k]);
+      w = &f [pele[j]->nodes[i] * 3];
       ACC (v, w);
-      omp_unset_lock (&locks[k]);
     }
   }
-  ompu_locks_free (locks, msh->nodes_count);
+  ompu_kept_buffers_reduce (buf, threads, dofs, fint);
   free (pele);
 #else
   ELEMENT *ele;
@@ -1518,8 +1658,20 @@ static void accumulate_pressure (BODY *bod, MESH *msh, double *conf, int surfid,
   int i, j, k, n;
   FACE *fac;
 
+#if OMP
+  int l, m, dofs = MESH_DOFS (msh), threads = ompu_threads ();
+  FACE **pfac = ompu_faces (msh, &m);
+  double *buf = ompu_kept_buffers (&bod->threadbuf, &bod->threadbufsize, threads, dofs);
+  #pragma omp parallel for schedule (static) shared (pfac, buf) private (q, nodes, shapes, N, p, i, j, k, n, fac)
+  for (l = 0; l < m; l ++)
+  {
+    double *f = &buf [omp_get_thread_num () * dofs];
+    fac = pfac[l];
+#else
   for (fac = msh->faces; fac; fac = fac->n)
   {
+    double *f = fext;
+#endif
     if (fac->surface == surfid)
     {
       face_nodes (msh->ref_nodes, fac->type, fac->nodes, nodes);
@@ -1536,12 +1688,16 @@ static void accumulate_pressure (BODY *bod, MESH *msh, double *conf, int surfid,
 	{
 	  k = fac->nodes [i];
 	  for (n = 0; n < 3; n ++)
-	    fext [3*k+n] += N [n] * p * shapes [i]; /* TODO/XXX: verify */
+	    f [3*k+n] += N [n] * p * shapes [i]; /* TODO/XXX: verify */
 	}
       }
       INTEGRAL2D_END ()
     }
   }
+#if OMP
+  ompu_kept_buffers_reduce (buf, threads, dofs, fext);
+  free (pfac);
+#endif
 }
 
 /* compute external force */
@@ -1615,127 +1771,66 @@ static void external_force (BODY *bod, double time, double step, double *fext)
   }
 }
  
-/* compute global tangent stiffness */
-static MX* tangent_stiffness (BODY *bod, short spd)
-{
-  int i, j, k, l, n, dofs, *pp, *ii, *kk;
-  double K [576], *A, *rowblk;
-  MAP **col, *item;
+/* tangent stiffness symbolic structure; MESH->tdata = {spd, nnz, p [dofs+1], i [nnz], map}, where map stores
+ * CSC offsets of element row-blocks, for each element, element node, nodal dof and element node, or -1 if skipped */
+#define TDATA_P(msh) ((msh)->tdata + 2)
+#define TDATA_I(msh) (TDATA_P (msh) + MESH_DOFS (msh) + 1)
+#define TDATA_MAP(msh) (TDATA_I (msh) + (msh)->tdata [1])
+#define TDATA_BLOCKS(ele) (3 * (ele)->type * (ele)->type)
+static void tangent_pattern (MESH *msh, short spd)
+{
+  int i, j, k, l, n, m, r, dofs, *pp, *ii, *kk, *map, *lo, *hi;
+  SET **col, *item;
   ELEMENT *ele;
-  MESH *msh;
-#if OMP
-  MEM *blkmem,
-      *mapmem;
-#else
-  MEM blkmem,
-      mapmem;
-#endif
-  MX *tang;
+  MEM setmem;
+  short bulk;
 
-  if (spd) spd = 1;
-  msh = FEM_MESH (bod);
   dofs = MESH_DOFS (msh);
-  ERRMEM (col = MEM_CALLOC (sizeof (MAP*) * dofs)); /* sparse columns */
-#if OMP
-  int threads;
-  #pragma omp parallel
-  #pragma omp master
-  threads = omp_get_num_threads();
-  ERRMEM (blkmem = MEM_CALLOC (sizeof(MEM) * threads));
-  ERRMEM (mapmem = MEM_CALLOC (sizeof(MEM) * threads));
-  for (i = 0; i < threads; i ++)
-  {
-    MEM_Init  (&blkmem[i], sizeof (double [3]), dofs);
-    MEM_Init  (&mapmem[i], sizeof (MAP), dofs);
-  }
-#else
-  MEM_Init  (&blkmem, sizeof (double [3]), dofs);
-  MEM_Init  (&mapmem, sizeof (MAP), dofs);
-#endif
+  ERRMEM (col = MEM_CALLOC (sizeof (SET*) * dofs)); /* sparse columns */
+  MEM_Init (&setmem, sizeof (SET), dofs);
 
-#if OMP
-  int ei, en;
-  ELEMENT **pele = ompu_elements (msh, &en);
-  omp_lock_t *locks = ompu_locks (msh->nodes_count);
-  #pragma omp parallel for shared (bod, spd, msh, pele, locks, col, blkmem, mapmem) private (ele, K, k, A, l, j, n, i, rowblk)
-  for (ei = 0; ei < en; ei ++)
-#else
-  short bulk;
-  for (ele = msh->surfeles, bulk = 0; ele;
+  for (ele = msh->surfeles, bulk = 0, m = 0; ele;
        ele = (ele->next ? ele->next : bulk ? NULL : msh->bulkeles),
        bulk = (ele == msh->bulkeles ? 1 : bulk)) /* for each element in mesh */
-#endif
   {
-#if OMP
-    ele = pele[ei];
-#endif
-    element_internal_force (1, bod, msh, ele, K); /* compute internal force derivartive: K */
-
-#if 0
-  {
-    double max = K [0];
-
-    for (i = 1, l = ele->type * 3; i < l*l; i ++) max = MAX (max, K [i]);
-
-    for (i = 0; i < l; i ++)
-    {
-      for (j = i+1; j < l; j ++)
-      {
-	ASSERT_DEBUG (fabs (K[l*j+i] - K[l*i+j]) < 1E-10 * max, "Unsymmetry of K: %e, %e", K[l*j+i], K[l*i+j]);
-      }
-    }
-  }
-#endif
-
-    for (k = 0, A = K; k < ele->type; k ++) /* initialize K column block pointer; for element each node */
+    for (k = 0; k < ele->type; k ++) /* for each element node */
     {
-#if OMP
-      omp_set_lock (&locks[ele->nodes[k]]);
-#endif
       for (l = 0; l < 3; l ++) /* for each nodal degree of freedom */
       {
 	j = 3 * ele->nodes [k] + l; /* for each global column index */
 
-	for (n = 0; n < ele->type; n ++, A += 3) /* for each column row-block; shift column block pointer A */
+	for (n = 0; n < ele->type; n ++) /* for each column row-block */
 	{
 	  i = 3 * ele->nodes [n];
 
 	  if (spd && i+2 < j) continue; /* skip upper triangle (leave diagonal overlaping blocks) */
 
-	  if (!(rowblk = MAP_Find (col [j], (void*) (long) i, NULL))) /* if this row-block was not mapped */
-	  {
-#if OMP
-	    ERRMEM (rowblk = MEM_Alloc (&blkmem[omp_get_thread_num()]));
-	    MAP_Insert (&mapmem[omp_get_thread_num()], &col [j], (void*) (long) i, rowblk, NULL); /* map it */
-#else
-	    ERRMEM (rowblk = MEM_Alloc (&blkmem));
-	    MAP_Insert (&mapmem, &col [j], (void*) (long) i, rowblk, NULL); /* map it */
-#endif
-	  }
-	  ACC (A, rowblk); /* accumulate values */
+	  SET_Insert (&setmem, &col [j], (void*) (long) i, NULL); /* map row-block */
 	}
       }
-#if OMP
-      omp_unset_lock (&locks[ele->nodes[k]]);
-#endif
     }
+
+    m += TDATA_BLOCKS (ele);
   }
-#if OMP
-  ompu_locks_free (locks, msh->nodes_count);
-  free (pele);
-#endif
 
-  ERRMEM (pp = malloc (sizeof (int [dofs + 1]))); /* column pointers */
+  if (msh->tdata) free (msh->tdata);
+
+  for (n = 0, j = 0; j < dofs; j ++) n += 3 * SET_Size (col [j]) - spd * (j % 3); /* subtract upper triangular j % 3 sticking out bits */
 
-  for (pp [0] = 0, j = 0; j < dofs; j ++) pp [j+1] = pp [j] + 3 * MAP_Size (col [j]) - spd * (j % 3); /* subtract upper triangular j % 3 sticking out bits */
+  ERRMEM (msh->tdata = malloc (sizeof (int [2 + dofs + 1 + n + m])));
+  msh->tdata [0] = spd;
+  msh->tdata [1] = n;
+  pp = TDATA_P (msh);
+  ii = TDATA_I (msh);
+  map = TDATA_MAP (msh);
 
-  ERRMEM (ii = malloc (sizeof (int [pp [dofs]]))); /* row indices */
+  for (pp [0] = 0, j = 0; j < dofs; j ++) pp [j+1] = pp [j] + 3 * SET_Size (col [j]) - spd * (j % 3); /* column pointers */
 
   for (j = 0, kk = ii; j < dofs; j ++) /* initialize row index pointer; for each column */
   {
-    for (item = MAP_First (col [j]); item; item = MAP_Next (item)) /* for each row-block */
+    for (item = SET_First (col [j]); item; item = SET_Next (item)) /* for each row-block */
     {
-      i = (int) (long) item->key;
+      i = (int) (long) item->data;
       if (spd && i < j) /* diagonal block with sticking out upper triangle */
       {
 	for (n = 0; n < 3 - j % 3; n ++, kk ++) kk [0] = j + n;
@@ -1750,41 +1845,131 @@ static MX* tangent_stiffness (BODY *bod, short spd)
     }
   }
 
-  tang = MX_Create (MXCSC, dofs, dofs, pp, ii); /* create tangent matrix structure */
-  if (spd) tang->flags |= MXSPD;
-
-  for (j = 0, A = tang->x; j < dofs; j ++) /* initialize column values pointer A; for each column */
+  for (ele = msh->surfeles, bulk = 0; ele;
+       ele = (ele->next ? ele->next : bulk ? NULL : msh->bulkeles),
+       bulk = (ele == msh->bulkeles ? 1 : bulk)) /* create scatter map */
   {
-    for (item = MAP_First (col [j]); item; item = MAP_Next (item)) /* for each row-block */
+    for (k = 0; k < ele->type; k ++)
     {
-      i = (int) (long) item->key;
-      rowblk = item->data;
-      if (spd && i < j) /* diagonal block with sticking out upper triangle */
+      for (l = 0; l < 3; l ++)
       {
-	for (n = 0; n < 3 - j % 3; n ++, A ++) A [0] = rowblk [j % 3 + n];
+	j = 3 * ele->nodes [k] + l;
+
+	for (n = 0; n < ele->type; n ++, map ++)
+	{
+	  i = 3 * ele->nodes [n];
+
+	  if (spd && i+2 < j) map [0] = -1;
+	  else
+	  {
+	    r = (spd && i < j) ? j : i; /* first stored row of the block */
+
+	    for (lo = &ii [pp [j]], hi = &ii [pp [j+1]]; lo < hi; ) /* bisect the sorted column */
+	    {
+	      kk = lo + (hi - lo) / 2;
+	      if (*kk < r) lo = kk + 1;
+	      else hi = kk;
+	    }
+
+	    ASSERT_DEBUG (lo < &ii [pp [j+1]] && *lo == r, "Row-block missing from the tangent pattern");
+
+	    map [0] = lo - ii;
+	  }
+	}
       }
-      else /* lower triangle block */
+    }
+  }
+
+  MEM_Release (&setmem);
+  free (col);
+}
+
+/* scatter the columns of element node 'k' from the element tangent into the global tangent values */
+inline static void tangent_scatter (ELEMENT *ele, int k, short spd, double *K, int *map, double *x)
+{
+  int i, j, l, n, t;
+  double *A, *y;
+
+  A = &K [9 * ele->type * k]; /* column block pointer */
+  map += 3 * ele->type * k;
+
+  for (l = 0; l < 3; l ++) /* for each nodal degree of freedom */
+  {
+    j = 3 * ele->nodes [k] + l; /* global column index */
+
+    for (n = 0; n < ele->type; n ++, A += 3, map ++) /* for each column row-block; shift column block pointer A */
+    {
+      if (map [0] < 0) continue; /* skipped upper triangle */
+
+      i = 3 * ele->nodes [n];
+      y = &x [map [0]];
+
+      if (spd && i < j) /* diagonal block with sticking out upper triangle */
       {
-        COPY (rowblk, A); /* copy values */
-	A += 3;
+	for (t = j % 3; t < 3; t ++, y ++) (*y) += A [t];
       }
+      else { ACC (A, y); } /* accumulate values */
     }
   }
+}
+
+/* compute tangent stiffness; the symbolic structure is computed once per mesh */
+static MX* tangent_stiffness (BODY *bod, short spd)
+{
+  double K [576];
+  ELEMENT *ele;
+  MESH *msh;
+  MX *tang;
+  int dofs;
+
+  if (spd) spd = 1;
+  msh = FEM_MESH (bod);
+  dofs = MESH_DOFS (msh);
+
+  if (!msh->tdata || msh->tdata [0] != spd) tangent_pattern (msh, spd);
+
+  tang = MX_Create (MXCSC, dofs, dofs, TDATA_P (msh), TDATA_I (msh)); /* create tangent matrix structure */
+  if (spd) tang->flags |= MXSPD;
 
-  free (ii);
-  free (pp);
-  free (col);
 #if OMP
-  for (i = 0; i < threads; i ++)
+  int ei, en, *moff;
+  ELEMENT **pele = ompu_elements (msh, &en);
+  omp_lock_t *locks = ompu_locks (msh->nodes_count);
+  ERRMEM (moff = malloc (sizeof (int [en])));
+  for (moff [0] = 0, ei = 1; ei < en; ei ++) moff [ei] = moff [ei-1] + TDATA_BLOCKS (pele [ei-1]);
+  #pragma omp parallel for shared (bod, spd, msh, pele, locks, moff, tang) private (ele, K)
+  for (ei = 0; ei < en; ei ++)
   {
-    MEM_Release (&mapmem[i]);
-    MEM_Release (&blkmem[i]);
+    int k, *map = TDATA_MAP (msh) + moff [ei];
+
+    ele = pele[ei];
+
+    element_internal_force (1, bod, msh, ele, K); /* compute internal force derivartive: K */
+
+    for (k = 0; k < ele->type; k ++) /* columns of node k */
+    {
+      omp_set_lock (&locks[ele->nodes[k]]);
+      tangent_scatter (ele, k, spd, K, map, tang->x);
+      omp_unset_lock (&locks[ele->nodes[k]]);
+    }
   }
-  free (mapmem);
-  free (blkmem);
+  ompu_locks_free (locks, msh->nodes_count);
+  free (moff);
+  free (pele);
 #else
-  MEM_Release (&mapmem);
-  MEM_Release (&blkmem);
+  int k, *map = TDATA_MAP (msh);
+  short bulk;
+
+  for (ele = msh->surfeles, bulk = 0; ele;
+       ele = (ele->next ? ele->next : bulk ? NULL : msh->bulkeles),
+       bulk = (ele == msh->bulkeles ? 1 : bulk)) /* for each element in mesh */
+  {
+    element_internal_force (1, bod, msh, ele, K); /* compute internal force derivartive: K */
+
+    for (k = 0; k < ele->type; k ++) tangent_scatter (ele, k, spd, K, map, tang->x);
+
+    map += TDATA_BLOCKS (ele);
+  }
 #endif
 
   return tang;
@@ -1864,11 +2049,99 @@ static void TL_dynamic_force (BODY *bod, double time, double step, double *fext,
 /* the smame computation for the static case */
 #define TL_static_force(bod, time, step, fext, fint, force) TL_dynamic_force (bod,time,step,fext,fint,force)
 
+/* update the factorized inverse with a new tangent operator A, according to the refactorization policy */
+static void TL_refactor (BODY *bod, MX *A)
+{
+  MX *inv = bod->inverse;
+
+  if (bod->tangent) MX_Destroy (bod->tangent), bod->tangent = NULL;
+
+  if (bod->refactor != REF_FULL && inv && inv->kind == MXCSC && (inv->flags & MXIFAC) &&
+      inv->nzmax == A->nzmax && (inv->flags & MXSPD) == (A->flags & MXSPD)) /* the tangent pattern is cached and hence does not change */
+  {
+    if (bod->refactor == REF_KRYLOV && bod->refiters < REF_MAXITER / 2 && !bod->con) /* W = H inv (A) H' is built from 'inverse' */
+    {
+      bod->tangent = A; /* lag the factorization behind the tangent */
+      return;
+    }
+
+    MX_Refactor (A, inv);
+    MX_Destroy (A);
+  }
+  else
+  {
+    if (inv) MX_Destroy (inv);
+
+    bod->inverse = MX_Inverse (A, A);
+  }
+
+  bod->refiters = 0;
+}
+
+/* compute c = alpha * inv (A) * b + beta * c, where A is the current tangent operator; when the factorization lags
+ * behind the tangent, preconditioned conjugate gradient iterations are used, and the factorization is numerically
+ * refreshed if they fail to converge within REF_MAXITER iterations; the factorization is only lagged for bodies
+ * without constraints, while constraint reactions are always mapped by 'inverse', consistently with W = H inv (A) H' */
+static void TL_invvec (double alpha, BODY *bod, double *b, double beta, double *c)
+{
+  MX *A = bod->tangent,
+     *P = bod->inverse;
+
+  if (!A)
+  {
+    MX_Matvec (alpha, P, b, beta, c);
+    return;
+  }
+
+  int n = bod->dofs, k;
+  double *x, *r, *z, *p, *w, rz, rznew, eps;
+
+  ERRMEM (x = MEM_CALLOC (sizeof (double [5*n]))); /* zeroed, since factorized matvecs scale the output by beta */
+  r = x + n;
+  z = r + n;
+  p = z + n;
+  w = p + n;
+
+  eps = REF_TOL * sqrt (blas_ddot (n, b, 1, b, 1));
+  MX_Matvec (1.0, P, b, 0.0, x); /* x = inv (A_old) b */
+  blas_dcopy (n, b, 1, r, 1);
+  MX_Matvec (-1.0, A, x, 1.0, r); /* r = b - A x */
+  MX_Matvec (1.0, P, r, 0.0, z);
+  blas_dcopy (n, z, 1, p, 1);
+  rz = blas_ddot (n, r, 1, z, 1);
+
+  for (k = 0; k < REF_MAXITER && sqrt (blas_ddot (n, r, 1, r, 1)) > eps; k ++)
+  {
+    MX_Matvec (1.0, A, p, 0.0, w);
+    double a = rz / blas_ddot (n, p, 1, w, 1);
+    blas_daxpy (n, a, p, 1, x, 1);
+    blas_daxpy (n, -a, w, 1, r, 1);
+    MX_Matvec (1.0, P, r, 0.0, z);
+    rznew = blas_ddot (n, r, 1, z, 1);
+    for (int i = 0; i < n; i ++) p [i] = z [i] + (rznew / rz) * p [i];
+    rz = rznew;
+  }
+
+  if (!(sqrt (blas_ddot (n, r, 1, r, 1)) <= eps)) /* slow convergence or breakdown => refactorize numerically and solve directly */
+  {
+    MX_Refactor (A, P);
+    MX_Destroy (A);
+    bod->tangent = NULL;
+    bod->refiters = 0;
+    memset (x, 0, sizeof (double [n]));
+    MX_Matvec (1.0, P, b, 0.0, x);
+  }
+  else bod->refiters = MAX (bod->refiters, k);
+
+  if (beta == 0.0) for (int i = 0; i < n; i ++) c [i] = alpha * x [i];
+  else for (int i = 0; i < n; i ++) c [i] = alpha * x [i] + beta * c [i];
+
+  free (x);
+}
+
 /* compute inverse operator for the implicit dynamic time stepping */
 static void TL_dynamic_inverse (BODY *bod, double step, double *force)
 {
-  if (bod->inverse) MX_Destroy (bod->inverse);
-
   if (bod->K) MX_Destroy (bod->K);
 
   bod->K = tangent_stiffness (bod, 1);
@@ -1882,11 +2155,8 @@ static void TL_dynamic_inverse (BODY *bod, double step, double *force)
     MX_Matvec (-0.25 * step, bod->K, bod->velo, 1.0, force);
   }
 
-  /* calculate tangent operator A = M + (damping*h/2 + h*h/4) K */
-  bod->inverse = MX_Add (1.0, bod->M, 0.5*bod->damping*step + 0.25*step*step, bod->K, NULL);
-
-  /* invert A */
-  MX_Inverse (bod->inverse, bod->inverse);
+  /* calculate tangent operator A = M + (damping*h/2 + h*h/4) K and invert it */
+  TL_refactor (bod, MX_Add (1.0, bod->M, 0.5*bod->damping*step + 0.25*step*step, bod->K, NULL));
 }
 
 /* static time-stepping inverse */
@@ -1896,13 +2166,9 @@ static void TL_static_inverse (BODY *bod, double step)
 
   if (bod->M) M = bod->M; else bod->M = M = diagonal_inertia (bod, 1);
 
-  if (bod->inverse) MX_Destroy (bod->inverse);
-
   K = tangent_stiffness (bod, 1);
 
-  bod->inverse = MX_Add (1.0, M, step*step, K, NULL); /* TODO: figure out alpha and beta scaling */
-
-  MX_Inverse (bod->inverse, bod->inverse);
+  TL_refactor (bod, MX_Add (1.0, M, step*step, K, NULL)); /* TODO: figure out alpha and beta scaling */
 
   MX_Destroy (K);
 }
@@ -1910,6 +2176,13 @@ static void TL_static_inverse (BODY *bod, double step)
 /* total lagrangian initialise dynamic time stepping */
 static void TL_dynamic_init (BODY *bod)
 {
+  MESH *msh = FEM_MESH (bod);
+
+  if (!msh->idata) /* once, or after the referential mesh has changed */
+  {
+    create_element_integration_data (msh);
+  }
+
   if (!bod->M) /* once */
   {
     bod->M = diagonal_inertia (bod, bod->scheme != SCH_DEF_EXP);
@@ -2035,7 +2308,7 @@ static void TL_dynamic_step_begin (BODY *bod, double time, double step)
     TL_dynamic_force (bod, time+half, step, fext, fint, f);  /* f = fext (t+h/2) - fint (q(t+h/2)) */
     TL_dynamic_inverse (bod, step, NULL); /* A = M + (h*h/4) * K */
     if (bod->damping > 0.0) MX_Matvec (-bod->damping, bod->K, u, 1.0, f); /* f -= damping K u (t) */
-    MX_Matvec (step, bod->inverse, f, 1.0, u); /* u(t+h) = u(t) + inv (A) * h * f */
+    TL_invvec (step, bod, f, 1.0, u); /* u(t+h) = u(t) + inv (A) * h * f */
   }
   break;
   default:
@@ -2049,7 +2322,7 @@ static void TL_dynamic_step_begin (BODY *bod, double time, double step)
 static void TL_dynamic_step_end (BODY *bod, double time, double step)
 {
   int n = bod->dofs;
-  double half = 0.5 * step,
+  double half = 0.5 * SUBSTEP (bod, step),
 	*x = bod->inverse->x,
 	*fext = FEM_FEXT (bod),
 	*u = bod->velo,
@@ -2087,6 +2360,10 @@ static void TL_dynamic_step_end (BODY *bod, double time, double step)
 /* total lagrangian initialise static time stepping */
 static void TL_static_init (BODY *bod)
 {
+  MESH *msh = FEM_MESH (bod);
+
+  if (!msh->idata) create_element_integration_data (msh);
+
   if (!bod->M && !bod->K)
   {
     TL_static_inverse (bod, bod->dom->step);
@@ -2103,7 +2380,7 @@ static void TL_static_step_begin (BODY *bod, double time, double step)
   ERRMEM (f = malloc (sizeof (double [bod->dofs])));
   TL_static_inverse (bod, step); /* compute inverse of static tangent operator */
   TL_static_force (bod, time+step, step, FEM_FEXT(bod), FEM_FINT(bod), f);  /* f(t+h) = fext (t+h) - fint (q(t+h)) */
-  MX_Matvec (step, bod->inverse, f, 0.0, bod->velo); /* u(t+h) = inv (A) * h * f(t+h) */
+  TL_invvec (step, bod, f, 0.0, bod->velo); /* u(t+h) = inv (A) * h * f(t+h) */
   free (f);
 }
 
@@ -2133,19 +2410,15 @@ static void BC_surface_integral (BODY *bod, MESH *msh, double *conf, int num, do
 
 #if OMP
   int integral_size = 3 * num;
-  double *local_integral;
-  int threads;
+  int threads = ompu_threads ();
   int k, m;
-  #pragma omp parallel
-  #pragma omp master
-  threads = omp_get_num_threads();
   FACE **pfac = ompu_faces (msh, &m);
-  ERRMEM (local_integral = MEM_CALLOC (threads * sizeof (double [integral_size])));
+  double *local_integral = ompu_buffers (threads, integral_size);
   #pragma omp parallel
   {
   double *integral = &local_integral[omp_get_thread_num() * integral_size];
   double *e = integral + integral_size;
-  #pragma omp for private (q,refn,curn,B,C,N,shapes,Y,fac,i,j)
+  #pragma omp for schedule (static) private (q,refn,curn,B,C,N,shapes,Y,fac,i,j)
   for (k = 0; k < m; k ++)
 #else
   for (fac = msh->faces; fac; fac = fac->n)
@@ -2178,11 +2451,7 @@ static void BC_surface_integral (BODY *bod, MESH *msh, double *conf, int num, do
   }
 #if OMP
   }
-  double *li = local_integral;
-  for (int i = 0; i < threads; i ++)
-    for (j = 0; j < integral_size; j ++, li ++)
-      integral [j] += *li;
-  free (local_integral);
+  ompu_buffers_reduce (local_integral, threads, integral_size, integral);
   free (pfac);
 #endif
 }
@@ -2242,31 +2511,34 @@ static void BC_update_rotation (BODY *bod, MESH *msh, double *q, double *R)
 /* fint = R K R' [(I-R)Z + q] */
 static void BC_internal_force (BODY *bod, double *R, double *q, double *fint)
 {
-  double *a, *b, *x, *y, *z, *d, (*Z) [3], (*e) [3], Y [3];
+  double *a, *b, (*Z) [3], Y [3];
   MESH *msh = FEM_MESH (bod);
   MX *K = bod->K;
-  int n = K->n;
+  int i, n = K->n;
 
   ERRMEM (a = MEM_CALLOC (2 * sizeof (double [n])));
   b = a + n;
+  Z = msh->ref_nodes;
 
-  for (Z = msh->ref_nodes, e = Z + msh->nodes_count, d = b; Z < e; Z ++, d += 3, q += 3)
-  {
-    NVMUL (R, Z[0], Y);
-    SUB (Z[0], Y, Y);
-    ADD (Y, q, d); /* d = (I-R)Z + q */
-  }
-
-  for (x = b, y = b + n, z = a; x < y; x += 3, z += 3)
+#if OMP
+  #pragma omp parallel for private (Y)
+#endif
+  for (i = 0; i < n; i += 3)
   {
-    TVMUL (R, x, z); /* a = R' [(I-R)Z + q] */
+    NVMUL (R, Z[i/3], Y);
+    SUB (Z[i/3], Y, Y);
+    ACC (&q[i], Y); /* Y = (I-R)Z + q */
+    TVMUL (R, Y, &a[i]); /* a = R' [(I-R)Z + q] */
   }
 
   MX_Matvec (1.0, K, a, 0.0, b); /* b = K a */
 
-  for (x = b, y = b + n, z = fint; x < y; x += 3, z += 3)
+#if OMP
+  #pragma omp parallel for
+#endif
+  for (i = 0; i < n; i += 3)
   {
-    NVMUL (R, x, z); /* fint = R b  */
+    NVMUL (R, &b[i], &fint[i]); /* fint = R b  */
   }
 
   free (a);
@@ -2275,25 +2547,25 @@ static void BC_internal_force (BODY *bod, double *R, double *q, double *fint)
 /* energy = 0.5 * [(I-R)Z + q] R K R' [(I-R)Z + q] */
 static double BC_internal_energy (BODY *bod)
 {
-  double *a, *b, *x, *y, *d, *z, (*Z) [3], (*e) [3], Y [3], intene;
+  double *a, *b, (*Z) [3], Y [3], intene;
   double *R = FEM_ROT (bod), *q = bod->conf;
   MESH *msh = FEM_MESH (bod);
   MX *K = bod->K;
-  int n = K->n;
+  int i, n = K->n;
 
   ERRMEM (a = MEM_CALLOC (2 * sizeof (double [n])));
   b = a + n;
+  Z = msh->ref_nodes;
 
-  for (Z = msh->ref_nodes, e = Z + msh->nodes_count, d = b; Z < e; Z ++, d += 3, q += 3)
-  {
-    NVMUL (R, Z[0], Y);
-    SUB (Z[0], Y, Y);
-    ADD (Y, q, d); /* d = (I-R)Z + q */
-  }
-
-  for (x = b, y = b + n, z = a; x < y; x += 3, z += 3)
+#if OMP
+  #pragma omp parallel for private (Y)
+#endif
+  for (i = 0; i < n; i += 3)
   {
-    TVMUL (R, x, z); /* a = R' [(I-R)Z + q] */
+    NVMUL (R, Z[i/3], Y);
+    SUB (Z[i/3], Y, Y);
+    ACC (&q[i], Y); /* Y = (I-R)Z + q */
+    TVMUL (R, Y, &a[i]); /* a = R' [(I-R)Z + q] */
   }
 
   MX_Matvec (1.0, K, a, 0.0, b); /* b = K a */
@@ -2308,23 +2580,30 @@ static double BC_internal_energy (BODY *bod)
 /* compute u = alpha * R A R' b + beta * u  */
 static void BC_matvec (double alpha, MX *A, double *R, double *b, double beta, double *u)
 {
-  double *x, *y, *z;
-  int n = A->n;
+  double *x, *y;
+  int i, n = A->n;
 
   ERRMEM (x = MEM_CALLOC (2 * sizeof (double [n])));
+  y = x + n;
 
-  for (y = x, z = x + n; y < z; y += 3, b += 3)
+#if OMP
+  #pragma omp parallel for
+#endif
+  for (i = 0; i < n; i += 3)
   {
-    TVMUL (R, b, y);
+    TVMUL (R, &b[i], &x[i]);
   }
 
   MX_Matvec (alpha, A, x, 0.0, y);
 
   if (beta != 1.0) blas_dscal (n, beta, u, 1);
 
-  for (z = y + n; y < z; y += 3, u += 3)
+#if OMP
+  #pragma omp parallel for
+#endif
+  for (i = 0; i < n; i += 3)
   {
-    NVADDMUL (u, R, y, u);
+    NVADDMUL (&u[i], R, &y[i], &u[i]);
   }
 
   free (x);
@@ -2434,7 +2713,7 @@ static void BC_dynamic_step_end (BODY *bod, double time, double step)
 {
   int n = bod->dofs;
   MESH *msh = FEM_MESH (bod);
-  double half = 0.5 * step,
+  double half = 0.5 * SUBSTEP (bod, step),
 	*fext = FEM_FEXT (bod),
 	*R = FEM_ROT (bod),
 	*q = bod->conf,
@@ -2471,6 +2750,36 @@ static void BC_dynamic_step_end (BODY *bod, double time, double step)
   free (r);
 }
 
+/* perform a complete explicit substep under the predicted constraint force (subcycling) */
+static void free_substep (BODY *bod, double time, double step, double *r)
+{
+  int n = bod->dofs;
+  double half = 0.5 * step,
+	*energy = bod->energy,
+	*fext = FEM_FEXT (bod),
+	*u0 = FEM_VEL0 (bod),
+	*u = bod->velo,
+	*q = bod->conf;
+
+  switch (bod->form)
+  {
+    case TOTAL_LAGRANGIAN:
+      TL_dynamic_step_begin (bod, time, step);
+      break;
+    case BODY_COROTATIONAL:
+      BC_dynamic_step_begin (bod, time, step);
+      break;
+    default:
+      return;
+  }
+
+  MX_Matvec (step, bod->inverse, r, 1.0, u); /* u(t+h) += inv (M) * h * r */
+  blas_daxpy (n, half, u, 1, q, 1); /* q (t+h) = q(t+h/2) + (h/2) * u(t+h) */
+  if (bod->form == BODY_COROTATIONAL) BC_update_rotation (bod, FEM_MESH (bod), q, FEM_ROT (bod)); /* R(t+h) = R(q(t+h)) */
+
+  for (int i = 0; i < n; i ++) energy [EXTERNAL] += half * (u0[i] + u[i]) * (fext[i] + r[i]); /* dq = (h/2) * {u(t) + u(t+h)} */
+}
+
 /* body co-rotational initialise static time stepping */
 static void BC_static_init (BODY *bod)
 {
@@ -2540,41 +2849,55 @@ static void BC_static_step_end (BODY *bod, double time, double step)
 /* x = R x */
 static void RO_rotate_forward (double *R, double *x, int n)
 {
-  double *y = x + n, z [3];
+  double z [3];
+  int i;
 
-  for (;x < y; x += 3)
+#if OMP
+  #pragma omp parallel for private (z)
+#endif
+  for (i = 0; i < n; i += 3)
   {
-    COPY (x, z);
-    NVMUL (R, z, x);
+    COPY (&x[i], z);
+    NVMUL (R, z, &x[i]);
   }
 }
 
 /* x = R' x */
 static void RO_rotate_backward (double *R, double *x, int n)
 {
-  double *y = x + n, z [3];
+  double z [3];
+  int i;
 
-  for (;x < y; x += 3)
+#if OMP
+  #pragma omp parallel for private (z)
+#endif
+  for (i = 0; i < n; i += 3)
   {
-    COPY (x, z);
-    TVMUL (R, z, x);
+    COPY (&x[i], z);
+    TVMUL (R, z, &x[i]);
   }
 }
 
 /* qm = REq - (I-R)Z */
 static void RO_lift_conf (BODY *bod, MX *E, MESH *msh, double *R, double *q, double *qm)
 {
-  double (*Z) [3], Y [3], *x, *y;
+  double (*Z) [3] = msh->ref_nodes, Y [3], *x;
+  int i;
 
   MX_Matvec (1.0, E, q, 0.0, qm); /* d0 = E q */
 
-  for (x = qm, y = qm+E->m, Z = msh->ref_nodes; x < y; x += 3, Z ++)
+#if OMP
+  #pragma omp parallel for private (Y, x)
+#endif
+  for (i = 0; i < E->m; i += 3)
   {
+    x = &qm[i];
+
     COPY (x, Y);
     NVMUL (R, Y, x); /* d = R d0 */
 
-    NVMUL (R, Z[0], Y);
-    SUB (Z[0], Y, Y);
+    NVMUL (R, Z[i/3], Y);
+    SUB (Z[i/3], Y, Y);
     SCC (Y, x); /* qm = d - (I-R)Z */
   }
 
@@ -2586,14 +2909,21 @@ static void RO_lift_conf (BODY *bod, MX *E, MESH *msh, double *R, double *q, dou
 /* q = project_onto_E_in_the_M_norm (d = R'[(I-R)Z+qm]) */
 static void RO_project_conf (BODY *bod, MX *E, MESH *msh, double *tmp, double *R, double *qm, double *q)
 {
-  double (*Z) [3], Y [3], *x, *y, *z;
+  double (*Z) [3] = msh->ref_nodes, Y [3], *x, *z, *mass = FEM_MESH_MASS (bod);
+  int i;
 
   blas_dcopy (E->m, qm, 1, tmp, 1);
 
-  for (x = tmp, y = tmp+E->m, Z = msh->ref_nodes, z = FEM_MESH_MASS (bod); x < y; x += 3, z += 3, Z ++)
+#if OMP
+  #pragma omp parallel for private (Y, x, z)
+#endif
+  for (i = 0; i < E->m; i += 3)
   {
-    NVMUL (R, Z[0], Y);
-    SUB (Z[0], Y, Y);
+    x = &tmp[i];
+    z = &mass[i];
+
+    NVMUL (R, Z[i/3], Y);
+    SUB (Z[i/3], Y, Y);
     ACC (Y, x); /* d = (I-R)Z + qm */
 
     COPY (x, Y);
@@ -2611,12 +2941,19 @@ static void RO_project_conf (BODY *bod, MX *E, MESH *msh, double *tmp, double *R
 /* u = E'M R' um */
 static void RO_project_velo (BODY *bod, MX *E, double *tmp, double *R, double *um, double *u)
 {
-  double Y [3], *x, *y, *z;
+  double Y [3], *x, *z, *mass = FEM_MESH_MASS (bod);
+  int i;
 
   blas_dcopy (E->m, um, 1, tmp, 1);
 
-  for (x = tmp, y = tmp+E->m, z = FEM_MESH_MASS (bod); x < y; x += 3, z += 3)
+#if OMP
+  #pragma omp parallel for private (Y, x, z)
+#endif
+  for (i = 0; i < E->m; i += 3)
   {
+    x = &tmp[i];
+    z = &mass[i];
+
     COPY (x, Y);
     TVMUL (R, Y, x); /* R' um */
 
@@ -2667,6 +3004,48 @@ static void RO_initialize_velocity (BODY *bod)
   }
 }
 
+/* create the reduced base projection table: rows of bod->evec at the nodes of surface elements are
+ * stored in consecutive 3 x modes blocks, so that contact operators can be gathered from a few blocks */
+static void RO_projection_table (BODY *bod)
+{
+  MESH *msh = FEM_MESH (bod);
+  MX *E = bod->evec;
+  int n = msh->nodes_count,
+      m = E->n, i, j, k;
+  ELEMENT *ele;
+  double *x;
+
+  ERRMEM (bod->etab = malloc (sizeof (double [3*m*n]) + sizeof (int [n]))); /* at most all nodes; trimmed below */
+  bod->emap = (int*) (bod->etab + 3*m*n);
+
+  for (i = 0; i < n; i ++) bod->emap [i] = -1;
+
+  for (ele = msh->surfeles, k = 0; ele; ele = ele->next)
+  {
+    for (i = 0; i < ele->type; i ++)
+    {
+      if (bod->emap [ele->nodes [i]] < 0) bod->emap [ele->nodes [i]] = k ++;
+    }
+  }
+
+  if (k < n) /* move the map and shrink */
+  {
+    memmove (bod->etab + 3*m*k, bod->emap, sizeof (int [n]));
+    ERRMEM (bod->etab = realloc (bod->etab, sizeof (double [3*m*k]) + sizeof (int [n])));
+    bod->emap = (int*) (bod->etab + 3*m*k);
+  }
+
+  for (i = 0; i < n; i ++)
+  {
+    if ((k = bod->emap [i]) < 0) continue;
+
+    for (j = 0, x = &bod->etab [3*m*k]; j < m; j ++, x += 3)
+    {
+      COPY (&E->x [E->m*j + 3*i], x);
+    }
+  }
+}
+
 /* reduced order initialise dynamic time stepping */
 static void RO_dynamic_init (BODY *bod)
 {
@@ -2732,6 +3111,8 @@ static void RO_dynamic_init (BODY *bod)
     /* initialize reduced velocity */
     if (time == 0.0) RO_initialize_velocity (bod);
   }
+
+  if (!bod->etab) RO_projection_table (bod); /* once, or after the reduced base has changed */
 }
 
 /* reduced order estimate critical step for the dynamic scheme */
@@ -3372,17 +3753,40 @@ double FEM_Dynamic_Critical_Step (BODY *bod)
 /* perform the initial half-step of the dynamic scheme */
 void FEM_Dynamic_Step_Begin (BODY *bod, double time, double step)
 {
+  double h = SUBSTEP (bod, step);
+
+  if (bod->subcycles > 1) /* explicit subcycling => complete substeps come first */
+  {
+    int n = bod->dofs;
+    double *energy = bod->energy,
+	   *u = bod->velo,
+	   *r, *v;
+
+    ERRMEM (r = malloc (sizeof (double [2*n])));
+    v = r + n;
+
+    fem_constraints_force (bod, r); /* predict constraint force using reactions from the previous step */
+
+    for (int i = 1; i < bod->subcycles; i ++, time += h) free_substep (bod, time, h, r);
+
+    blas_dcopy (n, u, 1, v, 1);
+    MX_Matvec (h - step, bod->inverse, r, 1.0, u); /* withdraw the predicted impulse so that the end velocity only includes the current reactions */
+    for (int i = 0; i < n; i ++) energy [EXTERNAL] += 0.5 * (h - step) * (v[i] + u[i]) * r[i];
+
+    free (r);
+  }
+
   switch (bod->form)
   {
     case TOTAL_LAGRANGIAN:
-      TL_dynamic_step_begin (bod, time, step);
+      TL_dynamic_step_begin (bod, time, h);
       break;
     case BODY_COROTATIONAL:
-      BC_dynamic_step_begin (bod, time, step);
+      BC_dynamic_step_begin (bod, time, h);
       break;
     case BODY_COROTATIONAL_MODAL:
     case BODY_COROTATIONAL_REDUCED_ORDER:
-      RO_dynamic_step_begin (bod, time, step);
+      RO_dynamic_step_begin (bod, time, h);
       break;
   }
 
@@ -3400,10 +3804,19 @@ void FEM_Dynamic_Step_End (BODY *bod, double time, double step)
 	*ue = u + n,
 	*iu0 = u0,
 	*iu = u,
-	*dq, *idq;
+	*uf = NULL,
+	*dq, *idq, *ff;
 
   ERRMEM (idq = dq = malloc (sizeof (double [n])));
 
+  if (bod->subcycles > 1) /* keep the free velocity and force of the last substep */
+  {
+    ERRMEM (uf = malloc (sizeof (double [2*n])));
+    ff = uf + n;
+    blas_dcopy (n, u, 1, uf, 1); /* u(t+H) without the reaction impulse */
+    blas_dcopy (n, fext, 1, ff, 1); /* fext (t+H-h/2) */
+  }
+
   switch (bod->form)
   {
     case TOTAL_LAGRANGIAN:
@@ -3418,8 +3831,20 @@ void FEM_Dynamic_Step_End (BODY *bod, double time, double step)
       break;
   }
 
-  for (; iu < ue; idq ++, iu ++, iu0 ++) *idq = half * ((*iu) + (*iu0)); /* dq = (h/2) * {u(t) + u(t+h)} */
-  energy [EXTERNAL] += blas_ddot (n, dq, 1, fext, 1); /* XXX: may not be too good for the reduced order model (save q0 and copute dq = q1-q0) */
+  if (uf) /* work of fext over the last substep and of the reaction impulse over the whole step */
+  {
+    double h = SUBSTEP (bod, step);
+
+    for (int i = 0; i < n; i ++) energy [EXTERNAL] += 0.5 * h * (u0[i] + uf[i]) * ff[i] + half * (uf[i] + u[i]) * (fext[i] - ff[i]);
+
+    free (uf);
+  }
+  else
+  {
+    for (; iu < ue; idq ++, iu ++, iu0 ++) *idq = half * ((*iu) + (*iu0)); /* dq = (h/2) * {u(t) + u(t+h)} */
+    energy [EXTERNAL] += blas_ddot (n, dq, 1, fext, 1); /* XXX: may not be too good for the reduced order model (save q0 and copute dq = q1-q0) */
+  }
+
   if (bod->form == BODY_COROTATIONAL_MODAL)
   {
     energy [INTERNAL] = 0.0;
@@ -3698,8 +4123,38 @@ MX* FEM_Gen_To_Loc_Operator (BODY *bod, SHAPE *shp, void *gobj, double *X, doubl
     body_space = (ns->locdyn == LOCDYN_OFF);
   }
 
-  TNCOPY (base, base_trans.x);
   referential_to_local (msh, ele, X, point);
+
+  if (bod->form >= BODY_COROTATIONAL_MODAL) /* H = E' N R * bod->evec = E' R * SUM_k {shape_k * evec rows at node_k} */
+  {
+    double shapes [MAX_NODES], *R = FEM_ROT (bod), T [9], *x, *y, *z;
+    int j, k, l, m = bod->evec->n, n = element_shapes (ele->type, point, shapes);
+
+    H = MX_Create (MXDENSE, 3, m, NULL, NULL);
+
+    for (k = 0; k < n; k ++)
+    {
+      if (bod->emap && (l = bod->emap [ele->nodes [k]]) >= 0) /* gather a table block */
+      {
+	for (x = H->x, z = x + 3*m, y = &bod->etab [3*m*l]; x < z; x ++, y ++) (*x) += shapes [k] * (*y);
+      }
+      else /* gather strided evec rows */
+      {
+	for (j = 0, x = H->x, y = &bod->evec->x [3*ele->nodes [k]]; j < m; j ++, x += 3, y += bod->evec->m) { ADDMUL (x, shapes [k], y, x); }
+      }
+    }
+
+    TNMUL (base, R, T); /* T = E' R */
+    for (x = H->x, z = x + 3*m; x < z; x += 3)
+    {
+      double v [3] = {x[0], x[1], x[2]};
+      NVMUL (T, v, x);
+    }
+
+    return H;
+  }
+
+  TNCOPY (base, base_trans.x);
   N = element_shapes_matrix (bod, msh, ele, point);
   H = MX_Matmat (1.0, &base_trans, N, 0.0, NULL);
   MX_Destroy (N);
@@ -3707,7 +4162,7 @@ MX* FEM_Gen_To_Loc_Operator (BODY *bod, SHAPE *shp, void *gobj, double *X, doubl
   if ((bod->form == BODY_COROTATIONAL && bod->scheme != SCH_DEF_EXP && body_space == 0)  /* XXX => NEWTON_SOLVER sees the regular H = E' N ,
 											    rather than H R when using the body-space mode,
 											    since FEM_Invvec already incorportes R */
-      || bod->form >= BODY_COROTATIONAL_MODAL) /* in this case H = E' N R * bod->evec, hence it is a projection of pulled-back E' N onto the reduced base */
+     )
   {
     double *x = H->x, *y = x + H->nzmax, *R = FEM_ROT (bod), T [9];
 
@@ -3718,13 +4173,6 @@ MX* FEM_Gen_To_Loc_Operator (BODY *bod, SHAPE *shp, void *gobj, double *X, doubl
       NNMUL (x, R, T);
       NNCOPY (T, x); /* H = E' N R <=> rotaions gets shifted to H */
     }
-
-    if (bod->form >= BODY_COROTATIONAL_MODAL)
-    {
-      N = H; /* tentative */
-      H = MX_Matmat (1.0, H, bod->evec, 0.0, NULL); /* H = E' N R * bod->evec */
-      MX_Destroy (N);
-    }
   }
 
   return H;
@@ -4112,6 +4560,8 @@ void FEM_Destroy (BODY *bod)
 {
   free (bod->conf);
   if (bod->field) free (bod->field);
+  if (bod->etab) free (bod->etab);
+  if (bod->threadbuf) free (bod->threadbuf);
 }
 
 /* get configuration write/read size */
@@ -4126,7 +4576,6 @@ int FEM_Conf_Size (BODY *bod)
   }
 }
 
-#if MPI
 /* get configuration packing size */
 int FEM_Conf_Pack_Size (BODY *bod)
 {
@@ -4153,7 +4602,6 @@ int FEM_Velo_Pack_Size (BODY *bod)
   default: return 4 * bod->dofs; /* velo, vel0, fext, fint */
   }
 }
-#endif
 
 /* compute c = alpha * INVERSE (bod) * b + beta * c */
 void FEM_Invvec (double alpha, BODY *bod, double *b, double beta, double *c)
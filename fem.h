@@ -115,13 +115,11 @@ void FEM_Destroy (BODY *bod);
 /* get configuration write/read size */
 int FEM_Conf_Size (BODY *bod);
 
-#if MPI
 /* get configuration packing size */
 int FEM_Conf_Pack_Size (BODY *bod);
 
 /* get velocity packing size */
 int FEM_Velo_Pack_Size (BODY *bod);
-#endif
 
 /* compute c = alpha * INVERSE (bod) * b + beta * c */
 void FEM_Invvec (double alpha, BODY *bod, double *b, double beta, double *c);
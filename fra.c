@@ -109,10 +109,10 @@ static void fracture_state_write (DOM *dom)
       free (disp);
       numbod ++;
     }
-
-    PBF_Int2 (f, "numbod", &numbod, 1);
   }
 
+  PBF_Int2 (f, "numbod", &numbod, 1);
+
   PBF_Close (f);
 #else
   FILE *f;
@@ -371,6 +371,12 @@ void Fracture_Check (DOM *dom)
   }
 #endif
 
+#if PBF_COLLECTIVE
+  short all;
+  MPI_Allreduce (&on, &all, 1, MPI_SHORT, MPI_MAX, MPI_COMM_WORLD); /* the fracture file is written collectively */
+  on = all;
+#endif
+
   if (on) fracture_state_write (dom);
 }
 
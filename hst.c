@@ -0,0 +1,659 @@
+/*
+ * hst.c
+ * Copyright (C) 2006, Tomasz Koziara (t.koziara AT gmail.com)
+ * --------------------------------------------------------------
+ * columnar time history side store
+ */
+
+/* This file is part of Solfec.
+ * Solfec is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Solfec is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
+
+#if POSIX
+#define _XOPEN_SOURCE 500 /* fseeko, ftello */
+#define _LARGEFILE64_SOURCE /* fseeko64, ftello64 */
+#endif
+
+#if MPI
+#include <mpi.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <rpc/types.h>
+#include <rpc/xdr.h>
+#include "hst.h"
+#include "alg.h"
+#include "err.h"
+
+#ifndef FSEEK /* HDF5 build */
+  #define FSEEK fseeko
+  #define FTELL ftello
+  #define OFF_T off_t
+#endif
+
+#if __APPLE__ && !defined(xdr_uint64_t)
+  #define xdr_uint64_t xdr_u_int64_t
+#endif
+
+/*
+ * The store is a sequence of chunks, each holding a number of output frames.
+ * Body states are stored as per-body column blocks, so that a time history
+ * query reads only the blocks of the requested bodies. Chunk layout:
+ *
+ *  [T] (int) {number of frames}
+ *  [NEXT] (uint64_t) {offset of the next chunk}
+ *  [TIME_0] ... [TIME_T-1] (double)
+ *  [COFF] (uint64_t) {offset of the constraints block}
+ *  [NBOD] (int)
+ *  [ID] (u_int) [NCONF] [NDOFS] [NENER] (int) [BOFF] (uint64_t) {directory entry, NBOD times, increasing ID}
+ *  [CONF] (double, T x NCONF) [VELO] (double, T x NDOFS) [ENERGY] (double, T x NENER) {column block, NBOD times}
+ *  [NCON_0] ... [NCON_T-1] (int) [RECORDS] (double, HST_CONREC x sum NCON_i) {constraints block}
+ *
+ * Rows of column blocks at frames where a body is absent are filled with NAN.
+ */
+
+#define HEAD(T) (24 + 8 * (uint64_t) (T)) /* chunk header size */
+#define ENTRY 24 /* directory entry size */
+
+/* buffered columns of a body (WRITE) */
+typedef struct hst_column HST_COLUMN;
+
+struct hst_column
+{
+  int nconf, ndofs, nener;
+
+  double *conf, *velo, *energy;
+};
+
+/* make encoding buffer of at least 'size' bytes */
+static void memgrow (HST *hs, uint64_t size)
+{
+  ASSERT_TEXT (size < UINT_MAX, "History chunk exceeds 4GB: use fewer OUTPUT columns per chunk");
+
+  if (size > hs->memsize)
+  {
+    free (hs->mem);
+    hs->memsize = size;
+    ERRMEM (hs->mem = malloc (hs->memsize));
+  }
+}
+
+/* read 'size' bytes at 'offset' into encoding buffer and create decoding stream */
+static int readat (HST *hs, uint64_t offset, uint64_t size, XDR *x)
+{
+  memgrow (hs, size);
+
+  if (FSEEK (hs->file, (OFF_T) offset, SEEK_SET) != 0 ||
+      fread (hs->mem, 1, size, hs->file) != size) return 0;
+
+  xdrmem_create (x, hs->mem, size, XDR_DECODE);
+
+  return 1;
+}
+
+/* code doubles */
+static int doubles (XDR *x, double *v, int n)
+{
+  for (; n > 0; n --, v ++)
+  {
+    if (!xdr_double (x, v)) return 0;
+  }
+
+  return 1;
+}
+
+/* code ints */
+static int ints (XDR *x, int *v, int n)
+{
+  for (; n > 0; n --, v ++)
+  {
+    if (!xdr_int (x, v)) return 0;
+  }
+
+  return 1;
+}
+
+/* create body columns for 'chunk' frames */
+static HST_COLUMN* column_create (int chunk, int nconf, int ndofs, int nener)
+{
+  HST_COLUMN *col;
+  int i, n;
+
+  n = chunk * (nconf + ndofs + nener);
+  ERRMEM (col = malloc (sizeof (HST_COLUMN)));
+  ERRMEM (col->conf = malloc (sizeof (double [MAX (n, 1)])));
+  col->velo = col->conf + chunk * nconf;
+  col->energy = col->velo + chunk * ndofs;
+  col->nconf = nconf;
+  col->ndofs = ndofs;
+  col->nener = nener;
+
+  for (i = 0; i < n; i ++) col->conf [i] = NAN; /* absent body */
+
+  return col;
+}
+
+/* output buffered chunk */
+static void flush_chunk (HST *hs)
+{
+  uint64_t start, boff, coff, next;
+  int T, nbod, ok;
+  HST_COLUMN *col;
+  unsigned int id;
+  MAP *item;
+  XDR x;
+
+  if ((T = hs->frames) == 0) return;
+
+  nbod = MAP_Size (hs->columns);
+  start = (uint64_t) FTELL (hs->file);
+  coff = boff = start + HEAD (T) + ENTRY * (uint64_t) nbod;
+
+  for (item = MAP_First (hs->columns); item; item = MAP_Next (item))
+  {
+    col = item->data;
+    coff += 8 * (uint64_t) T * (col->nconf + col->ndofs + col->nener);
+  }
+
+  next = coff + 4 * (uint64_t) T + 8 * (uint64_t) HST_CONREC * hs->csize;
+
+  memgrow (hs, next - start);
+  xdrmem_create (&x, hs->mem, hs->memsize, XDR_ENCODE);
+
+  ok = xdr_int (&x, &T) &&
+       xdr_uint64_t (&x, &next) &&
+       doubles (&x, hs->times, T) &&
+       xdr_uint64_t (&x, &coff) &&
+       xdr_int (&x, &nbod);
+
+  for (item = MAP_First (hs->columns); item; item = MAP_Next (item))
+  {
+    col = item->data;
+    id = (unsigned int) (long) item->key;
+
+    ok = ok && xdr_u_int (&x, &id) &&
+	 xdr_int (&x, &col->nconf) &&
+	 xdr_int (&x, &col->ndofs) &&
+	 xdr_int (&x, &col->nener) &&
+	 xdr_uint64_t (&x, &boff);
+
+    boff += 8 * (uint64_t) T * (col->nconf + col->ndofs + col->nener);
+  }
+
+  for (item = MAP_First (hs->columns); item; item = MAP_Next (item))
+  {
+    col = item->data;
+
+    ok = ok && doubles (&x, col->conf, T * col->nconf) &&
+	 doubles (&x, col->velo, T * col->ndofs) &&
+	 doubles (&x, col->energy, T * col->nener);
+
+    free (col->conf);
+    free (col);
+  }
+
+  ok = ok && ints (&x, hs->ncon, T) &&
+       doubles (&x, hs->crec, HST_CONREC * hs->csize);
+
+  xdr_destroy (&x);
+
+  ASSERT (ok && fwrite (hs->mem, 1, next - start, hs->file) == next - start, ERR_FILE_WRITE);
+
+  MAP_Free (&hs->mappool, &hs->columns);
+  hs->frames = 0;
+  hs->csize = 0;
+}
+
+/* scan chunks of an opened store */
+static int initialise_reading (HST *hs)
+{
+  uint64_t offset, length, next;
+  HST_CHUNK *c;
+  int T, ok, cap;
+  XDR x;
+
+  FSEEK (hs->file, 0, SEEK_END);
+  length = (uint64_t) FTELL (hs->file);
+
+  for (offset = cap = 0; offset + HEAD (0) <= length; offset = next)
+  {
+    if (!readat (hs, offset, 12, &x)) return 0;
+    ok = xdr_int (&x, &T) && xdr_uint64_t (&x, &next);
+    xdr_destroy (&x);
+
+    if (!ok || T <= 0 || next > length || next < offset + HEAD (T)) break; /* incomplete last chunk */
+
+    if (hs->nchunks == cap)
+    {
+      cap = 2 * cap + 16;
+      ERRMEM (hs->ctab = realloc (hs->ctab, sizeof (HST_CHUNK [cap])));
+    }
+    ERRMEM (hs->times = realloc (hs->times, sizeof (double [hs->frames + T])));
+
+    c = &hs->ctab [hs->nchunks];
+    if (!readat (hs, offset + 12, HEAD (T) - 12, &x)) return 0;
+    ok = doubles (&x, &hs->times [hs->frames], T) &&
+	 xdr_uint64_t (&x, &c->coff) &&
+	 xdr_int (&x, &c->nbod);
+    xdr_destroy (&x);
+
+    if (!ok) break;
+
+    c->offset = offset;
+    c->doff = offset + HEAD (T);
+    c->first = hs->frames;
+    c->length = T;
+    hs->frames += T;
+    hs->nchunks ++;
+  }
+
+  return hs->frames > 0;
+}
+
+/* find chunk of a frame */
+static HST_CHUNK* chunk_of (HST *hs, int frame)
+{
+  int l = 0, h = hs->nchunks - 1, m;
+
+  while (l < h)
+  {
+    m = (l + h + 1) / 2;
+    if (frame < hs->ctab [m].first) h = m - 1;
+    else l = m;
+  }
+
+  return &hs->ctab [l];
+}
+
+/* find directory entry of body 'id' within chunk 'c' */
+static int find_entry (HST *hs, HST_CHUNK *c, unsigned int id, int *sizes, uint64_t *boff)
+{
+  int l = 0, h = c->nbod - 1, m, ok;
+  unsigned int mid;
+  XDR x;
+
+  while (l <= h)
+  {
+    m = (l + h) / 2;
+    ASSERT (readat (hs, c->doff + ENTRY * (uint64_t) m, ENTRY, &x), ERR_FILE_READ);
+    ok = xdr_u_int (&x, &mid) && ints (&x, sizes, 3) && xdr_uint64_t (&x, boff);
+    xdr_destroy (&x);
+    ASSERT (ok, ERR_FILE_FORMAT);
+
+    if (id == mid) return 1;
+    else if (id < mid) h = m - 1;
+    else l = m + 1;
+  }
+
+  return 0;
+}
+
+/* decode 'n' selected rows of a T x m column block at 'offset' of chunk 'c';
+ * rows of absent bodies are skipped so that other files can fill them in */
+static void rows (HST *hs, HST_CHUNK *c, uint64_t offset, int m, int *frames, int n, double *out)
+{
+  int i, f0 = frames [0] - c->first;
+  double v;
+  XDR x;
+
+  if (m == 0) return;
+
+  ASSERT (readat (hs, offset + 8 * (uint64_t) m * f0, 8 * (uint64_t) m * (frames [n-1] - frames [0] + 1), &x), ERR_FILE_READ);
+
+  for (i = 0; i < n; i ++, out += m)
+  {
+    xdr_setpos (&x, 8 * m * (frames [i] - c->first - f0));
+    ASSERT (xdr_double (&x, &v), ERR_FILE_FORMAT);
+    if (isnan (v)) continue;
+    out [0] = v;
+    ASSERT (doubles (&x, out + 1, m - 1), ERR_FILE_FORMAT);
+  }
+
+  xdr_destroy (&x);
+}
+
+/* add 'index' column values of a T x m block at 'offset' of chunk 'c' to 'sums' at 'n' selected rows */
+static void sums (HST *hs, HST_CHUNK *c, uint64_t offset, int m, int index, int *frames, int n, double *out)
+{
+  int i, f0 = frames [0] - c->first;
+  double v;
+  XDR x;
+
+  ASSERT (readat (hs, offset + 8 * (uint64_t) m * f0, 8 * (uint64_t) m * (frames [n-1] - frames [0] + 1), &x), ERR_FILE_READ);
+
+  for (i = 0; i < n; i ++)
+  {
+    xdr_setpos (&x, 8 * (m * (frames [i] - c->first - f0) + index));
+    ASSERT (xdr_double (&x, &v), ERR_FILE_FORMAT);
+    if (!isnan (v)) out [i] += v;
+  }
+
+  xdr_destroy (&x);
+}
+
+/* number of selected frames, starting from frames [i], that fall into chunk 'c' */
+static int span (HST_CHUNK *c, int *frames, int i, int n)
+{
+  int j;
+
+  for (j = i + 1; j < n && frames [j] < c->first + c->length; j ++);
+
+  return j - i;
+}
+
+HST* HST_Write (const char *path, int chunk, int append)
+{
+  char *txt;
+  HST *hs;
+
+  ERRMEM (txt = malloc (strlen (path) + 16));
+#if MPI
+  int rank;
+  MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+  sprintf (txt, "%s.hst.%d", path, rank);
+#else
+  sprintf (txt, "%s.hst", path);
+#endif
+
+  ERRMEM (hs = MEM_CALLOC (sizeof (HST)));
+  if (!(hs->file = fopen (txt, append ? "a" : "w")))
+  {
+    free (hs);
+    free (txt);
+    return NULL;
+  }
+  free (txt);
+
+  if (append) FSEEK (hs->file, 0, SEEK_END);
+
+  hs->mode = PBF_WRITE;
+  hs->chunk = MAX (chunk, 1);
+  ERRMEM (hs->times = malloc (sizeof (double [hs->chunk])));
+  ERRMEM (hs->ncon = malloc (sizeof (int [hs->chunk])));
+  MEM_Init (&hs->mappool, sizeof (MAP), 128);
+  hs->cchunk = -1;
+
+  return hs;
+}
+
+HST* HST_Read (const char *path)
+{
+  HST *hs, *out;
+  FILE *file;
+  char *txt;
+  int n, m;
+
+  ERRMEM (txt = malloc (strlen (path) + 16));
+
+  /* count input files */
+  m = 0;
+  do
+  {
+    sprintf (txt, "%s.hst.%d", path, m);
+    file = fopen (txt, "r");
+  } while (file && fclose (file) == 0 && ++ m); /* m incremented as last */
+
+  /* open input files */
+  out = NULL;
+  n = m-1;
+  do
+  {
+    if (m) sprintf (txt, "%s.hst.%d", path, n);
+    else sprintf (txt, "%s.hst", path);
+    if (!(file = fopen (txt, "r"))) goto failure;
+
+    ERRMEM (hs = MEM_CALLOC (sizeof (HST)));
+    hs->mode = PBF_READ;
+    hs->file = file;
+    hs->cchunk = -1;
+    hs->next = out;
+    out = hs;
+
+    if (!initialise_reading (hs)) goto failure;
+
+    if (hs->next && (hs->next->frames != hs->frames || /* all ranks store the same frames */
+	memcmp (hs->next->times, hs->times, sizeof (double [hs->frames])))) goto failure;
+
+  } while (-- n >= 0); /* the first item in the returned list corresponds to rank 0 */
+
+  free (txt);
+  return out;
+
+failure:
+  HST_Close (out);
+  free (txt);
+  return NULL;
+}
+
+void HST_Append (HST *hs, DOM *dom)
+{
+  int k = hs->frames, nconf, nener, n;
+  HST_COLUMN *col;
+  double *rec;
+  BODY *bod;
+  CON *con;
+
+  hs->times [k] = dom->time;
+
+  for (bod = dom->bod; bod; bod = bod->next)
+  {
+    nconf = BODY_Conf_Size (bod);
+    nener = BODY_ENERGY_SIZE (bod->kind);
+
+    if (!(col = MAP_Find (hs->columns, (void*) (long) bod->id, NULL)))
+    {
+      col = column_create (hs->chunk, nconf, bod->dofs, nener);
+      MAP_Insert (&hs->mappool, &hs->columns, (void*) (long) bod->id, col, NULL);
+    }
+
+    memcpy (&col->conf [k * nconf], bod->conf, sizeof (double [nconf]));
+    memcpy (&col->velo [k * bod->dofs], bod->velo, sizeof (double [bod->dofs]));
+    memcpy (&col->energy [k * nener], bod->energy, sizeof (double [nener]));
+  }
+
+  for (n = 0, con = dom->con; con; con = con->next, n ++)
+  {
+    if (hs->csize == hs->ccap)
+    {
+      hs->ccap = 2 * hs->ccap + 256;
+      ERRMEM (hs->crec = realloc (hs->crec, sizeof (double [HST_CONREC * hs->ccap])));
+    }
+
+    rec = &hs->crec [HST_CONREC * hs->csize ++];
+
+    rec [HST_KIND] = con->kind;
+    rec [HST_MASTER] = con->master->id;
+    rec [HST_SLAVE] = con->slave ? con->slave->id : 0;
+    if (con->kind == CONTACT)
+    {
+      rec [HST_SPAIR] = con->spair [0];
+      rec [HST_SPAIR+1] = con->spair [1];
+      rec [HST_GAP] = con->gap;
+    }
+    else rec [HST_SPAIR] = rec [HST_SPAIR+1] = rec [HST_GAP] = 0.0;
+    NNCOPY (con->base, &rec [HST_BASE]);
+    COPY (con->R, &rec [HST_R]);
+    COPY (con->U, &rec [HST_U]);
+  }
+
+  hs->ncon [k] = n;
+
+  if (++ hs->frames == hs->chunk) flush_chunk (hs);
+}
+
+int HST_Frame (HST *hs, double t)
+{
+  int l = 0, h = hs->frames - 1, m;
+
+  while (l <= h)
+  {
+    m = (l + h) / 2;
+    if (t == hs->times [m]) return m;
+    else if (t < hs->times [m]) h = m - 1;
+    else l = m + 1;
+  }
+
+  return -1;
+}
+
+void HST_Body (HST *hs, unsigned int id, int *frames, int n, int nconf, int ndofs, int nener, double *conf, double *velo, double *energy)
+{
+  int i, j, k, sizes [3];
+  HST_CHUNK *c;
+  uint64_t boff;
+
+  for (i = 0; i < n; i ++)
+  {
+    if (conf) for (k = 0; k < nconf; k ++) conf [i*nconf + k] = NAN;
+    if (velo) for (k = 0; k < ndofs; k ++) velo [i*ndofs + k] = NAN;
+    if (energy) for (k = 0; k < nener; k ++) energy [i*nener + k] = NAN;
+  }
+
+  for (; hs; hs = hs->next)
+  {
+    for (i = 0; i < n; i += j)
+    {
+      c = chunk_of (hs, frames [i]);
+      j = span (c, frames, i, n);
+
+      if (!find_entry (hs, c, id, sizes, &boff) ||
+	  sizes [0] != nconf || sizes [1] != ndofs || sizes [2] != nener) continue;
+
+      if (conf) rows (hs, c, boff, nconf, frames + i, j, conf + i*nconf);
+      boff += 8 * (uint64_t) c->length * nconf;
+      if (velo) rows (hs, c, boff, ndofs, frames + i, j, velo + i*ndofs);
+      boff += 8 * (uint64_t) c->length * ndofs;
+      if (energy) rows (hs, c, boff, nener, frames + i, j, energy + i*nener);
+    }
+  }
+}
+
+void HST_Energy (HST *hs, SET *ids, int index, int *frames, int n, double *out)
+{
+  int i, j, k, ok, *sizes;
+  unsigned int *id;
+  uint64_t *boff;
+  HST_CHUNK *c;
+  XDR x;
+
+  for (i = 0; i < n; i ++) out [i] = 0.0;
+
+  for (; hs; hs = hs->next)
+  {
+    for (i = 0; i < n; i += j)
+    {
+      c = chunk_of (hs, frames [i]);
+      j = span (c, frames, i, n);
+
+      ERRMEM (id = malloc (sizeof (unsigned int [c->nbod + 1])));
+      ERRMEM (sizes = malloc (sizeof (int [3 * c->nbod + 1])));
+      ERRMEM (boff = malloc (sizeof (uint64_t [c->nbod + 1])));
+
+      ASSERT (readat (hs, c->doff, ENTRY * (uint64_t) c->nbod, &x), ERR_FILE_READ);
+      for (k = ok = 1; k <= c->nbod && ok; k ++)
+      {
+	ok = xdr_u_int (&x, &id [k-1]) && ints (&x, &sizes [3*(k-1)], 3) && xdr_uint64_t (&x, &boff [k-1]);
+      }
+      xdr_destroy (&x);
+      ASSERT (ok, ERR_FILE_FORMAT);
+
+      for (k = 0; k < c->nbod; k ++)
+      {
+	if (ids && !SET_Contains (ids, (void*) (long) id [k], NULL)) continue;
+
+	if (index < sizes [3*k+2])
+	{
+	  sums (hs, c, boff [k] + 8 * (uint64_t) c->length * (sizes [3*k] + sizes [3*k+1]),
+		sizes [3*k+2], index, frames + i, j, out + i);
+	}
+      }
+
+      free (id);
+      free (sizes);
+      free (boff);
+    }
+  }
+}
+
+double* HST_Constraints (HST *hs, int frame, int *ncon)
+{
+  HST_CHUNK *c = chunk_of (hs, frame);
+  int i, total, ok;
+  XDR x;
+
+  if (c - hs->ctab != hs->cchunk)
+  {
+    ERRMEM (hs->ncon = realloc (hs->ncon, sizeof (int [c->length])));
+    ERRMEM (hs->cfirst = realloc (hs->cfirst, sizeof (int [c->length])));
+
+    ASSERT (readat (hs, c->coff, 4 * (uint64_t) c->length, &x), ERR_FILE_READ);
+    ok = ints (&x, hs->ncon, c->length);
+    xdr_destroy (&x);
+    ASSERT (ok, ERR_FILE_FORMAT);
+
+    for (i = total = 0; i < c->length; i ++)
+    {
+      hs->cfirst [i] = total;
+      total += hs->ncon [i];
+    }
+
+    if (total > hs->ccap)
+    {
+      hs->ccap = total;
+      free (hs->crec);
+      ERRMEM (hs->crec = malloc (sizeof (double [HST_CONREC * hs->ccap])));
+    }
+
+    if (total)
+    {
+      ASSERT (readat (hs, c->coff + 4 * (uint64_t) c->length, 8 * (uint64_t) HST_CONREC * total, &x), ERR_FILE_READ);
+      ok = doubles (&x, hs->crec, HST_CONREC * total);
+      xdr_destroy (&x);
+      ASSERT (ok, ERR_FILE_FORMAT);
+    }
+
+    hs->cchunk = c - hs->ctab;
+  }
+
+  *ncon = hs->ncon [frame - c->first];
+
+  return &hs->crec [HST_CONREC * hs->cfirst [frame - c->first]];
+}
+
+void HST_Close (HST *hs)
+{
+  HST *next;
+
+  for (; hs; hs = next)
+  {
+    next = hs->next;
+
+    if (hs->mode == PBF_WRITE)
+    {
+      flush_chunk (hs);
+      MEM_Release (&hs->mappool);
+    }
+
+    fclose (hs->file);
+    free (hs->mem);
+    free (hs->times);
+    free (hs->crec);
+    free (hs->ncon);
+    free (hs->cfirst);
+    free (hs->ctab);
+    free (hs);
+  }
+}
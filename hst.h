@@ -0,0 +1,116 @@
+/*
+ * hst.h
+ * Copyright (C) 2006, Tomasz Koziara (t.koziara AT gmail.com)
+ * --------------------------------------------------------------
+ * columnar time history side store
+ */
+
+/* This file is part of Solfec.
+ * Solfec is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Solfec is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef __hst__
+#define __hst__
+
+#include <stdint.h>
+#include <stdio.h>
+#include "dom.h"
+
+/* constraint record layout */
+#define HST_KIND   0 /* constraint kind */
+#define HST_MASTER 1 /* master body id */
+#define HST_SLAVE  2 /* slave body id or zero */
+#define HST_SPAIR  3 /* surface pair (2 values) */
+#define HST_GAP    5 /* contact gap */
+#define HST_BASE   6 /* local base (9 values) */
+#define HST_R      15 /* reaction (3 values) */
+#define HST_U      18 /* relative velocity (3 values) */
+#define HST_CONREC 21 /* record size */
+
+typedef struct hst_chunk HST_CHUNK;
+
+typedef struct hst HST;
+
+/* chunk of frames (READ) */
+struct hst_chunk
+{
+  uint64_t offset, /* chunk offset */
+	   doff, /* body directory offset */
+	   coff; /* constraints block offset */
+
+  int first, /* first frame */
+      length, /* number of frames */
+      nbod; /* number of stored bodies */
+};
+
+/* store file */
+struct hst
+{
+  PBF_ACC mode; /* access mode */
+
+  FILE *file; /* store file */
+
+  char *mem; /* encoding buffer */
+
+  unsigned int memsize; /* encoding buffer size */
+
+  double *times; /* chunk times (WRITE) or all frame times (READ) */
+
+  int frames, /* number of frames in current chunk (WRITE) or in total (READ) */
+      chunk; /* frames per chunk (WRITE) */
+
+  MEM mappool; /* map items pool (WRITE) */
+
+  MAP *columns; /* body id to buffered columns map (WRITE) */
+
+  double *crec; /* constraint records of current (WRITE) or cached (READ) chunk */
+
+  int *ncon, /* per frame constraint counts of current or cached chunk */
+      *cfirst, /* per frame first constraint record (READ) */
+      csize, /* number of constraint records */
+      ccap, /* records capacity */
+      cchunk; /* cached chunk (READ) */
+
+  HST_CHUNK *ctab; /* chunks table (READ) */
+
+  int nchunks; /* number of chunks (READ) */
+
+  HST *next; /* next file in case of parallel output (READ) */
+};
+
+/* open store for writing or appending; 'chunk' frames are buffered before output */
+HST* HST_Write (const char *path, int chunk, int append);
+
+/* open store for reading; NULL if files are missing or inconsistent */
+HST* HST_Read (const char *path);
+
+/* append current domain state (WRITE) */
+void HST_Append (HST *hs, DOM *dom);
+
+/* return number of the frame at time 't' or -1 if not found (READ) */
+int HST_Frame (HST *hs, double t);
+
+/* read columns of body 'id' at 'n' frames into 'conf', 'velo' and 'energy' rows
+ * (any of these can be NULL); rows of absent or size mismatched bodies are NAN (READ) */
+void HST_Body (HST *hs, unsigned int id, int *frames, int n, int nconf, int ndofs, int nener, double *conf, double *velo, double *energy);
+
+/* sum 'index' energies of bodies within 'ids' set (or all if NULL) at 'n' frames into 'sums' (READ) */
+void HST_Energy (HST *hs, SET *ids, int index, int *frames, int n, double *sums);
+
+/* return constraint records of a single file at 'frame' and output their number in 'ncon' (READ) */
+double* HST_Constraints (HST *hs, int frame, int *ncon);
+
+/* flush and close store */
+void HST_Close (HST *hs);
+
+#endif
@@ -0,0 +1,60 @@
+# finite element element-loop scaling benchmark;
+# run with OPENMP=yes in Config.mak as, e.g.:
+# for n in 1 2 4 8; do OMP_NUM_THREADS=$n solfec inp/devel/fem-omp-scaling.py; done
+import os
+import time
+
+n = 12 # elements along the block width
+l = 4 # length to width ratio
+steps = 20 # number of time steps per formulation
+modes = 12 # modal base size for the BC-MODAL formulation
+
+nodes = [0, 0, 0,
+         1, 0, 0,
+         1, 1, 0,
+         0, 1, 0,
+         0, 0, 1,
+         1, 0, 1,
+         1, 1, 1,
+         0, 1, 1]
+
+def block_mesh ():
+  msh = HEX (nodes, l*n, n, n, 0, [1, 1, 1, 1, 1, 2])
+  SCALE (msh, (l*0.1, 0.1, 0.1))
+  return msh
+
+def run (form, scheme):
+  path = 'out/fem-omp-scaling/' + form + '-' + scheme
+  solfec = SOLFEC ('DYNAMIC', 1E-3, path)
+  solfec.verbose = 'OFF'
+  SURFACE_MATERIAL (solfec, model = 'SIGNORINI_COULOMB', friction = 0.3)
+  bulk = BULK_MATERIAL (solfec, model = 'KIRCHHOFF', young = 1E9, poisson = 0.25, density = 1E3)
+  GRAVITY (solfec, (0, 0, -9.81))
+
+  base = HEX (nodes, 1, 1, 1, 0, [3, 3, 3, 3, 3, 3])
+  SCALE (base, (l*0.2, 0.2, 0.05))
+  TRANSLATE (base, (-l*0.05, -0.05, -0.05))
+  BODY (solfec, 'OBSTACLE', base, bulk)
+
+  if form == 'BC-MODAL':
+    bod = BODY (solfec, 'FINITE_ELEMENT', block_mesh (), bulk)
+    data = MODAL_ANALYSIS (bod, modes, path + '/modal')
+    DELETE (solfec, bod)
+    bod = BODY (solfec, 'FINITE_ELEMENT', block_mesh (), bulk, form = form, base = data)
+  else:
+    bod = BODY (solfec, 'FINITE_ELEMENT', block_mesh (), bulk, form = form)
+    bod.scheme = scheme
+
+  PRESSURE (bod, 2, -1E3)
+  OUTPUT (solfec, 1E3) # exclude output from timings
+  gs = GAUSS_SEIDEL_SOLVER (1E-4, 100)
+
+  RUN (solfec, gs, solfec.step) # the first step sets up the body and the critical step
+  t0 = time.time ()
+  for i in range (steps): RUN (solfec, gs, solfec.step)
+  return (time.time () - t0) / steps
+
+if not VIEWER():
+  threads = os.environ.get ('OMP_NUM_THREADS', 'default')
+  for (form, scheme) in [('TL', 'DEF_EXP'), ('TL', 'DEF_LIM'), ('BC', 'DEF_EXP'), ('BC', 'DEF_LIM'), ('BC-MODAL', 'DEF_LIM')]:
+    print 'THREADS: %s, FORMULATION: %s, SCHEME: %s, time per step: %.3e s' % (threads, form, scheme, run (form, scheme))
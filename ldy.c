@@ -35,6 +35,11 @@
 #include "put.h"
 #endif
 
+#if OMP
+#include <omp.h>
+#include "ompu.h"
+#endif
+
 /* memory block size */
 #define BLKSIZE 128
 
@@ -623,208 +628,380 @@ void LOCDYN_Remove (LOCDYN *ldy, DIAB *dia)
   MEM_Free (&ldy->diamem, dia);
 }
 
-void LOCDYN_Update_Begin (LOCDYN *ldy)
+/* test whether a diagonal block is adjacent to a non-contact constraint */
+static int noncontact_adjacent (DIAB *dia)
 {
-  DOM *dom = ldy->dom;
-  UPKIND upkind = update_kind (dom->solfec);
-  double step = dom->step;
-  OFFB *blk, *blj;
-  DIAB *dia;
+  OFFB *blk;
 
-#if MPI
-  if (dom->rank == 0)
+  for (blk = dia->adj; blk; blk = blk->n)
+  {
+    if (blk->dia->con->kind != CONTACT) return 1;
+  }
+
+  return 0;
+}
+
+/* test whether a DEM contact does not use W: it is not coupled with
+ * non-contact constraints and its dashpot is not critical damping */
+static int dem_without_W (DIAB *dia)
+{
+  CON *con = dia->con;
+
+  return con->kind == CONTACT && con->mat.base->dashpot >= 0.0 && !noncontact_adjacent (dia);
+}
+
+#if !MPI
+/* pending product of a factorized sparse inverse */
+typedef struct { BODY *bod; MX *H; MX **prod; } INVPROD;
+
+typedef int (*qcmp) (const void*, const void*);
+
+/* order pending products by bodies */
+static int invprodcmp (INVPROD *a, INVPROD *b)
+{
+  if (a->bod->id < b->bod->id) return -1;
+  else if (a->bod->id > b->bod->id) return 1;
+  else return 0;
+}
 #endif
-  if (dom->verbose) printf ("LOCDYN ... "), fflush (stdout);
 
-  SOLFEC_Timer_Start (ldy->dom->solfec, "LOCDYN");
+/* calculate constraint operators H of a diagonal block; this only reads
+ * body data and can run concurrently for different blocks */
+static void constraint_operators (DIAB *dia, short dem)
+{
+  CON *con = dia->con;
+  BODY *m = con->master,
+       *s = con->slave;
+  SGP *msgp = con->msgp,
+      *ssgp = con->ssgp;
+  double *mpnt = con->mpnt,
+	 *spnt = con->spnt,
+	 *base = con->base;
+
+  if (dem && dem_without_W (dia)) return;
+
+  if (m != s)
+  {
+    dia->mH = BODY_Gen_To_Loc_Operator (m, con->kind, msgp, mpnt, base);
 
-  /* update previous and free velocites */
-  update_V_and_B (dom);
+    if (s)
+    {
+      dia->sH = BODY_Gen_To_Loc_Operator (s, con->kind, ssgp, spnt, base);
+      MX_Scale (dia->sH, -1.0);
+    }
+  }
+  else /* eg. self-contact */
+  {
+    MX *mH = BODY_Gen_To_Loc_Operator (m, con->kind, msgp, mpnt, base),
+       *sH = BODY_Gen_To_Loc_Operator (s, con->kind, ssgp, spnt, base);
 
-  if (upkind == UPMIN) goto end; /* skip update */
+    dia->mH = MX_Add (1.0, mH, -1.0, sH, NULL);
+    dia->sH = MX_Copy (dia->mH, NULL);
 
-#if MPI
-  compute_adjext (ldy, upkind);
+    MX_Destroy (mH);
+    MX_Destroy (sH);
+  }
+}
+
+/* calculate constraint operators H and their products with the body inverses;
+ * in the shared memory case the products with factorized sparse inverses are
+ * gathered per body and computed as multiple right hand side solves; the H
+ * operators are computed by all threads while the products, which may share
+ * the work space of a body inverse, are computed by the calling thread */
+static void operators (LOCDYN *ldy, short dem)
+{
+  DIAB *dia;
+#if !MPI
+  INVPROD *inv;
+  int i, j, n;
 #endif
 
-  ldy->free_energy = 0.0;
+#if OMP
+  {
+    int j, n;
+    DIAB **pdia = ompu_blocks (ldy, &n);
+    #pragma omp parallel for shared (pdia)
+    for (j = 0; j < n; j ++)
+    {
+      constraint_operators (pdia [j], dem);
+    }
+    free (pdia);
+  }
+#else
+  for (dia = ldy->dia; dia; dia = dia->n) constraint_operators (dia, dem);
+#endif
+
+#if !MPI
+  for (n = 0, dia = ldy->dia; dia; dia = dia->n) n += 2;
+  ERRMEM (inv = malloc (sizeof (INVPROD [n+1])));
+  n = 0;
+#endif
 
-  /* calculate local velocities and assmeble
-   * the diagonal force-velocity 'W' operator */
   for (dia = ldy->dia; dia; dia = dia->n)
   {
     CON *con = dia->con;
     BODY *m = con->master,
 	 *s = con->slave;
-    SGP *msgp = con->msgp,
-	*ssgp = con->ssgp;
-    double *mpnt = con->mpnt,
-	   *spnt = con->spnt,
-	   *base = con->base,
-	   *B = dia->B,
-           X [3], Y [9];
-    MX_DENSE_PTR (W, 3, 3, dia->W);
-    MX_DENSE_PTR (A, 3, 3, dia->A);
-    MX_DENSE (C, 3, 3);
-
-    /* diagonal block */
-    if (m != s)
-    {
-      dia->mH = BODY_Gen_To_Loc_Operator (m, con->kind, msgp, mpnt, base);
+
+    if (!dia->mH) continue; /* skipped DEM contact */
+
 #if MPI
-      dia->mprod = MX_Matmat (1.0, dia->mH, m->inverse, 0.0, NULL);
-      MX_Matmat (1.0, dia->mprod, MX_Tran (dia->mH), 0.0, &W); /* H * inv (M) * H^T */
+    dia->mprod = MX_Matmat (1.0, dia->mH, m->inverse, 0.0, NULL);
+    if (m == s) dia->sprod = MX_Copy (dia->mprod, NULL);
+    else if (s) dia->sprod = MX_Matmat (1.0, dia->sH, s->inverse, 0.0, NULL);
 #else
-      dia->mprod = MX_Matmat (1.0, m->inverse, MX_Tran (dia->mH), 0.0, NULL);
-      MX_Matmat (1.0, dia->mH, dia->mprod, 0.0, &W); /* H * inv (M) * H^T */
+    if (m->inverse->kind == MXCSC && (m->inverse->flags & MXIFAC)) inv [n].bod = m, inv [n].H = dia->mH, inv [n ++].prod = &dia->mprod;
+    else dia->mprod = MX_Matmat (1.0, m->inverse, MX_Tran (dia->mH), 0.0, NULL);
+
+    if (s && m != s)
+    {
+      if (s->inverse->kind == MXCSC && (s->inverse->flags & MXIFAC)) inv [n].bod = s, inv [n].H = dia->sH, inv [n ++].prod = &dia->sprod;
+      else dia->sprod = MX_Matmat (1.0, s->inverse, MX_Tran (dia->sH), 0.0, NULL);
+    }
 #endif
+  }
 
-      if (s)
-      {
-	dia->sH = BODY_Gen_To_Loc_Operator (s, con->kind, ssgp, spnt, base);
-	MX_Scale (dia->sH, -1.0);
+#if !MPI
+  qsort (inv, n, sizeof (INVPROD), (qcmp) invprodcmp);
+
+  for (i = 0; i < n; i = j) /* inv (M) * H' for all constraints of a body at once */
+  {
+    MX **b, **c;
+
+    for (j = i; j < n && inv [j].bod == inv [i].bod; j ++);
+    ERRMEM (b = malloc (sizeof (MX* [2*(j-i)])));
+    c = b + (j-i);
+    for (int k = i; k < j; k ++) b [k-i] = MX_Tran (inv [k].H);
+    MX_Invmats (inv [i].bod->inverse, j-i, b, c);
+    for (int k = i; k < j; k ++) *inv [k].prod = c [k-i];
+    free (b);
+  }
+
+  for (dia = ldy->dia; dia; dia = dia->n)
+  {
+    CON *con = dia->con;
+
+    if (con->master == con->slave && dia->mH) dia->sprod = MX_Copy (dia->mprod, NULL);
+  }
+
+  free (inv);
+#endif
+}
+
+/* assemble a diagonal block of W and return its free energy contribution DOT (AB, B) */
+static double diagonal_block (DIAB *dia, UPKIND upkind, double step, short dem)
+{
+  CON *con = dia->con;
+  BODY *m = con->master,
+       *s = con->slave;
+  double *B = dia->B,
+	 X [3], Y [9],
+	 energy;
+  MX_DENSE_PTR (W, 3, 3, dia->W);
+  MX_DENSE_PTR (A, 3, 3, dia->A);
+  MX_DENSE (C, 3, 3);
+
+  if (dem && dem_without_W (dia)) return 0.0;
+
+  /* diagonal block */
 #if MPI
-	dia->sprod = MX_Matmat (1.0, dia->sH, s->inverse, 0.0, NULL);
-	MX_Matmat (1.0, dia->sprod, MX_Tran (dia->sH), 0.0, &C); /* H * inv (M) * H^T */
+  MX_Matmat (1.0, dia->mprod, MX_Tran (dia->mH), 0.0, &W); /* H * inv (M) * H^T */
 #else
-	dia->sprod = MX_Matmat (1.0, s->inverse, MX_Tran (dia->sH), 0.0, NULL);
-	MX_Matmat (1.0, dia->sH, dia->sprod, 0.0, &C); /* H * inv (M) * H^T */
+  MX_Matmat (1.0, dia->mH, dia->mprod, 0.0, &W); /* H * inv (M) * H^T */
 #endif
-	NNADD (W.x, C.x, W.x);
-      }
-    }
-    else /* eg. self-contact */
-    {
-      MX *mH = BODY_Gen_To_Loc_Operator (m, con->kind, msgp, mpnt, base),
-	 *sH = BODY_Gen_To_Loc_Operator (s, con->kind, ssgp, spnt, base);
 
-      dia->mH = MX_Add (1.0, mH, -1.0, sH, NULL);
-      dia->sH = MX_Copy (dia->mH, NULL);
-
-      MX_Destroy (mH);
-      MX_Destroy (sH);
+  if (s && m != s)
+  {
 #if MPI
-      dia->mprod = MX_Matmat (1.0, dia->mH, m->inverse, 0.0, NULL);
-      dia->sprod = MX_Copy (dia->mprod, NULL);
-      MX_Matmat (1.0, dia->mprod, MX_Tran (dia->mH), 0.0, &W); /* H * inv (M) * H^T */
+    MX_Matmat (1.0, dia->sprod, MX_Tran (dia->sH), 0.0, &C); /* H * inv (M) * H^T */
 #else
-      dia->mprod = MX_Matmat (1.0, m->inverse, MX_Tran (dia->mH), 0.0, NULL);
-      dia->sprod = MX_Copy (dia->mprod, NULL);
-      MX_Matmat (1.0, dia->mH, dia->mprod, 0.0, &W); /* H * inv (M) * H^T */
+    MX_Matmat (1.0, dia->sH, dia->sprod, 0.0, &C); /* H * inv (M) * H^T */
 #endif
-    }
+    NNADD (W.x, C.x, W.x);
+  }
 
-    SCALE9 (W.x, step); /* W = h * ( ... ) */
+  SCALE9 (W.x, step); /* W = h * ( ... ) */
 
-    if (upkind != UPPES) /* diagonal regularization (not needed by the explicit solver) */
-    {
-      NNCOPY (W.x, C.x); /* calculate regularisation parameter */
-      ASSERT (lapack_dsyev ('N', 'U', 3, C.x, 3, X, Y, 9) == 0, ERR_LDY_EIGEN_DECOMP);
-      dia->rho = 1.0 / X [2]; /* inverse of maximal eigenvalue */
-    }
+  if (upkind != UPPES) /* diagonal regularization (not needed by the explicit solver) */
+  {
+    NNCOPY (W.x, C.x); /* calculate regularisation parameter */
+    ASSERT (lapack_dsyev ('N', 'U', 3, C.x, 3, X, Y, 9) == 0, ERR_LDY_EIGEN_DECOMP);
+    dia->rho = 1.0 / X [2]; /* inverse of maximal eigenvalue */
+  }
 
-    NNCOPY (W.x, A.x);
-    MX_Inverse (&A, &A); /* inverse of diagonal block */
+  NNCOPY (W.x, A.x);
+  MX_Inverse (&A, &A); /* inverse of diagonal block */
 
-    NVMUL (A.x, B, X);
-    ldy->free_energy += DOT (X, B); /* sum up free energy */
+  NVMUL (A.x, B, X);
+  energy = DOT (X, B); /* free energy */
 
-    /* add up prescribed velocity contribution */
-    if (con->kind == VELODIR) ldy->free_energy += A.x[8] * VELODIR(con->Z) * VELODIR(con->Z);
-  }
+  /* add up prescribed velocity contribution */
+  if (con->kind == VELODIR) energy += A.x[8] * VELODIR(con->Z) * VELODIR(con->Z);
 
-  ldy->free_energy *= 0.5; /* 0.5 * DOT (AB, B) */
+  return energy;
+}
 
-  for (dia = ldy->dia; dia; dia = dia->n) /* off-diagonal blocks update */
-  {
-    CON *con = dia->con;
-    BODY *m = con->master,
-	 *s = con->slave;
+/* assemble off-diagonal blocks of W stored at a diagonal block; the adjacent
+ * operators are only read, hence different blocks can be assembled concurrently */
+static void offdiagonal_blocks (DIAB *dia, UPKIND upkind, double step)
+{
+  CON *con = dia->con;
+  BODY *m = con->master,
+       *s = con->slave;
+  OFFB *blk;
 
-    if (upkind == UPPES && con->kind == CONTACT) continue; /* update only non-contact constraint blocks */
+  if (upkind == UPPES && con->kind == CONTACT) return; /* update only non-contact constraint blocks */
 
-    /* off-diagonal local blocks */
-    for (blk = dia->adj; blk; blk = blk->n)
-    {
-      if (upkind == UPALL && blk->dia < dia) continue; /* skip lower triangle */
+  /* off-diagonal local blocks */
+  for (blk = dia->adj; blk; blk = blk->n)
+  {
+    if (upkind == UPALL && blk->dia < dia) continue; /* skip lower triangle */
 
-      MX *left, *right;
-      DIAB *adj = blk->dia;
-      BODY *bod = blk->bod;
-      CON *con = adj->con;
-      MX_DENSE_PTR (W, 3, 3, blk->W);
+    MX *left, *right;
+    DIAB *adj = blk->dia;
+    BODY *bod = blk->bod;
+    CON *con = adj->con;
+    MX_DENSE_PTR (W, 3, 3, blk->W);
 
-      ASSERT_DEBUG (bod == m || bod == s, "Off diagonal block is not connected!");
+    ASSERT_DEBUG (bod == m || bod == s, "Off diagonal block is not connected!");
 
 #if MPI
-      left = (bod == m ? dia->mprod : dia->sprod);
+    left = (bod == m ? dia->mprod : dia->sprod);
 #else
-      left = (bod == m ? dia->mH : dia->sH);
+    left = (bod == m ? dia->mH : dia->sH);
 #endif
 
-      if (bod == con->master) /* master on the right */
-      {
+    if (bod == con->master) /* master on the right */
+    {
 #if MPI
-	right = adj->mH;
+      right = adj->mH;
 #else
-	right =  adj->mprod;
+      right =  adj->mprod;
 #endif
-      }
-      else /* blk->bod == con->slave (slave on the right) */
-      {
+    }
+    else /* blk->bod == con->slave (slave on the right) */
+    {
 #if MPI
-	right = adj->sH;
+      right = adj->sH;
 #else
-	right =  adj->sprod;
+      right =  adj->sprod;
 #endif
-      }
+    }
 
 #if MPI
-      MX_Matmat (1.0, left, MX_Tran (right), 0.0, &W);
+    MX_Matmat (1.0, left, MX_Tran (right), 0.0, &W);
 #else
-      MX_Matmat (1.0, left, right, 0.0, &W);
+    MX_Matmat (1.0, left, right, 0.0, &W);
 #endif
-      SCALE9 (W.x, step);
-    }
+    SCALE9 (W.x, step);
+  }
 
 #if MPI
-    /* off-diagonal external blocks */
-    for (blk = dia->adjext; blk; blk = blk->n)
-    {
-      MX *left, *right;
-      CON *ext = (CON*)blk->dia;
-      BODY *bod = blk->bod;
-      MX_DENSE_PTR (W, 3, 3, blk->W);
-
-      ASSERT_DEBUG (bod == m || bod == s, "Not connected external off-diagonal block");
+  /* off-diagonal external blocks */
+  for (blk = dia->adjext; blk; blk = blk->n)
+  {
+    MX *left, *right;
+    CON *ext = (CON*)blk->dia;
+    BODY *bod = blk->bod;
+    MX_DENSE_PTR (W, 3, 3, blk->W);
 
-      if (bod == ext->master)
-      {
-	right = BODY_Gen_To_Loc_Operator (bod, ext->kind, ext->msgp, ext->mpnt, ext->base);
+    ASSERT_DEBUG (bod == m || bod == s, "Not connected external off-diagonal block");
 
-	if (bod == ext->slave) /* right self-contact */
-	{
-	  MX *a = right,
-	     *b = BODY_Gen_To_Loc_Operator (bod, ext->kind, ext->ssgp, ext->spnt, ext->base);
+    if (bod == ext->master)
+    {
+      right = BODY_Gen_To_Loc_Operator (bod, ext->kind, ext->msgp, ext->mpnt, ext->base);
 
-	  right = MX_Add (1.0, a, -1.0, b, NULL);
-	  MX_Destroy (a);
-	}
-      }
-      else
+      if (bod == ext->slave) /* right self-contact */
       {
-	right = BODY_Gen_To_Loc_Operator (bod, ext->kind, ext->ssgp, ext->spnt, ext->base);
-	MX_Scale (right, -1.0);
-      }
-     
-      left = (bod == m ? dia->mprod : dia->sprod);
+	MX *a = right,
+	   *b = BODY_Gen_To_Loc_Operator (bod, ext->kind, ext->ssgp, ext->spnt, ext->base);
 
-      MX_Matmat (1.0, left, MX_Tran (right), 0.0, &W);
-      SCALE9 (W.x, step);
-      MX_Destroy (right);
+	right = MX_Add (1.0, a, -1.0, b, NULL);
+	MX_Destroy (a);
+      }
     }
+    else
+    {
+      right = BODY_Gen_To_Loc_Operator (bod, ext->kind, ext->ssgp, ext->spnt, ext->base);
+      MX_Scale (right, -1.0);
+    }
+   
+    left = (bod == m ? dia->mprod : dia->sprod);
+
+    MX_Matmat (1.0, left, MX_Tran (right), 0.0, &W);
+    SCALE9 (W.x, step);
+    MX_Destroy (right);
+  }
+#endif
+}
+
+void LOCDYN_Update_Begin (LOCDYN *ldy)
+{
+  DOM *dom = ldy->dom;
+  UPKIND upkind = update_kind (dom->solfec);
+  double step = dom->step;
+  OFFB *blk, *blj;
+  DIAB *dia;
+  short dem;
+
+#if MPI
+  if (dom->rank == 0)
+#endif
+  if (dom->verbose) printf ("LOCDYN ... "), fflush (stdout);
+
+  SOLFEC_Timer_Start (ldy->dom->solfec, "LOCDYN");
+
+  /* update previous and free velocites */
+  update_V_and_B (dom);
+
+  if (upkind == UPMIN) goto end; /* skip update */
+
+#if MPI
+  compute_adjext (ldy, upkind);
 #endif
+
+  ldy->free_energy = 0.0;
+
+  dem = (upkind == UPPES && ((PENALTY*)dom->solfec->solver)->dem);
+
+  /* calculate constraint operators
+   * and inverse inertia products */
+  operators (ldy, dem);
+
+  /* calculate local velocities and assmeble
+   * the diagonal force-velocity 'W' operator */
+#if OMP
+  {
+    int j, n;
+    DIAB **pdia = ompu_blocks (ldy, &n);
+    double *energy;
+
+    ERRMEM (energy = malloc (sizeof (double [n+1])));
+
+    #pragma omp parallel for shared (pdia, energy)
+    for (j = 0; j < n; j ++)
+    {
+      energy [j] = diagonal_block (pdia [j], upkind, step, dem);
+    }
+
+    for (j = 0; j < n; j ++) ldy->free_energy += energy [j]; /* summed in the block order so that the result does not depend on timing */
+
+    #pragma omp parallel for shared (pdia)
+    for (j = 0; j < n; j ++)
+    {
+      offdiagonal_blocks (pdia [j], upkind, step); /* each block writes only its own off-diagonal blocks */
+    }
+
+    free (energy);
+    free (pdia);
   }
+#else
+  for (dia = ldy->dia; dia; dia = dia->n) ldy->free_energy += diagonal_block (dia, upkind, step, dem);
+
+  for (dia = ldy->dia; dia; dia = dia->n) offdiagonal_blocks (dia, upkind, step); /* off-diagonal blocks update */
+#endif
+
+  ldy->free_energy *= 0.5; /* 0.5 * DOT (AB, B) */
 
   /* use symmetry */
   if (upkind == UPALL)
@@ -68,6 +68,8 @@ struct diab
      *sH, *sprod; /* slave counterpart */
                   /* NOTE: left product can be applied to adjext assembly (MPI)
 		           while right product is sligtly faster (serial code) */
+  int calm; /* number of consecutive sweeps with a small reaction change (bgs.c) */
+
   DIAB *p, *n;
 
   /* put parallel data at the end of the structutre so that
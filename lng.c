@@ -1898,6 +1898,27 @@ static int lng_SOLFEC_set_step (lng_SOLFEC *self, PyObject *value, void *closure
   return 0;
 }
 
+static PyObject* lng_SOLFEC_get_subcycling (lng_SOLFEC *self, void *closure)
+{
+  if (self->sol->dom->subcycling) return PyString_FromString ("ON");
+  else return PyString_FromString ("OFF");
+}
+
+static int lng_SOLFEC_set_subcycling (lng_SOLFEC *self, PyObject *value, void *closure)
+{
+  if (!is_string (value, "subcycling")) return -1;
+
+  IFIS (value, "ON") self->sol->dom->subcycling = 1;
+  ELIF (value, "OFF") self->sol->dom->subcycling = 0;
+  ELSE
+  {
+    PyErr_SetString (PyExc_ValueError, "Invalid subcycling value (ON/OFF accepted)");
+    return -1;
+  }
+
+  return 0;
+}
+
 static PyObject* lng_SOLFEC_get_verbose (lng_SOLFEC *self, void *closure)
 {
   if (self->sol->verbose > 0) return PyString_FromString ("ON");
@@ -1973,6 +1994,7 @@ static PyGetSetDef lng_SOLFEC_getset [] =
   {"bodies", (getter)lng_SOLFEC_get_bodies, (setter)lng_SOLFEC_set_bodies, "list of bodies", NULL},
   {"nbod", (getter)lng_SOLFEC_get_nbod, (setter)lng_SOLFEC_set_nbod, "bodies count", NULL},
   {"step", (getter)lng_SOLFEC_get_step, (setter)lng_SOLFEC_set_step, "time step", NULL},
+  {"subcycling", (getter)lng_SOLFEC_get_subcycling, (setter)lng_SOLFEC_set_subcycling, "explicit subcycling", NULL},
   {"verbose", (getter)lng_SOLFEC_get_verbose, (setter)lng_SOLFEC_set_verbose, "verbosity", NULL},
   {"cleanup", (getter)lng_SOLFEC_get_cleanup, (setter)lng_SOLFEC_set_cleanup, "verbosity", NULL},
   {"outpath", (getter)lng_SOLFEC_get_outpath, (setter)lng_SOLFEC_set_outpath, "verbosity", NULL},
@@ -3598,6 +3620,53 @@ static int lng_BODY_set_damping (lng_BODY *self, PyObject *value, void *closure)
   return 0;
 }
 
+static PyObject* lng_BODY_get_refactor (lng_BODY *self, void *closure)
+{
+#if MPI
+  if (IS_HERE (self))
+  {
+#endif
+
+  switch (self->bod->refactor)
+  {
+  case REF_FULL: return PyString_FromString ("FULL");
+  case REF_NUMERIC: return PyString_FromString ("NUMERIC");
+  case REF_KRYLOV: return PyString_FromString ("KRYLOV");
+  }
+
+  return NULL;
+
+#if MPI
+  }
+  else Py_RETURN_NONE;
+#endif
+}
+
+static int lng_BODY_set_refactor (lng_BODY *self, PyObject *value, void *closure)
+{
+#if MPI
+  if (IS_HERE (self))
+  {
+#endif
+
+  if (!is_string (value, "refactor")) return -1;
+
+  IFIS (value, "FULL") self->bod->refactor = REF_FULL;
+  ELIF (value, "NUMERIC") self->bod->refactor = REF_NUMERIC;
+  ELIF (value, "KRYLOV") self->bod->refactor = REF_KRYLOV;
+  ELSE
+  {
+    PyErr_SetString (PyExc_ValueError, "Invalid refactorization policy");
+    return -1;
+  }
+
+#if MPI
+  }
+#endif
+
+  return 0;
+}
+
 static PyObject* lng_BODY_get_constraints (lng_BODY *self, void *closure)
 {
 #if MPI
@@ -3884,6 +3953,7 @@ static PyGetSetDef lng_BODY_getset [] =
   {"selfcontact", (getter)lng_BODY_get_selfcontact, (setter)lng_BODY_set_selfcontact, "selfcontact", NULL},
   {"scheme", (getter)lng_BODY_get_scheme, (setter)lng_BODY_set_scheme, "scheme", NULL},
   {"damping", (getter)lng_BODY_get_damping, (setter)lng_BODY_set_damping, "damping", NULL},
+  {"refactor", (getter)lng_BODY_get_refactor, (setter)lng_BODY_set_refactor, "sparse inverse refactorization policy", NULL},
   {"constraints", (getter)lng_BODY_get_constraints, (setter)lng_BODY_set_constraints, "constraints list", NULL},
   {"ncon", (getter)lng_BODY_get_ncon, (setter)lng_BODY_set_ncon, "constraints count", NULL},
   {"material", (getter)lng_BODY_get_material, (setter)lng_BODY_set_material, "global body material", NULL},
@@ -4612,6 +4682,94 @@ static int lng_GAUSS_SEIDEL_SOLVER_set_innerloops (lng_GAUSS_SEIDEL_SOLVER *self
   return 0;
 }
 
+static PyObject* lng_GAUSS_SEIDEL_SOLVER_get_meritmode (lng_GAUSS_SEIDEL_SOLVER *self, void *closure)
+{
+  return PyString_FromString (GAUSS_SEIDEL_Meritmode (self->gs));
+}
+
+static int lng_GAUSS_SEIDEL_SOLVER_set_meritmode (lng_GAUSS_SEIDEL_SOLVER *self, PyObject *value, void *closure)
+{
+  if (!is_string (value, "meritmode")) return -1;
+
+  IFIS (value, "EXACT")
+  {
+    self->gs->meritmode = GS_MERIT_EXACT;
+  }
+  ELIF (value, "INCREMENTAL")
+  {
+    self->gs->meritmode = GS_MERIT_INCREMENTAL;
+  }
+  ELSE
+  {
+    PyErr_SetString (PyExc_ValueError, "Invalid merit mode (EXACT/INCREMENTAL accepted)");
+    return -1;
+  }
+
+  return 0;
+}
+
+static PyObject* lng_GAUSS_SEIDEL_SOLVER_get_schedule (lng_GAUSS_SEIDEL_SOLVER *self, void *closure)
+{
+  return PyString_FromString (GAUSS_SEIDEL_Schedule (self->gs));
+}
+
+static int lng_GAUSS_SEIDEL_SOLVER_set_schedule (lng_GAUSS_SEIDEL_SOLVER *self, PyObject *value, void *closure)
+{
+  if (!is_string (value, "schedule")) return -1;
+
+  IFIS (value, "FULL")
+  {
+    self->gs->schedule = GS_SCHEDULE_FULL;
+  }
+  ELIF (value, "ACTIVE")
+  {
+    self->gs->schedule = GS_SCHEDULE_ACTIVE;
+  }
+  ELSE
+  {
+    PyErr_SetString (PyExc_ValueError, "Invalid schedule (FULL/ACTIVE accepted)");
+    return -1;
+  }
+
+  return 0;
+}
+
+static PyObject* lng_GAUSS_SEIDEL_SOLVER_get_parksweeps (lng_GAUSS_SEIDEL_SOLVER *self, void *closure)
+{
+  return PyInt_FromLong (self->gs->parksweeps);
+}
+
+static int lng_GAUSS_SEIDEL_SOLVER_set_parksweeps (lng_GAUSS_SEIDEL_SOLVER *self, PyObject *value, void *closure)
+{
+  if (!is_number_ge (value, "parksweeps", 1)) return -1;
+
+  self->gs->parksweeps = (int) PyInt_AsLong (value);
+
+  return 0;
+}
+
+static PyObject* lng_GAUSS_SEIDEL_SOLVER_get_relaxed (lng_GAUSS_SEIDEL_SOLVER *self, void *closure)
+{
+  return PyInt_FromLong (self->gs->relaxed);
+}
+
+static int lng_GAUSS_SEIDEL_SOLVER_set_relaxed (lng_GAUSS_SEIDEL_SOLVER *self, PyObject *value, void *closure)
+{
+  PyErr_SetString (PyExc_ValueError, "Writing to a read-only member");
+  return -1;
+}
+
+static PyObject* lng_GAUSS_SEIDEL_SOLVER_get_skipped (lng_GAUSS_SEIDEL_SOLVER *self, void *closure)
+{
+  return PyInt_FromLong (self->gs->skipped);
+}
+
+static int lng_GAUSS_SEIDEL_SOLVER_set_skipped (lng_GAUSS_SEIDEL_SOLVER *self, PyObject *value, void *closure)
+{
+  PyErr_SetString (PyExc_ValueError, "Writing to a read-only member");
+  return -1;
+}
+
 /* GAUSS_SEIDEL_SOLVER methods */
 static PyMethodDef lng_GAUSS_SEIDEL_SOLVER_methods [] =
 { {NULL, NULL, 0, NULL} };
@@ -4637,6 +4795,11 @@ static PyGetSetDef lng_GAUSS_SEIDEL_SOLVER_getset [] =
   {"reverse", (getter)lng_GAUSS_SEIDEL_SOLVER_get_reverse, (setter)lng_GAUSS_SEIDEL_SOLVER_set_reverse, "iteration reversion flag", NULL},
   {"variant", (getter)lng_GAUSS_SEIDEL_SOLVER_get_variant, (setter)lng_GAUSS_SEIDEL_SOLVER_set_variant, "parallel update variant", NULL},
   {"innerloops", (getter)lng_GAUSS_SEIDEL_SOLVER_get_innerloops, (setter)lng_GAUSS_SEIDEL_SOLVER_set_innerloops, "number of inner loops per one parallel step", NULL},
+  {"meritmode", (getter)lng_GAUSS_SEIDEL_SOLVER_get_meritmode, (setter)lng_GAUSS_SEIDEL_SOLVER_set_meritmode, "merit function evaluation mode", NULL},
+  {"schedule", (getter)lng_GAUSS_SEIDEL_SOLVER_get_schedule, (setter)lng_GAUSS_SEIDEL_SOLVER_set_schedule, "sweep scheduling mode", NULL},
+  {"parksweeps", (getter)lng_GAUSS_SEIDEL_SOLVER_get_parksweeps, (setter)lng_GAUSS_SEIDEL_SOLVER_set_parksweeps, "number of calm sweeps before a block is skipped", NULL},
+  {"relaxed", (getter)lng_GAUSS_SEIDEL_SOLVER_get_relaxed, (setter)lng_GAUSS_SEIDEL_SOLVER_set_relaxed, "total number of diagonal block updates", NULL},
+  {"skipped", (getter)lng_GAUSS_SEIDEL_SOLVER_get_skipped, (setter)lng_GAUSS_SEIDEL_SOLVER_set_skipped, "total number of skipped diagonal block updates", NULL},
   {NULL, 0, 0, NULL, NULL}
 };
 
@@ -4661,7 +4824,7 @@ static PyObject* lng_PENALTY_SOLVER_new (PyTypeObject *type, PyObject *args, PyO
   KEYWORDS ("variant");
   lng_PENALTY_SOLVER *self;
   PyObject *variant;
-  short implicit;
+  short implicit, dem;
 
   self = (lng_PENALTY_SOLVER*)type->tp_alloc (type, 0);
 
@@ -4669,6 +4832,7 @@ static PyObject* lng_PENALTY_SOLVER_new (PyTypeObject *type, PyObject *args, PyO
   {
     variant = NULL;
     implicit = 1;
+    dem = 0;
 
     PARSEKEYS ("|O", &variant);
 
@@ -4684,6 +4848,11 @@ static PyObject* lng_PENALTY_SOLVER_new (PyTypeObject *type, PyObject *args, PyO
       {
 	implicit = 0;
       }
+      ELIF (variant, "DEM")
+      {
+	implicit = 0;
+	dem = 1;
+      }
       ELSE
       {
 	PyErr_SetString (PyExc_ValueError, "Invalid variant");
@@ -4691,7 +4860,7 @@ static PyObject* lng_PENALTY_SOLVER_new (PyTypeObject *type, PyObject *args, PyO
       }
     }
 
-    self->ps = PENALTY_Create (implicit);
+    self->ps = PENALTY_Create (implicit, dem);
   }
 
   return (PyObject*)self;
@@ -4803,9 +4972,17 @@ static PyObject* lng_NEWTON_SOLVER_new (PyTypeObject *type, PyObject *args, PyOb
       {
 	self->ns->linver = PQN_DIAG;
       }
+      ELIF (linver, "DIRECT")
+      {
+	self->ns->linver = PQN_DIRECT;
+      }
+      ELIF (linver, "ILU")
+      {
+	self->ns->linver = PQN_ILU;
+      }
       ELSE
       {
-	PyErr_SetString (PyExc_ValueError, "Invalid linver value: neither GMRES nor DIAG");
+	PyErr_SetString (PyExc_ValueError, "Invalid linver value: neither of {GMRES, DIAG, DIRECT, ILU}");
 	return NULL;
       }
     }
@@ -4921,8 +5098,15 @@ static int lng_NEWTON_SOLVER_set_locdyn (lng_NEWTON_SOLVER *self, PyObject *valu
 
 static PyObject* lng_NEWTON_SOLVER_get_linver (lng_NEWTON_SOLVER *self, void *closure)
 {
-  if (self->ns->linver == PQN_GMRES) return PyString_FromString ("GMRES");
-  else return PyString_FromString ("DIAG");
+  switch (self->ns->linver)
+  {
+  case PQN_GMRES: return PyString_FromString ("GMRES");
+  case PQN_DIAG: return PyString_FromString ("DIAG");
+  case PQN_DIRECT: return PyString_FromString ("DIRECT");
+  case PQN_ILU: return PyString_FromString ("ILU");
+  }
+
+  return NULL;
 }
 
 static int lng_NEWTON_SOLVER_set_linver (lng_NEWTON_SOLVER *self, PyObject *value, void *closure)
@@ -4937,9 +5121,17 @@ static int lng_NEWTON_SOLVER_set_linver (lng_NEWTON_SOLVER *self, PyObject *valu
   {
     self->ns->linver = PQN_DIAG;
   }
+  ELIF (value, "DIRECT")
+  {
+    self->ns->linver = PQN_DIRECT;
+  }
+  ELIF (value, "ILU")
+  {
+    self->ns->linver = PQN_ILU;
+  }
   ELSE
   {
-    PyErr_SetString (PyExc_ValueError, "Invalid linver value: neither GMRES nor DIAG");
+    PyErr_SetString (PyExc_ValueError, "Invalid linver value: neither of {GMRES, DIAG, DIRECT, ILU}");
     return -1;
   }
 
@@ -9027,18 +9219,29 @@ static PyObject* lng_RUN (PyObject *self, PyObject *args, PyObject *kwds)
 /* set output frequency */
 static PyObject* lng_OUTPUT (PyObject *self, PyObject *args, PyObject *kwds)
 {
-  KEYWORDS ("solfec", "interval", "compression");
-  PyObject *compression;
+  KEYWORDS ("solfec", "interval", "compression", "columns", "level", "shuffle", "keyframes", "tolerance");
+  PyObject *compression, *shuffle;
   lng_SOLFEC *solfec;
-  double interval;
+  CMP_CODEC codec;
+  double interval, tolerance;
+  int columns, keyframes;
   PBF_FLG cmp;
 
   compression = NULL;
+  shuffle = NULL;
   cmp = PBF_OFF;
+  columns = 0;
+  keyframes = 0;
+  tolerance = 0.0;
+  codec.alg = CMP_FASTLZ;
+  codec.level = 0;
+  codec.shuffle = 0;
 
-  PARSEKEYS ("Od|O", &solfec, &interval, &compression);
+  PARSEKEYS ("Od|OiiOid", &solfec, &interval, &compression, &columns, &codec.level, &shuffle, &keyframes, &tolerance);
 
-  TYPETEST (is_solfec (solfec, kwl[0]) && is_non_negative (interval, kwl[1]) && is_string (compression, kwl [2]));
+  TYPETEST (is_solfec (solfec, kwl[0]) && is_non_negative (interval, kwl[1]) && is_string (compression, kwl [2]) &&
+            is_non_negative (columns, kwl[3]) && is_non_negative (codec.level, kwl[4]) && is_string (shuffle, kwl[5]) &&
+            is_non_negative (keyframes, kwl[6]) && is_non_negative (tolerance, kwl[7]));
 
   if (solfec->sol->mode == SOLFEC_READ) Py_RETURN_NONE; /* skip READ mode */
 
@@ -9052,6 +9255,16 @@ static PyObject* lng_OUTPUT (PyObject *self, PyObject *args, PyObject *kwds)
     {
       cmp = PBF_ON;
     }
+    ELIF (compression, "FASTLZ")
+    {
+      cmp = PBF_ON;
+      codec.alg = CMP_FASTLZ;
+    }
+    ELIF (compression, "ZSTD")
+    {
+      cmp = PBF_ON;
+      codec.alg = CMP_ZSTD;
+    }
     ELSE
     {
       PyErr_SetString (PyExc_ValueError, "Invalid compression mode");
@@ -9059,7 +9272,31 @@ static PyObject* lng_OUTPUT (PyObject *self, PyObject *args, PyObject *kwds)
     }
   }
 
-  SOLFEC_Output (solfec->sol, interval, cmp);
+  if (codec.level == 0) codec.level = (codec.alg == CMP_ZSTD ? 3 : 1);
+  else if ((codec.alg == CMP_FASTLZ && codec.level > 2) || codec.level > CMP_ZSTD_MAXLEVEL)
+  {
+    PyErr_SetString (PyExc_ValueError, "Invalid compression level (FASTLZ: 1 or 2, ZSTD: 1 to 22)");
+    return NULL;
+  }
+
+  if (shuffle)
+  {
+    IFIS (shuffle, "ON")
+    {
+      codec.shuffle = CMP_SHUFFLE;
+    }
+    ELIF (shuffle, "OFF")
+    {
+      codec.shuffle = 0;
+    }
+    ELSE
+    {
+      PyErr_SetString (PyExc_ValueError, "Invalid shuffle mode");
+      return NULL;
+    }
+  }
+
+  SOLFEC_Output (solfec->sol, interval, cmp, &codec, columns, keyframes, tolerance);
 
   Py_RETURN_NONE;
 }
@@ -9295,6 +9532,56 @@ static PyObject* lng_INITIALIZE_STATE (PyObject *self, PyObject *args, PyObject
   Py_RETURN_NONE;
 }
 
+/* write restart checkpoints */
+static PyObject* lng_CHECKPOINT (PyObject *self, PyObject *args, PyObject *kwds)
+{
+  KEYWORDS ("solfec", "interval");
+  lng_SOLFEC *solfec;
+  double interval;
+
+  PARSEKEYS ("Od", &solfec, &interval);
+
+  TYPETEST (is_solfec (solfec, kwl[0]) && is_non_negative (interval, kwl[1]));
+
+  if (solfec->sol->mode == SOLFEC_WRITE)
+  {
+    SOLFEC_Checkpoint (solfec->sol, interval);
+  }
+  else
+  {
+    WARNING (0, "CHECKPOINT has been ingnored in the 'READ' mode");
+  }
+
+  Py_RETURN_NONE;
+}
+
+/* restart from a checkpoint */
+static PyObject* lng_RESTART (PyObject *self, PyObject *args, PyObject *kwds)
+{
+  KEYWORDS ("solfec", "path");
+  lng_SOLFEC *solfec;
+  PyObject *path;
+
+  PARSEKEYS ("OO", &solfec, &path);
+
+  TYPETEST (is_solfec (solfec, kwl[0]) && is_string (path, kwl[1]));
+
+  if (solfec->sol->mode == SOLFEC_WRITE)
+  {
+    if (SOLFEC_Restart (solfec->sol, PyString_AsString (path)) == 0)
+    {
+      PyErr_SetString (PyExc_RuntimeError, "Restart has failed");
+      return NULL;
+    }
+  }
+  else
+  {
+    WARNING (0, "RESTART has been ingnored in the 'READ' mode");
+  }
+
+  Py_RETURN_NONE;
+}
+
 /* initialize FEM bodies with rigid motion */
 static PyObject* lng_RIGID_TO_FEM (PyObject *self, PyObject *args, PyObject *kwds)
 {
@@ -9770,6 +10057,13 @@ static PyObject* lng_MODAL_ANALYSIS (PyObject *self, PyObject *args, PyObject *k
   body->bod->evec = V;
   body->bod->eval = v;
 
+  if (body->bod->etab) /* projection table of a previous base */
+  {
+    free (body->bod->etab);
+    body->bod->etab = NULL;
+    body->bod->emap = NULL;
+  }
+
 #if MPI
   }
 #endif
@@ -10534,9 +10828,16 @@ static PyObject* lng_XDMF_EXPORT (PyObject *self, PyObject *args, PyObject *kwds
   }
 
 #if !MPI
-  if (solfec->sol->mode == SOLFEC_WRITE)
+  if (solfec->sol->mode == SOLFEC_WRITE) /* stream output frames of subsequent RUN commands */
   {
-    xdmf_export (solfec->sol, NULL, 0, PyString_AsString(path), subset, 0);
+    if (solfec->sol->xf) XDMF_Close (solfec->sol->xf);
+
+    if ((solfec->sol->xf = XDMF_Create (PyString_AsString(path), subset, attributes)))
+    {
+      XDMF_Append (solfec->sol->xf, solfec->sol->dom);
+
+      XDMF_Markup (solfec->sol->xf);
+    }
   }
   else
   {
@@ -10977,10 +11278,10 @@ static int parse_history_item (PyObject *obj, MEM *setmem, SOLFEC *sol, SHI *shi
       point = PyTuple_GetItem (obj, 1);
       entity = PyTuple_GetItem (obj, 2);
 
-      if (!((is_body (body, "body") || is_string ((PyObject*)body, "body")) &&
+      if (!((PyString_Check ((PyObject*)body) || is_body (body, "body")) && /* avoid a stale type error for labels */
 	   is_tuple (point, "point", 3) && is_string (entity, "entity"))) return 0;
 
-      if (is_body (body, "body"))
+      if (!PyString_Check ((PyObject*)body))
       {
         shi->bod = body->bod;
 	shi->label = NULL;
@@ -11405,6 +11706,8 @@ static PyMethodDef lng_methods [] =
   {"GEOMETRIC_EPSILON", METHOD_WITH_KEYWORDS(lng_GEOMETRIC_EPSILON), METH_VARARGS|METH_KEYWORDS, "Set geometric epsilon"},
   {"WARNINGS", METHOD_WITH_KEYWORDS(lng_WARNINGS), METH_VARARGS|METH_KEYWORDS, "Enable or disable warnings"},
   {"INITIALIZE_STATE", METHOD_WITH_KEYWORDS(lng_INITIALIZE_STATE), METH_VARARGS|METH_KEYWORDS, "Initialize Solfec state"},
+  {"CHECKPOINT", METHOD_WITH_KEYWORDS(lng_CHECKPOINT), METH_VARARGS|METH_KEYWORDS, "Write restart checkpoints"},
+  {"RESTART", METHOD_WITH_KEYWORDS(lng_RESTART), METH_VARARGS|METH_KEYWORDS, "Restart from a checkpoint"},
   {"RIGID_TO_FEM", METHOD_WITH_KEYWORDS(lng_RIGID_TO_FEM), METH_VARARGS|METH_KEYWORDS, "Map rigid motion onto FEM bodies"},
   {"LOCDYN_DUMP", METHOD_WITH_KEYWORDS(lng_LOCDYN_DUMP), METH_VARARGS|METH_KEYWORDS, "Dump local dynamics"},
   {"OVERLAPPING", METHOD_WITH_KEYWORDS(lng_OVERLAPPING), METH_VARARGS|METH_KEYWORDS, "Detect shapes (not) overlapping obstacles"},
@@ -11670,6 +11973,8 @@ int lng (const char *path)
                      "from solfec import GEOMETRIC_EPSILON\n"
                      "from solfec import WARNINGS\n"
                      "from solfec import INITIALIZE_STATE\n"
+                     "from solfec import CHECKPOINT\n"
+                     "from solfec import RESTART\n"
                      "from solfec import RIGID_TO_FEM\n"
                      "from solfec import LOCDYN_DUMP\n"
                      "from solfec import OVERLAPPING\n"
@@ -103,6 +103,33 @@ double BULK_MATERIAL_ROUTINE (BULK_MATERIAL *mat, double *state, double *field,
   return J;
 }
 
+/* batched bulk material routine */
+double BULK_MATERIAL_ROUTINE_BATCH (BULK_MATERIAL *mat, int n, int ld, double *state, double *field, double *F, double *a, double *P)
+{
+  double energy = 0.0;
+
+  switch (mat->model)
+  {
+  case KIRCHHOFF:
+  {
+    double mat_lambda, mat_mi;
+
+    mat_lambda = lambda (mat->young, mat->poisson);
+    mat_mi = mi (mat->young, mat->poisson);
+    if (P) SVK_Stress_Batch_C (mat_lambda, mat_mi, n, ld, a, F, P);
+    else energy = SVK_Energy_Batch_C (mat_lambda, mat_mi, n, ld, a, F);
+  }
+  break;
+  case TSANG_MARSDEN:
+  {
+    ASSERT (0, ERR_NOT_IMPLEMENTED); /* TODO */
+  }
+  break;
+  }
+
+  return energy;
+}
+
 /* insert new material */
 BULK_MATERIAL* MATSET_Insert (MATSET *set, char *label, BULK_MATERIAL data)
 {
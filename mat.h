@@ -126,6 +126,21 @@ struct matset
  */
 double BULK_MATERIAL_ROUTINE (BULK_MATERIAL *mat, double *state, double *field, double *F, double a, double *P, double *K);
 
+/* batched bulk material routine
+ * -----------------------------
+ *  mat (IN) - material
+ *  n (IN) - number of integration points
+ *  ld (IN) - leading dimension of F and P
+ *  state (IN/OUT) - state variables at the 'n' integration points (point after point)
+ *  field (IN) - field variables at the 'n' integration points (MAX_NFIELD stride); NULL allowed
+ *  F (IN) - deformation gradients; F [k*ld+i] is the k-th (column-wise) component at point i
+ *  a (IN) - 'n' coefficients that will scale P
+ *  P (OUT) - first Piola tensors stored as F; NULL allowed
+ * --------------------------------------
+ *  return the sum of a * internal energy density if P is NULL; otherwise 0
+ */
+double BULK_MATERIAL_ROUTINE_BATCH (BULK_MATERIAL *mat, int n, int ld, double *state, double *field, double *F, double *a, double *P);
+
 /* create bulk material set */
 MATSET* MATSET_Create ();
 
@@ -28,33 +28,138 @@
 #include "alg.h"
 #include "scf.h"
 
+/* constraint satisfaction merit function numerator of a single
+ * diagonal block, for a given relative velocity U of this block */
+double MERIT_Block (LOCDYN *ldy, DIAB *dia, double *U)
+{
+  double step, up, Q [3], P [3];
+  SOLVER_KIND solver;
+  short dynamic;
+  CON *con;
+
+  dynamic = ldy->dom->dynamic;
+  step = ldy->dom->step;
+  solver = ldy->dom->solfec->kind;
+  con = dia->con;
+
+  double *W = dia->W,
+	 *A = dia->A,
+	 *V = dia->V,
+	 *R = dia->R;
+
+  up = 0.0;
+
+  switch (con->kind)
+  {
+  case CONTACT:
+  {
+    SCF_Linearize (con, U, R, -1, 0, P, NULL, NULL);
+    NVMUL (A, P, Q);
+    up = DOT (Q, P);
+  }
+  break;
+  case FIXPNT:
+  {
+    if (dynamic) { ADD (U, V, P); }
+    else { COPY (U, P); }
+    NVMUL (A, P, Q);
+    up = DOT (Q, P);
+  }
+  break;
+  case FIXDIR:
+  {
+    if (dynamic) { P[2] = U[2] + V[2]; }
+    else { P[2] = U[2]; }
+    Q [2] = A[8] * P[2];
+    up = Q[2] * P[2];
+  }
+  break;
+  case VELODIR:
+  {
+    P [2] = VELODIR(con->Z) - U[2];
+    Q [2] = A[8] * P[2];
+    up = Q[2] * P[2];
+  }
+  break;
+  case VELODIR3:
+  {
+    P [0] = VELODIR0(con->Z) - U[0];
+    P [1] = VELODIR1(con->Z) - U[1];
+    P [2] = VELODIR2(con->Z) - U[2];
+    NVMUL (A, P, Q);
+    up = DOT (Q, P);
+  }
+  break;
+  case RIGLNK:
+  {
+    double h = step * (dynamic ? 0.5 : 1.0);
+
+    if (solver == GAUSS_SEIDEL_SOLVER)
+    {
+      P[2] = con->gap/h + U[2]; /* XXX: this is rough since dbb.c:riglnk is minimising R[2] under |Z+hU|=d */
+    }
+    else
+    {
+      double d = RIGLNK_LEN (con->Z),
+	     delta;
+
+      delta = d*d - h*h*DOT2(U,U);
+      if (delta >= 0.0) P [2] = (sqrt (delta) - d)/h - U[2];
+      else P[2] = -U[2];
+    }
+
+    Q [2] = A[8] * P[2];
+    up = Q[2] * P[2];
+  }
+  break;
+  case SPRING:
+  {
+    double *lim = con->Z, gap = con->gap;
+
+    if ((gap < lim[0] && U[2] < 0) || (gap > lim[1] && U[2] > 0))
+    {
+      if (dynamic) { P[2] = U[2] + V[2]; }
+      else { P[2] = U[2]; }
+      Q [2] = A[8] * P[2]; /* inv(W) * velocity */
+      up = Q[2] * P[2];
+    }
+    else
+    {
+      double g = dynamic ? gap + 0.25*step*(U[2]-V[2]) : gap + step*U[2],
+             v = dynamic ? 0.5*(V[2]+U[2]) : U[2],
+             R2 = springcallback ((PyObject*)con->tms, g, v);
+
+      P [2] = -R[2] + R2;
+      Q [2] = W[8]*P[2]; /* W * force */
+      up = Q[2] * P[2];
+    }
+  }
+  break;
+  }
+
+  return up;
+}
+
 /* constraint satisfaction merit function approximately indicates the
  * amount of spurious momentum due to constraint force inaccuracy;
  * update_U != 0 implies that U needs to be computed for current R;
  * (it is assumed that all (also external) reactions are updated) */
 double MERIT_Function (LOCDYN *ldy, short update_U)
 {
-  double step, up, uplo [2], Q [3], P [3];
-  SOLVER_KIND solver;
-  short dynamic;
+  double up, uplo [2];
   DIAB *dia;
   OFFB *blk;
   CON *con;
 
   uplo [0] = 0.0;
   uplo [1] = ldy->free_energy < DBL_EPSILON ? 1.0 : ldy->free_energy; /* XXX => avoid division by zero */
-  dynamic = ldy->dom->dynamic;
-  step = ldy->dom->step;
-  solver = ldy->dom->solfec->kind;
 
   for (dia = ldy->dia; dia; dia = dia->n)
   {
     con = dia->con;
 
     double *W = dia->W,
-	   *A = dia->A,
 	   *B = dia->B,
-	   *V = dia->V,
 	   *U = dia->U,
 	   *R = dia->R;
 
@@ -75,94 +180,7 @@ double MERIT_Function (LOCDYN *ldy, short update_U)
 #endif
     }
 
-    switch (con->kind)
-    {
-    case CONTACT:
-    {
-      SCF_Linearize (con, U, R, -1, 0, P, NULL, NULL);
-      NVMUL (A, P, Q);
-      up = DOT (Q, P);
-    }
-    break;
-    case FIXPNT:
-    {
-      if (dynamic) { ADD (U, V, P); }
-      else { COPY (U, P); }
-      NVMUL (A, P, Q);
-      up = DOT (Q, P);
-    }
-    break;
-    case FIXDIR:
-    {
-      if (dynamic) { P[2] = U[2] + V[2]; }
-      else { P[2] = U[2]; }
-      Q [2] = A[8] * P[2];
-      up = Q[2] * P[2];
-    }
-    break;
-    case VELODIR:
-    {
-      P [2] = VELODIR(con->Z) - U[2];
-      Q [2] = A[8] * P[2];
-      up = Q[2] * P[2];
-    }
-    break;
-    case VELODIR3:
-    {
-      P [0] = VELODIR0(con->Z) - U[0];
-      P [1] = VELODIR1(con->Z) - U[1];
-      P [2] = VELODIR2(con->Z) - U[2];
-      NVMUL (A, P, Q);
-      up = DOT (Q, P);
-    }
-    break;
- 
-    case RIGLNK:
-    {
-      double h = step * (dynamic ? 0.5 : 1.0);
-
-      if (solver == GAUSS_SEIDEL_SOLVER)
-      {
-        P[2] = con->gap/h + U[2]; /* XXX: this is rough since dbb.c:riglnk is minimising R[2] under |Z+hU|=d */
-      }
-      else
-      {
-	double d = RIGLNK_LEN (con->Z),
-	       delta;
-
-	delta = d*d - h*h*DOT2(U,U);
-	if (delta >= 0.0) P [2] = (sqrt (delta) - d)/h - U[2];
-	else P[2] = -U[2];
-      }
-
-      Q [2] = A[8] * P[2];
-      up = Q[2] * P[2];
-    }
-    break;
-    case SPRING:
-    {
-      double *lim = con->Z, gap = con->gap;
-
-      if ((gap < lim[0] && U[2] < 0) || (gap > lim[1] && U[2] > 0))
-      {
-	if (dynamic) { P[2] = U[2] + V[2]; }
-	else { P[2] = U[2]; }
-	Q [2] = A[8] * P[2]; /* inv(W) * velocity */
-	up = Q[2] * P[2];
-      }
-      else
-      {
-        double g = dynamic ? gap + 0.25*step*(U[2]-V[2]) : gap + step*U[2],
-               v = dynamic ? 0.5*(V[2]+U[2]) : U[2],
-               R2 = springcallback ((PyObject*)con->tms, g, v);
-
-	P [2] = -R[2] + R2;
-        Q [2] = W[8]*P[2]; /* W * force */
-        up = Q[2] * P[2];
-      }
-    }
-    break;
-    }
+    up = MERIT_Block (ldy, dia, U);
 
     con->merit = up; /* per-constraint merit numerator */
     uplo [0] += up;
@@ -183,3 +201,12 @@ double MERIT_Function (LOCDYN *ldy, short update_U)
 
   return uplo [0] / uplo [1];
 }
+
+/* merit function value estimated from a sum of MERIT_Block
+ * numerators accumulated over the local blocks (no reduction) */
+double MERIT_Estimate (LOCDYN *ldy, double sum)
+{
+  double lo = ldy->free_energy < DBL_EPSILON ? 1.0 : ldy->free_energy;
+
+  return 0.5 * sum / lo;
+}
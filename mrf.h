@@ -30,4 +30,12 @@
  * (it is assumed that all (also external) reactions are updated) */
 double MERIT_Function (LOCDYN *ldy, short update_U);
 
+/* constraint satisfaction merit function numerator of a single
+ * diagonal block, for a given relative velocity U of this block */
+double MERIT_Block (LOCDYN *ldy, DIAB *dia, double *U);
+
+/* merit function value estimated from a sum of MERIT_Block
+ * numerators accumulated over the local blocks (no reduction) */
+double MERIT_Estimate (LOCDYN *ldy, double sum);
+
 #endif
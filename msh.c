@@ -1115,6 +1115,20 @@ static void mark_neighs (ELEMENT *ele, short flag)
   }
 }
 
+/* free element integration data; it becomes invalid once referential nodes change */
+static void free_integration_data (MESH *msh)
+{
+  ELEMENT *ele;
+
+  if (msh->idata)
+  {
+    for (ele = msh->surfeles; ele; ele = ele->next) ele->idata = NULL;
+    for (ele = msh->bulkeles; ele; ele = ele->next) ele->idata = NULL;
+    free (msh->idata);
+    msh->idata = NULL;
+  }
+}
+
 /* free up mesh internal memory */
 static void freeup (MESH *msh)
 {
@@ -1122,6 +1136,10 @@ static void freeup (MESH *msh)
   FACE *fac;
   int n;
 
+  free_integration_data (msh);
+
+  if (msh->tdata) free (msh->tdata);
+
   for (fac = msh->faces; fac; fac = fac->n)
   {
     if (fac->idata) free (fac->idata);
@@ -1836,6 +1854,10 @@ MESH* MESH_Copy (MESH *msh)
     cpy->domnum = 0;
     cpy->dom = NULL;
 
+    /* integration data
+     * does not get coppied */
+    cpy->idata = NULL;
+
     /* maintain list */
     cpy->prev = NULL;
     cpy->next = ret->surfeles;
@@ -1872,6 +1894,10 @@ MESH* MESH_Copy (MESH *msh)
     cpy->domnum = 0;
     cpy->dom = NULL;
 
+    /* integration data
+     * does not get coppied */
+    cpy->idata = NULL;
+
     /* maintain list */
     cpy->prev = NULL;
     cpy->next = ret->bulkeles;
@@ -1921,6 +1947,8 @@ void MESH_Scale (MESH *msh, double *vector)
   ELEMENT *ele;
   FACE *fac;
 
+  free_integration_data (msh);
+
   for (; ref < end; ref ++, cur ++)
   {
     ref [0][0] *= vector [0];
@@ -1976,6 +2004,8 @@ void MESH_Rotate (MESH *msh, double *point, double *vector, double angle)
   ELEMENT *ele;
   FACE *fac;
 
+  free_integration_data (msh);
+
   for (; ref < end; ref ++, cur ++)
   {
     SUB (ref[0], point, omega);
@@ -73,6 +73,8 @@ struct element
   BULK_MATERIAL *mat; /* bulk material, overrdiing BODY->mat */
   double *state; /* material state variables */
 
+  double *idata; /* integration data (points into MESH->idata) */
+
   TRISURF *dom; /* integration domains */
 
   ELEMENT *prev,
@@ -102,6 +104,10 @@ struct mesh
        nodes_count;
 
   MAP *map; /* MESH_Element_With_Node uses it */
+
+  double *idata; /* element integration data block */
+
+  int *tdata; /* tangent stiffness pattern and scatter map */
 };
 
 /* create mesh from vector of nodes, element list in format =>
@@ -59,6 +59,8 @@
 #define ICNTL(I) icntl[(I)-1] /* MUMPS macro s.t. indices match documentation */
 #define INFO(I) info[(I)-1] /* MUMPS */
 
+#define INVMATS_BATCH 96 /* maximal number of right hand sides per batched solve */
+
 /* types */
 typedef int (*qcmp_t) (const void*, const void*);
 
@@ -937,6 +939,66 @@ static void vec_inv (double *b, MX *a, double *c)
 /* c = b * inv (a)' */
 #define vec_inv_tran(b, a, c) inv_vec (a, b, c)
 
+/* x = inv (a) * x, or x = inv (a)' * x when 'tran' is set, for 'nrhs' right hand sides stored column-wise in 'x' */
+static void inv_mat (MX *a, int tran, int nrhs, double *x)
+{
+  if (MXSPD (a)) /* MUMPS: all right hand sides at once */
+  {
+    DMUMPS_STRUC_C *id = a->sym;
+    id->nrhs = nrhs;
+    id->lrhs = a->n;
+    id->rhs = x;
+    id->job = 3;
+    dmumps_c (id);
+    id->nrhs = 1;
+  }
+  else /* CSparse: right hand sides in parallel */
+  {
+    css *S = a->sym;
+    csn *N = a->num;
+    int n = a->n, threads = 1;
+    double *work;
+
+#if OMP
+    #pragma omp parallel
+    #pragma omp master
+    threads = omp_get_num_threads ();
+#endif
+
+    ERRMEM (work = malloc (sizeof (double [threads * n])));
+
+#if OMP
+    #pragma omp parallel for
+#endif
+    for (int j = 0; j < nrhs; j ++)
+    {
+#if OMP
+      double *w = &work [omp_get_thread_num () * n];
+#else
+      double *w = work;
+#endif
+      double *b = &x [j * n];
+
+      if (tran)
+      {
+	cs_pvec (S->q, b, w, n);
+	cs_utsolve (N->U, w);
+	cs_ltsolve (N->L, w);
+	cs_pvec (N->pinv, w, b, n);
+      }
+      else
+      {
+	cs_ipvec (N->pinv, b, w, n);
+	cs_lsolve (N->L, w);
+	cs_usolve (N->U, w);
+	cs_ipvec (S->q, w, b, n);
+      }
+    }
+
+    free (work);
+  }
+}
+
 /* return w = a (:,j) */
 static double* col (MX *a, int j, double *w)
 {
@@ -961,7 +1023,7 @@ static double* col (MX *a, int j, double *w)
 	  *i = a->i,
 	  k, l, o;
 
-#if DEBUG
+#if DEBUG && !OMP /* the sequence check state is shared between threads */
       static int j_prev = -1;
       ASSERT_DEBUG (j == (j_prev + 1), "Column retrival must be called for a sequence of js: 0, 1, 2, ..., n");
       j_prev = j;
@@ -1022,14 +1084,14 @@ static void putrow (MX *a, int i, double *v)
 static MX* matmat_inv_general (int reverse, double alpha, MX *a, MX *b, double beta, MX *c)
 {
   MX *A, *B, *d;
-  double *w, *v;
+  double *w, *t;
   int i, m, un;
 
   ASSERT_DEBUG (a != b && b != c && c != a, "Matrices 'a','b','c' must be different");
 
   m = reverse ? MAX (b->m, b->n) : MAX (a ->m, a->n);
-  ERRMEM (w = malloc (sizeof (double [m * 2])));
-  v = w + m;
+  ERRMEM (w = malloc (sizeof (double [m])));
+  t = NULL;
 
   if (reverse)
   {
@@ -1043,7 +1105,10 @@ static MX* matmat_inv_general (int reverse, double alpha, MX *a, MX *b, double b
 	if (a->kind == MXCSC) A = cs_transpose (a, 1), un = 0;
 	else A = a, a->flags |= MXTRANS, un = 1; /* transpose (we need to read rows) */
 	B = b;
-	for (i = 0; i < d->m; i ++) vec_inv (col (A, i, w), B, v), putrow (d, i, v);
+	ERRMEM (t = malloc (sizeof (double [m * d->m])));
+	for (i = 0; i < d->m; i ++) blas_dcopy (m, col (A, i, w), 1, &t[i*m], 1);
+	inv_mat (B, 1, d->m, t); /* rows of a * inv (b) = columns of inv (b)' * a' */
+	for (i = 0; i < d->m; i ++) putrow (d, i, &t[i*m]);
 	if (un) a->flags &= ~MXTRANS; /* untranspose */
       }
       break;
@@ -1053,7 +1118,10 @@ static MX* matmat_inv_general (int reverse, double alpha, MX *a, MX *b, double b
 	d = MX_Create (MXDENSE, a->n, b->n, NULL, NULL);
 	A = a, a->flags &= ~MXTRANS; /* untranspose (to read rows) */
 	B = b;
-	for (i = 0; i < d->m; i ++) vec_inv (col (A, i, w), B, v), putrow (d, i, v);
+	ERRMEM (t = malloc (sizeof (double [m * d->m])));
+	for (i = 0; i < d->m; i ++) blas_dcopy (m, col (A, i, w), 1, &t[i*m], 1);
+	inv_mat (B, 1, d->m, t); /* rows of a * inv (b) = columns of inv (b)' * a' */
+	for (i = 0; i < d->m; i ++) putrow (d, i, &t[i*m]);
 	a->flags |= MXTRANS; /* transpose back */
       }
       break;
@@ -1064,7 +1132,10 @@ static MX* matmat_inv_general (int reverse, double alpha, MX *a, MX *b, double b
 	if (a->kind == MXCSC) A = cs_transpose (a, 1), un = 0;
 	else A = a, a->flags |= MXTRANS, un = 1; /* transpose (we need to read rows) */
 	B = b;
-	for (i = 0; i < d->m; i ++) vec_inv_tran (col (A, i, w), B, v), putrow (d, i, v);
+	ERRMEM (t = malloc (sizeof (double [m * d->m])));
+	for (i = 0; i < d->m; i ++) blas_dcopy (m, col (A, i, w), 1, &t[i*m], 1);
+	inv_mat (B, 0, d->m, t); /* rows of a * inv (b)' = columns of inv (b) * a' */
+	for (i = 0; i < d->m; i ++) putrow (d, i, &t[i*m]);
 	if (un) a->flags &= ~MXTRANS; /* untranspose */
       }
       break;
@@ -1074,7 +1145,10 @@ static MX* matmat_inv_general (int reverse, double alpha, MX *a, MX *b, double b
 	d = MX_Create (MXDENSE, a->n, b->m, NULL, NULL);
 	A = a, a->flags &= ~MXTRANS; /* untranspose (to read rows) */
 	B = b;
-	for (i = 0; i < d->m; i ++) vec_inv_tran (col (A, i, w), B, v), putrow (d, i, v);
+	ERRMEM (t = malloc (sizeof (double [m * d->m])));
+	for (i = 0; i < d->m; i ++) blas_dcopy (m, col (A, i, w), 1, &t[i*m], 1);
+	inv_mat (B, 0, d->m, t); /* rows of a * inv (b)' = columns of inv (b) * a' */
+	for (i = 0; i < d->m; i ++) putrow (d, i, &t[i*m]);
 	a->flags |= MXTRANS; /* transpose back */
       }
       break;
@@ -1090,7 +1164,8 @@ static MX* matmat_inv_general (int reverse, double alpha, MX *a, MX *b, double b
 	d = MX_Create (MXDENSE, a->m, b->n, NULL, NULL);
 	A = a;
 	B = b;
-	for (i = 0; i < d->n; i ++) inv_vec (A, col (B, i, w), col (d, i, NULL));
+	for (i = 0; i < d->n; i ++) blas_dcopy (d->m, col (B, i, w), 1, col (d, i, NULL), 1);
+	inv_mat (A, 0, d->n, d->x);
       }
       break;
       case 0x10:
@@ -1099,7 +1174,8 @@ static MX* matmat_inv_general (int reverse, double alpha, MX *a, MX *b, double b
 	d = MX_Create (MXDENSE, a->n, b->n, NULL, NULL);
 	A = a;
 	B = b;
-	for (i = 0; i < d->n; i ++) inv_tran_vec (A, col (B, i, w), col (d, i, NULL));
+	for (i = 0; i < d->n; i ++) blas_dcopy (d->m, col (B, i, w), 1, col (d, i, NULL), 1);
+	inv_mat (A, 1, d->n, d->x);
       }
       break;
       case 0x01:
@@ -1108,7 +1184,8 @@ static MX* matmat_inv_general (int reverse, double alpha, MX *a, MX *b, double b
 	d = MX_Create (MXDENSE, a->m, b->m, NULL, NULL);
 	A = a;
 	B = b->kind == MXCSC ? cs_transpose (b, 1) : b;
-	for (i = 0; i < d->n; i ++) inv_vec (A, col (B, i, w), col (d, i, NULL));
+	for (i = 0; i < d->n; i ++) blas_dcopy (d->m, col (B, i, w), 1, col (d, i, NULL), 1);
+	inv_mat (A, 0, d->n, d->x);
       }
       break;
       case 0x11:
@@ -1117,7 +1194,8 @@ static MX* matmat_inv_general (int reverse, double alpha, MX *a, MX *b, double b
 	d = MX_Create (MXDENSE, a->n, b->m, NULL, NULL);
 	A = a;
 	B = b->kind == MXCSC ? cs_transpose (b, 1) : b;
-	for (i = 0; i < d->n; i ++) inv_tran_vec (A, col (B, i, w), col (d, i, NULL));
+	for (i = 0; i < d->n; i ++) blas_dcopy (d->m, col (B, i, w), 1, col (d, i, NULL), 1);
+	inv_mat (A, 1, d->n, d->x);
       }
       break;
     }
@@ -1144,6 +1222,7 @@ static MX* matmat_inv_general (int reverse, double alpha, MX *a, MX *b, double b
   if (B != b) cs_spfree (B);
 
   free (w);
+  free (t);
 
   return c;
 }
@@ -2435,6 +2514,84 @@ MX* MX_Inverse (MX *a, MX *b)
   else return b;
 }
 
+MX* MX_Refactor (MX *a, MX *b)
+{
+  ASSERT_DEBUG (KIND (a) == MXCSC && KIND (b) == MXCSC, "Invalid matrix kind");
+  ASSERT_DEBUG (!MXIFAC (a) && MXIFAC (b), "The second argument must be a factorized inverse");
+  ASSERT_DEBUG (a->n == b->n && a->nzmax == b->nzmax, "Sparsity patterns differ");
+
+  memcpy (b->x, a->x, sizeof (double [a->nzmax])); /* workspace after b->x stays intact */
+
+  if (MXSPD (b)) /* MUMPS: factorization only */
+  {
+    DMUMPS_STRUC_C *id = b->sym;
+
+    id->job = 2;
+    dmumps_c (id);
+    ASSERT (id->INFO(1) >= 0, ERR_MTX_CHOL_FACTOR);
+  }
+  else /* CSparse: numeric LU with the symbolic ordering */
+  {
+    cs_nfree (b->num);
+    ASSERT (b->num = cs_lu (b, b->sym, 0.1), ERR_MTX_LU_FACTOR);
+  }
+
+  if (TEMPORARY (a)) free (a);
+  return b;
+}
+
+MX** MX_Invmats (MX *a, int n, MX **b, MX **c)
+{
+  int i, j, k, l, nrhs, cols;
+  double *w, *x;
+  MX **B;
+
+  ASSERT_DEBUG (KIND (a) == MXCSC && MXIFAC (a) && !MXTRANS (a), "Not a factorized sparse inverse");
+
+  ERRMEM (B = malloc (sizeof (MX*) * n));
+  for (j = cols = 0; j < n; j ++)
+  {
+    B [j] = b [j]->kind == MXCSC && MXTRANS (b [j]) ? cs_transpose (b [j], 1) : b [j]; /* columns of CSC are read directly */
+    ASSERT_DEBUG ((MXTRANS (B [j]) ? B [j]->n : B [j]->m) == a->n, "Incompatible dimensions");
+    cols = MAX (cols, MXTRANS (B [j]) ? B [j]->m : B [j]->n);
+  }
+
+  ERRMEM (w = malloc (sizeof (double [a->n])));
+  ERRMEM (x = malloc (sizeof (double [a->n * MAX (cols, INVMATS_BATCH)])));
+
+  for (j = 0; j < n; j = k)
+  {
+    for (k = j, nrhs = 0; k < n; k ++) /* gather a batch of right hand sides */
+    {
+      cols = MXTRANS (B [k]) ? B [k]->m : B [k]->n;
+      if (nrhs && nrhs + cols > INVMATS_BATCH) break;
+      for (i = 0; i < cols; i ++, nrhs ++) blas_dcopy (a->n, col (B [k], i, w), 1, &x [nrhs * a->n], 1);
+    }
+
+    inv_mat (a, 0, nrhs, x);
+
+    for (l = j, nrhs = 0; l < k; l ++) /* scatter the solutions */
+    {
+      cols = MXTRANS (B [l]) ? B [l]->m : B [l]->n;
+      c [l] = MX_Create (MXDENSE, a->n, cols, NULL, NULL);
+      blas_dcopy (a->n * cols, &x [nrhs * a->n], 1, c [l]->x, 1);
+      nrhs += cols;
+    }
+  }
+
+  for (j = 0; j < n; j ++)
+  {
+    if (B [j] != b [j]) cs_spfree (B [j]);
+    if (TEMPORARY (b [j])) free (b [j]);
+  }
+
+  free (B);
+  free (w);
+  free (x);
+
+  return c;
+}
+
 void MX_Eigen (MX *a, int n, double *val, MX *vec)
 {
   switch (a->kind)
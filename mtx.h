@@ -116,6 +116,14 @@ void MX_Matvec (double alpha, MX *a, double *b, double beta, double *c);
  * Cholesky for MXSPD; if 'b' == NULL return new matrix; otherwise return 'b' */
 MX* MX_Inverse (MX *a, MX *b);
 
+/* numeric refactorization => b = inv (a), where 'b' is a factorized CSC inverse
+ * with the sparsity pattern of 'a'; the symbolic analysis of 'b' is reused; return 'b' */
+MX* MX_Refactor (MX *a, MX *b);
+
+/* batched products with a factorized CSC inverse => c [j] = inv (a) * b [j], for j = 0, ..., n-1;
+ * all right hand sides are solved together, in batches; dense 'c [j]' are created; return 'c' */
+MX** MX_Invmats (MX *a, int n, MX **b, MX **c);
+
 /* compute |n| eigenvalues & eigenvectors (vec != NULL) in the upper or
  * lower range (n < 0 or n > 0) => symmetry of 'a' is assumed and the
  * results are outputed according to the ascending order of eigenvalues */
@@ -85,6 +85,22 @@ struct private
 
   VECTOR *dr, /* reactions increment */
 	 *rhs; /* right hand side of linearization */
+
+  short linver; /* linear solver version in use */
+
+  int nblk, /* number of 3x3 block rows of the assembled linearization */
+     *bp, /* block row pointers */
+     *bj, /* block column indices (sorted within rows) */
+     *bd, /* diagonal block positions */
+     *bt, /* positions of transposed blocks */
+     *cp, /* scalar compressed column pointers (PQN_DIRECT) */
+     *ci; /* scalar compressed column row indices (PQN_DIRECT) */
+
+  double *bx, /* 3x3 blocks of the linearization or its ILU(0) factors */
+         *bi; /* inverted diagonal blocks of the ILU(0) factors */
+
+  MX *M, /* scalar compressed linearization (PQN_DIRECT) */
+     *F; /* its factorized inverse; the symbolic analysis is reused across Newton steps */
 #if MPI
   SET *inner, *boundary;
   COMDATA *send, *recv;
@@ -439,6 +455,254 @@ static void U_WR_B (PRIVATE *A, short zero_B)
   }
 }
 
+/* compute the 3x3 row scaling S, so that S W(i,j) are the off-diagonal blocks of the linearization */
+static void row_scaling (CON_DATA *dat, double *S)
+{
+  switch (dat->con->kind)
+  {
+  case VELODIR:
+  case FIXDIR:
+  case RIGLNK:
+    SET9 (S, 0.0);
+    S [8] = 1.0;
+  break;
+  case SPRING:
+    SET9 (S, 0.0);
+    S [8] = dat->X [8];
+  break;
+  case CONTACT:
+    NNCOPY (dat->X, S);
+  break;
+  default:
+    IDENTITY (S);
+  break;
+  }
+}
+
+/* find block column j in block row i */
+static int block_find (PRIVATE *A, int i, int j)
+{
+  int lo = A->bp [i], hi = A->bp [i+1] - 1, k;
+
+  while (lo <= hi)
+  {
+    k = (lo + hi) / 2;
+    if (A->bj [k] < j) lo = k + 1;
+    else if (A->bj [k] > j) hi = k - 1;
+    else return k;
+  }
+
+  return -1;
+}
+
+/* create block sparse pattern of the linearization from the W adjacency (LOCDYN_ON mode) */
+static void sparse_pattern (PRIVATE *A)
+{
+  int i, j, k, l, n, *mark, *bp, *bj;
+  CON_DATA *dat;
+  OFFB *blk;
+
+  for (dat = A->dat, n = 0; dat != A->end; dat ++, n ++)
+  {
+#if MPI
+    if (!dat->con->dia) break; /* skip external */
+#endif
+    dat->con->num = n;
+  }
+
+  A->nblk = n;
+  ERRMEM (A->bp = malloc (sizeof (int [n+1])));
+  ERRMEM (A->bd = malloc (sizeof (int [n])));
+  ERRMEM (mark = malloc (sizeof (int [n])));
+  for (i = 0; i < n; i ++) mark [i] = -1;
+  bp = A->bp;
+
+  for (dat = A->dat, bp [0] = i = 0; i < n; dat ++, i ++) /* count distinct neighbours */
+  {
+    for (bp [i+1] = bp [i] + 1, mark [i] = i, blk = dat->con->dia->adj; blk; blk = blk->n)
+    {
+      j = blk->dia->con->num;
+      if (mark [j] != i) mark [j] = i, bp [i+1] ++;
+    }
+  }
+
+  ERRMEM (A->bj = malloc (sizeof (int [bp [n]])));
+  ERRMEM (A->bt = malloc (sizeof (int [bp [n]])));
+  ERRMEM (A->bx = malloc (sizeof (double [9 * bp [n]])));
+  for (i = 0; i < n; i ++) mark [i] = -1;
+  bj = A->bj;
+
+  for (dat = A->dat, i = 0; i < n; dat ++, i ++) /* fill and sort columns */
+  {
+    k = bp [i];
+    bj [k ++] = i;
+    mark [i] = i;
+
+    for (blk = dat->con->dia->adj; blk; blk = blk->n)
+    {
+      j = blk->dia->con->num;
+      if (mark [j] != i) mark [j] = i, bj [k ++] = j;
+    }
+
+    for (k = bp [i] + 1; k < bp [i+1]; k ++) /* insertion sort of a short row */
+    {
+      for (j = bj [k], l = k; l > bp [i] && bj [l-1] > j; l --) bj [l] = bj [l-1];
+      bj [l] = j;
+    }
+
+    A->bd [i] = block_find (A, i, i);
+  }
+
+  for (i = 0; i < n; i ++)
+  {
+    for (k = bp [i]; k < bp [i+1]; k ++)
+    {
+      A->bt [k] = block_find (A, bj [k], i);
+      ASSERT_DEBUG (A->bt [k] >= 0, "Unsymmetric W adjacency");
+    }
+  }
+
+  if (A->linver == PQN_DIRECT) /* scalar compressed columns; the block pattern is symmetric */
+  {
+    ERRMEM (A->cp = malloc (sizeof (int [3*n+1])));
+    ERRMEM (A->ci = malloc (sizeof (int [9 * bp [n]])));
+
+    for (A->cp [0] = l = i = 0; i < n; i ++)
+    {
+      for (j = 0; j < 3; j ++)
+      {
+	for (k = bp [i]; k < bp [i+1]; k ++)
+	{
+	  A->ci [l ++] = 3 * bj [k];
+	  A->ci [l ++] = 3 * bj [k] + 1;
+	  A->ci [l ++] = 3 * bj [k] + 2;
+	}
+	A->cp [3*i+j+1] = l;
+      }
+    }
+  }
+  else
+  {
+    ERRMEM (A->bi = malloc (sizeof (double [9 * n])));
+  }
+
+  free (mark);
+}
+
+/* assemble the linearization blocks S W(i,j) + (D + delta I) [i == j]; the diagonal blocks
+ * S W(i,i) + D are passed in dat->T as computed by solve () */
+static void sparse_values (PRIVATE *A, double delta)
+{
+  double S [9], P [9], *x;
+  CON_DATA *dat;
+  OFFB *blk;
+  int i, k;
+
+  for (dat = A->dat, i = 0; i < A->nblk; dat ++, i ++)
+  {
+    for (k = A->bp [i]; k < A->bp [i+1]; k ++) SET9 (&A->bx [9*k], 0.0);
+
+    x = &A->bx [9 * A->bd [i]];
+    NNCOPY (dat->T, x);
+    x [0] += delta;
+    x [4] += delta;
+    x [8] += delta;
+
+    row_scaling (dat, S);
+
+    for (blk = dat->con->dia->adj; blk; blk = blk->n) /* W1(i,j) and W2(i,j) are stored separately */
+    {
+      x = &A->bx [9 * block_find (A, i, blk->dia->con->num)];
+      NNMUL (S, blk->W, P);
+      NNADD (x, P, x);
+    }
+  }
+}
+
+/* block ILU(0) factorization of the assembled linearization */
+static void ilu_factor (PRIVATE *A)
+{
+  int i, k, l, m, q, *bp = A->bp, *bj = A->bj, *bd = A->bd;
+  double L [9], P [9], *bx = A->bx;
+
+  for (i = 0; i < A->nblk; i ++)
+  {
+    for (k = bp [i]; k < bd [i]; k ++) /* lower blocks of row i */
+    {
+      l = bj [k];
+      NNMUL (&bx[9*k], &A->bi[9*l], L); /* L(i,l) = A(i,l) inv (U(l,l)) */
+      NNCOPY (L, &bx[9*k]);
+
+      for (m = k + 1, q = bd [l] + 1; m < bp [i+1] && q < bp [l+1];) /* A(i,j) -= L(i,l) U(l,j) within the pattern */
+      {
+	if (bj [m] < bj [q]) m ++;
+	else if (bj [m] > bj [q]) q ++;
+	else
+	{
+	  NNMUL (L, &bx[9*q], P);
+	  NNSUB (&bx[9*m], P, &bx[9*m]);
+	  m ++, q ++;
+	}
+      }
+    }
+
+    MX_DENSE_PTR (D, 3, 3, &bx[9*bd[i]]);
+    MX_DENSE_PTR (I, 3, 3, &A->bi[9*i]);
+    MX_Inverse (&D, &I);
+  }
+}
+
+/* x = inv (L U) b */
+static void ilu_solve (PRIVATE *A, double *b, double *x)
+{
+  int i, k, *bp = A->bp, *bj = A->bj, *bd = A->bd;
+  double y [3], *bx = A->bx;
+
+  for (i = 0; i < A->nblk; i ++) /* forward: L has unit diagonal blocks */
+  {
+    COPY (&b[3*i], y);
+    for (k = bp [i]; k < bd [i]; k ++) NVSUBMUL (y, &bx[9*k], &x[3*bj[k]], y);
+    COPY (y, &x[3*i]);
+  }
+
+  for (i = A->nblk - 1; i >= 0; i --) /* backward */
+  {
+    COPY (&x[3*i], y);
+    for (k = bd [i] + 1; k < bp [i+1]; k ++) NVSUBMUL (y, &bx[9*k], &x[3*bj[k]], y);
+    NVMUL (&A->bi[9*i], y, &x[3*i]);
+  }
+}
+
+/* x = inv (A) b using sparse LU factorization of the assembled linearization;
+ * the pattern does not change during a solve, hence after the first Newton
+ * step only the numeric factorization is redone */
+static void direct_solve (PRIVATE *A, double *b, double *x)
+{
+  int i, j, k, l, r, n = A->nblk, *bp = A->bp, *bt = A->bt;
+  double *bx = A->bx;
+  MX *M;
+
+  if (!A->M) A->M = MX_Create (MXCSC, 3*n, 3*n, A->cp, A->ci);
+
+  M = A->M;
+
+  for (i = l = 0; i < n; i ++) /* column block i gathers the blocks (j,i) stored in block rows j */
+  {
+    for (j = 0; j < 3; j ++)
+    {
+      for (k = bp [i]; k < bp [i+1]; k ++)
+      {
+	for (r = 0; r < 3; r ++) M->x [l ++] = bx [9*bt[k] + 3*j + r];
+      }
+    }
+  }
+
+  if (A->F) MX_Refactor (M, A->F); /* numeric CSparse LU */
+  else A->F = MX_Inverse (M, NULL); /* symbolic and numeric CSparse LU */
+
+  MX_Matvec (1.0, A->F, b, 0.0, x);
+}
+
 /* allocate vector */
 static VECTOR* newvector (int n)
 {
@@ -666,6 +930,12 @@ static int Precond (void *vdata, PRIVATE *A, VECTOR *b, VECTOR *x)
   double *T, *Q, *R;
   CON_DATA *dat;
 
+  if (A->linver == PQN_ILU)
+  {
+    ilu_solve (A, b->x, x->x);
+    return 0;
+  }
+
   for (dat = A->dat, R = x->x, Q = b->x; dat != A->end; dat ++, R += 3, Q += 3)
   {
 #if MPI
@@ -893,6 +1163,15 @@ static PRIVATE *create_private_data (NEWTON *ns, LOCDYN *ldy)
   ERRMEM (A = MEM_CALLOC (sizeof (PRIVATE)));
   A->dom = ldy->dom;
   A->ns = ns;
+  A->linver = ns->linver;
+
+  if (ns->locdyn == LOCDYN_OFF && (A->linver == PQN_DIRECT || A->linver == PQN_ILU))
+  {
+    A->linver = PQN_GMRES; /* W blocks are not assembled in body space mode */
+  }
+#if MPI
+  if (A->linver == PQN_DIRECT) A->linver = PQN_ILU; /* block ILU(0) of local rows: block Jacobi across processors */
+#endif
 
   if (ns->locdyn == LOCDYN_OFF)
   {
@@ -903,6 +1182,8 @@ static PRIVATE *create_private_data (NEWTON *ns, LOCDYN *ldy)
   }
   else locdyn_constraints_data (ldy->dom, A);
 
+  if (A->linver == PQN_DIRECT || A->linver == PQN_ILU) sparse_pattern (A);
+
   A->dr = newvector  (3 * (A->end - A->dat));
   A->rhs = CreateVector (A->dr);
 
@@ -921,6 +1202,16 @@ static void destroy_private_data (PRIVATE *A)
   free (A->a);
   DestroyVector (A->dr);
   DestroyVector (A->rhs);
+  free (A->bp);
+  free (A->bj);
+  free (A->bd);
+  free (A->bt);
+  free (A->cp);
+  free (A->ci);
+  if (A->M) MX_Destroy (A->M);
+  if (A->F) MX_Destroy (A->F);
+  free (A->bx);
+  free (A->bi);
 
 #if MPI
   SET_Free (NULL, &A->boundary);
@@ -954,7 +1245,7 @@ static int solve (PRIVATE *A, short linver, int linmaxiter, double epsilon, shor
 	   *W = dia->W,
 	   *T = dat->T;
 
-    if (linver == PQN_GMRES)
+    if (linver != PQN_DIAG)
     {
       double *RC = dat->RC;
       COPY (R, RC); /* save current reaction */
@@ -1105,7 +1396,7 @@ static int solve (PRIVATE *A, short linver, int linmaxiter, double epsilon, shor
 	SCF_Project (con->mat.base->friction, c, R, R); /* projection */
       }
     }
-    else /* PQN_GMRES */
+    else if (linver == PQN_GMRES)
     {
       T [0] += delta;
       T [4] += delta;
@@ -1116,7 +1407,20 @@ static int solve (PRIVATE *A, short linver, int linmaxiter, double epsilon, shor
     }
   }
 
-  if (linver == PQN_GMRES)
+  if (linver == PQN_DIRECT || linver == PQN_ILU)
+  {
+    sparse_values (A, delta);
+
+    if (linver == PQN_ILU) ilu_factor (A);
+    else
+    {
+      direct_solve (A, rhs->x, dr->x); /* sparse LU solve */
+      A->matvec ++;
+      iters = 1;
+    }
+  }
+
+  if (linver == PQN_GMRES || linver == PQN_ILU)
   {
     hypre_FlexGMRESFunctions *gmres_functions;
     void *gmres_vdata;
@@ -1142,7 +1446,10 @@ static int solve (PRIVATE *A, short linver, int linmaxiter, double epsilon, shor
     /* ret = */ hypre_FlexGMRESSolve (gmres_vdata, A, rhs, dr); /* GMRES solve */
     hypre_FlexGMRESGetNumIterations (gmres_vdata , &iters);
     hypre_FlexGMRESDestroy (gmres_vdata);
+  }
 
+  if (linver != PQN_DIAG)
+  {
     for (dat = A->dat, DR = dr->x; dat != A->end; dat ++, DR += 3)
     {
       CON *con = dat->con;
@@ -1180,7 +1487,7 @@ static void restore_initial_R (PRIVATE *A)
   }
 }
 
-/* GMRES based solver */
+/* GMRES or sparse direct based solver */
 static int gmres_based_solve (PRIVATE *A, NEWTON *ns, LOCDYN *ldy)
 {
   double *merit, step;
@@ -1200,7 +1507,7 @@ static int gmres_based_solve (PRIVATE *A, NEWTON *ns, LOCDYN *ldy)
 
   while (ns->iters < ns->maxiter && A->matvec < ns->maxmatvec && *merit > ns->meritval)
   {
-    solve (A, PQN_GMRES, ns->linmaxiter, ns->epsilon, dynamic, step, ns->delta * ns->W_norm, 0.0, ns->omega, A->dr, A->rhs);
+    solve (A, A->linver, ns->linmaxiter, ns->epsilon, dynamic, step, ns->delta * ns->W_norm, 0.0, ns->omega, A->dr, A->rhs);
 
     U_WR_B (A, 0);
 
@@ -1347,7 +1654,9 @@ void NEWTON_Solve (NEWTON *ns, LOCDYN *ldy)
 
   switch (ns->linver)
   {
-  case PQN_GMRES: ret = gmres_based_solve (A, ns, ldy); break;
+  case PQN_GMRES:
+  case PQN_DIRECT:
+  case PQN_ILU: ret = gmres_based_solve (A, ns, ldy); break;
   case PQN_DIAG: ret = diagonalized_solve (A, ns, ldy); break;
   }
 
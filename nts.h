@@ -36,7 +36,8 @@ struct newton
 
   enum {LOCDYN_ON, LOCDYN_OFF} locdyn; /* local dynamics assembling */
 
-  enum {PQN_GMRES, PQN_DIAG} linver; /* linear solver version */
+  enum {PQN_GMRES, PQN_DIAG, PQN_DIRECT, PQN_ILU} linver; /* linear solver version: GMRES with block diagonal preconditioner,
+                                                            diagonalized, sparse direct, GMRES with block ILU(0) preconditioner */
 
   int linmaxiter; /* linear solver iterations bound */
 
@@ -51,6 +51,39 @@ inline static CON** ompu_constraints (DOM *dom, int *n)
   return pcon;
 }
 
+inline static BODY** ompu_rigid_bodies (DOM *dom, int *n)
+{
+  int j = 0;
+  BODY **pbod, *bod;
+  for (bod = dom->bod; bod; bod = bod->next) if (bod->kind == OBS || bod->kind == RIG) j ++;
+  *n = j;
+  ERRMEM (pbod = malloc ((*n) * sizeof(BODY*)));
+  for (bod = dom->bod, j = 0; bod; bod = bod->next) if (bod->kind == OBS || bod->kind == RIG) pbod[j++] = bod;
+  return pbod;
+}
+
+inline static DIAB** ompu_contacts (LOCDYN *ldy, int *n)
+{
+  int j = 0;
+  DIAB **pdia, *dia;
+  for (dia = ldy->dia; dia; dia = dia->n) if (dia->con->kind == CONTACT) j ++;
+  *n = j;
+  ERRMEM (pdia = malloc ((*n) * sizeof(DIAB*)));
+  for (dia = ldy->dia, j = 0; dia; dia = dia->n) if (dia->con->kind == CONTACT) pdia[j++] = dia;
+  return pdia;
+}
+
+inline static DIAB** ompu_blocks (LOCDYN *ldy, int *n)
+{
+  int j = 0;
+  DIAB **pdia, *dia;
+  for (dia = ldy->dia; dia; dia = dia->n) j ++;
+  *n = j;
+  ERRMEM (pdia = malloc ((*n) * sizeof(DIAB*)));
+  for (dia = ldy->dia, j = 0; dia; dia = dia->n, j++) pdia[j] = dia;
+  return pdia;
+}
+
 inline static FACE** ompu_faces (MESH *msh, int *n)
 {
   int j = 0;
@@ -62,6 +95,18 @@ inline static FACE** ompu_faces (MESH *msh, int *n)
   return pfac;
 }
 
+inline static CON** ompu_body_constraints (BODY *bod, int *n)
+{
+  int j = 0;
+  CON **pcon;
+  SET *item;
+  for (item = SET_First (bod->con); item; item = SET_Next (item)) j ++;
+  *n = j;
+  ERRMEM (pcon = malloc ((*n) * sizeof(CON*)));
+  for (item = SET_First (bod->con), j = 0; item; item = SET_Next (item), j++) pcon[j] = item->data;
+  return pcon;
+}
+
 inline static ELEMENT** ompu_elements (MESH *msh, int *n)
 {
   int j;
@@ -96,3 +141,60 @@ inline static void ompu_locks_free (omp_lock_t *locks, int n)
   for (int j = 0; j < n; j ++) omp_destroy_lock (&locks[j]);
   free (locks);
 }
+
+inline static int ompu_threads (void)
+{
+  int threads = 1;
+  #pragma omp parallel
+  #pragma omp master
+  threads = omp_get_num_threads();
+  return threads;
+}
+
+/* per-thread accumulation buffers: thread i accumulates into buf + i * size */
+inline static double* ompu_buffers (int threads, int size)
+{
+  double *buf;
+  ERRMEM (buf = calloc (threads * size, sizeof (double)));
+  return buf;
+}
+
+/* per-thread accumulation buffers kept in *buf of allocated length *bufsize between calls;
+ * thread i accumulates into *buf + i * size; the buffers are zero outside of accumulation */
+inline static double* ompu_kept_buffers (double **buf, int *bufsize, int threads, int size)
+{
+  if (*bufsize < threads * size)
+  {
+    free (*buf);
+    ERRMEM (*buf = calloc (threads * size, sizeof (double)));
+    *bufsize = threads * size;
+  }
+  return *buf;
+}
+
+/* out += SUM_i (buf + i * size) as below, but buf is zeroed for reuse rather than freed */
+inline static void ompu_kept_buffers_reduce (double *buf, int threads, int size, double *out)
+{
+  int j;
+  #pragma omp parallel for
+  for (j = 0; j < size; j ++)
+  {
+    double sum = 0.0;
+    for (int i = 0; i < threads; i ++) sum += buf [i * size + j], buf [i * size + j] = 0.0;
+    out [j] += sum;
+  }
+}
+
+/* out += SUM_i (buf + i * size), summed in the thread order so that results do not depend on timing; buf is freed */
+inline static void ompu_buffers_reduce (double *buf, int threads, int size, double *out)
+{
+  int j;
+  #pragma omp parallel for
+  for (j = 0; j < size; j ++)
+  {
+    double sum = 0.0;
+    for (int i = 0; i < threads; i ++) sum += buf [i * size + j];
+    out [j] += sum;
+  }
+  free (buf);
+}
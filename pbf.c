@@ -19,6 +19,11 @@
  * You should have received a copy of the GNU Lesser General Public
  * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
 
+#if POSIX
+#define _XOPEN_SOURCE 500 /* fileno, mmap */
+#define _LARGEFILE64_SOURCE /* fseeko64, ftello64 */
+#endif
+
 #if MPI
 #include <mpi.h>
 #endif
@@ -42,6 +47,105 @@ static hid_t gmake (hid_t loc_id, const char *name)
   else return H5Gcreate (loc_id, name, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
 }
 
+#if PBF_COLLECTIVE
+/* write this rank's segment of a shared dataset; collective call */
+static void write_segment (PBF *bf, const char *name, hid_t type, void *value, int length)
+{
+  hid_t dset, fspc, mspc, dxpl;
+  hsize_t total, start, count;
+  int *offs, i;
+
+  ERRMEM (offs = malloc (sizeof (int [bf->size+1])));
+  MPI_Allgather (&length, 1, MPI_INT, offs+1, 1, MPI_INT, MPI_COMM_WORLD);
+  for (offs [0] = i = 0; i < bf->size; i ++) offs [i+1] += offs [i];
+
+  total = offs [bf->size] > 0 ? offs [bf->size] : 1; /* avoid empty datasets */
+  start = offs [bf->rank];
+  count = length > 0 ? length : 1;
+
+  ASSERT ((fspc = H5Screate_simple (1, &total, NULL)) >= 0, ERR_PBF_WRITE);
+  ASSERT ((mspc = H5Screate_simple (1, &count, NULL)) >= 0, ERR_PBF_WRITE);
+  ASSERT ((dset = H5Dcreate (bf->stack [bf->top], name, type, fspc, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)) >= 0, ERR_PBF_WRITE);
+  ASSERT (H5LTset_attribute_int (bf->stack [bf->top], name, "OFFSETS", offs, bf->size+1) >= 0, ERR_PBF_WRITE);
+
+  if (length > 0)
+  {
+    ASSERT (H5Sselect_hyperslab (fspc, H5S_SELECT_SET, &start, NULL, &count, NULL) >= 0, ERR_PBF_WRITE);
+  }
+  else /* ranks without data take part in the collective write too */
+  {
+    H5Sselect_none (fspc);
+    H5Sselect_none (mspc);
+    value = &count;
+  }
+
+  ASSERT ((dxpl = H5Pcreate (H5P_DATASET_XFER)) >= 0, ERR_PBF_WRITE);
+  H5Pset_dxpl_mpio (dxpl, H5FD_MPIO_COLLECTIVE);
+  ASSERT (H5Dwrite (dset, type, mspc, fspc, dxpl, value) >= 0, ERR_PBF_WRITE);
+
+  H5Pclose (dxpl);
+  H5Dclose (dset);
+  H5Sclose (mspc);
+  H5Sclose (fspc);
+  free (offs);
+}
+#endif
+
+/* read this rank's segment of a shared dataset */
+static void read_segment (PBF *bf, const char *name, hid_t type, void *value, int length)
+{
+  hid_t dset, fspc, mspc;
+  hsize_t start, count;
+  int *offs;
+
+  ERRMEM (offs = malloc (sizeof (int [bf->size+1])));
+  ASSERT (H5LTget_attribute_int (bf->stack [bf->top], name, "OFFSETS", offs) >= 0, ERR_PBF_READ);
+  ASSERT (offs [bf->rank+1] - offs [bf->rank] == length, ERR_PBF_READ);
+
+  if (length > 0)
+  {
+    start = offs [bf->rank];
+    count = length;
+
+    ASSERT ((dset = H5Dopen (bf->stack [bf->top], name, H5P_DEFAULT)) >= 0, ERR_PBF_READ);
+    ASSERT ((fspc = H5Dget_space (dset)) >= 0, ERR_PBF_READ);
+    ASSERT ((mspc = H5Screate_simple (1, &count, NULL)) >= 0, ERR_PBF_READ);
+    ASSERT (H5Sselect_hyperslab (fspc, H5S_SELECT_SET, &start, NULL, &count, NULL) >= 0, ERR_PBF_READ);
+    ASSERT (H5Dread (dset, type, mspc, fspc, H5P_DEFAULT, value) >= 0, ERR_PBF_READ);
+
+    H5Sclose (mspc);
+    H5Sclose (fspc);
+    H5Dclose (dset);
+  }
+
+  free (offs);
+}
+
+/* find label in packed labels of a collective file */
+static int find_label (PBF *bf, const char *label)
+{
+  int pos, len, n, found = 0;
+
+  for (pos = 0; pos < bf->lints; pos += len + 3) /* (length, characters, ipos, dpos) records, as packed by pack_string */
+  {
+    len = bf->l [pos]; /* including the terminating zero */
+
+    for (n = 0; n < len; n ++)
+    {
+      if ((char) bf->l [pos+1+n] != label [n]) break;
+    }
+
+    if (n == len) /* the last record wins, as with overwritten attributes */
+    {
+      bf->ipos = bf->l [pos+1+len];
+      bf->dpos = bf->l [pos+2+len];
+      found = 1;
+    }
+  }
+
+  return found;
+}
+
 /* push new frame group */
 static void new_frame (PBF *bf, int frame, double *time)
 {
@@ -50,7 +154,11 @@ static void new_frame (PBF *bf, int frame, double *time)
   while (bf->top > 0) PBF_Pop (bf);
   snprintf (name, 128, "/%d", frame);
   PBF_Push (bf, name);
-  PBF_Double2 (bf, "time", time, 1);
+  if (bf->mode == PBF_WRITE) /* the same on all ranks of a collective file */
+  {
+    ASSERT (H5LTset_attribute_double (bf->stack [bf->top], ".", "time", time, 1) >= 0, ERR_PBF_WRITE);
+  }
+  else ASSERT (H5LTget_attribute_double (bf->stack [bf->top], ".", "time", time) >= 0, ERR_PBF_READ);
   bf->frame = frame;
 }
 
@@ -73,6 +181,14 @@ static void read_frame (PBF *bf, int frame, double *time)
   PBF_Int2 (bf, "doubles", &bf->doubles, 1);
   ERRMEM (bf->d = malloc (sizeof (double [bf->doubles])));
   PBF_Double2 (bf, "d", bf->d, bf->doubles);
+
+  if (bf->size)
+  {
+    free (bf->l);
+    PBF_Int2 (bf, "lints", &bf->lints, 1);
+    ERRMEM (bf->l = malloc (sizeof (int [bf->lints])));
+    PBF_Int2 (bf, "l", bf->l, bf->lints);
+  }
 }
 
 /* write last frame data */
@@ -82,6 +198,11 @@ static void write_frame (PBF *bf)
   PBF_Int2 (bf, "i", bf->i, bf->ipos);
   PBF_Int2 (bf, "doubles", &bf->dpos, 1);
   PBF_Double2 (bf, "d", bf->d, bf->dpos);
+  if (bf->size)
+  {
+    PBF_Int2 (bf, "lints", &bf->lpos, 1);
+    PBF_Int2 (bf, "l", bf->l, bf->lpos);
+  }
   ASSERT (H5LTset_attribute_int (bf->stack[0], ".", "FRAMES", &bf->frame, 1) >= 0, ERR_PBF_WRITE); /* speeds up count_time_frames */
   H5Fflush (bf->stack[0], H5F_SCOPE_GLOBAL); /* fixes Issue 55 ? */
 }
@@ -140,6 +261,7 @@ static void initialize_time_frames (PBF *bf)
 PBF* PBF_Write (const char *path, PBF_FLG append, PBF_FLG parallel)
 {
   FILE *dat;
+  hid_t fapl;
   char *txt;
   PBF *bf;
 
@@ -155,8 +277,23 @@ PBF* PBF_Write (const char *path, PBF_FLG append, PBF_FLG parallel)
   bf->ipos = bf->ints = 0;
   bf->d = NULL;
   bf->dpos = bf->doubles = 0;
+  bf->l = NULL;
+  bf->lpos = bf->lints = 0;
+  bf->rank = bf->size = 0;
+  fapl = H5P_DEFAULT;
 
-#if MPI
+#if PBF_COLLECTIVE
+  if (parallel == PBF_ON) /* one file written collectively by all ranks */
+  {
+    bf->parallel = PBF_ON;
+    MPI_Comm_rank (MPI_COMM_WORLD, &bf->rank);
+    MPI_Comm_size (MPI_COMM_WORLD, &bf->size);
+    ASSERT ((fapl = H5Pcreate (H5P_FILE_ACCESS)) >= 0, ERR_PBF_WRITE);
+    H5Pset_fapl_mpio (fapl, MPI_COMM_WORLD, MPI_INFO_NULL);
+    sprintf (txt, "%s.h5", path);
+  }
+  else
+#elif MPI
   if (parallel == PBF_ON)
   {
     int rank;
@@ -176,21 +313,31 @@ PBF* PBF_Write (const char *path, PBF_FLG append, PBF_FLG parallel)
   if (append == PBF_ON && (dat = fopen (txt, "r")) != NULL) /* HDF5 is noisy if file does not exist */
   {
     fclose (dat);
-    if ((bf->stack[0] = H5Fopen(txt, H5F_ACC_RDWR, H5P_DEFAULT)) < 0)
+    if ((bf->stack[0] = H5Fopen(txt, H5F_ACC_RDWR, fapl)) < 0)
     {
+      if (fapl != H5P_DEFAULT) H5Pclose (fapl);
       free (bf);
       free (txt);
       return NULL;
     }
 
+    if (bf->size) /* the same ranks must continue a collective file */
+    {
+      int ranks;
+
+      ASSERT (H5LTget_attribute_int (bf->stack[0], ".", "RANKS", &ranks) >= 0, ERR_PBF_WRITE);
+      ASSERT_TEXT (ranks == bf->size, "Output written by %d ranks cannot be continued by %d ranks", ranks, bf->size);
+    }
+
     bf->count = count_time_frames (bf); /* count frames that have been written already */
 
     bf->frame = bf->count; /* set new frame counter */
   }
   else /* write from scratch */
   {
-    if ((bf->stack[0] = H5Fcreate(txt, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT)) < 0)
+    if ((bf->stack[0] = H5Fcreate(txt, H5F_ACC_TRUNC, H5P_DEFAULT, fapl)) < 0)
     {
+      if (fapl != H5P_DEFAULT) H5Pclose (fapl);
       free (bf);
       free (txt);
       return NULL;
@@ -198,8 +345,15 @@ PBF* PBF_Write (const char *path, PBF_FLG append, PBF_FLG parallel)
 
     bf->count = 0;
     bf->frame = 0;
+
+    if (bf->size) /* mark collective file */
+    {
+      ASSERT (H5LTset_attribute_int (bf->stack[0], ".", "RANKS", &bf->size, 1) >= 0, ERR_PBF_WRITE);
+    }
   }
 
+  if (fapl != H5P_DEFAULT) H5Pclose (fapl);
+
   bf->next = NULL;
 
   bf->path = txt;
@@ -209,10 +363,11 @@ PBF* PBF_Write (const char *path, PBF_FLG append, PBF_FLG parallel)
 
 PBF* PBF_Read (const char *path)
 {
+  int n, m, size;
   PBF *bf, *out;
   FILE *dat;
   char *txt;
-  int n, m;
+  hid_t fid;
 
   /* count input files */
   m = 0;
@@ -224,17 +379,40 @@ PBF* PBF_Read (const char *path)
     free (txt);
   } while (dat && fclose (dat) == 0 && ++ m); /* m incremented as last */
 
-  /* open input files */
+  /* check for a collective file */
+  size = 0;
+  if (m == 0)
+  {
+    ERRMEM (txt = malloc (strlen (path) + 64));
+    sprintf (txt, "%s.h5", path);
+    if ((dat = fopen (txt, "r")))
+    {
+      fclose (dat);
+      if ((fid = H5Fopen (txt, H5F_ACC_RDONLY, H5P_DEFAULT)) >= 0)
+      {
+        if (H5LTfind_attribute (fid, "RANKS"))
+	{
+	  ASSERT (H5LTget_attribute_int (fid, ".", "RANKS", &size) >= 0, ERR_PBF_READ);
+	}
+	H5Fclose (fid);
+      }
+    }
+    free (txt);
+  }
+
+  /* open input files; a collective file is opened once per rank */
   out = NULL;
-  n = m-1;
+  n = (size ? size : m) - 1;
   do
   {
     ERRMEM (txt = malloc (strlen (path) + 64));
     ERRMEM (bf = malloc (sizeof (PBF)));
     bf->mode = PBF_READ;
     bf->compression = PBF_OFF;
-    if (m) bf->parallel = PBF_ON;
+    if (m || size) bf->parallel = PBF_ON;
     else bf->parallel = PBF_OFF;
+    bf->rank = size ? n : 0;
+    bf->size = size;
 
     if (m) sprintf (txt, "%s.h5.%d", path, n);
     else sprintf (txt, "%s.h5", path);
@@ -259,6 +437,8 @@ PBF* PBF_Read (const char *path)
     bf->ipos = bf->ints = 0;
     bf->d = NULL;
     bf->dpos = bf->doubles = 0;
+    bf->l = NULL;
+    bf->lpos = bf->lints = 0;
 
     bf->top = 0; /* set to zero before frames are initialized (while loop in new_frame) */
 
@@ -299,7 +479,18 @@ void PBF_Close (PBF *bf)
     while (bf->top > 0) PBF_Pop (bf);
     H5Fclose (bf->stack[0]);
 
-    if (bf->count == 0 && bf->ipos == 0 && bf->dpos == 0) /* empty file */
+    int empty = bf->count == 0 && bf->ipos == 0 && bf->dpos == 0;
+
+#if PBF_COLLECTIVE
+    if (bf->mode == PBF_WRITE && bf->size) /* empty on all ranks; removed once */
+    {
+      int all;
+      MPI_Allreduce (&empty, &all, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+      empty = all && bf->rank == 0;
+    }
+#endif
+
+    if (empty) /* empty file */
     {
       remove (bf->path);
     }
@@ -308,6 +499,7 @@ void PBF_Close (PBF *bf)
     free (bf->path);
     free (bf->i);
     free (bf->d);
+    free (bf->l);
     free (bf);
   }
 }
@@ -322,7 +514,7 @@ void PBF_Time (PBF *bf, double *time)
     
     new_frame (bf, bf->frame, time); /* create new frame */
 
-    bf->ipos = bf->dpos = 0; /* zero buffer pointers */
+    bf->ipos = bf->dpos = bf->lpos = 0; /* zero buffer pointers */
 
     bf->time = *time;
 
@@ -338,6 +530,18 @@ int PBF_Label (PBF *bf, const char *label)
 {
   ASSERT_DEBUG (bf->top >= 1, "PBF ERROR: PBF_Time must be called before PBF_Label!\n");
 
+  if (bf->size) /* labels of a collective file are packed and written with the frame */
+  {
+    if (bf->mode == PBF_WRITE)
+    {
+      pack_string (&bf->lints, &bf->l, &bf->lpos, (char*) label);
+      pack_int (&bf->lints, &bf->l, &bf->lpos, bf->ipos);
+      pack_int (&bf->lints, &bf->l, &bf->lpos, bf->dpos);
+      return 1;
+    }
+    else return find_label (bf, label);
+  }
+
   if (bf->mode == PBF_WRITE)
   {
     hid_t g = gmake (bf->stack[1], "LABELS");
@@ -499,7 +703,15 @@ void PBF_Pop (PBF *bf)
 
 void PBF_Int2 (PBF *bf, const char *name, int *value, hsize_t length)
 {
-  if (bf->mode == PBF_WRITE)
+  if (bf->size)
+  {
+#if PBF_COLLECTIVE
+    if (bf->mode == PBF_WRITE) write_segment (bf, name, H5T_NATIVE_INT, value, length);
+    else
+#endif
+    read_segment (bf, name, H5T_NATIVE_INT, value, length);
+  }
+  else if (bf->mode == PBF_WRITE)
   {
     if (length == 1)
     {
@@ -525,7 +737,15 @@ void PBF_Int2 (PBF *bf, const char *name, int *value, hsize_t length)
 
 void PBF_Double2 (PBF *bf, const char *name, double *value, hsize_t length)
 {
-  if (bf->mode == PBF_WRITE)
+  if (bf->size)
+  {
+#if PBF_COLLECTIVE
+    if (bf->mode == PBF_WRITE) write_segment (bf, name, H5T_NATIVE_DOUBLE, value, length);
+    else
+#endif
+    read_segment (bf, name, H5T_NATIVE_DOUBLE, value, length);
+  }
+  else if (bf->mode == PBF_WRITE)
   {
     if (length == 1)
     {
@@ -697,12 +917,55 @@ unsigned int PBF_Span (PBF *bf, double t0, double t1)
 #include "err.h"
 #include "alg.h"
 
+#if POSIX
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 /* memory increment */
 #define CHUNK 1024
 
+/* maximal number of threads loading frames of parallel file sets */
+#define LOADERS 16
+
 /* memory margin */
 #define MARGIN 64
 
+/* maximal number of packed frames pending output */
+#define QUEUE 2
+
+/* DAT frame flags */
+#define RAW_FRAME 0 /* uncompressed data */
+#define CMP_FRAME 1 /* compressed data (older files) */
+#define CMP_SIZED 2 /* 4 byte big-endian uncompressed size followed by compressed data (older files) */
+#define CMP_CODED 3 /* codec header and 4 byte big-endian uncompressed size followed by compressed data */
+
+#if POSIX
+/* background output of packed frames: the simulation thread packs the
+ * current frame while the output thread compresses and writes the previous ones */
+struct pbf_queue
+{
+  pthread_t thread; /* output thread */
+  pthread_mutex_t lock; /* queue lock */
+  pthread_cond_t cond; /* queue state change */
+  PBF_FRAME *head, *tail; /* frames pending output */
+  PBF_FRAME *free; /* written frames for reuse */
+  int count; /* number of pending frames */
+  int error; /* first output error code */
+  short done; /* output thread exit flag */
+};
+
+/* concurrent loading of frames of parallel file sets */
+typedef struct pbf_loader
+{
+  pthread_mutex_t lock; /* list lock */
+  PBF *item; /* next file to be loaded */
+  int error; /* first load error code */
+} PBF_LOADER;
+#endif
+
 /* DAT file format:
  * ----------------
  *  [FRAME_0]
@@ -712,6 +975,11 @@ unsigned int PBF_Span (PBF *bf, double t0, double t1)
  * ----------
  *  FRAME_i:
  * -------------------
+ *    [FLAG] (char) {RAW_FRAME, CMP_FRAME, CMP_SIZED or CMP_CODED}
+ *    [ALG] (char) {CMP_ALG codec; CMP_CODED only}
+ *    [LEVEL] (char) {compression level; CMP_CODED only}
+ *    [SHUFFLE] (char) {byte shuffling element size; CMP_CODED only}
+ *    [SIZE] (4 bytes) {uncompressed size; CMP_SIZED and CMP_CODED only}
  *    [UNLABELED_DATA]
  *    [LABELED_0]
  *    [LABELED_1]
@@ -758,64 +1026,152 @@ unsigned int PBF_Span (PBF *bf, double t0, double t1)
  * ----------
  */
 
-/* write to data file */
-static u_int fileread (char **mem, u_int size, FILE *f)
+/* TIX file format:
+ * ----------------
+ *  [MARKER_0]
+ *  [MARKER_1]
+ *  ...
+ *  [MARKER_N]
+ *  [MARKER_INF]
+ * ----------
+ *  MARKER_i:
+ * -------------------------------
+ *  [TIME] (double) {time of FRAME_i or DBL_MAX}
+ *  [IPOS] (u_int) {position of IDX_0 of FRAME_i (or of the INF marker) in IDX file}
+ *  [DOFF] (uint64_t) {offest of FRAME_i in DAT file}
+ * ----------------------------------
+ * a persisted copy of the markers table, written along with the IDX
+ * file or, for older outputs, when they are read for the first time
+ */
+
+/* make sure READ mode memory can store 'size' bytes */
+static void readmem (PBF *bf, u_int size)
 {
-  char cmp;
+  if (size > (u_int) bf->memsize)
+  {
+    free (bf->mem);
+    bf->memsize = size;
+    ERRMEM (bf->mem = malloc (size));
+  }
+}
 
-  fread (&cmp, 1, 1, f); /* read 1 byte */
+/* read from data file; output uncompressed frame data (either in the mapped
+ * file or in bf->mem) and its size; return zero or an error code (may run on a loading thread) */
+static int fileread (PBF *bf, int frm, char **data, u_int *length)
+{
+  uint64_t doff = bf->mtab [frm].doff;
+  u_int size = bf->mtab [frm+1].doff - doff;
+  unsigned char *head;
+  char *inp, *buf;
+  int outsize, error = 0;
 
-  size --; /* subtract 1 byte */
+  if (size == 0) return ERR_PBF_INDEX_FILE_CORRUPTED;
 
-  if (cmp)
+#if POSIX
+  if (bf->dmap) /* zero-copy access */
   {
-    int maxout, outsize;
-    char *inp;
+    if (doff + size > bf->dlen) return ERR_PBF_INDEX_FILE_CORRUPTED;
+    inp = bf->dmap + doff;
+    buf = NULL;
+  }
+  else
+#endif
+  {
+    ERRMEM (buf = malloc (size));
+    FSEEK (bf->dat, (OFF_T) doff, SEEK_SET);
+    if (fread (buf, 1, size, bf->dat) != size)
+    {
+      free (buf);
+      return ERR_PBF_READ;
+    }
+    inp = buf;
+  }
 
-    ERRMEM (inp = malloc (size));
-    ASSERT (fread (inp, 1, size, f) == size, ERR_PBF_READ);
-    maxout = 2 * size;
-    do
+  switch (inp [0])
+  {
+  case RAW_FRAME:
+  {
+    if (buf) /* keep the read buffer */
     {
-      maxout *= 2;
-      free (*mem);
-      ERRMEM (*mem = malloc (maxout));
-      outsize = fastlz_decompress (inp, size, *mem, maxout);
-    } while (outsize == 0);
-    size = outsize;
-    free (inp);
+      free (bf->mem);
+      bf->mem = buf;
+      bf->memsize = size;
+      buf = NULL;
+    }
+    *length = size - 1;
+    *data = inp + 1;
   }
-  else
+  break;
+  case CMP_SIZED:
+  {
+    if (size <= 5) { error = ERR_PBF_READ; break; }
+    head = (unsigned char*) inp + 1;
+    *length = ((u_int)head[0] << 24) | ((u_int)head[1] << 16) | ((u_int)head[2] << 8) | (u_int)head[3];
+    readmem (bf, *length);
+    outsize = fastlz_decompress (inp + 5, size - 5, bf->mem, bf->memsize);
+    if (outsize != (int) *length) error = ERR_PBF_READ;
+    *data = bf->mem;
+  }
+  break;
+  case CMP_CODED:
   {
-    free (*mem);
-    ERRMEM (*mem = malloc (size));
-    ASSERT (fread (*mem, 1, size, f) == size, ERR_PBF_READ);
+    if (size <= 8) { error = ERR_PBF_READ; break; }
+    head = (unsigned char*) inp + 1;
+    *length = ((u_int)head[3] << 24) | ((u_int)head[4] << 16) | ((u_int)head[5] << 8) | (u_int)head[6];
+    readmem (bf, *length);
+    outsize = CMP_Decode (head[0], head[2], inp + 8, size - 8, bf->mem, *length);
+    if (outsize != (int) *length) error = ERR_PBF_READ;
+    *data = bf->mem;
   }
+  break;
+  case CMP_FRAME: /* uncompressed size unknown */
+  {
+    readmem (bf, 4 * size);
+    while ((outsize = fastlz_decompress (inp + 1, size - 1, bf->mem, bf->memsize)) == 0)
+    {
+      readmem (bf, 2 * bf->memsize);
+    }
+    *length = outsize;
+    *data = bf->mem;
+  }
+  break;
+  default:
+    error = ERR_PBF_READ;
+  }
+
+  free (buf);
 
-  return size;
+  return error;
 }
 
-/* read from data file */
-static void filewrite (char *mem, u_int size, FILE *f, char cmp)
+/* write to data file; return zero or an error code (may run on the output thread) */
+static int filewrite (char *mem, u_int size, FILE *f, PBF_FLG cmp, CMP_CODEC *codec)
 {
-  if (cmp && size < 16) cmp = 0;  /* see ext/fastlz.h */
-
-  fwrite (&cmp, 1, 1, f); /* write compresion flag (adds 1 byte per frame) */
-
-  if (cmp)
+  if (cmp == PBF_ON && codec->alg != CMP_OFF)
   {
-    int nbuf, num;
+    unsigned char head [8] = {CMP_CODED, codec->alg, codec->level, codec->shuffle, size >> 24, size >> 16, size >> 8, size};
+    int nbuf, num, error;
     char *out;
 
-    nbuf = 2 * MAX (size, 66); /* see ext/fastlz.h */
-    ERRMEM (out = malloc (nbuf));
-    num = fastlz_compress (mem, size, out);
-    WARNING (num < (int)size, "Compression increased the buffer size => Consider disabling it.");
-    ASSERT_TEXT (num < nbuf, "Compression increased the buffer size by more than 100%%.");
-    ASSERT (fwrite (out, 1, num, f) == (unsigned)num, ERR_PBF_WRITE);
-    free (out);
+    nbuf = CMP_Bound (size);
+    if (!(out = malloc (nbuf))) return ERR_OUT_OF_MEMORY;
+
+    if ((num = CMP_Encode (codec, mem, size, out, nbuf)) > 0)
+    {
+      /* codec header and uncompressed size allow single pass decompression */
+      error = (fwrite (head, 1, 8, f) == 8 && fwrite (out, 1, num, f) == (unsigned)num) ? 0 : ERR_PBF_WRITE;
+      free (out);
+      return error;
+    }
+
+    free (out); /* compression would not reduce the size: write raw data */
   }
-  else ASSERT (fwrite (mem, 1, size, f) == size, ERR_PBF_WRITE);
+
+  /* write raw data flag (adds 1 byte per frame) */
+  char flag = RAW_FRAME;
+  if (fwrite (&flag, 1, 1, f) != 1) return ERR_PBF_WRITE;
+
+  return fwrite (mem, 1, size, f) == size ? 0 : ERR_PBF_WRITE;
 }
 
 /* grow memory buffer in WRITE mode */
@@ -833,44 +1189,184 @@ static void growmem (PBF *bf, u_int nb)
   xdrmem_create (&bf->x_dat, bf->mem + bf->membase, bf->memsize - bf->membase, XDR_ENCODE);
 }
 
-/* initialize a frame to be red */
-static void initialise_frame (PBF *bf, int frm)
+/* load a frame to be red; return zero or an error code (may run on a loading thread) */
+static int load_frame (PBF *bf, int frm)
 {
   PBF_LABEL *l;
-  int index;
+  int index, error;
 
   bf->cur = frm; /* set current frame */
   bf->time = bf->mtab [frm].time; /* and time */
 
   /* create new memory XDR stream for DATA chunk */
-  bf->memsize = bf->mtab [frm+1].doff - bf->mtab [frm].doff;
-  FSEEK (bf->dat, (OFF_T) bf->mtab [frm].doff, SEEK_SET);
-  bf->memsize = fileread (&bf->mem, bf->memsize, bf->dat);
+  char *data;
+  u_int length;
+  if ((error = fileread (bf, frm, &data, &length))) return error;
   xdr_destroy (&bf->x_dat);
-  xdrmem_create (&bf->x_dat, bf->mem, bf->memsize, XDR_DECODE);
+  xdrmem_create (&bf->x_dat, data, length, XDR_DECODE);
 
-  /* empty current labels set */
-  MAP_Free (&bf->mappool, &bf->labels);
- 
-  /* seek to the frame in IDX file */ 
-  ASSERT (xdr_setpos (&bf->x_idx, bf->mtab [frm].ipos), ERR_PBF_INDEX_FILE_CORRUPTED);
+  /* seek to the frame in IDX file */
+  if (!xdr_setpos (&bf->x_idx, bf->mtab [frm].ipos)) return ERR_PBF_INDEX_FILE_CORRUPTED;
 
-  /* read labels */
-  ASSERT (xdr_int (&bf->x_idx, &index), ERR_PBF_INDEX_FILE_CORRUPTED);
+  /* read labels; labels are mapped once per file and
+   * here only stamped with the current frame number */
+  if (!xdr_int (&bf->x_idx, &index)) return ERR_PBF_INDEX_FILE_CORRUPTED;
   while (index >= 0)
   {
-    ASSERT (index < bf->lsize, ERR_PBF_INDEX_FILE_CORRUPTED);
+    if (index >= bf->lsize) return ERR_PBF_INDEX_FILE_CORRUPTED;
     l = &bf->ltab [index];
 
-    /* map label as current one */
-    MAP_Insert (&bf->mappool, &bf->labels, l->name, l, (MAP_Compare) strcmp);
-
     /* read position */
-    ASSERT (xdr_u_int (&bf->x_idx, &l->dpos), ERR_PBF_INDEX_FILE_CORRUPTED);
+    if (!xdr_u_int (&bf->x_idx, (u_int*) &l->dpos)) return ERR_PBF_INDEX_FILE_CORRUPTED;
+
+    /* mark label as current one */
+    l->frame = frm;
 
     /* get next label */
-    ASSERT (xdr_int (&bf->x_idx, &index), ERR_PBF_INDEX_FILE_CORRUPTED);
+    if (!xdr_int (&bf->x_idx, &index)) return ERR_PBF_INDEX_FILE_CORRUPTED;
+  }
+
+  return 0;
+}
+
+/* initialize a frame to be red */
+static void initialise_frame (PBF *bf, int frm)
+{
+  int error = load_frame (bf, frm);
+
+  ASSERT (error == 0, error);
+}
+
+#if POSIX
+/* loading thread loop */
+static void* load_thread (void *data)
+{
+  PBF_LOADER *ld = data;
+  int error;
+  PBF *bf;
+
+  for (;;)
+  {
+    pthread_mutex_lock (&ld->lock);
+    if ((bf = ld->item)) ld->item = bf->next;
+    pthread_mutex_unlock (&ld->lock);
+
+    if (!bf) break;
+
+    if ((error = load_frame (bf, bf->seek)))
+    {
+      pthread_mutex_lock (&ld->lock);
+      if (!ld->error) ld->error = error;
+      pthread_mutex_unlock (&ld->lock);
+    }
+  }
+
+  return NULL;
+}
+
+/* load frames of a parallel file set concurrently; return zero or the first error code */
+static int load_concurrently (PBF *bf)
+{
+  pthread_t thread [LOADERS];
+  PBF_LOADER ld;
+  int n, k, m;
+  PBF *f;
+
+  for (n = 0, f = bf; f; f = f->next) n ++;
+  n = MIN (n, LOADERS);
+  n = MIN (n, (int) sysconf (_SC_NPROCESSORS_ONLN));
+
+  pthread_mutex_init (&ld.lock, NULL);
+  ld.item = bf;
+  ld.error = 0;
+
+  for (k = m = 0; k < n - 1; k ++) /* the calling thread is the last loader */
+  {
+    if (pthread_create (&thread [m], NULL, load_thread, &ld) == 0) m ++;
   }
+
+  load_thread (&ld);
+
+  for (k = 0; k < m; k ++) pthread_join (thread [k], NULL);
+
+  pthread_mutex_destroy (&ld.lock);
+
+  return ld.error;
+}
+#endif
+
+/* load the 'seek' frames of all files in the list */
+static void load_frames (PBF *bf)
+{
+  int error = 0;
+
+#if POSIX
+  if (bf->next) error = load_concurrently (bf);
+  else
+#endif
+  for (; bf && !error; bf = bf->next) error = load_frame (bf, bf->seek);
+
+  ASSERT (error == 0, error);
+}
+
+/* read persisted time index; return 1 on success or 0 if it is missing or does not match the IDX file */
+static int read_time_index (PBF *bf)
+{
+  int num, siz, done, index;
+  u_int ipos;
+  FILE *tix;
+  XDR x;
+
+  if (!(tix = fopen (bf->tph, "r"))) return 0;
+
+  xdrstdio_create (&x, tix, XDR_DECODE);
+  num = 0; siz = CHUNK; done = 0;
+  ERRMEM (bf->mtab = malloc (sizeof (PBF_MARKER) * siz));
+  while (xdr_double (&x, &bf->mtab [num].time) &&
+         xdr_u_int (&x, &ipos) &&
+         xdr_uint64_t (&x, &bf->mtab [num].doff))
+  {
+    bf->mtab [num].ipos = ipos;
+    if ((done = bf->mtab [num].time == DBL_MAX)) break; /* infinite frame */
+    if (++ num >= siz) { siz += CHUNK; ERRMEM (bf->mtab = realloc (bf->mtab, sizeof (PBF_MARKER) * siz)); }
+  }
+  xdr_destroy (&x);
+  fclose (tix);
+
+  /* the infinite frame marker must also close the IDX file */
+  if (done && xdr_setpos (&bf->x_idx, bf->mtab [num].ipos) && xdr_int (&bf->x_idx, &index) && index == -2)
+  {
+    bf->mtab = realloc (bf->mtab, sizeof (PBF_MARKER) * (num + 1)); /* shrink */
+    bf->msize = num;
+    return 1;
+  }
+
+  free (bf->mtab);
+  bf->mtab = NULL;
+  return 0;
+}
+
+/* persist time index of older outputs; failures (e.g. read-only directories) are ignored */
+static void write_time_index (PBF *bf)
+{
+  u_int ipos;
+  FILE *tix;
+  XDR x;
+  int k;
+
+  if (!(tix = fopen (bf->tph, "w"))) return;
+
+  xdrstdio_create (&x, tix, XDR_ENCODE);
+  for (k = 0; k <= bf->msize; k ++)
+  {
+    ipos = bf->mtab [k].ipos;
+    if (!xdr_double (&x, &bf->mtab [k].time) ||
+        !xdr_u_int (&x, &ipos) ||
+        !xdr_uint64_t (&x, &bf->mtab [k].doff)) break;
+  }
+  xdr_destroy (&x);
+
+  if (fclose (tix) != 0 || k <= bf->msize) remove (bf->tph);
 }
 
 /* initialise labels and time index */
@@ -878,7 +1374,7 @@ static void initialise_reading (PBF *bf)
 {
   int index, num, siz;
   u_int dpos;
-  
+
   /* create labels table */
   num = 0; siz = CHUNK;
   ERRMEM (bf->ltab = malloc (sizeof (PBF_LABEL) * siz));
@@ -888,82 +1384,290 @@ static void initialise_reading (PBF *bf)
     if (xdr_string (&bf->x_lab, &bf->ltab [num].name, PBF_MAXSTRING))
     {
       bf->ltab [num].index = num;
+      bf->ltab [num].frame = -1;
       if (++ num >= siz) { siz += CHUNK; ERRMEM (bf->ltab = realloc (bf->ltab, sizeof (PBF_LABEL) * siz)); }
     }
     else break;
   }
   bf->ltab = realloc (bf->ltab, sizeof (PBF_LABEL) * num); /* shrink */
   bf->lsize = num;
-  
-  /* create markers table */
-  num = 0; siz = CHUNK;
-  ERRMEM (bf->mtab = malloc (sizeof (PBF_MARKER) * siz));
-  while (! feof (bf->idx))
+
+  /* map labels once */
+  for (index = 0; index < num; index ++)
   {
-    /* time and unlabeled data position */
-    ASSERT (xdr_double (&bf->x_idx, &bf->mtab [num].time), ERR_PBF_INDEX_FILE_CORRUPTED);
-    ASSERT (xdr_uint64_t (&bf->x_idx, &bf->mtab [num].doff), ERR_PBF_INDEX_FILE_CORRUPTED);
-    bf->mtab [num].ipos = xdr_getpos (&bf->x_idx);
+    MAP_Insert (&bf->mappool, &bf->labels, bf->ltab [index].name, &bf->ltab [index], (MAP_Compare) strcmp);
+  }
 
-    /* skip labels */
-    ASSERT (xdr_int (&bf->x_idx, &index), ERR_PBF_INDEX_FILE_CORRUPTED);
-    while (index >= 0)
+  /* read persisted markers table or create it by scanning the index file */
+  if (!read_time_index (bf))
+  {
+    ASSERT (xdr_setpos (&bf->x_idx, 0), ERR_PBF_INDEX_FILE_CORRUPTED);
+    num = 0; siz = CHUNK;
+    ERRMEM (bf->mtab = malloc (sizeof (PBF_MARKER) * siz));
+    while (! feof (bf->idx))
     {
-      ASSERT (index < bf->lsize, ERR_PBF_INDEX_FILE_CORRUPTED);
-      ASSERT (xdr_u_int (&bf->x_idx, &dpos), ERR_PBF_INDEX_FILE_CORRUPTED);
-      ASSERT (xdr_int (&bf->x_idx, &index), ERR_PBF_INDEX_FILE_CORRUPTED); 
+      /* time and unlabeled data position */
+      ASSERT (xdr_double (&bf->x_idx, &bf->mtab [num].time), ERR_PBF_INDEX_FILE_CORRUPTED);
+      ASSERT (xdr_uint64_t (&bf->x_idx, &bf->mtab [num].doff), ERR_PBF_INDEX_FILE_CORRUPTED);
+      bf->mtab [num].ipos = xdr_getpos (&bf->x_idx);
+
+      /* skip labels */
+      ASSERT (xdr_int (&bf->x_idx, &index), ERR_PBF_INDEX_FILE_CORRUPTED);
+      while (index >= 0)
+      {
+	ASSERT (index < bf->lsize, ERR_PBF_INDEX_FILE_CORRUPTED);
+	ASSERT (xdr_u_int (&bf->x_idx, &dpos), ERR_PBF_INDEX_FILE_CORRUPTED);
+	ASSERT (xdr_int (&bf->x_idx, &index), ERR_PBF_INDEX_FILE_CORRUPTED);
+      }
+
+      if (index == -2) break; /* infinite frame */
+
+      if (++ num >= siz) { siz += CHUNK; ERRMEM (bf->mtab = realloc (bf->mtab, sizeof (PBF_MARKER) * siz)); }
     }
+    ASSERT (index == -2, ERR_PBF_INDEX_FILE_CORRUPTED);
+    bf->mtab = realloc (bf->mtab, sizeof (PBF_MARKER) * (num + 1)); /* shrink (add INF frame) */
+    bf->msize = num;
 
-    if (index == -2) break; /* infinite frame */
-    
-    if (++ num >= siz) { siz += CHUNK; ERRMEM (bf->mtab = realloc (bf->mtab, sizeof (PBF_MARKER) * siz)); }
+    write_time_index (bf);
   }
-  ASSERT (index == -2, ERR_PBF_INDEX_FILE_CORRUPTED);
-  bf->mtab = realloc (bf->mtab, sizeof (PBF_MARKER) * (num + 1)); /* shrink (add INF frame) */
-  bf->msize = num;
 
   /* read first frame */
   initialise_frame (bf, 0);
 }
 
-/* write last frame data */
-static void write_frame (PBF *bf)
+/* write packed frame index and data; return zero or an error code (may run on the output thread) */
+static int write_frame (PBF *bf, PBF_FRAME *frm)
 {
-  if (xdr_getpos (&bf->x_idx) > 0)
+  uint64_t doff = (uint64_t) FTELL (bf->dat);
+  int index = -1, i;
+  u_int ipos;
+
+  /* output time and data position */
+  if (!xdr_double (&bf->x_idx, &frm->time) ||
+      !xdr_uint64_t (&bf->x_idx, &doff)) return ERR_PBF_WRITE;
+
+  /* output time index marker */
+  ipos = xdr_getpos (&bf->x_idx);
+  if (!xdr_double (&bf->x_tix, &frm->time) ||
+      !xdr_u_int (&bf->x_tix, &ipos) ||
+      !xdr_uint64_t (&bf->x_tix, &doff)) return ERR_PBF_WRITE;
+
+  /* output labels and their positions */
+  for (i = 0; i < frm->lsize; i += 2)
   {
-    /* mark end of frame labels */
-    int index = -1;
-    ASSERT (xdr_int (&bf->x_idx, &index), ERR_PBF_WRITE);
+    if (!xdr_int (&bf->x_idx, &frm->lrec [i]) ||
+        !xdr_u_int (&bf->x_idx, (u_int*) &frm->lrec [i+1])) return ERR_PBF_WRITE;
+  }
 
-    /* write from XDR stream to file */
-    filewrite (bf->mem, bf->membase + xdr_getpos (&bf->x_dat),
-	       bf->dat, bf->compression == PBF_ON);
+  /* mark end of frame labels */
+  if (!xdr_int (&bf->x_idx, &index)) return ERR_PBF_WRITE;
 
-    /* rewind XDR */
-    bf->membase = 0;
-    xdr_destroy (&bf->x_dat);
-    xdrmem_create (&bf->x_dat, bf->mem, bf->memsize, XDR_ENCODE);
+  /* write from XDR memory to file */
+  return filewrite (frm->mem, frm->size, bf->dat, frm->compression, &frm->codec);
+}
+
+#if POSIX
+/* output thread loop */
+static void* output_thread (void *data)
+{
+  PBF *bf = data;
+  PBF_QUEUE *q = bf->queue;
+  PBF_FRAME *frm;
+  int error;
+
+  pthread_mutex_lock (&q->lock);
+
+  for (;;)
+  {
+    while (!q->head && !q->done) pthread_cond_wait (&q->cond, &q->lock);
+
+    if (!(frm = q->head)) break; /* done and flushed */
+
+    error = q->error;
+
+    pthread_mutex_unlock (&q->lock);
+
+    if (!error) error = write_frame (bf, frm); /* skip output after the first error */
+
+    pthread_mutex_lock (&q->lock);
+
+    if (error && !q->error) q->error = error;
+    if (!(q->head = frm->next)) q->tail = NULL;
+    frm->lsize = 0;
+    frm->next = q->free;
+    q->free = frm;
+    q->count --;
+
+    pthread_cond_broadcast (&q->cond);
+  }
+
+  pthread_mutex_unlock (&q->lock);
+
+  return NULL;
+}
+
+/* start output thread; return 1 on success */
+static int start_queue (PBF *bf)
+{
+  PBF_QUEUE *q;
+
+  ERRMEM (q = MEM_CALLOC (sizeof (PBF_QUEUE)));
+  pthread_mutex_init (&q->lock, NULL);
+  pthread_cond_init (&q->cond, NULL);
+  bf->queue = q;
+
+  if (pthread_create (&q->thread, NULL, output_thread, bf) != 0) /* fall back to synchronous output */
+  {
+    pthread_cond_destroy (&q->cond);
+    pthread_mutex_destroy (&q->lock);
+    free (q);
+    bf->queue = NULL;
+  }
+
+  return bf->queue != NULL;
+}
+
+/* flush pending frames and stop output thread; return zero or the first output error code */
+static int stop_queue (PBF *bf)
+{
+  PBF_QUEUE *q = bf->queue;
+  PBF_FRAME *frm, *next;
+  int error;
+
+  pthread_mutex_lock (&q->lock);
+  q->done = 1;
+  pthread_cond_broadcast (&q->cond);
+  pthread_mutex_unlock (&q->lock);
+
+  pthread_join (q->thread, NULL);
+
+  error = q->error;
+
+  for (frm = q->free; frm; frm = next)
+  {
+    next = frm->next;
+    free (frm->mem);
+    free (frm->lrec);
+    free (frm);
+  }
+
+  pthread_cond_destroy (&q->cond);
+  pthread_mutex_destroy (&q->lock);
+  free (q);
+  bf->queue = NULL;
+
+  return error;
+}
+#endif
+
+/* submit packed frame for output and start packing a new one; return zero or an error code */
+static int submit_frame (PBF *bf)
+{
+  PBF_FRAME *frm = bf->frame;
+  int error = 0;
+
+  frm->mem = bf->mem;
+  frm->memsize = bf->memsize;
+  frm->size = bf->membase + xdr_getpos (&bf->x_dat);
+  frm->compression = bf->compression;
+  frm->codec = bf->codec;
+
+#if POSIX
+  if (bf->queue || start_queue (bf)) /* background output */
+  {
+    PBF_QUEUE *q = bf->queue;
+
+    pthread_mutex_lock (&q->lock);
+
+    while (q->count >= QUEUE && !q->error) pthread_cond_wait (&q->cond, &q->lock); /* bounded queue */
+
+    if (!(error = q->error))
+    {
+      frm->next = NULL;
+      if (q->tail) q->tail->next = frm;
+      else q->head = frm;
+      q->tail = frm;
+      q->count ++;
+      pthread_cond_broadcast (&q->cond);
+    }
+    else
+    {
+      frm->next = q->free;
+      q->free = frm;
+    }
+
+    if ((frm = q->free)) q->free = frm->next; /* reuse a written frame */
+
+    pthread_mutex_unlock (&q->lock);
+
+    if (!frm) ERRMEM (frm = MEM_CALLOC (sizeof (PBF_FRAME)));
+
+    frm->lsize = 0;
+    bf->frame = frm;
+  }
+  else
+#endif
+  {
+    error = write_frame (bf, frm);
+    frm->lsize = 0;
   }
+
+  /* the packing memory is owned by 'bf' */
+  if (!frm->mem)
+  {
+    frm->memsize = CHUNK;
+    ERRMEM (frm->mem = malloc (frm->memsize));
+  }
+  bf->mem = frm->mem;
+  bf->memsize = frm->memsize;
+  frm->mem = NULL;
+
+  /* rewind XDR */
+  bf->membase = 0;
+  xdr_destroy (&bf->x_dat);
+  xdrmem_create (&bf->x_dat, bf->mem, bf->memsize, XDR_ENCODE);
+
+  return error;
 }
 
-/* finalize frames after last write */
-static void finalize_frames (PBF *bf)
+/* finalize frames after last write; return zero or an error code */
+static int finalize_frames (PBF *bf)
 {
+  int error = 0;
+
   if (bf->mode == PBF_WRITE)
   {
     uint64_t doff;
     double time = DBL_MAX;
     int index = -2;
+    u_int ipos;
 
     /* write last frame */
-    write_frame (bf);
+    if (bf->cur) error = submit_frame (bf);
+
+#if POSIX
+    /* flush pending frames */
+    if (bf->queue)
+    {
+      int e = stop_queue (bf);
+      if (!error) error = e;
+    }
+#endif
 
     /* write infinite frame marker */
-    ASSERT (xdr_double (&bf->x_idx, &time), ERR_PBF_WRITE);
     doff = (uint64_t) FTELL (bf->dat);
-    ASSERT (xdr_uint64_t (&bf->x_idx, &doff), ERR_PBF_WRITE);
-    ASSERT (xdr_int (&bf->x_idx, &index), ERR_PBF_WRITE);
+    if (!xdr_double (&bf->x_idx, &time) ||
+        !xdr_uint64_t (&bf->x_idx, &doff)) error = ERR_PBF_WRITE;
+    ipos = xdr_getpos (&bf->x_idx);
+    if (!xdr_int (&bf->x_idx, &index)) error = ERR_PBF_WRITE;
+
+    /* and its time index marker */
+    if (!xdr_double (&bf->x_tix, &time) ||
+        !xdr_u_int (&bf->x_tix, &ipos) ||
+        !xdr_uint64_t (&bf->x_tix, &doff)) error = ERR_PBF_WRITE;
   }
+
+  return error;
 }
  
 /* test before closing */
@@ -988,6 +1692,25 @@ static char* copypath (const char *path)
   return out;
 }
 
+#if POSIX
+/* map file for reading; return NULL on failure */
+static char* mapfile (FILE *f, uint64_t *length)
+{
+  struct stat st;
+  void *map;
+
+  if (fstat (fileno (f), &st) != 0 || st.st_size <= 0) return NULL;
+
+  map = mmap (NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fileno (f), 0);
+
+  if (map == MAP_FAILED) return NULL;
+
+  *length = (uint64_t) st.st_size;
+
+  return map;
+}
+#endif
+
 PBF* PBF_Write (const char *path, PBF_FLG append, PBF_FLG parallel)
 {
   char *txt;
@@ -1001,9 +1724,15 @@ PBF* PBF_Write (const char *path, PBF_FLG append, PBF_FLG parallel)
   ERRMEM (bf = malloc (sizeof (PBF)));
   ERRMEM (txt = malloc (strlen (path) + 16));
   bf->compression = PBF_OFF;
+  bf->codec.alg = CMP_FASTLZ;
+  bf->codec.level = 1;
+  bf->codec.shuffle = 0;
   bf->membase = 0;
   bf->memsize = CHUNK;
   ERRMEM (bf->mem = malloc (bf->memsize));
+  ERRMEM (bf->frame = MEM_CALLOC (sizeof (PBF_FRAME)));
+  bf->queue = NULL;
+  bf->dmap = bf->imap = NULL;
 
   /* openin files */
 #if MPI
@@ -1033,6 +1762,15 @@ PBF* PBF_Write (const char *path, PBF_FLG append, PBF_FLG parallel)
   xdrstdio_create (&bf->x_lab, bf->lab, XDR_ENCODE);
   bf->lph = copypath (txt);
 
+#if MPI
+  sprintf (txt, "%s.tix.%d", path, rank);
+#else
+  sprintf (txt, "%s.tix", path);
+#endif
+  if (! (bf->tix = fopen (txt, "w"))) goto failure;
+  xdrstdio_create (&bf->x_tix, bf->tix, XDR_ENCODE);
+  bf->tph = copypath (txt);
+
   /* initialise the rest */
   MEM_Init (&bf->mappool, sizeof (MAP), CHUNK);
   MEM_Init (&bf->labpool, sizeof (PBF_LABEL), CHUNK);
@@ -1054,6 +1792,7 @@ PBF* PBF_Write (const char *path, PBF_FLG append, PBF_FLG parallel)
   return bf;
   
 failure: 
+  free (bf->frame);
   free (bf);
   free (txt);
   return NULL;
@@ -1086,6 +1825,9 @@ PBF* PBF_Read (const char *path)
     bf->compression = PBF_OFF;
     bf->memsize = CHUNK;
     bf->membase = 0;
+    bf->frame = NULL;
+    bf->queue = NULL;
+    bf->dmap = bf->imap = NULL;
 
     /* openin files */
     if (m) sprintf (txt, "%s.dat.%d", path, n);
@@ -1093,9 +1835,21 @@ PBF* PBF_Read (const char *path)
     if (! (bf->dat = fopen (txt, "r"))) goto failure;
     xdrmem_create (&bf->x_dat, bf->mem, bf->memsize, XDR_DECODE);
     bf->dph = copypath (txt);
+#if POSIX
+    bf->dmap = mapfile (bf->dat, &bf->dlen);
+#endif
     if (m) sprintf (txt, "%s.idx.%d", path, n);
     else sprintf (txt, "%s.idx", path);
     if (! (bf->idx = fopen (txt, "r"))) goto failure;
+#if POSIX
+    if ((bf->imap = mapfile (bf->idx, &bf->ilen)) && bf->ilen > UINT_MAX) /* beyond XDR positions */
+    {
+      munmap (bf->imap, bf->ilen);
+      bf->imap = NULL;
+    }
+    if (bf->imap) xdrmem_create (&bf->x_idx, bf->imap, bf->ilen, XDR_DECODE);
+    else
+#endif
     xdrstdio_create (&bf->x_idx, bf->idx, XDR_DECODE);
     bf->iph = copypath (txt);
     if (m) sprintf (txt, "%s.lab.%d", path, n);
@@ -1103,11 +1857,14 @@ PBF* PBF_Read (const char *path)
     if (! (bf->lab = fopen (txt, "r"))) goto failure;
     xdrstdio_create (&bf->x_lab, bf->lab, XDR_DECODE);
     bf->lph = copypath (txt);
+    if (m) sprintf (txt, "%s.tix.%d", path, n);
+    else sprintf (txt, "%s.tix", path);
+    bf->tph = copypath (txt);
+    bf->tix = NULL;
 
     /* initialise the rest */
     MEM_Init (&bf->mappool, sizeof (MAP), CHUNK);
     MEM_Init (&bf->labpool, sizeof (PBF_LABEL), CHUNK);
-    bf->mem = NULL;
     bf->ltab = NULL;
     bf->labels = NULL;
     bf->mtab = NULL;
@@ -1116,6 +1873,7 @@ PBF* PBF_Read (const char *path)
     bf->lsize = 0;
     bf->msize = 0;
     bf->cur = 0;
+    bf->seek = 0;
     initialise_reading (bf);
     if (m) bf->parallel = PBF_ON;
     else bf->parallel = PBF_OFF;
@@ -1140,32 +1898,41 @@ void PBF_Close (PBF *bf)
 
   for (; bf; bf = next)
   {
-    int empty;
+    int empty, error;
 
     /* finalize writing */
-    finalize_frames (bf);
+    error = finalize_frames (bf);
 
     /* close streams */
     xdr_destroy (&bf->x_dat);
     xdr_destroy (&bf->x_idx);
     xdr_destroy (&bf->x_lab);
+    if (bf->tix) xdr_destroy (&bf->x_tix);
+
+#if POSIX
+    if (bf->dmap) munmap (bf->dmap, bf->dlen);
+    if (bf->imap) munmap (bf->imap, bf->ilen);
+#endif
 
     empty = is_empty (bf->dat);
 
     fclose (bf->dat);
     fclose (bf->idx);
     fclose (bf->lab);
+    if (bf->tix) fclose (bf->tix);
 
     if (empty) /* remove empty files */
     {
       remove (bf->dph);
       remove (bf->iph);
       remove (bf->lph);
+      remove (bf->tph);
     }
   
     free (bf->dph);
     free (bf->iph);
     free (bf->lph);
+    free (bf->tph);
     free (bf->mem);
 
     /* free labels & markers */ 
@@ -1193,9 +1960,17 @@ void PBF_Close (PBF *bf)
       MEM_Release (&bf->labpool);
     }
 
+    if (bf->frame)
+    {
+      free (bf->frame->lrec);
+      free (bf->frame);
+    }
+
     MEM_Release (&bf->mappool);
     next = bf->next;
     free (bf);
+
+    ASSERT (error == 0, error);
   }
 }
 
@@ -1203,24 +1978,21 @@ void PBF_Close (PBF *bf)
 
 void PBF_Time (PBF *bf, double *time)
 {
-  uint64_t doff;
-
   if (bf->mode == PBF_WRITE)
   {
-    ASSERT ((*time) >= bf->time, ERR_PBF_OUTPUT_TIME_DECREASED);
+    int error = 0;
 
-    /* write last frame */
-    write_frame (bf);
+    ASSERT ((*time) >= bf->time, ERR_PBF_OUTPUT_TIME_DECREASED);
 
-    /* get current data offset */
-    doff = (uint64_t) FTELL (bf->dat);
+    /* submit last frame; report errors of
+     * previous frames output in background */
+    if (bf->cur) error = submit_frame (bf);
 
-    /* output current data position and time */
-    ASSERT (xdr_double (&bf->x_idx, time), ERR_PBF_WRITE);
-    ASSERT (xdr_uint64_t (&bf->x_idx, &doff), ERR_PBF_WRITE);
+    ASSERT (error == 0, error);
 
     /* set time */
-    bf->time = *time;
+    bf->frame->time = bf->time = *time;
+    bf->cur ++;
   }
   else
   { 
@@ -1248,14 +2020,20 @@ int PBF_Label (PBF *bf, const char *label)
       ASSERT (xdr_string (&bf->x_lab, (char**)&label, PBF_MAXSTRING), ERR_PBF_WRITE);
     }
 
-    /* record label and position in the index file */
-    ASSERT (xdr_int (&bf->x_idx, &l->index), ERR_PBF_WRITE);
+    /* record label and position for the index file */
+    PBF_FRAME *frm = bf->frame;
+    if (frm->lsize + 2 > frm->lcap)
+    {
+      frm->lcap = 2 * frm->lcap + CHUNK;
+      ERRMEM (frm->lrec = realloc (frm->lrec, sizeof (int [frm->lcap])));
+    }
     dpos = bf->membase + xdr_getpos (&bf->x_dat);
-    ASSERT (xdr_u_int (&bf->x_idx, &dpos), ERR_PBF_WRITE);
+    frm->lrec [frm->lsize ++] = l->index;
+    frm->lrec [frm->lsize ++] = (int) dpos;
   }
   else
   {
-    if ((l = MAP_Find (bf->labels, (void*)label, (MAP_Compare) strcmp)))
+    if ((l = MAP_Find (bf->labels, (void*)label, (MAP_Compare) strcmp)) && l->frame == bf->cur)
     {
       /* seek to labeled data begining (relative displacement) */
       ASSERT (xdr_setpos (&bf->x_dat, l->dpos), ERR_PBF_READ);
@@ -1266,6 +2044,37 @@ int PBF_Label (PBF *bf, const char *label)
   return 1;
 }
 
+/* bulk decoding of 'length' XDR (big-endian) words of 'size' bytes in READ mode;
+ * mapped or decompressed frame data is read in place; return 0 on failure */
+static int decode (PBF *bf, void *value, unsigned int length, unsigned int size)
+{
+  unsigned char *src, *dst = value, *end;
+
+  if (bf->mode != PBF_READ || length < 2 || length > UINT_MAX / size ||
+    !(src = (unsigned char*) xdr_inline (&bf->x_dat, size * length))) return 0;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  memcpy (dst, src, size * length); /* host layout matches */
+#else
+  for (end = src + size * length; src < end; src += size, dst += size)
+  {
+    if (size == 8)
+    {
+      uint64_t w = ((uint64_t)src[0] << 56) | ((uint64_t)src[1] << 48) | ((uint64_t)src[2] << 40) | ((uint64_t)src[3] << 32) |
+	           ((uint64_t)src[4] << 24) | ((uint64_t)src[5] << 16) | ((uint64_t)src[6] << 8) | (uint64_t)src[7];
+      memcpy (dst, &w, 8);
+    }
+    else
+    {
+      uint32_t w = ((uint32_t)src[0] << 24) | ((uint32_t)src[1] << 16) | ((uint32_t)src[2] << 8) | (uint32_t)src[3];
+      memcpy (dst, &w, 4);
+    }
+  }
+#endif
+
+  return 1;
+}
+
 #define IO(type, call)\
   if (bf->mode == PBF_WRITE)\
   {\
@@ -1297,6 +2106,8 @@ void PBF_Ushort (PBF *bf, unsigned short *value, unsigned int length)
 
 void PBF_Int (PBF *bf, int *value, unsigned int length)
 {
+  if (sizeof (int) == 4 && decode (bf, value, length, 4)) return;
+
   IO (int, xdr_int);
 }
 
@@ -1322,6 +2133,8 @@ void PBF_Float (PBF *bf, float *value, unsigned int length)
 
 void PBF_Double (PBF *bf, double *value, unsigned int length)
 { 
+  if (decode (bf, value, length, 8)) return;
+
   IO (double, xdr_double);
 }
 
@@ -1336,6 +2149,20 @@ void PBF_String (PBF *bf, char **value)
   else ASSERT (xdr_string (&bf->x_dat, value, PBF_MAXSTRING), ERR_PBF_READ);
 }
 
+unsigned int PBF_Tell (PBF *bf)
+{
+  if (bf->mode == PBF_WRITE) return bf->membase + xdr_getpos (&bf->x_dat);
+  else return xdr_getpos (&bf->x_dat);
+}
+
+void PBF_Goto (PBF *bf, unsigned int pos)
+{
+  if (bf->mode == PBF_READ)
+  {
+    ASSERT (xdr_setpos (&bf->x_dat, pos), ERR_PBF_READ);
+  }
+}
+
 void PBF_Limits (PBF *bf, double *start, double *end)
 {
   if (bf->mode == PBF_READ)
@@ -1345,31 +2172,46 @@ void PBF_Limits (PBF *bf, double *start, double *end)
   }
 }
 
+/* find frame nearest to time in the markers table */
+static int find_frame (PBF *bf, double time)
+{
+  PBF_MARKER *l, *h, *m;
+
+  /* binary search
+   * of marker */
+  l = bf->mtab;
+  h = l + bf->msize - 1;
+  m = l;
+  while (l <= h)
+  {
+    m = l + (h - l) / 2;
+    if (time == m->time) break;
+    else if (time < m->time) h = m - 1;
+    else l = m + 1;
+  }
+
+  /* handle limit cases */
+  if (h < bf->mtab) m = l;
+  else if (l > (bf->mtab + bf->msize - 1)) m = h;
+
+  return m - bf->mtab;
+}
+
 void PBF_Seek (PBF *bf, double time)
 {
   if (bf->mode == PBF_READ)
   {
-    for (; bf; bf = bf->next)
-    {
-      PBF_MARKER *l, *h, *m;
-
-      /* binary search
-       * of marker */
-      l = bf->mtab;
-      h = l + bf->msize - 1;
-      while (l <= h)
-      {
-	m = l + (h - l) / 2;
-	if (time == m->time) break;
-	else if (time < m->time) h = m - 1;
-	else l = m + 1;
-      }
+    int frm = find_frame (bf, time);
+    double t = bf->mtab [frm].time;
 
-      /* handle limit cases */
-      if (h < bf->mtab) m = l;
-      else if (l > (bf->mtab + bf->msize - 1)) m = h;
-      initialise_frame (bf, m - bf->mtab);
+    /* parallel files share frame times; search only when they do not */
+    for (PBF *f = bf; f; f = f->next)
+    {
+      if (frm < f->msize && f->mtab [frm].time == t) f->seek = frm;
+      else f->seek = find_frame (f, time);
     }
+
+    load_frames (bf);
   }
 }
 
@@ -1377,15 +2219,16 @@ int PBF_Backward (PBF *bf, unsigned int steps)
 {
   if (bf->mode == PBF_READ)
   {
-    int pos, ret;
+    int ret;
 
-    for (; bf; bf = bf->next)
+    for (PBF *f = bf; f; f = f->next)
     {
-      if (bf->cur < steps) pos = 0, ret = 0;
-      else pos = bf->cur - steps, ret = 1;
-      initialise_frame (bf, pos);
+      if (f->cur < steps) f->seek = 0, ret = 0;
+      else f->seek = f->cur - steps, ret = 1;
     }
 
+    load_frames (bf);
+
     return ret;
   }
 
@@ -1396,15 +2239,16 @@ int PBF_Forward (PBF *bf, unsigned int steps)
 {
   if (bf->mode == PBF_READ)
   {
-    int pos, ret;
+    int ret;
 
-    for (; bf; bf = bf->next)
+    for (PBF *f = bf; f; f = f->next)
     {
-      if (bf->cur + steps >=  bf->msize) pos = bf->msize - 1, ret = 0;
-      else pos = bf->cur + steps, ret = 1;
-      initialise_frame (bf, pos);
+      if (f->cur + steps >=  f->msize) f->seek = f->msize - 1, ret = 0;
+      else f->seek = f->cur + steps, ret = 1;
     }
 
+    load_frames (bf);
+
     return ret;
   }
 
@@ -1415,43 +2259,9 @@ unsigned int PBF_Span (PBF *bf, double t0, double t1)
 {
   if (bf->mode == PBF_READ)
   {
-    PBF_MARKER *l, *h, *m0, *m1;
-
     ASSERT_DEBUG (t0 <= t1, "t0 > t1");
 
-    /* binary search
-     * of marker */
-    l = bf->mtab;
-    h = l + bf->msize - 1;
-    while (l <= h)
-    {
-      m0 = l + (h - l) / 2;
-      if (t0 == m0->time) break;
-      else if (t0 < m0->time) h = m0 - 1;
-      else l = m0 + 1;
-    }
-
-    /* handle limit cases */
-    if (h < bf->mtab) m0 = l;
-    else if (l > (bf->mtab + bf->msize - 1)) m0 = h;
-
-    /* binary search
-     * of marker */
-    l = bf->mtab;
-    h = l + bf->msize - 1;
-    while (l <= h)
-    {
-      m1 = l + (h - l) / 2;
-      if (t1 == m1->time) break;
-      else if (t1 < m1->time) h = m1 - 1;
-      else l = m1 + 1;
-    }
-
-    /* handle limit cases */
-    if (h < bf->mtab) m1 = l;
-    else if (l > (bf->mtab + bf->msize - 1)) m1 = h;
-
-    return m1 - m0;
+    return find_frame (bf, t1) - find_frame (bf, t0);
   }
 
   return 0;
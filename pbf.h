@@ -28,6 +28,10 @@
 
 #define PBF_MAXSTACK 128 /* maximal group stack */
 
+#if MPI && defined(H5_HAVE_PARALLEL)
+#define PBF_COLLECTIVE 1 /* all ranks write into one file collectively */
+#endif
+
 typedef struct pbf PBF; /* file type */
 
 /* access mode */
@@ -52,6 +56,11 @@ struct pbf
   double *d; /* raw doubles space */
   int dpos, doubles; /* raw doubles position and size */
 
+  int *l; /* packed labels of a collective file */
+  int lpos, lints; /* packed labels position and size */
+
+  int rank, size; /* rank and number of ranks sharing a collective file; size is zero otherwise */
+
   char *path; /* file path; used to remove empty write access files upon closure */
 
   hid_t stack [PBF_MAXSTACK]; /* file id followed by groups stack */
@@ -92,7 +101,8 @@ int PBF_Has_Group (PBF *bf, const char *name);
 void PBF_Push (PBF *bf, const char *name);
 void PBF_Pop (PBF *bf);
 
-/* write/read named datasets (length > 1) or attributes (length == 1) */
+/* write/read named datasets (length > 1) or attributes (length == 1); in a collective
+ * file each rank writes/reads its own segment of a shared dataset of any length */
 void PBF_Int2 (PBF *bf, const char *name, int *value, hsize_t length);
 void PBF_Double2 (PBF *bf, const char *name, double *value, hsize_t length);
 void PBF_String2 (PBF *bf, const char *name, char **value);
@@ -120,6 +130,7 @@ unsigned int PBF_Span (PBF *bf, double t0, double t1);
 #include <rpc/xdr.h>
 #include "map.h"
 #include "mem.h"
+#include "cmp.h"
 
 #if __MINGW32__
   #define FSEEK fseeko64
@@ -143,6 +154,8 @@ unsigned int PBF_Span (PBF *bf, double t0, double t1);
 
 typedef struct pbf_marker PBF_MARKER; /* file marker */
 typedef struct pbf_label PBF_LABEL; /* label type */
+typedef struct pbf_frame PBF_FRAME; /* output frame */
+typedef struct pbf_queue PBF_QUEUE; /* output queue */
 typedef struct pbf PBF; /* file type */
 
 /* marker */
@@ -159,6 +172,7 @@ struct pbf_label
   char *name; /* label name */
   int index; /* unique index */
   int dpos; /* data position */
+  int frame; /* last read frame containing the label (READ) */
 };
 
 /* access mode */
@@ -167,33 +181,59 @@ typedef enum {PBF_READ, PBF_WRITE} PBF_ACC;
 /* compression flag */
 typedef enum {PBF_ON, PBF_OFF} PBF_FLG;
 
+/* output frame */
+struct pbf_frame
+{
+  double time; /* frame time */
+  char *mem; /* XDR data memory */
+  u_int size; /* data size */
+  int memsize; /* memory size */
+  int *lrec; /* (label index, data position) records */
+  int lsize, /* number of records */
+      lcap; /* records capacity */
+  PBF_FLG compression; /* compression flag */
+  CMP_CODEC codec; /* compression codec */
+  PBF_FRAME *next; /* next in queue or in free list */
+};
+
 /* file */
 struct pbf
 {
   PBF_ACC mode; /* access mode */
   char *dph, /* data path */
        *iph, /* index path */
-       *lph; /* label path */
+       *lph, /* label path */
+       *tph; /* time index path */
   FILE *dat, /* data file */
        *idx, /* index file */
-       *lab; /* label file */
+       *lab, /* label file */
+       *tix; /* time index file (WRITE) */
   XDR x_dat, /* data stream */
       x_idx, /* index stream */
-      x_lab; /* labels stream */
+      x_lab, /* labels stream */
+      x_tix; /* time index stream (WRITE) */
+  char *dmap, /* mapped data file (READ) */
+       *imap; /* mapped index file (READ) */
+  uint64_t dlen, /* mapped data length */
+           ilen; /* mapped index length */
   char *mem; /* read/write memory */
   int membase, /* memory base */
 	memsize; /* memory size */
   MEM mappool, /* map items pool */
       labpool; /* labels pool */
   PBF_LABEL *ltab; /* table of labels */
-  MAP *labels; /* name mapped labels */
+  MAP *labels; /* name mapped labels (mapped once per file in READ mode) */
   PBF_MARKER *mtab; /* markers */
   int lsize; /* free index (WRITE) or ltab size (READ) */
   int msize, /* mtab size (READ) */
-        cur; /* index of current time frame */
+        cur, /* index of current time frame (READ) or number of frames (WRITE) */
+        seek; /* frame to be loaded (READ) */
   double time; /* current time */
   PBF_FLG compression; /* compression flag */
+  CMP_CODEC codec; /* compression codec (WRITE) */
   PBF_FLG parallel; /* parallel flag */
+  PBF_FRAME *frame; /* frame being packed (WRITE) */
+  PBF_QUEUE *queue; /* background output of packed frames (WRITE) */
   PBF *next; /* list of parallel files (READ) */
 };
 
@@ -232,6 +272,12 @@ void PBF_Double (PBF *bf, double *value, unsigned int length);
 /* read/write NULL-termined string */
 void PBF_String (PBF *bf, char **value);
 
+/* get current data position within the current frame */
+unsigned int PBF_Tell (PBF *bf);
+
+/* set current data position within the current frame in read mode */
+void PBF_Goto (PBF *bf, unsigned int pos);
+
 /* get time limits in read mode */
 void PBF_Limits (PBF *bf, double *start, double *end);
 
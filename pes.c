@@ -26,6 +26,15 @@
 #include "lap.h"
 #include "err.h"
 
+#if MPI
+#include "put.h"
+#endif
+
+#if OMP
+#include <omp.h>
+#include "ompu.h"
+#endif
+
 #define PENALTY_MAXITER 1000
 #define PENALTY_EPSILON 1E-4 /* XXX */
 
@@ -232,13 +241,67 @@ int PENALTY_Spring_Dashpot_Contact (CON *con, short implicit, double step, doubl
 #endif
 }
 
+/* spring and dashpot based contact force computed from the gap and the initial velocity V only (DEM);
+ * W is only read for a negative dashpot, which indicates critical damping */
+void PENALTY_Spring_Dashpot_DEM (CON *con, double step, double gap, double spring, double dashpot, double hpow,
+                                 double friction, double cohesion, double *W, double *V, double *R)
+{
+  short cohesive = con->state & CON_COHESIVE;
+  double g, len, lim;
+
+  g = MIN (gap, 0);
+  if (dashpot < 0.0) dashpot = g < 0.0 ? 2.0 * sqrt (step * spring * hpow * pow (-g, hpow - 1.0) / W [8]) : 0.0; /* critical damping */
+  R [2] = spring * pow (-g, hpow) - dashpot * V[2];
+
+  if (!cohesive && R[2] <= 0.0)
+  {
+    SET (R, 0.0);
+    return;
+  }
+
+  if (cohesive && R [2] < -cohesion * con->area)
+  {
+    cohesive = 0;
+    con->state &= ~CON_COHESIVE;
+    SURFACE_MATERIAL_Cohesion_Set (&con->mat, 0.0);
+    R [2] = -cohesion * con->area;
+  }
+
+  lim = friction * fabs (R[2]);
+  len = LEN2 (V);
+
+  if (dashpot * len > lim || dashpot == 0.0) /* sliding */
+  {
+    if (len > 0.0)
+    {
+      R [0] = -lim * V[0] / len;
+      R [1] = -lim * V[1] / len;
+    }
+    else R [0] = R [1] = 0.0;
+
+    if (cohesive)
+    {
+      con->state &= ~CON_COHESIVE;
+      SURFACE_MATERIAL_Cohesion_Set (&con->mat, 0.0);
+    }
+  }
+  else /* viscous regularization of sticking */
+  {
+    R [0] = -dashpot * V[0];
+    R [1] = -dashpot * V[1];
+  }
+}
+
 /* create penalty solver */
-PENALTY* PENALTY_Create (short implicit)
+PENALTY* PENALTY_Create (short implicit, short dem)
 {
   PENALTY *ps;
 
   ERRMEM (ps = MEM_CALLOC (sizeof (PENALTY)));
   ps->implicit = implicit;
+  ps->dem = dem;
+  ps->gs = GAUSS_SEIDEL_Create (PENALTY_EPSILON, PENALTY_MAXITER, 1.0, GS_FAILURE_CONTINUE, 1E-9, 100, DS_SEMISMOOTH_NEWTON, NULL, NULL);
+  ps->gs->nomerit = 1;
 
   return ps;
 }
@@ -246,8 +309,8 @@ PENALTY* PENALTY_Create (short implicit)
 /* explcit constraint solver */
 void PENALTY_Solve (PENALTY *ps, LOCDYN *ldy)
 {
-  GAUSS_SEIDEL *gs;
   short implicit;
+  int noncon;
   double step;
   LOCDYN *clo;
   DIAB *dia;
@@ -262,31 +325,55 @@ void PENALTY_Solve (PENALTY *ps, LOCDYN *ldy)
   if (ldy->dom->verbose) printf ("PENALTY_SOLVER: applying springs and dashpots...\n");
 
   /* first explicitly process contacts */
+#if OMP
+  int j, n;
+  DIAB **pdia = ompu_contacts (ldy, &n);
+  #pragma omp parallel for shared (pdia) private (dia, con)
+  for (j = 0; j < n; j ++)
+  {
+    dia = pdia [j];
+    con = dia->con;
+#else
   for (dia = ldy->dia; dia; dia = dia->n)
   {
     con = dia->con;
 
-    if (con->kind == CONTACT)
+    if (con->kind != CONTACT) continue;
+#endif
+    SURFACE_MATERIAL *bas = con->mat.base;
+
+    if (ps->dem)
     {
-      SURFACE_MATERIAL *bas = con->mat.base;
-      PENALTY_Spring_Dashpot_Contact (con, implicit, step, con->gap, bas->spring, bas->dashpot, bas->hpow,
-	                  bas->friction, bas->cohesion, dia->W, dia->B, dia->V, dia->U, dia->R);
+      PENALTY_Spring_Dashpot_DEM (con, step, con->gap, bas->spring, bas->dashpot, bas->hpow,
+				  bas->friction, bas->cohesion, dia->W, dia->V, dia->R);
+      COPY (dia->B, dia->U); /* W is not used: U holds the free velocity */
     }
+    else PENALTY_Spring_Dashpot_Contact (con, implicit, step, con->gap, bas->spring, bas->dashpot, bas->hpow,
+			bas->friction, bas->cohesion, dia->W, dia->B, dia->V, dia->U, dia->R);
+  }
+#if OMP
+  free (pdia);
+#endif
+
+  for (dia = ldy->dia, noncon = 0; dia; dia = dia->n)
+  {
+    if (dia->con->kind != CONTACT) noncon ++;
   }
 
 #if MPI
-  if (ldy->dom->rank == 0)
+  DOM_Update_External_Reactions (ldy->dom, 0);
+  noncon = PUT_int_max (noncon);
 #endif
-  if (ldy->dom->verbose) printf ("PENALTY_SOLVER: solving non-contact constraints...\n");
+
+  if (noncon == 0) return; /* nothing else to solve */
 
 #if MPI
-  DOM_Update_External_Reactions (ldy->dom, 0);
+  if (ldy->dom->rank == 0)
 #endif
+  if (ldy->dom->verbose) printf ("PENALTY_SOLVER: solving non-contact constraints...\n");
+
   clo = LOCDYN_Clone_Non_Contacts (ldy);
-  gs = GAUSS_SEIDEL_Create (PENALTY_EPSILON, PENALTY_MAXITER, 1.0, GS_FAILURE_CONTINUE, 1E-9, 100, DS_SEMISMOOTH_NEWTON, NULL, NULL);
-  gs->nomerit = 1;
-  GAUSS_SEIDEL_Solve (gs, clo);
-  GAUSS_SEIDEL_Destroy (gs);
+  GAUSS_SEIDEL_Solve (ps->gs, clo);
   LOCDYN_Destroy (clo);
 }
 
@@ -299,5 +386,6 @@ void PENALTY_Write_State (PENALTY *ps, PBF *bf)
 /* destroy penalty solver */
 void PENALTY_Destroy (PENALTY *ps)
 {
+  GAUSS_SEIDEL_Destroy (ps->gs);
   free (ps);
 }
@@ -20,6 +20,7 @@
  * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
 
 #include "ldy.h"
+#include "bgs.h"
 
 #ifndef __pes__
 #define __pes__
@@ -33,10 +34,15 @@ typedef struct penalty PENALTY;
 struct penalty
 {
   short implicit;
+
+  short dem; /* explicit DEM variant: contact forces follow from gaps and velocities only */
+
+  GAUSS_SEIDEL *gs; /* non-contact constraints solver */
 };
 
-/* create penalty solver */
-PENALTY* PENALTY_Create (short implicit);
+/* create penalty solver; for dem != 0 contact W blocks are not used, hence they are only
+ * assembled when coupled with non-contact constraints or for critically damped contacts */
+PENALTY* PENALTY_Create (short implicit, short dem);
 
 /* explcit constraint solver */
 void PENALTY_Solve (PENALTY *ps, LOCDYN *ldy);
@@ -50,6 +56,11 @@ void PENALTY_Destroy (PENALTY *ps);
 /* spring and dashpot based explicit diagonal block contact solver */
 int PENALTY_Spring_Dashpot_Contact (CON *con, short implicit, double step, double gap, double spring, double dashpot, double hpow,
                              double friction, double cohesion, double *W, double *B, double *V, double *U, double *R);
+
+/* spring and dashpot based contact force computed from the gap and the initial velocity V only (DEM);
+ * W is only read for a negative dashpot, which indicates critical damping */
+void PENALTY_Spring_Dashpot_DEM (CON *con, double step, double gap, double spring, double dashpot, double hpow,
+                                 double friction, double cohesion, double *W, double *V, double *R);
 #if __cplusplus
 } /* extern C */
 #endif
@@ -70,6 +70,7 @@ static void psc_write_element (ELEMENT *ele, FILE *f)
 
   /* XXX: skip ele->{mat, state} as they are not used in practice */
   /* XXX: skip ele->{domnum, dom} due to the same reasons */
+  /* XXX: skip ele->idata as it is recreated on demand */
 
   for (i = 0; i < ele->neighs; i ++) fwrite (&ele->adj[i]->flag, sizeof (short), 1, f);
 
@@ -3418,7 +3418,7 @@ static void step ()
   if (s) SOLFEC_Run (solfec, (SOLVER_KIND)s->kind, s->solver, epsilon); /* use epsilon as the duration in order to make just one step; see (***) */
   else 
   {
-    PENALTY *ps = PENALTY_Create (1);
+    PENALTY *ps = PENALTY_Create (1, 0);
     SOLFEC_Run (solfec, PENALTY_SOLVER, ps, epsilon); /* default and in read mode */
     PENALTY_Destroy (ps);
   }
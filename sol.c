@@ -43,6 +43,8 @@
 #include "iou.h"
 #include "err.h"
 #include "tmr.h"
+#include "xdmf.h"
+#include "ckp.h"
 #include "mrf.h"
 
 
@@ -151,6 +153,9 @@ static void write_state (SOLFEC *sol, void *solver, SOLVER_KIND kind)
   /* set compression */
 
   sol->bf->compression = sol->compression;
+#if !HDF5
+  sol->bf->codec = sol->codec;
+#endif
 
   /* write time */
 
@@ -169,6 +174,16 @@ static void write_state (SOLFEC *sol, void *solver, SOLVER_KIND kind)
 
   DOM_Write_State (sol->dom, sol->bf);
 
+  /* append history columns */
+
+  if (sol->hs) HST_Append (sol->hs, sol->dom);
+
+#if !MPI
+  /* append streamed XDMF frame */
+
+  if (sol->xf) XDMF_Append (sol->xf, sol->dom);
+#endif
+
   /* write timers */
 
 #if 0 /* HDF5 */
@@ -310,6 +325,29 @@ static void read_state (SOLFEC *sol)
   read_timers (sol);
 }
 
+/* input states of history bodies only */
+static void read_bodies (SOLFEC *sol, SHI *shi, int nshi)
+{
+  SET *bodies = NULL;
+  BODY *bod;
+  int i;
+
+  for (i = 0; i < nshi; i ++)
+  {
+    if (shi[i].item != BODY_ENTITY) continue;
+
+    if ((bod = shi[i].bod) ||
+        (bod = MAP_Find (sol->dom->lab, shi[i].label, (MAP_Compare)strcmp)))
+      SET_Insert (NULL, &bodies, bod, NULL);
+    else break; /* a labeled body inserted after the current time */
+  }
+
+  if (i < nshi) DOM_Read_State (sol->dom, sol->bf); /* read whole domain */
+  else DOM_Read_Bodies (sol->dom, sol->bf, bodies);
+
+  SET_Free (NULL, &bodies);
+}
+
 /* read initial state if needed */
 static int init (SOLFEC *sol)
 {
@@ -497,8 +535,16 @@ SOLFEC* SOLFEC_Create (short dynamic, double step, char *outpath)
   sol->output_interval = 0;
   sol->output_time = 0;
   sol->compression = PBF_OFF;
+  sol->codec.alg = CMP_FASTLZ;
+  sol->codec.level = 1;
+  sol->codec.shuffle = 0;
+  sol->keyframes = 0;
+  sol->tolerance = 0.0;
 
   sol->bcd = NULL;
+  sol->hs = NULL;
+  sol->xf = NULL;
+  sol->ckp = NULL;
 
 #if MPI
   sol->bf = readoutpath (sol->outpath);
@@ -801,6 +847,9 @@ void SOLFEC_Run (SOLFEC *sol, SOLVER_KIND kind, void *solver, double duration)
       /* BCD sampling */
       if (sol->bcd) BCD_Sample (sol, sol->bcd);
 
+      /* write restart checkpoint if due */
+      if (sol->ckp && CKP_Due (sol->ckp)) CKP_Write (sol->ckp, sol);
+
       /* check whether STOP file was created by the user */
       if (stopfile (sol)) break;
     }
@@ -813,6 +862,14 @@ void SOLFEC_Run (SOLFEC *sol, SOLVER_KIND kind, void *solver, double duration)
 
     /* BCD append Python output at the end of run */
     if (sol->bcd) BCD_Append_Output (sol->bcd);
+
+#if !MPI
+    /* make streamed XDMF frames visible */
+    if (sol->xf) XDMF_Markup (sol->xf);
+#endif
+
+    /* checkpoint the end of run */
+    if (sol->ckp) CKP_Write (sol->ckp, sol);
   }
   else /* READ */
   {
@@ -825,11 +882,23 @@ void SOLFEC_Run (SOLFEC *sol, SOLVER_KIND kind, void *solver, double duration)
 }
 
 /* set results output interval */
-void SOLFEC_Output (SOLFEC *sol, double interval, PBF_FLG compression)
+void SOLFEC_Output (SOLFEC *sol, double interval, PBF_FLG compression, CMP_CODEC *codec, int columns, int keyframes, double tolerance)
 {
   sol->output_interval = interval;
   sol->output_time = sol->dom->time + interval;
   sol->compression = compression;
+  if (codec) sol->codec = *codec;
+  sol->keyframes = keyframes;
+  sol->tolerance = tolerance;
+
+  if (columns > 0 && sol->mode == SOLFEC_WRITE && !sol->hs)
+  {
+    char *path = getfilepath (sol->outpath);
+
+    makedirspath (sol->outpath);
+    if (!(sol->hs = HST_Write (path, columns, CONTINUE_WRITE_FLAG()))) THROW (ERR_FILE_OPEN);
+    free (path);
+  }
 }
 
 /* the next time minus the current time */
@@ -946,6 +1015,26 @@ void SOLFEC_Abort (SOLFEC *sol)
 #endif
     sol->bf = NULL;
   }
+
+  if (sol->hs)
+  {
+    HST_Close (sol->hs);
+    sol->hs = NULL;
+  }
+
+#if !MPI
+  if (sol->xf)
+  {
+    XDMF_Close (sol->xf);
+    sol->xf = NULL;
+  }
+#endif
+
+  if (sol->ckp)
+  {
+    CKP_Destroy (sol->ckp);
+    sol->ckp = NULL;
+  }
 }
 
 /* free solfec memory */
@@ -971,6 +1060,14 @@ void SOLFEC_Destroy (SOLFEC *sol)
   if (sol->bf) PBF_Close (sol->bf);
 #endif
 
+  if (sol->hs) HST_Close (sol->hs);
+
+#if !MPI
+  if (sol->xf) XDMF_Close (sol->xf);
+#endif
+
+  if (sol->ckp) CKP_Destroy (sol->ckp);
+
   if (sol->mode == SOLFEC_READ)
   {
     for (MAP *item = MAP_First (sol->timers); item; item = MAP_Next (item))
@@ -997,6 +1094,205 @@ void SOLFEC_Destroy (SOLFEC *sol)
   free (sol);
 }
 
+/* number of frames per columnar history read */
+#define HISTORY_BLOCK 64
+
+/* read histories from the columnar store starting at the current frame;
+ * return NULL if the store is missing or does not suit the requested items */
+static double* history_columns (SOLFEC *sol, SHI *shi, int nshi, double t1, int skip, int size)
+{
+  int i, j, k, m, n, f, g, *frames;
+  double s, e, *time;
+  BODY **bod;
+  HST *hs;
+
+  for (i = 0; i < nshi; i ++)
+  {
+    if (!(shi[i].item == BODY_ENTITY ||
+          shi[i].item == ENERGY_VALUE ||
+	  shi[i].item == CONSTRAINT_VALUE)) return NULL; /* timers and labeled values are only in PBF */
+  }
+
+  if (!sol->hs)
+  {
+    char *path = getfilepath (sol->outpath);
+    sol->hs = HST_Read (path);
+    free (path);
+  }
+
+  if (!(hs = sol->hs)) return NULL;
+
+  PBF_Limits (sol->bf, &s, &e);
+
+  if (hs->times [0] != s || hs->times [hs->frames-1] != e ||
+      (int) PBF_Span (sol->bf, s, e) + 1 != hs->frames) return NULL; /* store does not cover the output */
+
+  if ((f = HST_Frame (hs, sol->dom->time)) < 0) return NULL;
+
+  ERRMEM (bod = malloc (sizeof (BODY* [nshi + 1])));
+
+  for (i = 0; i < nshi; i ++)
+  {
+    if (shi[i].item == BODY_ENTITY)
+    {
+      if (!(bod [i] = shi[i].bod ? shi[i].bod : MAP_Find (sol->dom->lab, shi[i].label, (MAP_Compare)strcmp)))
+      {
+	free (bod);
+	return NULL; /* labeled body absent at the start of the history */
+      }
+    }
+  }
+
+  /* frames visited by the PBF based loop */
+  ERRMEM (frames = malloc (sizeof (int [size + 4])));
+  n = 0;
+  do
+  {
+    frames [n ++] = f;
+    g = MIN (f + ABS (skip), hs->frames - 1);
+    if (g == f || n == size + 4) break;
+    f = g;
+  }
+  while (hs->times [f] < t1);
+
+  ERRMEM (time = MEM_CALLOC (sizeof (double [size + 4])));
+  for (j = 0; j < n; j ++) time [j] = hs->times [frames [j]];
+
+  for (i = 0; i < nshi; i ++)
+  {
+    ERRMEM (shi[i].history = MEM_CALLOC (sizeof (double [size + 4])));
+
+    switch (shi[i].item)
+    {
+    case BODY_ENTITY:
+      {
+	int nconf = BODY_Conf_Size (bod [i]),
+	    ndofs = bod [i]->dofs,
+	    nener = BODY_ENERGY_SIZE (bod [i]->kind);
+	double *conf, *velo, *energy, values [7];
+
+	ERRMEM (conf = malloc (sizeof (double [HISTORY_BLOCK * (nconf + ndofs + nener)])));
+	velo = conf + HISTORY_BLOCK * nconf;
+	energy = velo + HISTORY_BLOCK * ndofs;
+
+	for (j = 0; j < n; j += m)
+	{
+	  m = MIN (HISTORY_BLOCK, n - j);
+
+	  HST_Body (hs, bod [i]->id, frames + j, m, nconf, ndofs, nener, conf, velo, energy);
+
+	  for (k = 0; k < m; k ++)
+	  {
+	    if (isnan (conf [k*nconf])) shi[i].history [j+k] = NAN; /* body absent */
+	    else
+	    {
+	      BODY_Set_State (bod [i], &conf [k*nconf], &velo [k*ndofs], &energy [k*nener]);
+	      BODY_Point_Values (bod [i], shi[i].point, shi[i].entity, values);
+	      shi[i].history [j+k] = values [shi[i].index];
+	    }
+	  }
+	}
+
+	free (conf);
+      }
+      break;
+    case ENERGY_VALUE:
+    case CONSTRAINT_VALUE:
+      {
+	SET *ids = NULL;
+	MEM setmem;
+
+	MEM_Init (&setmem, sizeof (SET), 128);
+
+	for (SET *item = SET_First (shi[i].bodies); item; item = SET_Next (item))
+	{
+	  BODY *b = item->data;
+	  SET_Insert (&setmem, &ids, (void*) (long) b->id, NULL);
+	}
+
+	if (shi[i].item == ENERGY_VALUE)
+	{
+	  HST_Energy (hs, ids, shi[i].index, frames, n, shi[i].history);
+	}
+	else for (j = 0; j < n; j ++)
+	{
+	  double value, vec [3], *rec,
+		 div = 1.0,
+	        *dir = shi[i].vector;
+	  int s1 = shi[i].surf1,
+	      s2 = shi[i].surf2,
+	      ncon, kind;
+	  short usedir = DOT (dir, dir) > 0.0 ? 1 : 0;
+
+	  switch (shi[i].op)
+	  {
+	  case OP_SUM:
+	  case OP_AVG: value = 0.0; break;
+	  case OP_MAX: value = -DBL_MAX; break;
+	  case OP_MIN: value = DBL_MAX; break;
+	  }
+
+	  for (HST *h = hs; h; h = h->next)
+	  {
+	    for (rec = HST_Constraints (h, frames [j], &ncon), k = 0; k < ncon; k ++, rec += HST_CONREC)
+	    {
+	      if (ids && !SET_Contains (ids, (void*) (long) rec [HST_MASTER], NULL) &&
+		  !(rec [HST_SLAVE] && SET_Contains (ids, (void*) (long) rec [HST_SLAVE], NULL))) continue;
+
+	      kind = (int) rec [HST_KIND];
+
+	      if (shi[i].contacts_only && kind != CONTACT) continue;
+	      else if (kind == CONTACT && s1 != INT_MAX && s2 != INT_MAX)
+	      {
+		int r1 = (int) rec [HST_SPAIR], r2 = (int) rec [HST_SPAIR+1];
+		if (!((s1 == r1 && s2 == r2) || (s1 == r2 && s2 == r1))) continue;
+	      }
+
+	      switch (shi[i].index)
+	      {
+	      case CONSTRAINT_GAP:
+		if (kind == CONTACT) value = MIN (value, rec [HST_GAP]);
+		break;
+	      case CONSTRAINT_R:
+		if (usedir)
+		{
+		  TVMUL (&rec [HST_BASE], &rec [HST_R], vec);
+		  value += DOT (dir, vec);
+		}
+		else value += rec [HST_R+2];
+		break;
+	      case CONSTRAINT_U:
+		if (usedir)
+		{
+		  TVMUL (&rec [HST_BASE], &rec [HST_U], vec);
+		  value += DOT (dir, vec);
+		}
+		else value += rec [HST_U+2];
+		div += 1.0;
+		break;
+	      }
+	    }
+	  }
+
+	  if (fabs (value) == DBL_MAX) value = 0.0;
+
+	  shi[i].history [j] = value / div;
+	}
+
+	MEM_Release (&setmem);
+      }
+      break;
+    default:
+      break;
+    }
+  }
+
+  free (frames);
+  free (bod);
+
+  return time;
+}
+
 /* read histories of a set of requested items; allocate and fill 'history'  members
  * of those items; return table of times of the same 'size' as the 'history' members;
  * skip every 'skip' steps; if 'skip' < 0 then print out a percentage based progress bar */
@@ -1009,6 +1305,7 @@ double* SOLFEC_History (SOLFEC *sol, SHI *shi, int nshi, double t0, double t1, i
       dodel = 0,
       timers = 0,
       labeled = 0,
+      bodies = 0,
       full_read = 0;
 
   if (skip < 0) printf ("Reading history ... "); /* progress begin */
@@ -1017,6 +1314,16 @@ double* SOLFEC_History (SOLFEC *sol, SHI *shi, int nshi, double t0, double t1, i
   save = sol->dom->time;
   SOLFEC_Seek_To (sol, t0);
   *size = PBF_Span (sol->bf, t0, t1) / ABS (skip);
+
+  if ((time = history_columns (sol, shi, nshi, t1, skip, *size))) /* columnar store */
+  {
+    SOLFEC_Seek_To (sol, save); /* restore initial time frame */
+
+    if (skip < 0) printf ("100%%\n"); /* progress end */
+
+    return time;
+  }
+
   ERRMEM (time = MEM_CALLOC (sizeof (double [(*size) + 4]))); /* safeguard */
   time [cur] = sol->dom->time;
 
@@ -1026,7 +1333,7 @@ double* SOLFEC_History (SOLFEC *sol, SHI *shi, int nshi, double t0, double t1, i
 
     switch (shi [i].item)
     {
-      case BODY_ENTITY:
+      case BODY_ENTITY: bodies = 1; break;
       case ENERGY_VALUE: full_read = 1; break;
       case TIMING_VALUE: timers = 1; break;
       case CONSTRAINT_VALUE: full_read = 1; break;
@@ -1228,6 +1535,7 @@ double* SOLFEC_History (SOLFEC *sol, SHI *shi, int nshi, double t0, double t1, i
       PBF_Time (sol->bf, &sol->dom->time); /* read time */
 
       if (labeled) read_state (sol); /* read whole domain */
+      else if (bodies) read_bodies (sol, shi, nshi); /* read history bodies only */
 
       if (timers) read_timers (sol); /* read timers */
     }
@@ -1276,6 +1584,57 @@ int SOLFEC_Initialize_State (SOLFEC *sol, char *path, double time, SET *subset)
   return ret;
 }
 
+/* write restart checkpoints every 'interval' seconds of wall-clock time and at the end of each run */
+void SOLFEC_Checkpoint (SOLFEC *sol, double interval)
+{
+  if (sol->mode == SOLFEC_WRITE)
+  {
+#if MPI
+    WARNING (0, "CHECKPOINT is not available in parallel and has been ignored");
+#else
+    if (sol->ckp) sol->ckp->interval = interval;
+    else
+    {
+      char *copy, *path = getfilepath (sol->outpath);
+
+      ERRMEM (copy = malloc (strlen (path) + 8));
+      sprintf (copy, "%s.ckp", path);
+      makedirspath (sol->outpath);
+      sol->ckp = CKP_Create (copy, interval);
+      free (copy);
+      free (path);
+    }
+#endif
+  }
+}
+
+/* restore state from the checkpoint of the output at 'path'; return 1 on success, 0 otherwise */
+int SOLFEC_Restart (SOLFEC *sol, char *path)
+{
+#if MPI
+  WARNING (0, "RESTART is not available in parallel");
+  return 0;
+#else
+  char *copy, *file = getfilepath (path);
+  int ret;
+
+  ERRMEM (copy = malloc (strlen (file) + 8));
+  sprintf (copy, "%s.ckp", file);
+  ret = CKP_Read (copy, sol);
+  WARNING (ret, "Reading of the checkpoint %s has failed", copy);
+  free (copy);
+  free (file);
+
+  if (ret) /* statistics start over at the restart */
+  {
+    sol->start = time (NULL);
+    timerstart (&sol->verbose_timing);
+  }
+
+  return ret;
+#endif
+}
+
 /* map rigid motion onto FEM bodies; return 1 on success, 0 otherwise;
  * optinal "subset" is a set of strings defining POSIX regular expressions to be matched
  * against body labels -- narrowing down the set of bodies whose state will  be initialized */
@@ -34,6 +34,7 @@
 #include "fld.h"
 #include "mat.h"
 #include "pbf.h"
+#include "hst.h"
 #include "cmp.h"
 #include "tmr.h"
 #include "bcd.h"
@@ -119,7 +120,13 @@ struct solfec
 	 output_time;
   char *outpath;
   PBF_FLG compression;
+  CMP_CODEC codec;
+  int keyframes; /* delta coding of body states with a full state every 'keyframes' frames (or 0) */
+  double tolerance; /* absolute quantization tolerance of delta coded velocities and FE displacements (or 0) */
   PBF *bf;  
+  HST *hs; /* columnar history store */
+  struct xdmf *xf; /* streamed XDMF export */
+  struct ckp *ckp; /* restart checkpoints */
 
   /* body co-rotated FEM displacements sampling */
   BCD *bcd;
@@ -180,8 +187,12 @@ char* SOLFEC_Mode (SOLFEC *sol);
 /* run analysis with a specific constraint solver */
 void SOLFEC_Run (SOLFEC *sol, SOLVER_KIND kind, void *solver, double duration);
 
-/* set results output interval */
-void SOLFEC_Output (SOLFEC *sol, double interval, PBF_FLG compression);
+/* set results output interval and compression codec; if 'columns' > 0
+ * also write the columnar history store in chunks of 'columns' frames;
+ * if 'keyframes' > 0 delta code body states in between of full states
+ * written every 'keyframes' frames, with quantization of velocities
+ * and finite element displacements when 'tolerance' > 0 */
+void SOLFEC_Output (SOLFEC *sol, double interval, PBF_FLG compression, CMP_CODEC *codec, int columns, int keyframes, double tolerance);
 
 /* set up callback function */
 void SOLFEC_Set_Callback (SOLFEC *sol, double interval, void *data, void *call, SOLFEC_Callback callback);
@@ -246,6 +257,12 @@ void SOLFEC_2_MBFCP (SOLFEC *sol, FILE *out);
  * against body labels -- narrowing down the set of bodies whose state will  be initialized */
 int SOLFEC_Initialize_State (SOLFEC *sol, char *path, double time, SET *subset);
 
+/* write restart checkpoints every 'interval' seconds of wall-clock time and at the end of each run */
+void SOLFEC_Checkpoint (SOLFEC *sol, double interval);
+
+/* restore state from the checkpoint of the output at 'path'; return 1 on success, 0 otherwise */
+int SOLFEC_Restart (SOLFEC *sol, char *path);
+
 /* map rigid motion onto FEM bodies; return 1 on success, 0 otherwise;
  * optinal "subset" is a set of strings defining POSIX regular expressions to be matched
  * against body labels -- narrowing down the set of bodies whose state will  be initialized */
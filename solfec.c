@@ -23,6 +23,10 @@
 #include <zoltan.h>
 #endif
 
+#if OMP
+#include <omp.h>
+#endif
+
 #include <signal.h>
 #include <string.h>
 #include <stdio.h>
@@ -304,7 +308,21 @@ int main (int argc, char **argv)
   signal (SIGSEGV, sighnd);
 
 #if MPI
+#if OMP
+  int provided, rank;
+
+  /* hybrid mode: threads run between MPI calls issued by the master thread */
+  MPI_Init_thread (&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+
+  if (provided < MPI_THREAD_FUNNELED)
+  {
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+    if (rank == 0) fprintf (stderr, "WARNING: MPI_THREAD_FUNNELED is not supported => using one thread per rank\n");
+    omp_set_num_threads (1);
+  }
+#else
   MPI_Init (&argc, &argv);
+#endif
 #if ZOLTAN
   float version;
   ASSERT (Zoltan_Initialize (argc, argv, &version) == ZOLTAN_OK, ERR_ZOLTAN_INIT);
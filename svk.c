@@ -1482,3 +1482,91 @@ void SVK_Tangent_Derivative_C (int comp,
     }
   }
 }
+
+/* batched column-wise F => ............................. */
+
+double SVK_Energy_Batch_C (double lambda, double mi, int n, int ld, double *volume, double *F)
+{
+  double f0, f1, f2, f3, f4, f5, f6, f7, f8,
+         e0, e1, e2, e4, e5, e8,
+         s0, s1, s2, s4, s5, s8,
+         trace, energy;
+  int i;
+
+  for (i = 0, energy = 0.0; i < n; i ++)
+  {
+    f0 = F [i];      f1 = F [ld+i];   f2 = F [2*ld+i];
+    f3 = F [3*ld+i]; f4 = F [4*ld+i]; f5 = F [5*ld+i];
+    f6 = F [6*ld+i]; f7 = F [7*ld+i]; f8 = F [8*ld+i];
+
+    /* symmetric Green tensor: E = (FF - 1) / 2 */
+    e0 = .5 * (f0*f0 + f1*f1 + f2*f2 - 1.);
+    e1 = .5 * (f3*f0 + f4*f1 + f5*f2);
+    e2 = .5 * (f6*f0 + f7*f1 + f8*f2);
+    e4 = .5 * (f3*f3 + f4*f4 + f5*f5 - 1.);
+    e5 = .5 * (f6*f3 + f7*f4 + f8*f5);
+    e8 = .5 * (f6*f6 + f7*f7 + f8*f8 - 1.);
+
+    /* symmetric second PK tensor */
+    trace = e0 + e4 + e8;
+    s0 = 2. * mi * e0 + lambda * trace;
+    s1 = 2. * mi * e1;
+    s2 = 2. * mi * e2;
+    s4 = 2. * mi * e4 + lambda * trace;
+    s5 = 2. * mi * e5;
+    s8 = 2. * mi * e8 + lambda * trace;
+
+    /* internal energy: 0.5 * E : C : E */
+    energy += 0.5 * volume [i] * (e0*s0+e1*s1+e2*s2+e1*s1+e4*s4+e5*s5+e2*s2+e5*s5+e8*s8);
+  }
+
+  return energy;
+}
+
+void SVK_Stress_Batch_C (double lambda, double mi, int n, int ld, double *volume, double *F, double *P)
+{
+  double f0, f1, f2, f3, f4, f5, f6, f7, f8,
+         e0, e1, e2, e4, e5, e8,
+         s0, s1, s2, s4, s5, s8,
+         trace, v;
+  int i;
+
+#if defined(__GNUC__) && !defined(__clang__)
+  #pragma GCC ivdep /* P does not overlap F */
+#endif
+  for (i = 0; i < n; i ++)
+  {
+    f0 = F [i];      f1 = F [ld+i];   f2 = F [2*ld+i];
+    f3 = F [3*ld+i]; f4 = F [4*ld+i]; f5 = F [5*ld+i];
+    f6 = F [6*ld+i]; f7 = F [7*ld+i]; f8 = F [8*ld+i];
+
+    /* symmetric Green tensor: E = (FF - 1) / 2 */
+    e0 = .5 * (f0*f0 + f1*f1 + f2*f2 - 1.);
+    e1 = .5 * (f3*f0 + f4*f1 + f5*f2);
+    e2 = .5 * (f6*f0 + f7*f1 + f8*f2);
+    e4 = .5 * (f3*f3 + f4*f4 + f5*f5 - 1.);
+    e5 = .5 * (f6*f3 + f7*f4 + f8*f5);
+    e8 = .5 * (f6*f6 + f7*f7 + f8*f8 - 1.);
+
+    /* symmetric second PK tensor */
+    trace = e0 + e4 + e8;
+    s0 = 2. * mi * e0 + lambda * trace;
+    s1 = 2. * mi * e1;
+    s2 = 2. * mi * e2;
+    s4 = 2. * mi * e4 + lambda * trace;
+    s5 = 2. * mi * e5;
+    s8 = 2. * mi * e8 + lambda * trace;
+
+    /* first PK tensor: P = F S */
+    v = volume [i];
+    P [i]      = v * (f0*s0 + f3*s1 + f6*s2);
+    P [ld+i]   = v * (f1*s0 + f4*s1 + f7*s2);
+    P [2*ld+i] = v * (f2*s0 + f5*s1 + f8*s2);
+    P [3*ld+i] = v * (f0*s1 + f3*s4 + f6*s5);
+    P [4*ld+i] = v * (f1*s1 + f4*s4 + f7*s5);
+    P [5*ld+i] = v * (f2*s1 + f5*s4 + f8*s5);
+    P [6*ld+i] = v * (f0*s2 + f3*s5 + f6*s8);
+    P [7*ld+i] = v * (f1*s2 + f4*s5 + f7*s8);
+    P [8*ld+i] = v * (f2*s2 + f5*s5 + f8*s8);
+  }
+}
@@ -47,4 +47,9 @@ void SVK_Tangent_Diagonal_C (double lambda, double mi, double volume, int dim, d
 void SVK_Tangent_Derivative_R (int comp, double lambda, double mi, double volume, int dim, double *F, double *K); /* F is row-wise */
 void SVK_Tangent_Derivative_C (int comp, double lambda, double mi, double volume, int dim, double *F, double *K); /* F is column-wise */
 
+/* batched versions of the column-wise routines above, operating on 'n' points; F and P are stored
+ * component-wise with the leading dimension 'ld', so that F [k*ld+i] is the k-th component at point i */
+double SVK_Energy_Batch_C (double lambda, double mi, int n, int ld, double *volume, double *F); /* returns the sum of energies */
+void SVK_Stress_Batch_C (double lambda, double mi, int n, int ld, double *volume, double *F, double *P);
+
 #endif
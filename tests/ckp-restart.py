@@ -0,0 +1,69 @@
+# restart checkpoint test: a run restarted from the checkpoint written at its half
+# continues with the same contacts and reactions as an uninterrupted run
+step = 0.001
+stop = 0.1
+
+def ckp_restart_model (path):
+  solfec = SOLFEC ('DYNAMIC', step, path)
+  solfec.verbose = 'OFF'
+  SURFACE_MATERIAL (solfec, model = 'SIGNORINI_COULOMB', friction = 0.3)
+  material = BULK_MATERIAL (solfec, model = 'KIRCHHOFF', young = 1E6, poisson = 0.25, density = 1E3)
+  GRAVITY (solfec, (0, 0, -9.81))
+
+  base = [-1.0, -1.0, -0.2,
+           1.0, -1.0, -0.2,
+           1.0,  1.0, -0.2,
+          -1.0,  1.0, -0.2,
+          -1.0, -1.0,  0.0,
+           1.0, -1.0,  0.0,
+           1.0,  1.0,  0.0,
+          -1.0,  1.0,  0.0]
+  cube = [-0.2, -0.2, 0.0,
+           0.2, -0.2, 0.0,
+           0.2,  0.2, 0.0,
+          -0.2,  0.2, 0.0,
+          -0.2, -0.2, 0.4,
+           0.2, -0.2, 0.4,
+           0.2,  0.2, 0.4,
+          -0.2,  0.2, 0.4]
+  surfaces = [0, 0, 0, 0, 0, 0]
+
+  BODY (solfec, 'OBSTACLE', HEX (base, 1, 1, 1, 0, surfaces), material)
+  bodies = []
+  for i in range (3):
+    msh = HEX (cube, 1, 1, 1, 0, surfaces)
+    TRANSLATE (msh, (0.05*i, 0.0, 0.41*i))
+    ROTATE (msh, (0, 0, 0.41*i), (0, 0, 1), 10*i)
+    bodies.append (BODY (solfec, 'RIGID', msh, material, label = 'CUBE%d' % i))
+  bodies[2].velo = (0, 0, 0, 0.5, 0, -1.0)
+  FIX_POINT (bodies[0], (-0.2, -0.2, 0.0))
+
+  OUTPUT (solfec, 5*step)
+  return (solfec, bodies)
+
+if not VIEWER():
+  (sol0, bod0) = ckp_restart_model ('out/tests/ckp-restart/uninterrupted')
+  if sol0.mode == 'READ':
+    print '\nPrevious test results exist. Please "make del" and rerun tests'
+  else:
+    solver = GAUSS_SEIDEL_SOLVER (1E-8, 1000)
+    RUN (sol0, solver, stop)
+
+    (sol1, bod1) = ckp_restart_model ('out/tests/ckp-restart/interrupted')
+    CHECKPOINT (sol1, 0.0) # every step and at the end of the run
+    RUN (sol1, solver, 0.5*stop)
+    half = sol1.time
+
+    (sol2, bod2) = ckp_restart_model ('out/tests/ckp-restart/restarted')
+    RESTART (sol2, 'out/tests/ckp-restart/interrupted')
+    restored = sol2.time == half and [b.conf for b in bod2] == [b.conf for b in bod1] and [b.velo for b in bod2] == [b.velo for b in bod1]
+    RUN (sol2, solver, stop - sol2.time)
+
+    d = 0.0
+    for (b0, b2) in zip (bod0, bod2):
+      d = max ([d] + [abs (x - y) for (x, y) in zip (b0.conf + b0.velo, b2.conf + b2.velo)])
+
+    if not restored: print 'FAILED (restored state differs from the checkpointed one)'
+    elif abs (sol2.time - sol0.time) > 0.5*step: print 'FAILED (restarted run ended at %g instead of %g)' % (sol2.time, sol0.time)
+    elif d > 1E-10: print 'FAILED (restarted run differs from the uninterrupted one by %g)' % d
+    else: print 'PASSED'
@@ -0,0 +1,45 @@
+# linearly implicit finite element refactorization policies: a spinning block in free flight
+step = 1E-3
+stop = 0.05
+
+nodes = [0, 0, 0,
+         1, 0, 0,
+         1, 1, 0,
+         0, 1, 0,
+         0, 0, 1,
+         1, 0, 1,
+         1, 1, 1,
+         0, 1, 1]
+
+def run (refactor, path):
+  solfec = SOLFEC ('DYNAMIC', step, path)
+  solfec.verbose = 'OFF'
+  bulk = BULK_MATERIAL (solfec, model = 'KIRCHHOFF', young = 1E7, poisson = 0.25, density = 1E3)
+  GRAVITY (solfec, (0, 0, -9.81))
+  msh = HEX (nodes, 8, 4, 4, 0, [0]*6)
+  SCALE (msh, (0.4, 0.2, 0.2))
+  bod = BODY (solfec, 'FINITE_ELEMENT', msh, bulk, form = 'TL')
+  bod.scheme = 'DEF_LIM'
+  bod.refactor = refactor
+  INITIAL_VELOCITY (bod, (0.1, 0, -0.1), (0, 10, 0))
+  RUN (solfec, GAUSS_SEIDEL_SOLVER (1E-6, 100), stop)
+  return (solfec, bod)
+
+if not VIEWER():
+  (sol1, bod1) = run ('FULL', 'out/tests/fem-refactor/full')
+  (sol2, bod2) = run ('NUMERIC', 'out/tests/fem-refactor/numeric')
+  (sol3, bod3) = run ('KRYLOV', 'out/tests/fem-refactor/krylov')
+
+  if sol1.mode == 'READ' or sol2.mode == 'READ' or sol3.mode == 'READ':
+    print '\nPrevious test results exist. Please "make del" and rerun tests'
+  else:
+    d2 = max ([abs (x - y) for (x, y) in zip (bod1.conf, bod2.conf)])
+    d3 = max ([abs (x - y) for (x, y) in zip (bod1.conf, bod3.conf)])
+
+    if bod3.refactor != 'KRYLOV':
+      print 'FAILED (refactorization policy not set)'
+    elif d2 > 1E-12:
+      print 'FAILED (numeric refactorization changes the configuration by %g)' % d2
+    elif d3 > 1E-8:
+      print 'FAILED (lagged factorization changes the configuration by %g)' % d3
+    else: print 'PASSED'
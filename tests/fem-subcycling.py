@@ -0,0 +1,54 @@
+# explicit finite element subcycling: stiff and rigid blocks sliding to rest on a frictional table
+from math import fabs
+
+step = 1E-3
+stop = 0.5
+
+def box (x, y, z, a, b, c):
+  return [x,   y,   z,
+          x+a, y,   z,
+          x+a, y+b, z,
+          x,   y+b, z,
+          x,   y,   z+c,
+          x+a, y,   z+c,
+          x+a, y+b, z+c,
+          x,   y+b, z+c]
+
+def run (subcycling, path):
+  solfec = SOLFEC ('DYNAMIC', step, path)
+  solfec.verbose = 'OFF'
+  solfec.subcycling = subcycling
+  SURFACE_MATERIAL (solfec, model = 'SIGNORINI_COULOMB', friction = 0.3)
+  soft = BULK_MATERIAL (solfec, model = 'KIRCHHOFF', young = 1E6, poisson = 0.25, density = 1E3)
+  stiff = BULK_MATERIAL (solfec, model = 'KIRCHHOFF', young = 1E8, poisson = 0.25, density = 1E3)
+  GRAVITY (solfec, (0, 0, -9.81))
+  BODY (solfec, 'OBSTACLE', HEX (box (-1, -0.5, -0.1, 2, 1, 0.1), 1, 1, 1, 0, [0]*6), soft)
+  rig = BODY (solfec, 'RIGID', HEX (box (-0.8, -0.1, 0.0, 0.2, 0.2, 0.2), 2, 2, 1, 0, [0]*6), soft)
+  fem = BODY (solfec, 'FINITE_ELEMENT', HEX (box (0.2, -0.1, 0.0, 0.2, 0.2, 0.2), 2, 2, 2, 0, [0]*6), stiff, form = 'TL')
+  INITIAL_VELOCITY (rig, (1, 0, 0), (0, 0, 0))
+  INITIAL_VELOCITY (fem, (1, 0, 0), (0, 0, 0))
+  gs = GAUSS_SEIDEL_SOLVER (1E-6, 1000)
+  RUN (solfec, gs, stop)
+  return (solfec, rig, fem)
+
+if not VIEWER():
+  (sol1, rig1, fem1) = run ('OFF', 'out/tests/fem-subcycling/off')
+  (sol2, rig2, fem2) = run ('ON', 'out/tests/fem-subcycling/on')
+
+  if sol1.mode == 'READ' or sol2.mode == 'READ':
+    print '\nPrevious test results exist. Please "make del" and rerun tests'
+  else:
+    x1 = DISPLACEMENT (fem1, (0.3, 0.0, 0.1)) [0]
+    x2 = DISPLACEMENT (fem2, (0.3, 0.0, 0.1)) [0]
+    r1 = DISPLACEMENT (rig1, (-0.7, 0.0, 0.1)) [0]
+    r2 = DISPLACEMENT (rig2, (-0.7, 0.0, 0.1)) [0]
+
+    if sol2.subcycling != 'ON':
+      print 'FAILED (subcycling not set)'
+    elif not sol1.step < step:
+      print 'FAILED (reference step %g was not limited by the stiff body)' % sol1.step
+    elif sol2.step != step:
+      print 'FAILED (subcycled step %g differs from %g)' % (sol2.step, step)
+    elif fabs (x1 - x2) > 0.02 * x1 or fabs (r1 - r2) > 0.02 * r1:
+      print 'FAILED (finite element sliding distance %g vs %g, rigid %g vs %g)' % (x1, x2, r1, r2)
+    else: print 'PASSED'
@@ -0,0 +1,88 @@
+# Gauss-Seidel merit function evaluation modes test
+from sys import stdout
+
+GEOMETRIC_EPSILON (1E-6) # default value; other tests in the same run may change it
+
+step = 0.001
+stop = 0.5
+maxiter = 1000
+epsilon = 1E-4
+meritval = 1E-6
+CHECK = [] # termination criterion violations
+TERM = {'EXACT': [], 'INCREMENTAL': []} # termination points (iters, error, merit) per time step
+
+def stack_create (solfec, material):
+  base = [-1.0, -1.0, -0.2,
+           1.0, -1.0, -0.2,
+           1.0,  1.0, -0.2,
+          -1.0,  1.0, -0.2,
+          -1.0, -1.0,  0.0,
+           1.0, -1.0,  0.0,
+           1.0,  1.0,  0.0,
+          -1.0,  1.0,  0.0]
+  cube = [-0.2, -0.2, 0.0,
+           0.2, -0.2, 0.0,
+           0.2,  0.2, 0.0,
+          -0.2,  0.2, 0.0,
+          -0.2, -0.2, 0.4,
+           0.2, -0.2, 0.4,
+           0.2,  0.2, 0.4,
+          -0.2,  0.2, 0.4]
+  surfaces = [0, 0, 0, 0, 0, 0]
+
+  BODY (solfec, 'OBSTACLE', HEX (base, 1, 1, 1, 0, surfaces), material)
+  bodies = []
+  for i in range (4):
+    msh = HEX (cube, 1, 1, 1, 0, surfaces)
+    TRANSLATE (msh, (0.05*(i%2), 0.0, 0.4*i + 0.01*i))
+    ROTATE (msh, (0, 0, 0.4*i), (0, 0, 1), 10*i)
+    bodies.append (BODY (solfec, 'RIGID', msh, material))
+  return bodies
+
+def termination_check (gs):
+  n = gs.iters
+  if n > 0: TERM [gs.meritmode].append ((n, gs.rerhist [n-1], gs.merhist [n-1]))
+  if n > 0 and n < maxiter:
+    if gs.rerhist [n-1] > epsilon or gs.merhist [n-1] > meritval:
+      CHECK.append ((n, gs.rerhist [n-1], gs.merhist [n-1]))
+  return 1
+
+def run (mode, path):
+  solfec = SOLFEC ('DYNAMIC', step, path)
+  solfec.verbose = 'OFF'
+  SURFACE_MATERIAL (solfec, model = 'SIGNORINI_COULOMB', friction = 0.5)
+  material = BULK_MATERIAL (solfec, model = 'KIRCHHOFF', young = 1E6, poisson = 0.25, density = 1E3)
+  GRAVITY (solfec, (0, 0, -9.81))
+  bodies = stack_create (solfec, material)
+  gs = GAUSS_SEIDEL_SOLVER (epsilon, maxiter, meritval)
+  gs.meritmode = mode
+  gs.itershist = 'ON'
+  CALLBACK (solfec, step, gs, termination_check)
+  RUN (solfec, gs, stop)
+  return (solfec, bodies, gs)
+
+if not VIEWER():
+  (sol1, bod1, gs1) = run ('EXACT', 'out/tests/gs-merit/exact')
+  (sol2, bod2, gs2) = run ('INCREMENTAL', 'out/tests/gs-merit/incremental')
+
+  if sol1.mode == 'READ' or sol2.mode == 'READ':
+    print '\nPrevious test results exist. Please "make del" and rerun tests'
+  else:
+    dx = 0.0
+    for (a, b) in zip (bod1, bod2):
+      for (x, y) in zip (a.conf, b.conf): dx = max (dx, abs (x - y))
+    term = [i for i in range (len (TERM ['EXACT'])) if TERM ['EXACT'][i] != TERM ['INCREMENTAL'][i]]
+
+    if gs2.meritmode != 'INCREMENTAL':
+      print 'FAILED (merit mode not set)'
+    elif len (CHECK) > 0:
+      print 'FAILED (termination criterion violated %d times, e.g. iters = %d, error = %g, merit = %g)' % ((len (CHECK),) + CHECK[0])
+    elif len (TERM ['EXACT']) < 10 or len (TERM ['EXACT']) != len (TERM ['INCREMENTAL']):
+      print 'FAILED (termination points recorded: EXACT = %d, INCREMENTAL = %d)' % (len (TERM ['EXACT']), len (TERM ['INCREMENTAL']))
+    elif gs1.itershist != gs2.itershist:
+      print 'FAILED (iteration counts differ: EXACT = %d, INCREMENTAL = %d in total)' % (sum (gs1.itershist), sum (gs2.itershist))
+    elif len (term) > 0:
+      print 'FAILED (termination points differ at %d steps, e.g. EXACT %s, INCREMENTAL %s)' % (len (term), TERM ['EXACT'][term[0]], TERM ['INCREMENTAL'][term[0]])
+    elif dx > 1E-12:
+      print 'FAILED (configurations differ by %g)' % dx
+    else: print 'PASSED'
@@ -0,0 +1,71 @@
+# Gauss-Seidel active set scheduling test
+GEOMETRIC_EPSILON (1E-6) # default value; other tests in the same run may change it
+
+step = 0.001
+stop = 0.5
+epsilon = 1E-6
+
+def stack_create (solfec, material):
+  base = [-1.0, -1.0, -0.2,
+           1.0, -1.0, -0.2,
+           1.0,  1.0, -0.2,
+          -1.0,  1.0, -0.2,
+          -1.0, -1.0,  0.0,
+           1.0, -1.0,  0.0,
+           1.0,  1.0,  0.0,
+          -1.0,  1.0,  0.0]
+  cube = [-0.1, -0.1, 0.0,
+           0.1, -0.1, 0.0,
+           0.1,  0.1, 0.0,
+          -0.1,  0.1, 0.0,
+          -0.1, -0.1, 0.2,
+           0.1, -0.1, 0.2,
+           0.1,  0.1, 0.2,
+          -0.1,  0.1, 0.2]
+  surfaces = [0, 0, 0, 0, 0, 0]
+
+  BODY (solfec, 'OBSTACLE', HEX (base, 1, 1, 1, 0, surfaces), material)
+  bodies = []
+  for i in range (3):
+    for j in range (3):
+      for k in range (3):
+        msh = HEX (cube, 1, 1, 1, 0, surfaces)
+        TRANSLATE (msh, (-0.3 + 0.3*i, -0.3 + 0.3*j, 0.001 + 0.201*k))
+        bodies.append (BODY (solfec, 'RIGID', msh, material))
+  return bodies
+
+def run (schedule, path):
+  solfec = SOLFEC ('DYNAMIC', step, path)
+  solfec.verbose = 'OFF'
+  SURFACE_MATERIAL (solfec, model = 'SIGNORINI_COULOMB', friction = 0.5)
+  material = BULK_MATERIAL (solfec, model = 'KIRCHHOFF', young = 1E6, poisson = 0.25, density = 1E3)
+  GRAVITY (solfec, (0, 0, -9.81))
+  bodies = stack_create (solfec, material)
+  gs = GAUSS_SEIDEL_SOLVER (epsilon, 5000)
+  gs.schedule = schedule
+  gs.itershist = 'ON'
+  RUN (solfec, gs, stop)
+  return (solfec, bodies, gs)
+
+if not VIEWER():
+  (sol1, bod1, gs1) = run ('FULL', 'out/tests/gs-schedule/full')
+  (sol2, bod2, gs2) = run ('ACTIVE', 'out/tests/gs-schedule/active')
+
+  if sol1.mode == 'READ' or sol2.mode == 'READ':
+    print '\nPrevious test results exist. Please "make del" and rerun tests'
+  else:
+    dx = 0.0
+    for (a, b) in zip (bod1, bod2):
+      for (x, y) in zip (a.conf, b.conf): dx = max (dx, abs (x - y))
+
+    if gs2.schedule != 'ACTIVE' or gs2.parksweeps != 3:
+      print 'FAILED (schedule not set)'
+    elif gs1.skipped != 0 or gs2.skipped == 0:
+      print 'FAILED (no block updates were skipped by the ACTIVE schedule)'
+    elif gs2.relaxed >= gs1.relaxed:
+      print 'FAILED (ACTIVE schedule did not save work: %d >= %d block updates)' % (gs2.relaxed, gs1.relaxed)
+    elif max (gs2.itershist) >= 5000:
+      print 'FAILED (ACTIVE schedule did not converge)'
+    elif dx > 1E-3:
+      print 'FAILED (configurations differ by %g)' % dx
+    else: print 'PASSED'
@@ -0,0 +1,70 @@
+# columnar history store test: HISTORY read through the store matches HISTORY read from complete output states
+step = 0.001
+stop = 0.3
+path = 'out/tests/hst-history'
+
+def hst_history_run (read):
+  solfec = SOLFEC ('DYNAMIC', step, path)
+  solfec.verbose = 'OFF'
+  SURFACE_MATERIAL (solfec, model = 'SIGNORINI_COULOMB', friction = 0.3)
+  material = BULK_MATERIAL (solfec, model = 'KIRCHHOFF', young = 1E6, poisson = 0.25, density = 1E3)
+  GRAVITY (solfec, (0, 0, -9.81))
+
+  base = [-1.0, -1.0, -0.2,
+           1.0, -1.0, -0.2,
+           1.0,  1.0, -0.2,
+          -1.0,  1.0, -0.2,
+          -1.0, -1.0,  0.0,
+           1.0, -1.0,  0.0,
+           1.0,  1.0,  0.0,
+          -1.0,  1.0,  0.0]
+  cube = [-0.2, -0.2, 0.0,
+           0.2, -0.2, 0.0,
+           0.2,  0.2, 0.0,
+          -0.2,  0.2, 0.0,
+          -0.2, -0.2, 0.4,
+           0.2, -0.2, 0.4,
+           0.2,  0.2, 0.4,
+          -0.2,  0.2, 0.4]
+  surfaces = [0, 0, 0, 0, 0, 0]
+
+  BODY (solfec, 'OBSTACLE', HEX (base, 1, 1, 1, 0, surfaces), material)
+  bodies = []
+  for i in range (3):
+    msh = HEX (cube, 1, 1, 1, 0, surfaces)
+    TRANSLATE (msh, (0.05*i, 0.0, 0.45*i + 0.01))
+    ROTATE (msh, (0, 0, 0.45*i), (0, 0, 1), 10*i)
+    bodies.append (BODY (solfec, 'RIGID', msh, material, label = 'CUBE%d' % i))
+
+  OUTPUT (solfec, 2*step, columns = 7) # chunks do not divide the number of frames
+  RUN (solfec, GAUSS_SEIDEL_SOLVER (1E-6, 1000), stop)
+  if read: return (solfec, bodies)
+  else: return solfec.mode # release the written output
+
+if not VIEWER():
+  if hst_history_run (0) == 'READ':
+    print '\nPrevious test results exist. Please "make del" and rerun tests'
+  else:
+    (solfec, bodies) = hst_history_run (1) # reopen in read mode
+
+    b = bodies [2]
+    items = [(b, b.center, 'DX'), ('CUBE1', (0.2, 0.2, 0.4), 'VZ'), (solfec, 'KINETIC'), (bodies[1:], 'EXTERNAL'),
+             (solfec, None, None, 'R'), (bodies[0], (0, 0, 1), None, 'U'), (solfec, None, None, 'GAP')]
+
+    passed = 1
+    for skip in [1, 3]:
+      th1 = HISTORY (solfec, items, 0, stop, skip) # columnar store
+      th2 = HISTORY (solfec, items + ['STEP'], 0, stop, skip) # labeled values force reading of complete states
+      if len (th1[0]) < 10 or th1[0] != th2[0][:len (th1[0])]:
+        passed = 0
+        print '\b\b\b\bFAILED (history times differ for skip = %d)' % skip
+        break
+      for i in range (1, len (th1)):
+        d = max ([abs (x - y) for (x, y) in zip (th1[i], th2[i])])
+        if d > 1E-10 * max (1.0, max ([abs (y) for y in th2[i]])):
+          passed = 0
+          print '\b\b\b\bFAILED (history %d differs by %g for skip = %d)' % (i, d, skip)
+          break
+      if not passed: break
+
+    if passed: print '\b\b\b\bPASSED'
@@ -17,6 +17,13 @@ for NCPU in $CPUS; do
   DIFF="$DIFF$D"
 done
 
+# hybrid runs: 2 threads per rank (no effect unless OPENMP=yes)
+echo -n "(threads: 2) "
+OMP_NUM_THREADS=2 mpirun -np 2 solfec-mpi -s 2x2 ./tests/locdyn.py
+sort ./out/tests/locdyn/locdyn-2 > ./out/tests/locdyn/locdyn-2x2-sorted
+D=`diff ./out/tests/locdyn/locdyn-1-sorted ./out/tests/locdyn/locdyn-2x2-sorted`
+DIFF="$DIFF$D"
+
 if [ -n "$DIFF" ]; then
   echo "FAILED"
 else
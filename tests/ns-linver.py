@@ -0,0 +1,75 @@
+# Newton solver linear stage variants test
+from sys import stdout
+
+GEOMETRIC_EPSILON (1E-6) # default value; other tests in the same run may change it
+
+step = 0.001
+stop = 0.2
+meritval = 1E-8
+FAIL = {} # iterations which did not reach meritval
+
+def stack_create (solfec, material):
+  base = [-1.0, -1.0, -0.2,
+           1.0, -1.0, -0.2,
+           1.0,  1.0, -0.2,
+          -1.0,  1.0, -0.2,
+          -1.0, -1.0,  0.0,
+           1.0, -1.0,  0.0,
+           1.0,  1.0,  0.0,
+          -1.0,  1.0,  0.0]
+  cube = [-0.2, -0.2, 0.0,
+           0.2, -0.2, 0.0,
+           0.2,  0.2, 0.0,
+          -0.2,  0.2, 0.0,
+          -0.2, -0.2, 0.4,
+           0.2, -0.2, 0.4,
+           0.2,  0.2, 0.4,
+          -0.2,  0.2, 0.4]
+  surfaces = [0, 0, 0, 0, 0, 0]
+
+  BODY (solfec, 'OBSTACLE', HEX (base, 1, 1, 1, 0, surfaces), material)
+  bodies = []
+  for i in range (4):
+    msh = HEX (cube, 1, 1, 1, 0, surfaces)
+    TRANSLATE (msh, (0.05*(i%2), 0.0, 0.4*i + 0.01*i))
+    ROTATE (msh, (0, 0, 0.4*i), (0, 0, 1), 10*i)
+    bodies.append (BODY (solfec, 'RIGID', msh, material))
+  return bodies
+
+def merit_check (ns):
+  n = ns.iters
+  if n > 0 and ns.merhist [n-1] > meritval:
+    FAIL [ns.linver] = FAIL.get (ns.linver, 0) + 1
+  return 1
+
+def run (linver, path):
+  solfec = SOLFEC ('DYNAMIC', step, path)
+  solfec.verbose = 'OFF'
+  SURFACE_MATERIAL (solfec, model = 'SIGNORINI_COULOMB', friction = 0.5)
+  material = BULK_MATERIAL (solfec, model = 'KIRCHHOFF', young = 1E6, poisson = 0.25, density = 1E3)
+  GRAVITY (solfec, (0, 0, -9.81))
+  bodies = stack_create (solfec, material)
+  ns = NEWTON_SOLVER (meritval, 100, linver = linver)
+  ns.gsflag = 'OFF'
+  CALLBACK (solfec, step, ns, merit_check)
+  RUN (solfec, ns, stop)
+  return (solfec, bodies, ns)
+
+if not VIEWER():
+  res = [run (v, 'out/tests/ns-linver/' + v.lower()) for v in ['GMRES', 'DIRECT', 'ILU']]
+
+  if reduce (lambda a, b: a or b, [x[0].mode == 'READ' for x in res]):
+    print '\nPrevious test results exist. Please "make del" and rerun tests'
+  else:
+    dx = 0.0
+    for (sol, bod, ns) in res [1:]:
+      for (a, b) in zip (res[0][1], bod):
+        for (x, y) in zip (a.conf, b.conf): dx = max (dx, abs (x - y))
+
+    if res[1][2].linver != 'DIRECT' or res[2][2].linver != 'ILU':
+      print 'FAILED (linver not set)'
+    elif len (FAIL) > 0:
+      print 'FAILED (merit function not reduced below meritval: %s)' % str (FAIL)
+    elif dx > 1E-3:
+      print 'FAILED (configurations differ by %g)' % dx
+    else: print 'PASSED'
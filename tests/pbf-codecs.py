@@ -0,0 +1,72 @@
+# output compression codecs test: states read from compressed output match uncompressed ones
+import os
+step = 0.001
+stop = 0.1
+
+def pbf_codecs_run (name, kw, read):
+  path = 'out/tests/pbf-codecs/' + name
+  solfec = SOLFEC ('DYNAMIC', step, path)
+  solfec.verbose = 'OFF'
+  SURFACE_MATERIAL (solfec, model = 'SIGNORINI_COULOMB', friction = 0.3)
+  material = BULK_MATERIAL (solfec, model = 'KIRCHHOFF', young = 1E6, poisson = 0.25, density = 1E3)
+  GRAVITY (solfec, (0, 0, -9.81))
+
+  base = [-1.0, -1.0, -0.2,
+           1.0, -1.0, -0.2,
+           1.0,  1.0, -0.2,
+          -1.0,  1.0, -0.2,
+          -1.0, -1.0,  0.0,
+           1.0, -1.0,  0.0,
+           1.0,  1.0,  0.0,
+          -1.0,  1.0,  0.0]
+  cube = [-0.2, -0.2, 0.0,
+           0.2, -0.2, 0.0,
+           0.2,  0.2, 0.0,
+          -0.2,  0.2, 0.0,
+          -0.2, -0.2, 0.4,
+           0.2, -0.2, 0.4,
+           0.2,  0.2, 0.4,
+          -0.2,  0.2, 0.4]
+  surfaces = [0, 0, 0, 0, 0, 0]
+
+  BODY (solfec, 'OBSTACLE', HEX (base, 1, 1, 1, 0, surfaces), material)
+  msh = HEX (cube, 1, 1, 1, 0, surfaces)
+  TRANSLATE (msh, (-0.5, 0.0, 0.01))
+  rig = BODY (solfec, 'RIGID', msh, material)
+  msh = HEX (cube, 3, 3, 3, 0, surfaces)
+  TRANSLATE (msh, (0.3, 0.0, 0.01))
+  fem = BODY (solfec, 'FINITE_ELEMENT', msh, material)
+
+  OUTPUT (solfec, step, **kw)
+  RUN (solfec, GAUSS_SEIDEL_SOLVER (1E-6, 1000), stop)
+  if read: return (solfec, rig, fem, path + '/' + name + '.dat')
+  else: return solfec.mode # release the written output
+
+codecs = [('off', {}),
+          ('fastlz', {'compression' : 'FASTLZ', 'level' : 2}),
+          ('zstd', {'compression' : 'ZSTD'}),
+          ('zstd-shuffle', {'compression' : 'ZSTD', 'level' : 9, 'shuffle' : 'ON'})]
+
+if not VIEWER():
+  if 'READ' in [pbf_codecs_run (name, kw, 0) for (name, kw) in codecs]:
+    print '\nPrevious test results exist. Please "make del" and rerun tests'
+  else:
+    passed = 1
+    ref = None
+    for (name, kw) in codecs:
+      (solfec, rig, fem, dat) = pbf_codecs_run (name, kw, 1) # reopen in read mode
+      th = HISTORY (solfec, [(rig, rig.center, 'VZ'), (fem, fem.center, 'DZ'), (solfec, 'KINETIC'), 'STEP'], 0, stop)
+      SEEK (solfec, stop)
+      val = (th, fem.conf, fem.velo, os.path.getsize (dat))
+      del solfec
+      if ref == None: ref = val
+      elif val[0] != ref[0] or val[1] != ref[1] or val[2] != ref[2]:
+        passed = 0
+        print '\b\b\b\bFAILED (%s states differ from uncompressed ones)' % name
+        break
+      elif val[3] >= ref[3]:
+        passed = 0
+        print '\b\b\b\bFAILED (%s output of %d bytes is not smaller than uncompressed %d bytes)' % (name, val[3], ref[3])
+        break
+
+    if passed: print '\b\b\b\bPASSED'
@@ -0,0 +1,108 @@
+# delta coded output test: states read from delta coded output match, or are within the quantization tolerance of, full states
+step = 0.001
+stop = 0.1
+tolerance = 1E-6
+
+def pbf_delta_run (name, kw, read):
+  path = 'out/tests/pbf-delta/' + name
+  solfec = SOLFEC ('DYNAMIC', step, path)
+  solfec.verbose = 'OFF'
+  SURFACE_MATERIAL (solfec, model = 'SIGNORINI_COULOMB', friction = 0.3)
+  material = BULK_MATERIAL (solfec, model = 'KIRCHHOFF', young = 1E6, poisson = 0.25, density = 1E3)
+  GRAVITY (solfec, (0, 0, -9.81))
+
+  base = [-1.0, -1.0, -0.2,
+           1.0, -1.0, -0.2,
+           1.0,  1.0, -0.2,
+          -1.0,  1.0, -0.2,
+          -1.0, -1.0,  0.0,
+           1.0, -1.0,  0.0,
+           1.0,  1.0,  0.0,
+          -1.0,  1.0,  0.0]
+  cube = [-0.2, -0.2, 0.0,
+           0.2, -0.2, 0.0,
+           0.2,  0.2, 0.0,
+          -0.2,  0.2, 0.0,
+          -0.2, -0.2, 0.4,
+           0.2, -0.2, 0.4,
+           0.2,  0.2, 0.4,
+          -0.2,  0.2, 0.4]
+  surfaces = [0, 0, 0, 0, 0, 0]
+
+  bodies = [BODY (solfec, 'OBSTACLE', HEX (base, 1, 1, 1, 0, surfaces), material)]
+  for i in range (3):
+    msh = HEX (cube, 1, 1, 1, 0, surfaces)
+    TRANSLATE (msh, (-0.5, 0.0, 0.45*i + 0.01))
+    bodies.append (BODY (solfec, 'RIGID', msh, material))
+  msh = HEX (cube, 3, 3, 3, 0, surfaces)
+  TRANSLATE (msh, (0.3, 0.0, 0.01))
+  bodies.append (BODY (solfec, 'FINITE_ELEMENT', msh, material))
+
+  if read != 2:
+    OUTPUT (solfec, step, **kw)
+    RUN (solfec, GAUSS_SEIDEL_SOLVER (1E-6, 1000), stop)
+  if read: return (solfec, bodies)
+  else: return solfec.mode # release the written output
+
+def pbf_delta_diff (bod1, bod2):
+  dq = dv = 0.0
+  for (a, b) in zip (bod1, bod2):
+    dq = max ([dq] + [abs (x - y) for (x, y) in zip (a.conf, b.conf)])
+    dv = max ([dv] + [abs (x - y) for (x, y) in zip (a.velo, b.velo)])
+  return (dq, dv)
+
+outputs = [('full', {}),
+           ('lossless', {'keyframes' : 7}),
+           ('lossy', {'keyframes' : 7, 'tolerance' : tolerance, 'compression' : 'ON'})]
+
+if not VIEWER():
+  if 'READ' in [pbf_delta_run (name, kw, 0) for (name, kw) in outputs]:
+    print '\nPrevious test results exist. Please "make del" and rerun tests'
+  else:
+    (sol0, bod0) = pbf_delta_run ('full', {}, 1)
+    times = [0.057, 0.003, 0.1, 0.05, 0.05, 0.021, 0.0, 0.088] # random access across keyframes
+    passed = 1
+
+    for (name, kw) in outputs [1:]:
+      (sol1, bod1) = pbf_delta_run (name, kw, 1)
+      bound = 0.0 if name == 'lossless' else 0.5*tolerance*(1.0 + 1E-6)
+      dq = dv = 0.0
+
+      for t in times:
+        SEEK (sol0, t)
+        SEEK (sol1, t)
+        d = pbf_delta_diff (bod0, bod1)
+        dq = max (dq, d[0])
+        dv = max (dv, d[1])
+        FORWARD (sol0, 3)
+        FORWARD (sol1, 3)
+        d = pbf_delta_diff (bod0, bod1)
+        dq = max (dq, d[0])
+        dv = max (dv, d[1])
+        BACKWARD (sol0, 5)
+        BACKWARD (sol1, 5)
+        d = pbf_delta_diff (bod0, bod1)
+        dq = max (dq, d[0])
+        dv = max (dv, d[1])
+
+      if dq > bound or dv > bound:
+        passed = 0
+        print '\b\b\b\bFAILED (%s states differ: configuration by %g, velocity by %g)' % (name, dq, dv)
+        break
+
+      rigid = max ([abs (x - y) for (a, b) in zip (bod0[:4], bod1[:4]) for (x, y) in zip (a.conf, b.conf)])
+      if rigid > 0.0:
+        passed = 0
+        print '\b\b\b\bFAILED (%s rigid configurations differ by %g)' % (name, rigid)
+        break
+
+      (sol2, bod2) = pbf_delta_run (name + '-init', {}, 2)
+      INITIALIZE_STATE (sol2, 'out/tests/pbf-delta/' + name, 0.057)
+      SEEK (sol0, 0.057)
+      d = pbf_delta_diff (bod0, bod2)
+      if d[0] > bound or d[1] > bound:
+        passed = 0
+        print '\b\b\b\bFAILED (%s initialized states differ: configuration by %g, velocity by %g)' % (name, d[0], d[1])
+        break
+
+    if passed: print '\b\b\b\bPASSED'
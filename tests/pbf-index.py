@@ -0,0 +1,92 @@
+# persisted time index test: seeking with the time index written along with the output, with
+# a time index recreated for the output without it, and with a truncated time index gives the same states
+import os
+
+step = 0.001
+stop = 0.1
+path = 'out/tests/pbf-index'
+tix = path + '/pbf-index.tix'
+
+def pbf_index_run (write):
+  solfec = SOLFEC ('DYNAMIC', step, path)
+  solfec.verbose = 'OFF'
+  SURFACE_MATERIAL (solfec, model = 'SIGNORINI_COULOMB', friction = 0.3)
+  material = BULK_MATERIAL (solfec, model = 'KIRCHHOFF', young = 1E6, poisson = 0.25, density = 1E3)
+  GRAVITY (solfec, (0, 0, -9.81))
+
+  base = [-1.0, -1.0, -0.2,
+           1.0, -1.0, -0.2,
+           1.0,  1.0, -0.2,
+          -1.0,  1.0, -0.2,
+          -1.0, -1.0,  0.0,
+           1.0, -1.0,  0.0,
+           1.0,  1.0,  0.0,
+          -1.0,  1.0,  0.0]
+  cube = [-0.2, -0.2, 0.0,
+           0.2, -0.2, 0.0,
+           0.2,  0.2, 0.0,
+          -0.2,  0.2, 0.0,
+          -0.2, -0.2, 0.4,
+           0.2, -0.2, 0.4,
+           0.2,  0.2, 0.4,
+          -0.2,  0.2, 0.4]
+  surfaces = [0, 0, 0, 0, 0, 0]
+
+  bodies = [BODY (solfec, 'OBSTACLE', HEX (base, 1, 1, 1, 0, surfaces), material)]
+  for i in range (3):
+    msh = HEX (cube, 1, 1, 1, 0, surfaces)
+    TRANSLATE (msh, (0.05*i, 0.0, 0.45*i + 0.01))
+    bodies.append (BODY (solfec, 'RIGID', msh, material, label = 'CUBE%d' % i))
+
+  OUTPUT (solfec, 2*step)
+  RUN (solfec, GAUSS_SEIDEL_SOLVER (1E-6, 1000), stop)
+  if write: return solfec.mode # release the written output
+  else: return (solfec, bodies)
+
+def pbf_index_states (solfec, bodies, times):
+  states = []
+  for t in times:
+    SEEK (solfec, t)
+    states.append ((solfec.time, [b.conf for b in bodies]))
+    FORWARD (solfec, 2)
+    states.append ((solfec.time, [b.conf for b in bodies]))
+    BACKWARD (solfec, 1)
+    states.append ((solfec.time, [b.conf for b in bodies]))
+  return states
+
+if not VIEWER():
+  if pbf_index_run (1) == 'READ':
+    print '\nPrevious test results exist. Please "make del" and rerun tests'
+  elif not os.path.exists (tix):
+    print 'FAILED (time index was not written)'
+  else:
+    times = [0.057, 0.003, 0.1, 0.05, 0.0511, 0.0, 0.2, -1.0, 0.089] # exact, in between and beyond limits
+    (sol0, bod0) = pbf_index_run (0)
+    dur0 = DURATION (sol0)
+    st0 = pbf_index_states (sol0, bod0, times)
+    sol0 = bod0 = None
+
+    os.remove (tix)
+    (sol1, bod1) = pbf_index_run (0)
+    dur1 = DURATION (sol1)
+    st1 = pbf_index_states (sol1, bod1, times)
+    sol1 = bod1 = None
+    recreated = os.path.exists (tix)
+
+    size = os.path.getsize (tix)
+    f = open (tix, 'r+b')
+    f.truncate (size / 2)
+    f.close ()
+    (sol2, bod2) = pbf_index_run (0)
+    dur2 = DURATION (sol2)
+    st2 = pbf_index_states (sol2, bod2, times)
+
+    if not recreated:
+      print 'FAILED (time index was not recreated)'
+    elif os.path.getsize (tix) != size:
+      print 'FAILED (truncated time index was not rewritten)'
+    elif dur0 != dur1 or dur0 != dur2:
+      print 'FAILED (durations differ: %s, %s, %s)' % (dur0, dur1, dur2)
+    elif st0 != st1 or st0 != st2:
+      print 'FAILED (states read with and without the time index differ)'
+    else: print 'PASSED'
@@ -0,0 +1,114 @@
+# selective state reads test: HISTORY of bodies read through the per frame body tables
+# matches HISTORY read from complete output states (energy items force complete reads)
+step = 0.001
+stop = 0.2
+path = 'out/tests/pbf-select'
+
+def pbf_select_run (read, dynamic = 0):
+  solfec = SOLFEC ('DYNAMIC', step, path + ['', '/dynamic', '/swap'][dynamic])
+  solfec.verbose = 'OFF'
+  SURFACE_MATERIAL (solfec, model = 'SIGNORINI_COULOMB', friction = 0.3)
+  material = BULK_MATERIAL (solfec, model = 'KIRCHHOFF', young = 1E6, poisson = 0.25, density = 1E3)
+  GRAVITY (solfec, (0, 0, -9.81))
+
+  base = [-1.0, -1.0, -0.2,
+           1.0, -1.0, -0.2,
+           1.0,  1.0, -0.2,
+          -1.0,  1.0, -0.2,
+          -1.0, -1.0,  0.0,
+           1.0, -1.0,  0.0,
+           1.0,  1.0,  0.0,
+          -1.0,  1.0,  0.0]
+  cube = [-0.1, -0.1, 0.0,
+           0.1, -0.1, 0.0,
+           0.1,  0.1, 0.0,
+          -0.1,  0.1, 0.0,
+          -0.1, -0.1, 0.2,
+           0.1, -0.1, 0.2,
+           0.1,  0.1, 0.2,
+          -0.1,  0.1, 0.2]
+  surfaces = [0, 0, 0, 0, 0, 0]
+
+  BODY (solfec, 'OBSTACLE', HEX (base, 1, 1, 1, 0, surfaces), material)
+  bodies = []
+  for i in range (12):
+    msh = HEX (cube, 1, 1, 1, 0, surfaces)
+    TRANSLATE (msh, (-0.75 + 0.5*(i%4), -0.5 + 0.5*(i/4), 0.01 + 0.02*i))
+    if i % 3: bodies.append (BODY (solfec, 'RIGID', msh, material)) # unlabeled records are found in body tables
+    else: bodies.append (BODY (solfec, 'RIGID', msh, material, label = 'CUBE%d' % i))
+
+  OUTPUT (solfec, 2*step)
+  if dynamic: # insert and delete bodies after time 0
+    RUN (solfec, GAUSS_SEIDEL_SOLVER (1E-6, 1000), 0.5*stop)
+    if solfec.mode == 'WRITE' and dynamic == 1: # insert one and delete two bodies
+      msh = HEX (cube, 1, 1, 1, 0, surfaces)
+      TRANSLATE (msh, (0.0, 0.75, 0.01))
+      BODY (solfec, 'RIGID', msh, material, label = 'INSERTED')
+      DELETE (solfec, bodies [2])
+      DELETE (solfec, bodies [3])
+    elif solfec.mode == 'WRITE': # delete one body and insert another one with its label
+      DELETE (solfec, bodies [3])
+      msh = HEX (cube, 1, 1, 1, 0, surfaces)
+      TRANSLATE (msh, (0.0, 0.75, 0.01))
+      BODY (solfec, 'RIGID', msh, material, label = 'CUBE3')
+  RUN (solfec, GAUSS_SEIDEL_SOLVER (1E-6, 1000), stop)
+  if read: return (solfec, bodies)
+  else: return solfec.mode # release the written output
+
+def pbf_select_compare (solfec, items, passed):
+  for skip in [1, 4]:
+    th1 = HISTORY (solfec, items, 0, stop, skip) # selective reads
+    th2 = HISTORY (solfec, items + [(solfec, 'KINETIC')], 0, stop, skip) # complete reads
+    if len (th1[0]) < 10 or th1[0] != th2[0]:
+      print 'FAILED (history times differ for skip = %d)' % skip
+      return 0
+    for i in range (1, len (th1)):
+      if [repr (x) for x in th1[i]] != [repr (x) for x in th2[i]]: # NAN marks absent bodies
+        print 'FAILED (history %d differs for skip = %d)' % (i, skip)
+        return 0
+  return passed
+
+if not VIEWER():
+  if 'READ' in [pbf_select_run (0, dynamic) for dynamic in range (3)]:
+    print '\nPrevious test results exist. Please "make del" and rerun tests'
+  else:
+    (solfec, bodies) = pbf_select_run (1) # reopen in read mode
+
+    items = [(bodies[1], bodies[1].center, 'DZ'), (bodies[7], bodies[7].center, 'VX'),
+             ('CUBE9', (0.1, 0.1, 0.2), 'DZ'), (bodies[11], bodies[11].center, 'VZ')]
+
+    passed = pbf_select_compare (solfec, items, 1)
+
+    if passed:
+      SEEK (solfec, 0.5*stop) # body states are read back in full as well
+      t = solfec.time
+      conf = [b.conf for b in bodies]
+      SEEK (solfec, 0.0)
+      SEEK (solfec, t)
+      if conf != [b.conf for b in bodies]:
+        print 'FAILED (body states differ after seeking)'
+        passed = 0
+
+    if passed: # bodies inserted and deleted after time 0
+      (solfec, bodies) = pbf_select_run (1, 1)
+
+      items = [('INSERTED', (0.0, 0.75, 0.1), 'DZ'), ('CUBE3', (-0.25, -0.5, 0.2), 'DZ'),
+               (bodies[2], bodies[2].center, 'VZ'), (bodies[5], bodies[5].center, 'DZ')]
+
+      passed = pbf_select_compare (solfec, items, passed)
+
+      if passed:
+        th = HISTORY (solfec, items [:2], 0, stop)
+        n = len (th[0])
+        if repr (th[1][0]) != 'nan' or repr (th[1][n-1]) == 'nan':
+          print 'FAILED (inserted body history)'
+        elif repr (th[2][0]) == 'nan' or repr (th[2][n-1]) != 'nan':
+          print 'FAILED (deleted body history)'
+          passed = 0
+
+    if passed: # equal numbers of inserted and deleted bodies
+      (solfec, bodies) = pbf_select_run (1, 2)
+
+      items = [('CUBE3', (-0.25, -0.5, 0.2), 'DZ'), (bodies[5], bodies[5].center, 'DZ')]
+
+      if pbf_select_compare (solfec, items, passed): print 'PASSED'
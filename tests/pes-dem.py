@@ -0,0 +1,73 @@
+# penalty solver DEM variant: block sliding to rest on a frictional table
+base = [-1.0, -0.5, -0.1,
+         1.0, -0.5, -0.1,
+         1.0,  0.5, -0.1,
+        -1.0,  0.5, -0.1,
+        -1.0, -0.5,  0.0,
+         1.0, -0.5,  0.0,
+         1.0,  0.5,  0.0,
+        -1.0,  0.5,  0.0]
+cube = [-0.15, -0.15, 0.0,
+         0.15, -0.15, 0.0,
+         0.15,  0.15, 0.0,
+        -0.15,  0.15, 0.0,
+        -0.15, -0.15, 0.1,
+         0.15, -0.15, 0.1,
+         0.15,  0.15, 0.1,
+        -0.15,  0.15, 0.1]
+surfaces = [0, 0, 0, 0, 0, 0]
+
+step = 1E-4
+stop = 0.5
+gravity = 9.81
+friction = 0.3
+velocity = 1.0
+
+def run (variant, path, dashpot = 200):
+  solfec = SOLFEC ('DYNAMIC', step, path)
+  solfec.verbose = 'OFF'
+  material = BULK_MATERIAL (solfec, density = 111.11111111111111111) # so that 0.3*0.3*0.1*111.(1) = 1.0
+  SURFACE_MATERIAL (solfec, model = 'SPRING_DASHPOT', friction = friction, spring = 1E5, dashpot = dashpot)
+  GRAVITY (solfec, (0, 0, -gravity))
+  BODY (solfec, 'OBSTACLE', HEX (base, 1, 1, 1, 0, surfaces), material)
+  bod = BODY (solfec, 'RIGID', HEX (cube, 1, 1, 1, 0, surfaces), material)
+  INITIAL_VELOCITY (bod, (velocity, 0, 0), (0, 0, 0))
+  RUN (solfec, PENALTY_SOLVER (variant), stop)
+  return (solfec, bod)
+
+def dem_run (path, dashpot): # return the mode, final x position and normal velocity (velo [3:6] is linear for rigid bodies)
+  (solfec, bod) = run ('DEM', path, dashpot)
+  return (solfec.mode, bod.conf [9], bod.velo [3], bod.velo [5]) # the written output is released on return
+
+def peak_normal_velocity (path, dashpot): # peak |VZ| over the last 0.1 s, read back from the output
+  (solfec, bod) = run ('DEM', path, dashpot)
+  th = HISTORY (solfec, [(bod, bod.center, 'VZ')], stop - 0.1, stop)
+  return max ([abs (v) for v in th [1]])
+
+if not VIEWER():
+  (sol1, bod1) = run ('EXPLICIT', 'out/tests/pes-dem/explicit')
+  (mode2, x2, vx2, vz2) = dem_run ('out/tests/pes-dem/dem', 200)
+  (mode3, x3, vx3, vz3) = dem_run ('out/tests/pes-dem/critical', -1) # negative dashpot: critical damping
+  (mode4, x4, vx4, vz4) = dem_run ('out/tests/pes-dem/undamped', 0)
+
+  if sol1.mode == 'READ' or 'READ' in [mode2, mode3, mode4]:
+    print '\nPrevious test results exist. Please "make del" and rerun tests'
+  else:
+    ref = velocity**2 / (2.0 * friction * gravity) # stopping distance
+    x1 = bod1.conf [9]
+    v3 = peak_normal_velocity ('out/tests/pes-dem/critical', -1)
+    v4 = peak_normal_velocity ('out/tests/pes-dem/undamped', 0)
+
+    if abs (x1 - ref) > 0.02 * ref:
+      print 'FAILED (EXPLICIT stopping distance %g while the reference is %g)' % (x1, ref)
+    elif abs (x2 - ref) > 0.02 * ref:
+      print 'FAILED (DEM stopping distance %g while the reference is %g)' % (x2, ref)
+    elif abs (x3 - ref) > 0.02 * ref:
+      print 'FAILED (critically damped DEM stopping distance %g while the reference is %g)' % (x3, ref)
+    elif abs (vx2) > 1E-2:
+      print 'FAILED (DEM final velocity %g)' % vx2
+    elif abs (vz3) > 1E-2 or v3 > 1E-2:
+      print 'FAILED (critically damped DEM normal velocity %g, peak %g)' % (vz3, v3)
+    elif v4 < 10.0 * v3:
+      print 'FAILED (undamped DEM peak normal velocity %g is not well above the critically damped %g)' % (v4, v3)
+    else: print 'PASSED'
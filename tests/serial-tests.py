@@ -7,6 +7,18 @@ tests = [
          'tests/projectile.py',
 	 'tests/block-sliding.py',
 	 'tests/arch.py',
+	 'tests/gs-merit.py',
+	 'tests/gs-schedule.py',
+	 'tests/ns-linver.py',
+	 'tests/pes-dem.py',
+	 'tests/fem-subcycling.py',
+	 'tests/fem-refactor.py',
+	 'tests/hst-history.py',
+	 'tests/pbf-codecs.py',
+	 'tests/pbf-delta.py',
+	 'tests/pbf-index.py',
+	 'tests/pbf-select.py',
+	 'tests/ckp-restart.py',
 	 'tests/BM01/BM01_pressure.py',
 	 'tests/BM01/BM01_force.py',
 	 'tests/BM02/BM02_hexa.py',
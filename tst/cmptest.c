@@ -20,6 +20,8 @@
  * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
 
 #include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
 #include "cmp.h"
 #include "alg.h"
 #include "err.h"
@@ -85,6 +87,32 @@ int main (int argc, char **argv)
     else printf ("ERROR\n");
   }
 
+  CMP_CODEC codecs [4] = {{CMP_FASTLZ, 1, 0}, {CMP_FASTLZ, 2, CMP_SHUFFLE}, {CMP_ZSTD, 3, 0}, {CMP_ZSTD, 9, CMP_SHUFFLE}};
+  char *input = (char*) d, *output, *decoded;
+  int k, bound, num;
+
+  size = sizeof (double [length]);
+  bound = CMP_Bound (size);
+  ERRMEM (output = malloc (bound));
+  ERRMEM (decoded = malloc (size));
+
+  for (k = 0; k < 4; k ++)
+  {
+    printf ("Encoding with codec %d, level %d, shuffle %d ... ", codecs[k].alg, codecs[k].level, codecs[k].shuffle);
+
+    num = CMP_Encode (&codecs[k], input, size, output, bound);
+
+    if (num == 0) { printf ("ERROR\n"); continue; }
+
+    printf ("ratio: %g, decoding ... ", (double) size / (double) num);
+
+    if (CMP_Decode (codecs[k].alg, codecs[k].shuffle, output, num, decoded, size) != size ||
+        memcmp (decoded, input, size) != 0) printf ("ERROR\n");
+    else printf ("OK\n");
+  }
+
+  free (output);
+  free (decoded);
   free (d);
   free (i);
   free (ud);
@@ -0,0 +1,126 @@
+/*
+ * dbstest.c
+ * Copyright (C) 2008, Tomasz Koziara (t.koziara AT gmail.com)
+ * --------------------------------------------------------------
+ * batched diagonal block solver test
+ */
+
+/* This file is part of Solfec.
+ * Solfec is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Solfec is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "dom.h"
+#include "ldy.h"
+#include "dbs.h"
+#include "alg.h"
+#include "err.h"
+
+#define N 11 /* not a multiple of DBS_LANES */
+
+static double drand (double lo, double hi)
+{
+  return lo + (hi - lo) * ((double) rand () / (double) RAND_MAX);
+}
+
+/* create random contact blocks */
+static void blocks (SURFACE_MATERIAL *mat, CON *con, DIAB *dia, double *B)
+{
+  double J [9];
+  int i, k;
+
+  memset (con, 0, sizeof (CON [N]));
+  memset (dia, 0, sizeof (DIAB [N]));
+
+  for (i = 0; i < N; i ++)
+  {
+    con [i].kind = CONTACT;
+    con [i].mat.base = mat;
+    con [i].area = 1.0;
+    con [i].gap = (i % 5 == 4 ? 0.01 : -0.001); /* some open contacts */
+
+    for (k = 0; k < 9; k ++) J [k] = drand (-1.0, 1.0);
+    TNMUL (J, J, dia [i].W); /* W = J'J + I is symmetric positive definite */
+    dia [i].W [0] += 1.0; dia [i].W [4] += 1.0; dia [i].W [8] += 1.0;
+    dia [i].rho = 1.0 / (dia [i].W [0] + dia [i].W [4] + dia [i].W [8]);
+    dia [i].R = con [i].R;
+    dia [i].U = con [i].U;
+    dia [i].V = con [i].V;
+    dia [i].con = &con [i];
+
+    for (k = 0; k < 3; k ++)
+    {
+      B [3*i+k] = drand (-1.0, 1.0);
+      con [i].V [k] = drand (-1.0, 1.0);
+    }
+    B [3*i+2] -= 1.0; /* mostly approaching */
+    COPY (&B[3*i], con [i].U);
+  }
+}
+
+int main (int argc, char **argv)
+{
+  DIAS solvers [] = {DS_PROJECTED_GRADIENT, DS_DE_SAXCE_FENG, DS_SEMISMOOTH_NEWTON}; /* DS_PROJECTED_NEWTON needs bodies */
+  char *names [] = {"PROJECTED_GRADIENT", "DE_SAXCE_FENG", "SEMISMOOTH_NEWTON"};
+  double B [3*N], R [3*N], U [3*N], d, error;
+  CON con [N], cob [N];
+  DIAB dia [N], dib [N], *ptr [N];
+  int iters [N], i, j, k, ret;
+  SURFACE_MATERIAL mat;
+  short dynamic;
+
+  memset (&mat, 0, sizeof (SURFACE_MATERIAL));
+  mat.model = SIGNORINI_COULOMB;
+  mat.friction = 0.3;
+  ret = 0;
+
+  for (dynamic = 0; dynamic < 2; dynamic ++)
+  {
+    for (j = 0; j < 3; j ++)
+    {
+      srand (1);
+      blocks (&mat, con, dia, B);
+      srand (1);
+      blocks (&mat, cob, dib, B);
+
+      for (i = 0; i < N; i ++)
+      {
+	DIAGONAL_BLOCK_Solver (solvers [j], 1E-10, 100, dynamic, 1E-3, CONTACT,
+	  &con[i].mat, con[i].gap, con[i].area, con[i].Z, con[i].base, &dia[i], &B[3*i]);
+	COPY (con[i].R, &R[3*i]);
+	COPY (con[i].U, &U[3*i]);
+	ptr [i] = &dib [i];
+      }
+
+      DIAGONAL_BLOCK_Solver_Batch (solvers [j], 1E-10, 100, dynamic, 1E-3, N, ptr, B, iters);
+
+      for (error = 0.0, i = 0; i < N; i ++)
+      {
+	for (k = 0; k < 3; k ++)
+	{
+	  d = fabs (cob[i].R[k] - R[3*i+k]); error = MAX (error, d);
+	  d = fabs (cob[i].U[k] - U[3*i+k]); error = MAX (error, d);
+	}
+      }
+
+      printf ("%s (%s): max difference = %g ... %s\n", names [j], dynamic ? "DYNAMIC" : "QUASI_STATIC",
+	      error, error < 1E-6 ? "OK" : "ERROR");
+
+      if (error >= 1E-6) ret = 1;
+    }
+  }
+
+  return ret;
+}
@@ -237,6 +237,29 @@ static int test_run_0 (FILE *file, MX *A, MX *B, MX *C, MX *D, MX *E, double alp
   if (MX_Norm (Z) < EPSILON) printf ("OK\n");
   else { printf ("FAILED\n"); return 0; }
 
+  if (invA->kind == MXCSC) /* factorized sparse inverse */
+  {
+    MX *b [2] = {B, MX_Tran (B)}, *c [2], *R, *S;
+    int ok;
+
+    printf ("TEST: batched inv (A) * B, inv (A) * B' ... ");
+    MX_Invmats (invA, 2, b, c);
+    R = MX_Matmat (1.0, invA, B, 0.0, NULL);
+    S = MX_Add (1.0, c [0], -1.0, R, NULL);
+    ok = MX_Norm (S) < EPSILON;
+    MX_Destroy (R);
+    MX_Destroy (S);
+    R = MX_Matmat (1.0, invA, MX_Tran (B), 0.0, NULL);
+    S = MX_Add (1.0, c [1], -1.0, R, NULL);
+    ok = ok && MX_Norm (S) < EPSILON;
+    MX_Destroy (R);
+    MX_Destroy (S);
+    MX_Destroy (c [0]);
+    MX_Destroy (c [1]);
+    if (ok) printf ("OK\n");
+    else { printf ("FAILED\n"); return 0; }
+  }
+
   printf ("TEST: A * inv (B) ... ");
   MX_Matmat (1.0, A, invB, 0.0, X);
   Y = read_matrix (OUTPUT, file, A->m, invB->n, kind);
@@ -25,6 +25,8 @@
 #include <string.h>
 #include "pbf.h"
 
+#define ARRAY 33 /* array length */
+
 static void write (PBF *bf, int n)
 {
   char str [512], *pstr = str;
@@ -102,6 +104,14 @@ static void write (PBF *bf, int n)
   PBF_Uchar (bf, &uc, 1);
   PBF_Label (bf, "CHAR");
   PBF_Char (bf, &c, 1);
+
+  /* arrays */
+  double da [ARRAY];
+  int ia [ARRAY], j;
+  for (j = 0; j < ARRAY; j ++) { da [j] = n + 0.5 * j; ia [j] = n - j; }
+  PBF_Label (bf, "ARRAYS");
+  PBF_Double (bf, da, ARRAY);
+  PBF_Int (bf, ia, ARRAY);
 #endif
 }
 
@@ -216,6 +226,16 @@ static int read (PBF *bf, int n)
       d != _d || f != _f || ul != _ul ||
       l != _l || ui != _ui || i != _i ||
       us != _us || s != _s || uc != _uc || c != _c) return 0;
+
+  double da [ARRAY];
+  int ia [ARRAY], j;
+  PBF_Label (bf, "ARRAYS");
+  PBF_Double (bf, da, ARRAY);
+  PBF_Int (bf, ia, ARRAY);
+  for (j = 0; j < ARRAY; j ++)
+  {
+    if (da [j] != n + 0.5 * j || ia [j] != n - j) return 0;
+  }
 #endif
 
   free (pstr);
@@ -0,0 +1,80 @@
+/*
+ * svktest.c
+ * Copyright (C) 2006, Tomasz Koziara (t.koziara AT gmail.com)
+ * --------------------------------------------------------------
+ * batched Saint Venant - Kirchhoff material test
+ */
+
+/* This file is part of Solfec.
+ * Solfec is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Solfec is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Solfec. If not, see <http://www.gnu.org/licenses/>. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "svk.h"
+#include "alg.h"
+
+#define N 11 /* number of points */
+#define LD 16 /* leading dimension */
+
+static double drand (double lo, double hi)
+{
+  return lo + (hi - lo) * ((double) rand () / (double) RAND_MAX);
+}
+
+int main (int argc, char **argv)
+{
+  double F [N][9], P [9], V [N], FB [9*LD], PB [9*LD], energy, sum, d, error;
+  double lambda = 1E6, mi = 5E5;
+  int i, k, ret;
+
+  srand (1);
+
+  for (i = 0; i < N; i ++)
+  {
+    for (k = 0; k < 9; k ++)
+    {
+      F [i][k] = drand (-0.2, 0.2) + (k % 4 == 0 ? 1.0 : 0.0);
+      FB [k*LD+i] = F [i][k];
+    }
+    V [i] = drand (0.1, 1.0);
+  }
+
+  SVK_Stress_Batch_C (lambda, mi, N, LD, V, FB, PB);
+
+  for (error = 0.0, sum = 0.0, i = 0; i < N; i ++)
+  {
+    SVK_Stress_C (lambda, mi, V [i], F [i], P);
+    sum += SVK_Energy_C (lambda, mi, V [i], F [i]);
+
+    for (k = 0; k < 9; k ++)
+    {
+      d = fabs (P [k] - PB [k*LD+i]) / (1.0 + fabs (P [k]));
+      error = MAX (error, d);
+    }
+  }
+
+  ret = 0;
+
+  printf ("SVK_Stress_Batch_C: max relative difference = %g ... %s\n", error, error < 1E-12 ? "OK" : "ERROR");
+  if (error >= 1E-12) ret = 1;
+
+  energy = SVK_Energy_Batch_C (lambda, mi, N, LD, V, FB);
+  error = fabs (energy - sum) / (1.0 + fabs (sum));
+
+  printf ("SVK_Energy_Batch_C: relative difference = %g ... %s\n", error, error < 1E-12 ? "OK" : "ERROR");
+  if (error >= 1E-12) ret = 1;
+
+  return ret;
+}
@@ -36,6 +36,7 @@ SOFTWARE.
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <float.h>
 #include "sol.h"
 #include "set.h"
 #include "map.h"
@@ -46,6 +47,61 @@ SOFTWARE.
 #include "err.h"
 
 #if HDF5
+typedef struct xdmf_series XDMF_SERIES;
+
+typedef struct xdmf_grid XDMF_GRID;
+
+/* time series of appended dataset rows */
+struct xdmf_series
+{
+  int *rec, /* (frame, first row, number of rows) triplets */
+      size, /* records buffer size */
+      count; /* records count */
+};
+
+/* grid of a convex or a mesh */
+struct xdmf_grid
+{
+  int id; /* grid id */
+
+  char *label; /* grid name */
+
+  int elements, /* number of elements */
+      nodes, /* number of nodes */
+      topo_size; /* size of mixed topology data */
+
+  XDMF_SERIES steps; /* appended geometry and attributes */
+
+  XDMF_GRID *next;
+};
+
+/* streamed export */
+struct xdmf
+{
+  char *path, /* export path */
+       *h5_path, /* heavy data file path */
+       *h5_name; /* heavy data file name */
+
+  hid_t h5_file; /* heavy data file */
+
+  SET *subset; /* exported body ids or NULL */
+
+  int attributes; /* exported attributes */
+
+  double *times; /* exported times */
+
+  int times_size, /* times buffer size */
+      frames; /* number of exported frames */
+
+  MAP *gids; /* shape to grid map */
+
+  XDMF_GRID *grids, /* grids list */
+	    *last; /* grids list tail */
+
+  XDMF_SERIES spheres, /* appended spheres data */
+	      constraints; /* appended constraints data */
+};
+
 /* returns xmf file path string; creatses intermediate directories */
 static char *path_and_dirs (char *path, char *ext)
 {
@@ -80,41 +136,6 @@ static char *path_and_dirs (char *path, char *ext)
   return out;
 }
 
-/* read int attribute from HDF5 file path */
-static int read_int (hid_t file, const char *path, const char *name)
-{
-  int value;
-
-  ASSERT_TEXT (H5LTget_attribute_int (file, path, name, &value) >= 0, "HDF5 file write error");
-
-  return value;
-}
-
-/* read double attribute from HDF5 file path */
-static double read_double (hid_t file, const char *path, const char *name)
-{
-  double value;
-
-  ASSERT_TEXT (H5LTget_attribute_double (file, path, name, &value) >= 0, "HDF5 file write error");
-
-  return value;
-}
-
-/* read string attribute from HDF5 file path */
-static char* read_string (hid_t file, const char *path, const char *name)
-{
-  char *value;
-  H5T_class_t c;
-  hsize_t d;
-  size_t s;
-
-  ASSERT_TEXT (H5LTget_attribute_info (file, path, name,  &d, &c, &s) >= 0, "HDF5 file write error"); 
-  ERRMEM (value = malloc (s));
-  ASSERT_TEXT (H5LTget_attribute_string (file, path, name, value) >= 0, "HDF5 file write error");
-
-  return value;
-}
-
 /* obtain mesh attribute values */
 static void mesh_attribute_values (MESH *msh, BODY *bod, VALUE_KIND kind, double *values)
 {
@@ -160,104 +181,221 @@ static void convex_attribute_values (CONVEX *cvx, BODY *bod, VALUE_KIND kind, do
   }
 }
 
-/* write current mesh state */
-static void write_mesh (MESH *msh, BODY *bod, double time, int step, hid_t h5_grid, int attributes)
+#define XDMF_CHUNK 256 /* minimal number of rows per chunk of appended datasets */
+
+/* append 'rows' rows of 'cols' columns to an extendible dataset; return the first appended row */
+static int append_rows (hid_t loc, const char *name, hid_t type, int cols, int rows, void *data)
 {
-  if (step == 0)
+  hsize_t dims [2], start [2] = {0, 0}, count [2] = {rows, cols};
+  int rank = cols > 1 ? 2 : 1;
+  hid_t dset, fspc, mspc;
+
+  if (H5Lexists (loc, name, H5P_DEFAULT))
   {
-    int *topo = NULL, topo_size = 0, topo_count = 0;
-    ELEMENT *ele;
-    int *bid;
+    ASSERT_TEXT ((dset = H5Dopen (loc, name, H5P_DEFAULT)) >= 0, "HDF5 file write error");
+    ASSERT_TEXT ((fspc = H5Dget_space (dset)) >= 0, "HDF5 file write error");
+    H5Sget_simple_extent_dims (fspc, dims, NULL);
+    H5Sclose (fspc);
+  }
+  else /* chunked and unlimited along rows */
+  {
+    hsize_t maxdims [2] = {H5S_UNLIMITED, cols}, chunk [2] = {MAX (rows, XDMF_CHUNK), cols};
+    hid_t plist;
+
+    dims [0] = 0;
+    dims [1] = cols;
+    ASSERT_TEXT ((plist = H5Pcreate (H5P_DATASET_CREATE)) >= 0, "HDF5 file write error");
+    ASSERT_TEXT (H5Pset_chunk (plist, rank, chunk) >= 0, "HDF5 file write error");
+    ASSERT_TEXT ((fspc = H5Screate_simple (rank, dims, maxdims)) >= 0, "HDF5 file write error");
+    ASSERT_TEXT ((dset = H5Dcreate (loc, name, type, fspc, H5P_DEFAULT, plist, H5P_DEFAULT)) >= 0, "HDF5 file write error");
+    H5Sclose (fspc);
+    H5Pclose (plist);
+  }
 
-    for (ele = msh->surfeles; ele; ele = ele->next)
-    {
-      switch (ele->type)
-      {
-      case 4:
-	pack_int (&topo_size, &topo, &topo_count, 6);
-      break;
-      case 5:
-	pack_int (&topo_size, &topo, &topo_count, 7);
-      break;
-      case 6:
-	pack_int (&topo_size, &topo, &topo_count, 8);
-      break;
-      case 8:
-	pack_int (&topo_size, &topo, &topo_count, 9);
-      break;
-      }
-      pack_ints (&topo_size, &topo, &topo_count, ele->nodes, ele->type);
-    }
-    for (ele = msh->bulkeles; ele; ele = ele->next)
+  start [0] = dims [0];
+
+  if (rows > 0)
+  {
+    dims [0] += rows;
+    ASSERT_TEXT (H5Dset_extent (dset, dims) >= 0, "HDF5 file write error");
+    ASSERT_TEXT ((fspc = H5Dget_space (dset)) >= 0, "HDF5 file write error");
+    ASSERT_TEXT (H5Sselect_hyperslab (fspc, H5S_SELECT_SET, start, NULL, count, NULL) >= 0, "HDF5 file write error");
+    ASSERT_TEXT ((mspc = H5Screate_simple (rank, count, NULL)) >= 0, "HDF5 file write error");
+    ASSERT_TEXT (H5Dwrite (dset, type, mspc, fspc, H5P_DEFAULT, data) >= 0, "HDF5 file write error");
+    H5Sclose (mspc);
+    H5Sclose (fspc);
+  }
+
+  H5Dclose (dset);
+
+  return start [0];
+}
+
+/* create or open group */
+static hid_t group (hid_t loc, const char *name)
+{
+  hid_t g;
+
+  if (H5Lexists (loc, name, H5P_DEFAULT))
+  {
+    ASSERT_TEXT ((g = H5Gopen (loc, name, H5P_DEFAULT)) >= 0, "HDF5 file write error");
+  }
+  else
+  {
+    ASSERT_TEXT ((g = H5Gcreate (loc, name, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)) >= 0, "HDF5 file write error");
+  }
+
+  return g;
+}
+
+/* add (frame, first row, rows) record to a time series */
+static void series_add (XDMF_SERIES *s, int frame, int first, int rows)
+{
+  pack_int (&s->size, &s->rec, &s->count, frame);
+  pack_int (&s->size, &s->rec, &s->count, first);
+  pack_int (&s->size, &s->rec, &s->count, rows);
+}
+
+/* total number of rows in the datasets of a time series */
+static int series_rows (XDMF_SERIES *s)
+{
+  return s->count ? s->rec [s->count-2] + s->rec [s->count-1] : 0;
+}
+
+/* find or create grid of a shape; static topology and body ids are written once */
+static XDMF_GRID* grid (XDMF *xf, void *shape, BODY *bod, int *topo, int topo_count, int elements, int nodes)
+{
+  char h5_text [1024];
+  hid_t h5_grids, h5_grid;
+  XDMF_GRID *g;
+  hsize_t length;
+  char *label;
+  int *bid;
+
+  if ((g = MAP_Find (xf->gids, shape, NULL))) return g;
+
+  ERRMEM (g = MEM_CALLOC (sizeof (XDMF_GRID)));
+  g->id = MAP_Size (xf->gids);
+  g->elements = elements;
+  g->nodes = nodes;
+  g->topo_size = topo_count;
+  snprintf (h5_text, 1024, "%d", g->id);
+  label = bod->label ? bod->label : h5_text;
+  ERRMEM (g->label = malloc (strlen (label) + 1));
+  strcpy (g->label, label);
+  MAP_Insert (NULL, &xf->gids, shape, g, NULL);
+  if (xf->last) xf->last->next = g;
+  else xf->grids = g;
+  xf->last = g;
+
+  h5_grids = group (xf->h5_file, "GRIDS");
+  snprintf (h5_text, 1024, "%d", g->id);
+  h5_grid = group (h5_grids, h5_text);
+  length = topo_count;
+  ASSERT_TEXT (H5LTmake_dataset_int (h5_grid, "TOPO", 1, &length, topo) >= 0, "HDF5 file write error");
+  ASSERT_TEXT (H5LTset_attribute_int (h5_grid, ".", "TOPO_SIZE", &topo_count, 1) >= 0, "HDF5 file write error");
+  ASSERT_TEXT (H5LTset_attribute_int (h5_grid, ".", "ELEMENTS", &elements, 1) >= 0, "HDF5 file write error");
+  ASSERT_TEXT (H5LTset_attribute_int (h5_grid, ".", "NODES", &nodes, 1) >= 0, "HDF5 file write error");
+  ASSERT_TEXT (H5LTset_attribute_string (h5_grid, ".", "LABEL", g->label) >= 0, "HDF5 file write error");
+  length = elements;
+  ERRMEM (bid = malloc (sizeof (int) * elements));
+  for (int i = 0; i < elements; i ++) bid[i] = bod->id;
+  ASSERT_TEXT (H5LTmake_dataset_int (h5_grid, "BID", 1, &length, bid) >= 0, "HDF5 file write error");
+  free (bid);
+  H5Gclose (h5_grid);
+  H5Gclose (h5_grids);
+
+  return g;
+}
+
+/* open grid group */
+static hid_t grid_open (XDMF *xf, XDMF_GRID *g)
+{
+  char h5_text [1024];
+  hid_t h5_grid;
+
+  snprintf (h5_text, 1024, "/GRIDS/%d", g->id);
+  ASSERT_TEXT ((h5_grid = H5Gopen (xf->h5_file, h5_text, H5P_DEFAULT)) >= 0, "HDF5 file write error");
+
+  return h5_grid;
+}
+
+/* pack mixed topology of element list */
+static void mesh_topology (ELEMENT *ele, int *topo_size, int **topo, int *topo_count)
+{
+  for (; ele; ele = ele->next)
+  {
+    switch (ele->type)
     {
-      switch (ele->type)
-      {
-      case 4:
-	pack_int (&topo_size, &topo, &topo_count, 6);
-      break;
-      case 5:
-	pack_int (&topo_size, &topo, &topo_count, 7);
-      break;
-      case 6:
-	pack_int (&topo_size, &topo, &topo_count, 8);
-      break;
-      case 8:
-	pack_int (&topo_size, &topo, &topo_count, 9);
-      break;
-      }
-      pack_ints (&topo_size, &topo, &topo_count, ele->nodes, ele->type);
+    case 4:
+      pack_int (topo_size, topo, topo_count, 6);
+    break;
+    case 5:
+      pack_int (topo_size, topo, topo_count, 7);
+    break;
+    case 6:
+      pack_int (topo_size, topo, topo_count, 8);
+    break;
+    case 8:
+      pack_int (topo_size, topo, topo_count, 9);
+    break;
     }
-    hsize_t length = topo_count;
-    ASSERT_TEXT (H5LTmake_dataset_int (h5_grid, "TOPO", 1, &length, topo) >= 0, "HDF5 file write error");
-    free (topo);
-    ASSERT_TEXT (H5LTset_attribute_int (h5_grid, ".", "TOPO_SIZE", &topo_count, 1) >= 0, "HDF5 file write error");
-    int elements = msh->surfeles_count + msh->bulkeles_count;
-    ASSERT_TEXT (H5LTset_attribute_int (h5_grid, ".", "ELEMENTS", &elements, 1) >= 0, "HDF5 file write error");
-    ASSERT_TEXT (H5LTset_attribute_int (h5_grid, ".", "NODES", &msh->nodes_count, 1) >= 0, "HDF5 file write error");
-    length = elements;
-    ERRMEM (bid = malloc (sizeof (int) * elements));
-    for (int i = 0; i < elements; i ++) bid[i] = bod->id;
-    ASSERT_TEXT (H5LTmake_dataset_int (h5_grid, "BID", 1, &length, bid) >= 0, "HDF5 file write error");
-    free (bid);
-  }
-
-  char h5_text[1024];
+    pack_ints (topo_size, topo, topo_count, ele->nodes, ele->type);
+  }
+}
+
+/* append current mesh state */
+static void write_mesh (XDMF *xf, MESH *msh, BODY *bod)
+{
+  XDMF_GRID *g = MAP_Find (xf->gids, msh, NULL);
+  int first, nodes = msh->nodes_count;
   double *values;
-  hid_t h5_step;
-  
-  snprintf (h5_text, 1024, "%d", step);
-  ASSERT_TEXT ((h5_step = H5Gcreate (h5_grid, h5_text, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)) >= 0, "HDF5 file write error");
-  ASSERT_TEXT (H5LTset_attribute_double (h5_step, ".", "TIME", &time, 1) >= 0, "HDF5 file write error");
-  hsize_t dims[2] = {msh->nodes_count, 3};
-  ASSERT_TEXT (H5LTmake_dataset_double (h5_step, "GEOM", 2, dims, (double*)msh->cur_nodes) >= 0, "HDF5 file write error");
-  ERRMEM (values = malloc (msh->nodes_count * 7 * sizeof (double))); /* alloc maximum possible --> stress+mises */
-  if (attributes & XDMF_DISP)
+  hid_t h5_grid;
+
+  if (!g)
+  {
+    int *topo = NULL, topo_size = 0, topo_count = 0;
+    mesh_topology (msh->surfeles, &topo_size, &topo, &topo_count);
+    mesh_topology (msh->bulkeles, &topo_size, &topo, &topo_count);
+    g = grid (xf, msh, bod, topo, topo_count, msh->surfeles_count + msh->bulkeles_count, nodes);
+    free (topo);
+  }
+
+  h5_grid = grid_open (xf, g);
+  first = append_rows (h5_grid, "GEOM", H5T_NATIVE_DOUBLE, 3, nodes, msh->cur_nodes);
+  ERRMEM (values = malloc (nodes * 7 * sizeof (double))); /* alloc maximum possible --> stress+mises */
+  if (xf->attributes & XDMF_DISP)
   {
     mesh_attribute_values (msh, bod, VALUE_DISPLACEMENT, values);
-    ASSERT_TEXT (H5LTmake_dataset_double (h5_step, "DISP", 2, dims, values) >= 0, "HDF5 file write error");
+    append_rows (h5_grid, "DISP", H5T_NATIVE_DOUBLE, 3, nodes, values);
   }
-  if (attributes & XDMF_VELO)
+  if (xf->attributes & XDMF_VELO)
   {
     mesh_attribute_values (msh, bod, VALUE_VELOCITY, values);
-    ASSERT_TEXT (H5LTmake_dataset_double (h5_step, "VELO", 2, dims, values) >= 0, "HDF5 file write error");
+    append_rows (h5_grid, "VELO", H5T_NATIVE_DOUBLE, 3, nodes, values);
   }
-  if (attributes & XDMF_STRESS)
+  if (xf->attributes & XDMF_STRESS)
   {
-    hsize_t dims[2] = {msh->nodes_count, 6};
     mesh_attribute_values (msh, bod, VALUE_STRESS, values);
-    ASSERT_TEXT (H5LTmake_dataset_double (h5_step, "STRESS", 2, dims, values) >= 0, "HDF5 file write error");
+    append_rows (h5_grid, "STRESS", H5T_NATIVE_DOUBLE, 6, nodes, values);
   }
-  H5Gclose (h5_step);
+  series_add (&g->steps, xf->frames-1, first, nodes);
+  H5Gclose (h5_grid);
   free (values);
 }
 
-/* write current convex state */
-static void write_convex (CONVEX *cvx, BODY *bod, double time, int step, hid_t h5_grid, int attributes)
+/* append current convex state */
+static void write_convex (XDMF *xf, CONVEX *cvx, BODY *bod)
 {
-  if (step == 0)
+  XDMF_GRID *g = MAP_Find (xf->gids, cvx, NULL);
+  int first, nodes = cvx->nver;
+  double *values;
+  hid_t h5_grid;
+
+  if (!g)
   {
     int *topo = NULL, topo_size = 0, topo_count = 0;
-    int i = 0, *f = cvx->fac, *bid;
+    int i = 0, *f = cvx->fac;
     for (; i < cvx->nfac; i ++, f += (f[0]+1))
     {
       pack_int (&topo_size, &topo, &topo_count, 3); /* Polygon */
@@ -267,102 +405,63 @@ static void write_convex (CONVEX *cvx, BODY *bod, double time, int step, hid_t h
         pack_int (&topo_size, &topo, &topo_count, (f+1)[j]/3); /* Vertex indices */
       }
     }
-
-    hsize_t length = topo_count;
-    ASSERT_TEXT (H5LTmake_dataset_int (h5_grid, "TOPO", 1, &length, topo) >= 0, "HDF5 file write error");
+    g = grid (xf, cvx, bod, topo, topo_count, cvx->nfac, nodes);
     free (topo);
-    ASSERT_TEXT (H5LTset_attribute_int (h5_grid, ".", "TOPO_SIZE", &topo_count, 1) >= 0, "HDF5 file write error");
-    int nfac = cvx->nfac, nver = cvx->nver;
-    ASSERT_TEXT (H5LTset_attribute_int (h5_grid, ".", "ELEMENTS", &nfac, 1) >= 0, "HDF5 file write error");
-    ASSERT_TEXT (H5LTset_attribute_int (h5_grid, ".", "NODES", &nver, 1) >= 0, "HDF5 file write error");
-    length = nfac;
-    ERRMEM (bid = malloc (sizeof (int) * nfac));
-    for (int i = 0; i < nfac; i ++) bid[i] = bod->id;
-    ASSERT_TEXT (H5LTmake_dataset_int (h5_grid, "BID", 1, &length, bid) >= 0, "HDF5 file write error");
-    free (bid);
-  }
-
-  char h5_text[1024];
-  double *values;
-  hid_t h5_step;
-  
-  snprintf (h5_text, 1024, "%d", step);
-  ASSERT_TEXT ((h5_step = H5Gcreate (h5_grid, h5_text, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)) >= 0, "HDF5 file write error");
-  ASSERT_TEXT (H5LTset_attribute_double (h5_step, ".", "TIME", &time, 1) >= 0, "HDF5 file write error");
-  hsize_t dims[2] = {cvx->nver, 3};
-  ASSERT_TEXT (H5LTmake_dataset_double (h5_step, "GEOM", 2, dims, cvx->cur) >= 0, "HDF5 file write error");
-  ERRMEM (values = malloc (cvx->nver * 7 * sizeof (double))); /* alloc maximum possible --> stress+mises */
-  if (attributes & XDMF_DISP)
+  }
+
+  h5_grid = grid_open (xf, g);
+  first = append_rows (h5_grid, "GEOM", H5T_NATIVE_DOUBLE, 3, nodes, cvx->cur);
+  ERRMEM (values = malloc (nodes * 7 * sizeof (double))); /* alloc maximum possible --> stress+mises */
+  if (xf->attributes & XDMF_DISP)
   {
     convex_attribute_values (cvx, bod, VALUE_DISPLACEMENT, values);
-    ASSERT_TEXT (H5LTmake_dataset_double (h5_step, "DISP", 2, dims, values) >= 0, "HDF5 file write error");
+    append_rows (h5_grid, "DISP", H5T_NATIVE_DOUBLE, 3, nodes, values);
   }
-  if (attributes & XDMF_VELO)
+  if (xf->attributes & XDMF_VELO)
   {
     convex_attribute_values (cvx, bod, VALUE_VELOCITY, values);
-    ASSERT_TEXT (H5LTmake_dataset_double (h5_step, "VELO", 2, dims, values) >= 0, "HDF5 file write error");
+    append_rows (h5_grid, "VELO", H5T_NATIVE_DOUBLE, 3, nodes, values);
   }
-  if (attributes & XDMF_STRESS)
+  if (xf->attributes & XDMF_STRESS)
   {
-    hsize_t dims[2] = {cvx->nver, 6};
     convex_attribute_values (cvx, bod, VALUE_STRESS, values);
-    ASSERT_TEXT (H5LTmake_dataset_double (h5_step, "STRESS", 2, dims, values) >= 0, "HDF5 file write error");
+    append_rows (h5_grid, "STRESS", H5T_NATIVE_DOUBLE, 6, nodes, values);
   }
-  H5Gclose (h5_step);
+  series_add (&g->steps, xf->frames-1, first, nodes);
+  H5Gclose (h5_grid);
   free (values);
 }
 
-/* write sphere data at current time step */
-static void write_spheres (DOM *dom, hid_t h5_file, double *center, double *radius, int count, double *disp, double *velo, double *stress, int *bid, int attributes)
+/* append sphere data at current time step */
+static void write_spheres (XDMF *xf, double *center, double *radius, int count, double *disp, double *velo, double *stress, int *bid)
 {
-  hid_t h5_sphs, h5_step;
-  char h5_text[1024];
-  int steps;
+  hid_t h5_sphs;
+  int first;
 
   if (count == 0) return;
 
-  if (H5Lexists (h5_file, "SPHERES", H5P_DEFAULT))
-  {
-    ASSERT_TEXT (h5_sphs = H5Gopen (h5_file, "SPHERES", H5P_DEFAULT), "HDF5 file write error");
-    ASSERT_TEXT (H5LTget_attribute_int (h5_sphs, ".", "STEPS", &steps) >= 0, "HDF5 file write error");
-    steps ++;
-    ASSERT_TEXT (H5LTset_attribute_int (h5_sphs, ".", "STEPS", &steps, 1) >= 0, "HDF5 file write error");
-  }
-  else
-  {
-    steps = 1;
-    ASSERT_TEXT ((h5_sphs = H5Gcreate (h5_file, "SPHERES", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)) >= 0, "HDF5 file write error");
-    ASSERT_TEXT (H5LTset_attribute_int (h5_sphs, ".", "STEPS", &steps, 1) >= 0, "HDF5 file write error");
-  }
-
-  hsize_t nsph = count;
-  snprintf (h5_text, 1024, "%d", steps-1);
-  ASSERT_TEXT ((h5_step = H5Gcreate (h5_sphs, h5_text, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)) >= 0, "HDF5 file write error");
-  ASSERT_TEXT (H5LTset_attribute_double (h5_step, ".", "TIME", &dom->time, 1) >= 0, "HDF5 file write error");
-  ASSERT_TEXT (H5LTset_attribute_int (h5_step, ".", "COUNT", &count, 1) >= 0, "HDF5 file write error");
-  hsize_t dims[2] = {nsph, 3};
-  ASSERT_TEXT (H5LTmake_dataset_double (h5_step, "GEOM", 2, dims, center) >= 0, "HDF5 file write error");
-  ASSERT_TEXT (H5LTmake_dataset_double (h5_step, "RADI", 1, &nsph, radius) >= 0, "HDF5 file write error");
-  ASSERT_TEXT (H5LTmake_dataset_int (h5_step, "BID", 1, &nsph, bid) >= 0, "HDF5 file write error");
-  if (attributes & XDMF_DISP)
+  h5_sphs = group (xf->h5_file, "SPHERES");
+  first = append_rows (h5_sphs, "GEOM", H5T_NATIVE_DOUBLE, 3, count, center);
+  append_rows (h5_sphs, "RADI", H5T_NATIVE_DOUBLE, 1, count, radius);
+  append_rows (h5_sphs, "BID", H5T_NATIVE_INT, 1, count, bid);
+  if (xf->attributes & XDMF_DISP)
   {
-    ASSERT_TEXT (H5LTmake_dataset_double (h5_step, "DISP", 2, dims, disp) >= 0, "HDF5 file write error");
+    append_rows (h5_sphs, "DISP", H5T_NATIVE_DOUBLE, 3, count, disp);
   }
-  if (attributes & XDMF_VELO)
+  if (xf->attributes & XDMF_VELO)
   {
-    ASSERT_TEXT (H5LTmake_dataset_double (h5_step, "VELO", 2, dims, velo) >= 0, "HDF5 file write error");
+    append_rows (h5_sphs, "VELO", H5T_NATIVE_DOUBLE, 3, count, velo);
   }
-  if (attributes & XDMF_STRESS)
+  if (xf->attributes & XDMF_STRESS)
   {
-    hsize_t dims[2] = {nsph, 6};
-    ASSERT_TEXT (H5LTmake_dataset_double (h5_step, "STRESS", 2, dims, stress) >= 0, "HDF5 file write error");
+    append_rows (h5_sphs, "STRESS", H5T_NATIVE_DOUBLE, 6, count, stress);
   }
-  H5Gclose (h5_step);
+  series_add (&xf->spheres, xf->frames-1, first, count);
   H5Gclose (h5_sphs);
 }
 
-/* write bodies state at current time step */
-static void write_bodies (DOM *dom, hid_t h5_file, MAP **gids, int **gid, int *gid_count, int *gid_size, SET *subset, int attributes)
+/* append bodies state at current time step */
+static void write_bodies (XDMF *xf, DOM *dom)
 {
   double *sph_center = NULL, *sph_radius = NULL, *sph_disp = NULL, *sph_velo = NULL, *sph_stress = NULL;
   int sph_center_count = 0, sph_center_size = 0,
@@ -374,11 +473,7 @@ static void write_bodies (DOM *dom, hid_t h5_file, MAP **gids, int **gid, int *g
 
   for (BODY *bod = dom->bod; bod; bod = bod->next)
   {
-    hid_t h5_grids, h5_grid;
-    char h5_text[1024];
-    int steps;
-
-    if (subset && !SET_Find (subset, (void*) (long) bod->id, NULL)) continue;
+    if (xf->subset && !SET_Find (xf->subset, (void*) (long) bod->id, NULL)) continue;
 
     for (SHAPE *shp = bod->shape; shp; shp = shp->next)
     {
@@ -386,105 +481,15 @@ static void write_bodies (DOM *dom, hid_t h5_file, MAP **gids, int **gid, int *g
       {
       case SHAPE_CONVEX:
       {
-        if (H5Lexists (h5_file, "GRIDS", H5P_DEFAULT))
-	{
-	  ASSERT_TEXT (h5_grids = H5Gopen (h5_file, "GRIDS", H5P_DEFAULT), "HDF5 file write error");
-	}
-	else
-	{
-	  ASSERT_TEXT ((h5_grids = H5Gcreate (h5_file, "GRIDS", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)) >= 0, "HDF5 file write error");
-	}
-
 	for (CONVEX *cvx = shp->data; cvx; cvx = cvx->next)
 	{
-	  MAP *item = MAP_Find_Node (*gids, cvx, NULL);
-
-	  int grid_id; /* unique grid id */
-
-	  if (item)
-	  {
-	    grid_id = (int) (long) item->data;
-	  }
-	  else
-	  {
-	    grid_id = MAP_Size (*gids);
-	    MAP_Insert (NULL, gids, cvx, (void*) (long) grid_id, NULL);
-	  }
-
-	  snprintf (h5_text, 1024, "%d", grid_id);
-
-	  if (H5Lexists (h5_grids, h5_text, H5P_DEFAULT))
-	  {
-	    ASSERT_TEXT (h5_grid = H5Gopen (h5_grids, h5_text, H5P_DEFAULT), "HDF5 file write error");
-	    ASSERT_TEXT (H5LTget_attribute_int (h5_grid, ".", "STEPS", &steps) >= 0, "HDF5 file write error");
-	    steps ++;
-	    ASSERT_TEXT (H5LTset_attribute_int (h5_grid, ".", "STEPS", &steps, 1) >= 0, "HDF5 file write error");
-	  }
-	  else 
-	  {
-	    steps = 1;
-	    pack_int (gid_size, gid, gid_count, grid_id);
-	    ASSERT_TEXT ((h5_grid = H5Gcreate (h5_grids, h5_text, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)) >= 0, "HDF5 file write error");
-	    ASSERT_TEXT (H5LTset_attribute_int (h5_grid, ".", "STEPS", &steps, 1) >= 0, "HDF5 file write error");
-	    if (bod->label) ASSERT_TEXT (H5LTset_attribute_string (h5_grid, ".", "LABEL", bod->label) >= 0, "HDF5 file write error");
-	    else ASSERT_TEXT (H5LTset_attribute_string (h5_grid, ".", "LABEL", h5_text) >= 0, "HDF5 file write error");
-	  }
-
-	  write_convex (cvx, bod, dom->time, steps-1, h5_grid, attributes);
+	  write_convex (xf, cvx, bod);
 	}
-
-	H5Gclose (h5_grid);
-        H5Gclose (h5_grids);
       }
       break;
       case SHAPE_MESH:
       {
-	if (H5Lexists (h5_file, "GRIDS", H5P_DEFAULT))
-	{
-	  ASSERT_TEXT (h5_grids = H5Gopen (h5_file, "GRIDS", H5P_DEFAULT), "HDF5 file write error");
-	}
-	else
-	{
-	  ASSERT_TEXT ((h5_grids = H5Gcreate (h5_file, "GRIDS", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)) >= 0, "HDF5 file write error");
-	}
-
-	MAP *item = MAP_Find_Node (*gids, shp->data, NULL);
-
-	int grid_id; /* unique grid id */
-
-	if (item)
-	{
-	  grid_id = (int) (long) item->data;
-	}
-	else
-	{
-	  grid_id = MAP_Size (*gids);
-	  MAP_Insert (NULL, gids, shp->data, (void*) (long) grid_id, NULL);
-	}
-
-	snprintf (h5_text, 1024, "%d", grid_id);
-
-	if (H5Lexists (h5_grids, h5_text, H5P_DEFAULT))
-	{
-	  ASSERT_TEXT (h5_grid = H5Gopen (h5_grids, h5_text, H5P_DEFAULT), "HDF5 file write error");
-	  ASSERT_TEXT (H5LTget_attribute_int (h5_grid, ".", "STEPS", &steps) >= 0, "HDF5 file write error");
-	  steps ++;
-	  ASSERT_TEXT (H5LTset_attribute_int (h5_grid, ".", "STEPS", &steps, 1) >= 0, "HDF5 file write error");
-	}
-	else 
-	{
-	  steps = 1;
-	  pack_int (gid_size, gid, gid_count, grid_id);
-	  ASSERT_TEXT ((h5_grid = H5Gcreate (h5_grids, h5_text, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)) >= 0, "HDF5 file write error");
-	  ASSERT_TEXT (H5LTset_attribute_int (h5_grid, ".", "STEPS", &steps, 1) >= 0, "HDF5 file write error");
-	  if (bod->label) ASSERT_TEXT (H5LTset_attribute_string (h5_grid, ".", "LABEL", bod->label) >= 0, "HDF5 file write error");
-	  else ASSERT_TEXT (H5LTset_attribute_string (h5_grid, ".", "LABEL", h5_text) >= 0, "HDF5 file write error");
-	}
-
-	write_mesh (shp->data, bod, dom->time, steps-1, h5_grid, attributes);
-
-	H5Gclose (h5_grid);
-        H5Gclose (h5_grids);
+	write_mesh (xf, shp->data, bod);
       }
       break;
       case SHAPE_SPHERE:
@@ -495,17 +500,17 @@ static void write_bodies (DOM *dom, hid_t h5_file, MAP **gids, int **gid, int *g
 	pack_double (&sph_radius_size, &sph_radius, &sph_radius_count, sph->cur_radius);
 	pack_int (&sph_bid_size, &sph_bid, &sph_bid_count, bod->id);
 
-	if (attributes & XDMF_DISP)
+	if (xf->attributes & XDMF_DISP)
 	{
           BODY_Point_Values (bod, sph->cur_center, VALUE_DISPLACEMENT, values);
 	  pack_doubles (&sph_disp_size, &sph_disp, &sph_disp_count, values, 3);
 	}
-	if (attributes & XDMF_VELO)
+	if (xf->attributes & XDMF_VELO)
 	{
           BODY_Point_Values (bod, sph->cur_center, VALUE_VELOCITY, values);
 	  pack_doubles (&sph_velo_size, &sph_velo, &sph_velo_count, values, 3);
 	}
-	if (attributes & XDMF_STRESS)
+	if (xf->attributes & XDMF_STRESS)
 	{
           BODY_Point_Values (bod, sph->cur_center, VALUE_STRESS, values);
 	  pack_doubles (&sph_stress_size, &sph_stress, &sph_stress_count, values, 6);
@@ -521,7 +526,7 @@ static void write_bodies (DOM *dom, hid_t h5_file, MAP **gids, int **gid, int *g
     }
   }
 
-  write_spheres (dom, h5_file, sph_center, sph_radius, sph_radius_count, sph_disp, sph_velo, sph_stress, sph_bid, attributes);
+  write_spheres (xf, sph_center, sph_radius, sph_radius_count, sph_disp, sph_velo, sph_stress, sph_bid);
 
   free (sph_center);
   free (sph_radius);
@@ -531,30 +536,15 @@ static void write_bodies (DOM *dom, hid_t h5_file, MAP **gids, int **gid, int *g
   free (sph_bid);
 }
 
-/* write constraints state at current time step */
-static void write_constraints (DOM *dom, hid_t h5_file, SET *subset, int attributes)
+/* append constraints state at current time step */
+static void write_constraints (XDMF *xf, DOM *dom)
 {
-  hid_t h5_cons, h5_step;
-  char h5_text[1024];
-  int steps;
+  hid_t h5_cons;
+  int first;
   CON *con;
 
   if (dom->ncon == 0) return;
 
-  if (H5Lexists (h5_file, "CONSTRAINTS", H5P_DEFAULT))
-  {
-    ASSERT_TEXT (h5_cons = H5Gopen (h5_file, "CONSTRAINTS", H5P_DEFAULT), "HDF5 file write error");
-    ASSERT_TEXT (H5LTget_attribute_int (h5_cons, ".", "STEPS", &steps) >= 0, "HDF5 file write error");
-    steps ++;
-    ASSERT_TEXT (H5LTset_attribute_int (h5_cons, ".", "STEPS", &steps, 1) >= 0, "HDF5 file write error");
-  }
-  else
-  {
-    steps = 1;
-    ASSERT_TEXT ((h5_cons = H5Gcreate (h5_file, "CONSTRAINTS", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)) >= 0, "HDF5 file write error");
-    ASSERT_TEXT (H5LTset_attribute_int (h5_cons, ".", "STEPS", &steps, 1) >= 0, "HDF5 file write error");
-  }
-
   double *point = NULL, *reac = NULL, *relv = NULL, *gap = NULL;
   int point_count = 0, point_size = 0,
     reac_count = 0, reac_size = 0,
@@ -563,10 +553,10 @@ static void write_constraints (DOM *dom, hid_t h5_file, SET *subset, int attribu
 
   for (con = dom->con; con; con = con->next)
   {
-    if (subset)
+    if (xf->subset)
     {
-      if (!SET_Find (subset, (void*) (long) con->master->id, NULL)) continue;
-      if (con->slave && !SET_Find (subset, (void*) (long) con->slave->id, NULL)) continue;
+      if (!SET_Find (xf->subset, (void*) (long) con->master->id, NULL)) continue;
+      if (con->slave && !SET_Find (xf->subset, (void*) (long) con->slave->id, NULL)) continue;
     }
 
     pack_doubles (&point_size, &point, &point_count, con->point, 3);
@@ -579,382 +569,375 @@ static void write_constraints (DOM *dom, hid_t h5_file, SET *subset, int attribu
     pack_doubles (&relv_size, &relv, &relv_count, Uglo, 3);
     pack_double (&gap_size, &gap, &gap_count, con->gap);
   }
- 
-  hsize_t ncon = gap_count;
-  snprintf (h5_text, 1024, "%d", steps-1);
-  ASSERT_TEXT ((h5_step = H5Gcreate (h5_cons, h5_text, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)) >= 0, "HDF5 file write error");
-  ASSERT_TEXT (H5LTset_attribute_double (h5_step, ".", "TIME", &dom->time, 1) >= 0, "HDF5 file write error");
-  ASSERT_TEXT (H5LTset_attribute_int (h5_step, ".", "COUNT", &gap_count, 1) >= 0, "HDF5 file write error");
-  hsize_t dims[2] = {ncon, 3};
-  ASSERT_TEXT (H5LTmake_dataset_double (h5_step, "GEOM", 2, dims, point) >= 0, "HDF5 file write error");
-  if (attributes & XDMF_REAC)
+
+  h5_cons = group (xf->h5_file, "CONSTRAINTS");
+  first = append_rows (h5_cons, "GEOM", H5T_NATIVE_DOUBLE, 3, gap_count, point);
+  if (xf->attributes & XDMF_REAC)
   {
-    ASSERT_TEXT (H5LTmake_dataset_double (h5_step, "REAC", 2, dims, reac) >= 0, "HDF5 file write error");
+    append_rows (h5_cons, "REAC", H5T_NATIVE_DOUBLE, 3, gap_count, reac);
   }
-  if (attributes & XDMF_RELV)
+  if (xf->attributes & XDMF_RELV)
   {
-    ASSERT_TEXT (H5LTmake_dataset_double (h5_step, "RELV", 2, dims, relv) >= 0, "HDF5 file write error");
+    append_rows (h5_cons, "RELV", H5T_NATIVE_DOUBLE, 3, gap_count, relv);
   }
-  if (attributes & XDMF_GAP)
+  if (xf->attributes & XDMF_GAP)
   {
-    ASSERT_TEXT (H5LTmake_dataset_double (h5_step, "GAP", 1, &ncon, gap) >= 0, "HDF5 file write error");
+    append_rows (h5_cons, "GAP", H5T_NATIVE_DOUBLE, 1, gap_count, gap);
   }
-  H5Gclose (h5_step);
+  series_add (&xf->constraints, xf->frames-1, first, gap_count);
+  H5Gclose (h5_cons);
 
   free (point);
   free (reac);
   free (relv);
   free (gap);
- 
-  H5Gclose (h5_cons);
 }
 
-/* Export results in XDMF format;
- * ntimes > 0 --> number of individual time instances;
- * ntimes < 0 --> a time interval from times[0] to times[1];
- * ntimes = 0 --> export current geometry only without attributes;
- */
-void xdmf_export (SOLFEC *sol, double *times, int ntimes, char *path, SET *subset, int attributes)
+/* append current time and state */
+static void append (XDMF *xf, DOM *dom, int constraints)
 {
-  /* First --> write heavu data into a HDF5 file */
-  int *gid = NULL, gid_count = 0, gid_size = 0;
-  char *h5_path = path_and_dirs (path, ".h5");
-  MAP *gids = NULL;
-  hsize_t h5_size;
-  hid_t h5_file;
-  char *xmf_path;
-  FILE *xmf_file;
+  if (xf->frames && dom->time <= xf->times [xf->frames-1]) return; /* already exported */
 
-  printf ("XDMF_EXPORT --> starting ...\n");
+  pack_double (&xf->times_size, &xf->times, &xf->frames, dom->time);
+  append_rows (xf->h5_file, "TIMES", H5T_NATIVE_DOUBLE, 1, 1, &dom->time);
 
-  ASSERT_TEXT ((h5_file = H5Fcreate(h5_path, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT)) >= 0, "HDF5 file open error");
+  write_bodies (xf, dom);
 
-  if (ntimes < 0)
-  {
-    double start, end, t0, t1;
+  if (constraints) write_constraints (xf, dom);
+}
 
-    SOLFEC_Time_Limits (sol, &start, &end);
+/* write markup of 'rows' rows of an appended dataset, starting at row 'first' */
+static void xmf_slab (FILE *xmf_file, XDMF *xf, char *dataset, char *type, int first, int rows, int cols, int total)
+{
+  if (cols > 1)
+  {
+    fprintf (xmf_file, "<DataItem ItemType=\"HyperSlab\" Dimensions=\"%d %d\" Type=\"HyperSlab\">\n", rows, cols);
+    fprintf (xmf_file, "<DataItem Dimensions=\"3 2\" Format=\"XML\">%d 0 1 1 %d %d</DataItem>\n", first, rows, cols);
+    fprintf (xmf_file, "<DataItem Dimensions=\"%d %d\" %s Format=\"HDF\">%s:%s</DataItem>\n", total, cols, type, xf->h5_name, dataset);
+  }
+  else
+  {
+    fprintf (xmf_file, "<DataItem ItemType=\"HyperSlab\" Dimensions=\"%d\" Type=\"HyperSlab\">\n", rows);
+    fprintf (xmf_file, "<DataItem Dimensions=\"3 1\" Format=\"XML\">%d 1 %d</DataItem>\n", first, rows);
+    fprintf (xmf_file, "<DataItem Dimensions=\"%d\" %s Format=\"HDF\">%s:%s</DataItem>\n", total, type, xf->h5_name, dataset);
+  }
+  fprintf (xmf_file, "</DataItem>\n");
+}
 
-    t0 = MAX (start, times[0]);
+/* write markup of an attribute stored in an appended dataset */
+static void xmf_attribute (FILE *xmf_file, XDMF *xf, char *name, char *center, char *dataset, char *type, int first, int rows, int cols, int total)
+{
+  fprintf (xmf_file, "<Attribute Name=\"%s\" Center=\"%s\" AttributeType=\"%s\">\n", name, center, cols == 6 ? "Tensor6" : (cols == 3 ? "Vector" : "Scalar"));
+  xmf_slab (xmf_file, xf, dataset, type, first, rows, cols, total);
+  fprintf (xmf_file, "</Attribute>\n");
+}
 
-    t1 = MIN (end, times[1]);
+/* open markup file */
+static FILE* xmf_open (XDMF *xf, char *ext, char *collection)
+{
+  char *xmf_path = path_and_dirs (xf->path, ext);
+  FILE *xmf_file = fopen (xmf_path, "w");
+  ASSERT_TEXT (xmf_file, "Opening XDMF markup file %s has failed", xmf_path);
+  free (xmf_path);
 
-    printf ("XDMF_EXPORT --> seeking to time %g ...\n", t0);
+  fprintf (xmf_file, "<Xdmf>\n");
+  fprintf (xmf_file, "<Domain>\n");
+  fprintf (xmf_file, "<Grid GridType=\"Collection\" CollectionType=\"%s\">\n\n", collection);
 
-    SOLFEC_Seek_To (sol, t0);
+  return xmf_file;
+}
 
-    do
-    {
-      printf ("XDMF_EXPORT --> writing bodies at time %g ...\n", sol->dom->time);
+/* close markup file */
+static void xmf_close (FILE *xmf_file)
+{
+  fprintf (xmf_file, "</Grid>\n");
+  fprintf (xmf_file, "</Domain>\n");
+  fprintf (xmf_file, "</Xdmf>\n");
+  fclose (xmf_file);
+}
 
-      write_bodies (sol->dom, h5_file, &gids, &gid, &gid_count, &gid_size, subset, attributes);
+#define FLOAT "NumberType=\"Float\" Precision=\"8\""
+#define INT "NumberType=\"Int\""
 
-      printf ("XDMF_EXPORT --> writing constraints at time %g ...\n", sol->dom->time);
+/* write grids markup */
+static void xmf_grids (XDMF *xf)
+{
+  FILE *xmf_file = xmf_open (xf, "_grids.xmf", "Spatial");
+  char dataset [1024];
 
-      write_constraints (sol->dom, h5_file, subset, attributes);
+  for (XDMF_GRID *g = xf->grids; g; g = g->next)
+  {
+    int total = series_rows (&g->steps);
 
-      printf ("XDMF_EXPORT --> moving to next time step ...\n");
+    fprintf (xmf_file, "<Grid GridType=\"Collection\" CollectionType=\"Temporal\">\n");
 
-      SOLFEC_Forward (sol, 1, 0);
-    }
-    while (sol->dom->time < t1);
-  }
-  else if (ntimes > 0)
-  {
-    for (int i = 0; i < ntimes; i ++)
+    for (int *r = g->steps.rec, *e = r + g->steps.count; r < e; r += 3)
     {
-      printf ("XDMF_EXPORT --> seeking to time %g ...\n", times[i]);
+      fprintf (xmf_file, "<Grid Name=\"%s\" Type=\"Uniform\">\n", g->label);
+      fprintf (xmf_file, "<Time Type=\"Single\" Value=\"%.15g\" />\n", xf->times [r[0]]);
 
-      SOLFEC_Seek_To (sol, times[i]);
+      fprintf (xmf_file, "<Topology Type=\"Mixed\" NumberOfElements=\"%d\">\n", g->elements);
+      fprintf (xmf_file, "<DataItem Dimensions=\"%d\" " INT " Format=\"HDF\">%s:/GRIDS/%d/TOPO</DataItem>\n", g->topo_size, xf->h5_name, g->id);
+      fprintf (xmf_file, "</Topology>\n");
 
-      printf ("XDMF_EXPORT --> writing bodies at time %g ...\n", times[i]);
+      fprintf (xmf_file, "<Geometry GeometryType=\"XYZ\">\n");
+      snprintf (dataset, 1024, "/GRIDS/%d/GEOM", g->id);
+      xmf_slab (xmf_file, xf, dataset, FLOAT, r[1], r[2], 3, total);
+      fprintf (xmf_file, "</Geometry>\n");
 
-      write_bodies (sol->dom, h5_file, &gids, &gid, &gid_count, &gid_size, subset, attributes);
+      fprintf (xmf_file, "<Attribute Name=\"BID\" Center=\"Cell\" AttributeType=\"Scalar\">\n");
+      fprintf (xmf_file, "<DataItem Dimensions=\"%d\" " INT " Format=\"HDF\">%s:/GRIDS/%d/BID</DataItem>\n", g->elements, xf->h5_name, g->id);
+      fprintf (xmf_file, "</Attribute>\n");
 
-      printf ("XDMF_EXPORT --> writing constraints at time %g ...\n", times[i]);
+      if (xf->attributes & XDMF_DISP)
+      {
+	snprintf (dataset, 1024, "/GRIDS/%d/DISP", g->id);
+	xmf_attribute (xmf_file, xf, "DISP", "Node", dataset, FLOAT, r[1], r[2], 3, total);
+      }
+      if (xf->attributes & XDMF_VELO)
+      {
+	snprintf (dataset, 1024, "/GRIDS/%d/VELO", g->id);
+	xmf_attribute (xmf_file, xf, "VELO", "Node", dataset, FLOAT, r[1], r[2], 3, total);
+      }
+      if (xf->attributes & XDMF_STRESS)
+      {
+	snprintf (dataset, 1024, "/GRIDS/%d/STRESS", g->id);
+	xmf_attribute (xmf_file, xf, "STRESS", "Node", dataset, FLOAT, r[1], r[2], 6, total);
+      }
 
-      write_constraints (sol->dom, h5_file, subset, attributes);
+      fprintf (xmf_file, "</Grid>\n");
     }
-  }
-  else
-  {
-    attributes = 0;
 
-    printf ("XDMF_EXPORT --> writing bodies at time 0 ...\n");
-
-    write_bodies (sol->dom, h5_file, &gids, &gid, &gid_count, &gid_size, subset, 0);
+    fprintf (xmf_file, "</Grid>\n\n");
   }
 
-  ASSERT_TEXT (H5LTset_attribute_int (h5_file, ".", "GRID_COUNT", &gid_count, 1) >= 0, "HDF5 file write error");
-  h5_size = gid_count;
-  ASSERT_TEXT (H5LTmake_dataset_int (h5_file, "GRID_IDS", 1, &h5_size, gid) >= 0, "HDF5 file write error");
+  xmf_close (xmf_file);
+}
 
-  int k = strlen (h5_path) - 1;
-  while (k >= 0 && h5_path[k] != '/') k --;
-  char *h5_file_name = &h5_path[k+1];
+/* write constraints markup */
+static void xmf_constraints (XDMF *xf)
+{
+  FILE *xmf_file = xmf_open (xf, "_constraints.xmf", "Temporal");
+  int total = series_rows (&xf->constraints);
 
-  /* Second --> using the information from the HDF5 file write XDMF file --> Grids */
-  if (H5Lexists (h5_file, "GRIDS", H5P_DEFAULT))
+  for (int *r = xf->constraints.rec, *e = r + xf->constraints.count; r < e; r += 3)
   {
-    printf ("XDMF_EXPORT --> exporting grids markup ...\n");
-
-    xmf_path = path_and_dirs (path, "_grids.xmf");
-    xmf_file = fopen (xmf_path, "w");
-    ASSERT_TEXT (xmf_file, "Opening XDMF markup file %s has failed", xmf_path);
-
-    fprintf (xmf_file, "<Xdmf>\n");
-    fprintf (xmf_file, "<Domain>\n");
+    fprintf (xmf_file, "<Grid Name=\"CONS%d\" Type=\"Uniform\">\n", r[0]);
+    fprintf (xmf_file, "<Time Type=\"Single\" Value=\"%.15g\" />\n", xf->times [r[0]]);
+    fprintf (xmf_file, "<Topology Type=\"Polyvertex\" NumberOfElements=\"%d\">\n", r[2]);
+    fprintf (xmf_file, "</Topology>\n");
 
-    fprintf (xmf_file, "<Grid GridType=\"Collection\" CollectionType=\"Spatial\">\n\n");
-
-    for (int i = 0; i < gid_count; i ++)
+    if (r[2] > 0) /* frames without constraints are kept to hide stale points */
     {
-      char h5_text [1024];
-
-      snprintf (h5_text, 1024, "/GRIDS/%d", gid[i]);
-
-      fprintf (xmf_file, "<Grid GridType=\"Collection\" CollectionType=\"Temporal\">\n");
-
-      int steps = read_int (h5_file, h5_text, "STEPS");
-      int elements = read_int (h5_file, h5_text, "ELEMENTS");
-      int nodes = read_int (h5_file, h5_text, "NODES");
-      int topo_size = read_int (h5_file, h5_text, "TOPO_SIZE");
-      char *label = read_string (h5_file, h5_text, "LABEL");
+      fprintf (xmf_file, "<Geometry GeometryType=\"XYZ\">\n");
+      xmf_slab (xmf_file, xf, "/CONSTRAINTS/GEOM", FLOAT, r[1], r[2], 3, total);
+      fprintf (xmf_file, "</Geometry>\n");
 
-      for (int j = 0; j < steps; j ++)
+      if (xf->attributes & XDMF_REAC)
       {
-	fprintf (xmf_file, "<Grid Name=\"%s\" Type=\"Uniform\">\n", label);
-	snprintf (h5_text, 1024, "/GRIDS/%d/%d", gid[i], j);
-	double time = read_double (h5_file, h5_text, "TIME");
-	fprintf (xmf_file, "<Time Type=\"Single\" Value=\"%f\" />\n", time);
-
-	fprintf (xmf_file, "<Topology Type=\"Mixed\" NumberOfElements=\"%d\">\n", elements);
-	fprintf (xmf_file, "<DataStructure Dimensions=\"%d\" NumberType=\"Int\" Format=\"HDF\">\n", topo_size);
-	fprintf (xmf_file, "%s:/GRIDS/%d/TOPO\n", h5_file_name, gid[i]);
-	fprintf (xmf_file, "</DataStructure>\n");
-	fprintf (xmf_file, "</Topology>\n");
-
-	fprintf (xmf_file, "<Geometry GeometryType=\"XYZ\">\n");
-	fprintf (xmf_file, "<DataStructure Dimensions=\"%d 3\" NumberType=\"Float\" Presicion=\"8\" Format=\"HDF\">\n", nodes);
-	fprintf (xmf_file, "%s:/GRIDS/%d/%d/GEOM\n", h5_file_name, gid[i], j);
-	fprintf (xmf_file, "</DataStructure>\n");
-	fprintf (xmf_file, "</Geometry>\n");
-
-	fprintf (xmf_file, "<Attribute Name=\"BID\" Center=\"Cell\" AttributeType=\"Scalar\">\n");
-	fprintf (xmf_file, "<DataStructure Dimensions=\"%d\" NumberType=\"Int\" Format=\"HDF\">\n", elements);
-	fprintf (xmf_file, "%s:/GRIDS/%d/BID\n", h5_file_name, gid[i]);
-	fprintf (xmf_file, "</DataStructure>\n");
-	fprintf (xmf_file, "</Attribute>\n");
-
-	if (attributes & XDMF_DISP)
-	{
-	  fprintf (xmf_file, "<Attribute Name=\"DISP\" Center=\"Node\" AttributeType=\"Vector\">\n");
-	  fprintf (xmf_file, "<DataStructure Dimensions=\"%d 3\" NumberType=\"Float\" Presicion=\"8\" Format=\"HDF\">\n", nodes);
-	  fprintf (xmf_file, "%s:/GRIDS/%d/%d/DISP\n", h5_file_name, gid[i], j);
-	  fprintf (xmf_file, "</DataStructure>\n");
-	  fprintf (xmf_file, "</Attribute>\n");
-	}
-	if (attributes & XDMF_VELO)
-	{
-	  fprintf (xmf_file, "<Attribute Name=\"VELO\" Center=\"Node\" AttributeType=\"Vector\">\n");
-	  fprintf (xmf_file, "<DataStructure Dimensions=\"%d 3\" NumberType=\"Float\" Presicion=\"8\" Format=\"HDF\">\n", nodes);
-	  fprintf (xmf_file, "%s:/GRIDS/%d/%d/VELO\n", h5_file_name, gid[i], j);
-	  fprintf (xmf_file, "</DataStructure>\n");
-	  fprintf (xmf_file, "</Attribute>\n");
-	}
-	if (attributes & XDMF_STRESS)
-	{
-	  fprintf (xmf_file, "<Attribute Name=\"STRESS\" Center=\"Node\" AttributeType=\"Vector\">\n");
-	  fprintf (xmf_file, "<DataStructure Dimensions=\"%d 6\" NumberType=\"Float\" Presicion=\"8\" Format=\"HDF\">\n", nodes);
-	  fprintf (xmf_file, "%s:/GRIDS/%d/%d/STRESS\n", h5_file_name, gid[i], j);
-	  fprintf (xmf_file, "</DataStructure>\n");
-	  fprintf (xmf_file, "</Attribute>\n");
-	}
-   
-	fprintf (xmf_file, "</Grid>\n");
+	xmf_attribute (xmf_file, xf, "REAC", "Node", "/CONSTRAINTS/REAC", FLOAT, r[1], r[2], 3, total);
+      }
+      if (xf->attributes & XDMF_RELV)
+      {
+	xmf_attribute (xmf_file, xf, "RELV", "Node", "/CONSTRAINTS/RELV", FLOAT, r[1], r[2], 3, total);
+      }
+      if (xf->attributes & XDMF_GAP)
+      {
+	xmf_attribute (xmf_file, xf, "GAP", "Node", "/CONSTRAINTS/GAP", FLOAT, r[1], r[2], 1, total);
       }
-
-      free (label);
-
-      fprintf (xmf_file, "</Grid>\n\n");
     }
 
     fprintf (xmf_file, "</Grid>\n");
-    fprintf (xmf_file, "</Domain>\n");
-    fprintf (xmf_file, "</Xdmf>\n");
-
-    fclose (xmf_file);
-    free (xmf_path);
   }
 
-  /* Third --> using the information from the HDF5 file write XDMF file --> Constraints */
-  if (H5Lexists (h5_file, "CONSTRAINTS", H5P_DEFAULT))
-  {
-    printf ("XDMF_EXPORT --> exporting constraints markup ...\n");
+  xmf_close (xmf_file);
+}
 
-    xmf_path = path_and_dirs (path, "_constraints.xmf");
-    xmf_file = fopen (xmf_path, "w");
-    ASSERT_TEXT (xmf_file, "Opening XDMF markup file %s has failed", xmf_path);
+/* write spheres markup */
+static void xmf_spheres (XDMF *xf)
+{
+  FILE *xmf_file = xmf_open (xf, "_spheres.xmf", "Temporal");
+  int total = series_rows (&xf->spheres);
 
-    fprintf (xmf_file, "<Xdmf>\n");
-    fprintf (xmf_file, "<Domain>\n");
+  for (int *r = xf->spheres.rec, *e = r + xf->spheres.count; r < e; r += 3)
+  {
+    fprintf (xmf_file, "<Grid Name=\"SPHS%d\" Type=\"Uniform\">\n", r[0]);
+    fprintf (xmf_file, "<Time Type=\"Single\" Value=\"%.15g\" />\n", xf->times [r[0]]);
+    fprintf (xmf_file, "<Topology Type=\"Polyvertex\" NumberOfElements=\"%d\">\n", r[2]);
+    fprintf (xmf_file, "</Topology>\n");
 
-    fprintf (xmf_file, "<Grid GridType=\"Collection\" CollectionType=\"Temporal\">\n\n");
+    fprintf (xmf_file, "<Geometry GeometryType=\"XYZ\">\n");
+    xmf_slab (xmf_file, xf, "/SPHERES/GEOM", FLOAT, r[1], r[2], 3, total);
+    fprintf (xmf_file, "</Geometry>\n");
 
-    int con_steps = read_int (h5_file, "CONSTRAINTS", "STEPS");
+    xmf_attribute (xmf_file, xf, "RADI", "Node", "/SPHERES/RADI", FLOAT, r[1], r[2], 1, total);
+    xmf_attribute (xmf_file, xf, "BID", "Node", "/SPHERES/BID", INT, r[1], r[2], 1, total);
 
-    for (int i = 0; i < con_steps; i ++)
+    if (xf->attributes & XDMF_DISP)
+    {
+      xmf_attribute (xmf_file, xf, "DISP", "Node", "/SPHERES/DISP", FLOAT, r[1], r[2], 3, total);
+    }
+    if (xf->attributes & XDMF_VELO)
     {
-      char h5_text [1024];
+      xmf_attribute (xmf_file, xf, "VELO", "Node", "/SPHERES/VELO", FLOAT, r[1], r[2], 3, total);
+    }
+    if (xf->attributes & XDMF_STRESS)
+    {
+      xmf_attribute (xmf_file, xf, "STRESS", "Node", "/SPHERES/STRESS", FLOAT, r[1], r[2], 6, total);
+    }
 
-      snprintf (h5_text, 1024, "/CONSTRAINTS/%d", i);
+    fprintf (xmf_file, "</Grid>\n");
+  }
 
-      int count = read_int (h5_file, h5_text, "COUNT");
-      double time = read_double (h5_file, h5_text, "TIME");
+  xmf_close (xmf_file);
+}
 
-      fprintf (xmf_file, "<Grid Name=\"CONS%d\" Type=\"Uniform\">\n", i);
-      fprintf (xmf_file, "<Time Type=\"Single\" Value=\"%f\" />\n", time);
+/* create streamed export */
+XDMF* XDMF_Create (char *path, SET *subset, int attributes)
+{
+  XDMF *xf;
+  int k;
+
+  ERRMEM (xf = MEM_CALLOC (sizeof (XDMF)));
+  ERRMEM (xf->path = malloc (strlen (path) + 1));
+  strcpy (xf->path, path);
+  xf->h5_path = path_and_dirs (path, ".h5");
+  for (k = strlen (xf->h5_path) - 1; k >= 0 && xf->h5_path[k] != '/'; k --);
+  xf->h5_name = &xf->h5_path[k+1];
+  ASSERT_TEXT ((xf->h5_file = H5Fcreate (xf->h5_path, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT)) >= 0, "HDF5 file open error");
+  for (SET *item = SET_First (subset); item; item = SET_Next (item))
+  {
+    SET_Insert (NULL, &xf->subset, item->data, NULL);
+  }
+  xf->attributes = attributes;
 
-      fprintf (xmf_file, "<Topology Type=\"Polyvertex\" NumberOfElements=\"%d\">\n", count);
-      fprintf (xmf_file, "</Topology>\n");
+  return xf;
+}
 
-      fprintf (xmf_file, "<Geometry GeometryType=\"XYZ\">\n");
-      fprintf (xmf_file, "<DataStructure Dimensions=\"%d 3\" NumberType=\"Float\" Presicion=\"8\" Format=\"HDF\">\n", count);
-      fprintf (xmf_file, "%s:/CONSTRAINTS/%d/GEOM\n", h5_file_name, i);
-      fprintf (xmf_file, "</DataStructure>\n");
-      fprintf (xmf_file, "</Geometry>\n");
+/* append current domain state */
+void XDMF_Append (XDMF *xf, DOM *dom)
+{
+  append (xf, dom, 1);
+}
 
-      if (attributes & XDMF_REAC)
-      {
-	fprintf (xmf_file, "<Attribute Name=\"REAC\" Center=\"Node\" AttributeType=\"Vector\">\n");
-	fprintf (xmf_file, "<DataStructure Dimensions=\"%d 3\" NumberType=\"Float\" Presicion=\"8\" Format=\"HDF\">\n", count);
-	fprintf (xmf_file, "%s:/CONSTRAINTS/%d/REAC\n", h5_file_name, i);
-	fprintf (xmf_file, "</DataStructure>\n");
-	fprintf (xmf_file, "</Attribute>\n");
-      }
-      if (attributes & XDMF_RELV)
-      {
-	fprintf (xmf_file, "<Attribute Name=\"RELV\" Center=\"Node\" AttributeType=\"Vector\">\n");
-	fprintf (xmf_file, "<DataStructure Dimensions=\"%d 3\" NumberType=\"Float\" Presicion=\"8\" Format=\"HDF\">\n", count);
-	fprintf (xmf_file, "%s:/CONSTRAINTS/%d/RELV\n", h5_file_name, i);
-	fprintf (xmf_file, "</DataStructure>\n");
-	fprintf (xmf_file, "</Attribute>\n");
-      }
-      if (attributes & XDMF_GAP)
-      {
-	fprintf (xmf_file, "<Attribute Name=\"GAP\" Center=\"Node\" AttributeType=\"Scalar\">\n");
-	fprintf (xmf_file, "<DataStructure Dimensions=\"%d\" NumberType=\"Float\" Presicion=\"8\" Format=\"HDF\">\n", count);
-	fprintf (xmf_file, "%s:/CONSTRAINTS/%d/GAP\n", h5_file_name, i);
-	fprintf (xmf_file, "</DataStructure>\n");
-	fprintf (xmf_file, "</Attribute>\n");
-      }
+/* write markup of all frames appended so far */
+void XDMF_Markup (XDMF *xf)
+{
+  H5Fflush (xf->h5_file, H5F_SCOPE_GLOBAL); /* markup readers see all referenced data */
 
-      fprintf (xmf_file, "</Grid>\n");
-    }
+  if (xf->grids) xmf_grids (xf);
 
-    fprintf (xmf_file, "</Grid>\n");
-    fprintf (xmf_file, "</Domain>\n");
-    fprintf (xmf_file, "</Xdmf>\n");
+  if (xf->constraints.count) xmf_constraints (xf);
 
-    fclose (xmf_file);
-    free (xmf_path);
-  }
+  if (xf->spheres.count) xmf_spheres (xf);
+}
 
-  /* Fourth --> using the information from the HDF5 file write XDMF file --> Spheres */
-  if (H5Lexists (h5_file, "SPHERES", H5P_DEFAULT))
-  {
-    printf ("XDMF_EXPORT --> exporting spheres markup ...\n");
+/* write markup and release memory */
+void XDMF_Close (XDMF *xf)
+{
+  XDMF_GRID *g, *next;
 
-    xmf_path = path_and_dirs (path, "_spheres.xmf");
-    xmf_file = fopen (xmf_path, "w");
-    ASSERT_TEXT (xmf_file, "Opening XDMF markup file %s has failed", xmf_path);
+  XDMF_Markup (xf);
 
-    fprintf (xmf_file, "<Xdmf>\n");
-    fprintf (xmf_file, "<Domain>\n");
+  for (g = xf->grids; g; g = next)
+  {
+    next = g->next;
+    free (g->steps.rec);
+    free (g->label);
+    free (g);
+  }
 
-    fprintf (xmf_file, "<Grid GridType=\"Collection\" CollectionType=\"Temporal\">\n\n");
+  H5Fclose (xf->h5_file);
+  MAP_Free (NULL, &xf->gids);
+  SET_Free (NULL, &xf->subset);
+  free (xf->constraints.rec);
+  free (xf->spheres.rec);
+  free (xf->times);
+  free (xf->h5_path);
+  free (xf->path);
+  free (xf);
+}
 
-    int sph_steps = read_int (h5_file, "SPHERES", "STEPS");
+/* Export results in XDMF format;
+ * ntimes > 0 --> number of individual time instances;
+ * ntimes < 0 --> a time interval from times[0] to times[1];
+ * ntimes = 0 --> export current geometry only without attributes;
+ */
+void xdmf_export (SOLFEC *sol, double *times, int ntimes, char *path, SET *subset, int attributes)
+{
+  XDMF *xf;
 
-    for (int i = 0; i < sph_steps; i ++)
-    {
-      char h5_text [1024];
+  printf ("XDMF_EXPORT --> starting ...\n");
 
-      snprintf (h5_text, 1024, "/SPHERES/%d", i);
+  xf = XDMF_Create (path, subset, ntimes ? attributes : 0);
 
-      int count = read_int (h5_file, h5_text, "COUNT");
-      double time = read_double (h5_file, h5_text, "TIME");
+  if (ntimes < 0)
+  {
+    double start, end, t0, t1;
 
-      fprintf (xmf_file, "<Grid Name=\"SPHS%d\" Type=\"Uniform\">\n", i);
-      fprintf (xmf_file, "<Time Type=\"Single\" Value=\"%f\" />\n", time);
+    SOLFEC_Time_Limits (sol, &start, &end);
 
-      fprintf (xmf_file, "<Topology Type=\"Polyvertex\" NumberOfElements=\"%d\">\n", count);
-      fprintf (xmf_file, "</Topology>\n");
+    t0 = MAX (start, times[0]);
 
-      fprintf (xmf_file, "<Geometry GeometryType=\"XYZ\">\n");
-      fprintf (xmf_file, "<DataStructure Dimensions=\"%d 3\" NumberType=\"Float\" Presicion=\"8\" Format=\"HDF\">\n", count);
-      fprintf (xmf_file, "%s:/SPHERES/%d/GEOM\n", h5_file_name, i);
-      fprintf (xmf_file, "</DataStructure>\n");
-      fprintf (xmf_file, "</Geometry>\n");
+    t1 = MIN (end, times[1]);
 
-      fprintf (xmf_file, "<Attribute Name=\"RADI\" Center=\"Node\" AttributeType=\"Scalar\">\n");
-      fprintf (xmf_file, "<DataStructure Dimensions=\"%d\" NumberType=\"Float\" Presicion=\"8\" Format=\"HDF\">\n", count);
-      fprintf (xmf_file, "%s:/SPHERES/%d/RADI\n", h5_file_name, i);
-      fprintf (xmf_file, "</DataStructure>\n");
-      fprintf (xmf_file, "</Attribute>\n");
+    printf ("XDMF_EXPORT --> seeking to time %g ...\n", t0);
 
-      fprintf (xmf_file, "<Attribute Name=\"BID\" Center=\"Node\" AttributeType=\"Scalar\">\n");
-      fprintf (xmf_file, "<DataStructure Dimensions=\"%d\" NumberType=\"Int\" Format=\"HDF\">\n", count);
-      fprintf (xmf_file, "%s:/SPHERES/%d/BID\n", h5_file_name, i);
-      fprintf (xmf_file, "</DataStructure>\n");
-      fprintf (xmf_file, "</Attribute>\n");
+    SOLFEC_Seek_To (sol, t0);
 
-      if (attributes & XDMF_DISP)
-      {
-	fprintf (xmf_file, "<Attribute Name=\"DISP\" Center=\"Node\" AttributeType=\"Vector\">\n");
-	fprintf (xmf_file, "<DataStructure Dimensions=\"%d 3\" NumberType=\"Float\" Presicion=\"8\" Format=\"HDF\">\n", count);
-	fprintf (xmf_file, "%s:/SPHERES/%d/DISP\n", h5_file_name, i);
-	fprintf (xmf_file, "</DataStructure>\n");
-	fprintf (xmf_file, "</Attribute>\n");
-      }
-      if (attributes & XDMF_VELO)
-      {
-	fprintf (xmf_file, "<Attribute Name=\"VELO\" Center=\"Node\" AttributeType=\"Vector\">\n");
-	fprintf (xmf_file, "<DataStructure Dimensions=\"%d 3\" NumberType=\"Float\" Presicion=\"8\" Format=\"HDF\">\n", count);
-	fprintf (xmf_file, "%s:/SPHERES/%d/VELO\n", h5_file_name, i);
-	fprintf (xmf_file, "</DataStructure>\n");
-	fprintf (xmf_file, "</Attribute>\n");
-      }
-      if (attributes & XDMF_STRESS)
-      {
-	fprintf (xmf_file, "<Attribute Name=\"STRESS\" Center=\"Node\" AttributeType=\"Vector\">\n");
-	fprintf (xmf_file, "<DataStructure Dimensions=\"%d 6\" NumberType=\"Float\" Presicion=\"8\" Format=\"HDF\">\n", count);
-	fprintf (xmf_file, "%s:/SPHERE/%d/STRESS\n", h5_file_name, i);
-	fprintf (xmf_file, "</DataStructure>\n");
-	fprintf (xmf_file, "</Attribute>\n");
-      }
+    printf ("XDMF_EXPORT --> writing frames up to time %g ...\n", t1);
 
-      fprintf (xmf_file, "</Grid>\n");
+    for (double t = -DBL_MAX; sol->dom->time > t && sol->dom->time <= t1; SOLFEC_Forward (sol, 1, 0)) /* a single forward pass */
+    {
+      append (xf, sol->dom, 1);
+
+      t = sol->dom->time;
     }
+  }
+  else if (ntimes > 0)
+  {
+    for (int i = 0; i < ntimes; i ++)
+    {
+      printf ("XDMF_EXPORT --> writing frame at time %g ...\n", times[i]);
 
-    fprintf (xmf_file, "</Grid>\n");
-    fprintf (xmf_file, "</Domain>\n");
-    fprintf (xmf_file, "</Xdmf>\n");
+      SOLFEC_Seek_To (sol, times[i]);
 
-    fclose (xmf_file);
-    free (xmf_path);
+      append (xf, sol->dom, 1);
+    }
+  }
+  else
+  {
+    printf ("XDMF_EXPORT --> writing bodies at time %g ...\n", sol->dom->time);
+
+    append (xf, sol->dom, 0);
   }
 
-  /* Clean up */
-  free (gid);
-  free (h5_path);
-  H5Fclose (h5_file);
-  MAP_Free (NULL, &gids);
+  printf ("XDMF_EXPORT --> exporting markup ...\n");
+
+  XDMF_Close (xf);
 
   printf ("XDMF_EXPORT --> finished.\n");
 }
 #else
-void xdmf_export (SOLFEC *sol, double *times, int ntimes, char *path)
+XDMF* XDMF_Create (char *path, SET *subset, int attributes)
+{
+  fprintf (stderr, "Error: XDMF export is not supported without HDF5 --> Re-compile Soflec with HDF5 support.\n");
+  return NULL;
+}
+
+void XDMF_Append (XDMF *xf, DOM *dom)
+{
+}
+
+void XDMF_Markup (XDMF *xf)
+{
+}
+
+void XDMF_Close (XDMF *xf)
+{
+}
+
+void xdmf_export (SOLFEC *sol, double *times, int ntimes, char *path, SET *subset, int attributes)
 {
   fprintf (stderr, "Error: XDMF export is not supported without HDF5 --> Re-compile Soflec with HDF5 support.\n");
 }
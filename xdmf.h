@@ -27,6 +27,8 @@ SOFTWARE.
 #ifndef __xdmf__
 #define __xdmf__
 
+#include "sol.h"
+
 enum
 {
   XDMF_DISP = 1,
@@ -37,11 +39,26 @@ enum
   XDMF_GAP = 32
 };
 
+typedef struct xdmf XDMF;
+
+/* create streamed export into 'path'.h5 and 'path'_*.xmf files; 'subset' of body ids can be NULL;
+ * return NULL if HDF5 support is not compiled in */
+XDMF* XDMF_Create (char *path, SET *subset, int attributes);
+
+/* append current domain state; frames not later than the last exported one are skipped */
+void XDMF_Append (XDMF *xf, DOM *dom);
+
+/* flush heavy data and rewrite markup of all frames appended so far */
+void XDMF_Markup (XDMF *xf);
+
+/* write markup, close files and release memory */
+void XDMF_Close (XDMF *xf);
+
 /* Export results in XDMF format;
  * ntimes > 0 --> number of individual time instances;
  * ntimes < 0 --> a time interval from times[0] to times[1];
  * ntimes = 0 --> export current geometry only without attributes;
  */
-//void xdmf_export (SOLFEC *sol, double *times, int ntimes, char *path, SET *subset, int attributes);
+void xdmf_export (SOLFEC *sol, double *times, int ntimes, char *path, SET *subset, int attributes);
 
 #endif